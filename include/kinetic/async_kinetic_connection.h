@@ -0,0 +1,190 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without 
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or 
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public 
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifndef KINETIC_CPP_CLIENT_ASYNC_KINETIC_CONNECTION_H_
+#define KINETIC_CPP_CLIENT_ASYNC_KINETIC_CONNECTION_H_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "kinetic/nonblocking_kinetic_connection.h"
+
+namespace kinetic {
+
+using std::shared_ptr;
+using std::unique_ptr;
+using std::string;
+using std::vector;
+
+/// Where an operation issued through AsyncKineticConnection records its outcome. The state is
+/// also the operation's callback, so each operation allocates it only once.
+class AsyncState {
+  public:
+    AsyncState() : done_(false), status_(StatusCode::OK, "") {}
+
+    virtual ~AsyncState() {}
+
+    bool done() const {
+        return done_.load(std::memory_order_acquire);
+    }
+
+    const KineticStatus &status() const {
+        return status_;
+    }
+
+  protected:
+    // Anything else the operation produces must be stored before this is called
+    void Finish(KineticStatus status) {
+        status_ = status;
+        done_.store(true, std::memory_order_release);
+    }
+
+  private:
+    std::atomic<bool> done_;
+    KineticStatus status_;
+    DISALLOW_COPY_AND_ASSIGN(AsyncState);
+};
+
+template <typename T>
+class AsyncValueState : public AsyncState {
+  public:
+    AsyncValueState() : value_() {}
+
+    T &value() {
+        return value_;
+    }
+
+  private:
+    T value_;
+};
+
+/// The pending outcome of an operation. Copies refer to the same operation. Waiting is done
+/// through the AsyncKineticConnection that issued it, or by running the connection from an event
+/// loop and checking ready.
+class KineticFutureBase {
+  public:
+    explicit KineticFutureBase(const shared_ptr<AsyncState> state) : state_(state) {}
+
+    /// True once the operation has completed, whether or not it succeeded
+    bool ready() const {
+        return state_->done();
+    }
+
+    /// The operation's outcome; only meaningful once ready
+    const KineticStatus &status() const {
+        return state_->status();
+    }
+
+  private:
+    shared_ptr<AsyncState> state_;
+};
+
+template <typename T>
+class KineticFuture : public KineticFutureBase {
+  public:
+    explicit KineticFuture(const shared_ptr<AsyncValueState<T>> state)
+        : KineticFutureBase(state), value_state_(state.get()) {}
+
+    /// The operation's result; only meaningful once ready and status is ok. May be moved from.
+    T &value() const {
+        return value_state_->value();
+    }
+
+  private:
+    AsyncValueState<T> *value_state_;
+};
+
+template <>
+class KineticFuture<void> : public KineticFutureBase {
+  public:
+    explicit KineticFuture(const shared_ptr<AsyncState> state) : KineticFutureBase(state) {}
+};
+
+/// Issues operations on a nonblocking connection and returns futures for them instead of taking
+/// callbacks, so that many requests can be put in flight and then waited for together. The
+/// Wait methods drive the connection from the calling thread; alternatively call Run from an
+/// event loop and check the futures. Not safe for use by multiple threads.
+class AsyncKineticConnection {
+  public:
+    AsyncKineticConnection(unique_ptr<NonblockingKineticConnection> nonblocking_connection,
+                           unsigned int network_timeout_seconds);
+
+    NonblockingKineticConnection &nonblocking_connection();
+
+    /// Passes through to the nonblocking connection for callers with their own event loop
+    bool Run(SocketInterest *interest);
+
+    KineticFuture<void> NoOp(const RequestOptions &options = RequestOptions());
+
+    KineticFuture<unique_ptr<KineticRecord>> Get(const string &key,
+                                                 const RequestOptions &options = RequestOptions());
+
+    KineticFuture<string> GetVersion(const string &key,
+                                     const RequestOptions &options = RequestOptions());
+
+    KineticFuture<unique_ptr<vector<string>>> GetKeyRange(const string &start_key,
+                                                          bool start_key_inclusive,
+                                                          const string &end_key,
+                                                          bool end_key_inclusive,
+                                                          bool reverse_results,
+                                                          int32_t max_results,
+                                                          const RequestOptions &options = RequestOptions());
+
+    KineticFuture<void> Put(const string &key,
+                            const string &current_version,
+                            WriteMode mode,
+                            const shared_ptr<const KineticRecord> record,
+                            PersistMode persistMode = PersistMode::WRITE_BACK,
+                            const RequestOptions &options = RequestOptions());
+
+    KineticFuture<void> Delete(const string &key,
+                               const string &version,
+                               WriteMode mode,
+                               PersistMode persistMode = PersistMode::WRITE_BACK,
+                               const RequestOptions &options = RequestOptions());
+
+    KineticFuture<void> Flush(const RequestOptions &options = RequestOptions());
+
+    /// Drives the connection until the future is ready and returns its status, or the connection's
+    /// error if it fails or goes network_timeout_seconds without completing anything. Operations
+    /// still pending after an error stay pending; they're failed if the connection itself failed.
+    KineticStatus Wait(const KineticFutureBase &future);
+
+    /// Drives the connection until every future is ready. Returns ok once they are, whatever their
+    /// own statuses, or the connection's error as for Wait.
+    KineticStatus WaitAll(const vector<KineticFutureBase> &futures);
+
+    /// Drives the connection until at least one of the futures is ready and sets ready_index to
+    /// the first of them. Returns ok once one is, or the connection's error as for Wait.
+    KineticStatus WaitAny(const vector<KineticFutureBase> &futures,
+                          size_t *ready_index);
+
+  private:
+    KineticStatus RunUntil(const std::function<size_t()> &pending);
+
+    unique_ptr<NonblockingKineticConnection> nonblocking_connection_;
+    const unsigned int network_timeout_seconds_;
+    DISALLOW_COPY_AND_ASSIGN(AsyncKineticConnection);
+};
+
+} // namespace kinetic
+
+#endif  // KINETIC_CPP_CLIENT_ASYNC_KINETIC_CONNECTION_H_
@@ -21,8 +21,17 @@
 #include "kinetic/blocking_kinetic_connection_interface.h"
 #include "kinetic/nonblocking_kinetic_connection.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+
 namespace kinetic {
 
+/// Safe to use from several threads at once. Each thread submits its own requests and sleeps until
+/// they complete, while whichever waiting thread currently leads drives the socket for all of
+/// them, so requests from different threads are pipelined on the one connection.
 class BlockingKineticConnection : public BlockingKineticConnectionInterface {
   public:
     explicit BlockingKineticConnection(unique_ptr<NonblockingKineticConnection> nonblocking_connection,
@@ -34,35 +43,43 @@ class BlockingKineticConnection : public BlockingKineticConnectionInterface {
     /// tells the client the correct cluster version using this method.
     void SetClientClusterVersion(int64_t cluster_version);
 
-    KineticStatus NoOp();
+    KineticStatus NoOp(const RequestOptions &options = RequestOptions());
 
     KineticStatus Get(const shared_ptr<const string> key,
-                      unique_ptr<KineticRecord> &record);
+                      unique_ptr<KineticRecord> &record,
+                      const RequestOptions &options = RequestOptions());
 
     KineticStatus Get(const string &key,
-                      unique_ptr<KineticRecord> &record);
+                      unique_ptr<KineticRecord> &record,
+                      const RequestOptions &options = RequestOptions());
 
     KineticStatus GetNext(const shared_ptr<const string> key,
                           unique_ptr<string> &actual_key,
-                          unique_ptr<KineticRecord> &record);
+                          unique_ptr<KineticRecord> &record,
+                          const RequestOptions &options = RequestOptions());
 
     KineticStatus GetNext(const string &key,
                           unique_ptr<string> &actual_key,
-                          unique_ptr<KineticRecord> &record);
+                          unique_ptr<KineticRecord> &record,
+                          const RequestOptions &options = RequestOptions());
 
     KineticStatus GetPrevious(const shared_ptr<const string> key,
                               unique_ptr<string> &actual_key,
-                              unique_ptr<KineticRecord> &record);
+                              unique_ptr<KineticRecord> &record,
+                              const RequestOptions &options = RequestOptions());
 
     KineticStatus GetPrevious(const string &key,
                               unique_ptr<string> &actual_key,
-                              unique_ptr<KineticRecord> &record);
+                              unique_ptr<KineticRecord> &record,
+                              const RequestOptions &options = RequestOptions());
 
     KineticStatus GetVersion(const shared_ptr<const string> key,
-                             unique_ptr<string> &version);
+                             unique_ptr<string> &version,
+                             const RequestOptions &options = RequestOptions());
 
     KineticStatus GetVersion(const string &key,
-                             unique_ptr<string> &version);
+                             unique_ptr<string> &version,
+                             const RequestOptions &options = RequestOptions());
 
     KineticStatus GetKeyRange(const shared_ptr<const string> start_key,
                               bool start_key_inclusive,
@@ -70,7 +87,8 @@ class BlockingKineticConnection : public BlockingKineticConnectionInterface {
                               bool end_key_inclusive,
                               bool reverse_results,
                               int32_t max_results,
-                              unique_ptr<vector<string>> &keys);
+                              unique_ptr<vector<string>> &keys,
+                              const RequestOptions &options = RequestOptions());
 
     KineticStatus GetKeyRange(const string &start_key,
                               bool start_key_inclusive,
@@ -78,7 +96,8 @@ class BlockingKineticConnection : public BlockingKineticConnectionInterface {
                               bool end_key_inclusive,
                               bool reverse_results,
                               int32_t max_results,
-                              unique_ptr<vector<string>> &keys);
+                              unique_ptr<vector<string>> &keys,
+                              const RequestOptions &options = RequestOptions());
 
     KeyRangeIterator IterateKeyRange(const shared_ptr<const string> start_key,
                                      bool start_key_inclusive,
@@ -98,7 +117,8 @@ class BlockingKineticConnection : public BlockingKineticConnectionInterface {
                             bool end_key_inclusive,
                             int32_t max_results,
                             unique_ptr<string> &last_handled_key,
-                            unique_ptr<vector<string>> &keys);
+                            unique_ptr<vector<string>> &keys,
+                            const RequestOptions &options = RequestOptions());
 
     KineticStatus MediaScan(const string &start_key,
                             bool start_key_inclusive,
@@ -106,117 +126,182 @@ class BlockingKineticConnection : public BlockingKineticConnectionInterface {
                             bool end_key_inclusive,
                             int32_t max_results,
                             unique_ptr<string> &last_handled_key,
-                            unique_ptr<vector<string>> &keys);
+                            unique_ptr<vector<string>> &keys,
+                            const RequestOptions &options = RequestOptions());
 
     KineticStatus MediaOptimize(const shared_ptr<const string> start_key,
                                 bool start_key_inclusive,
                                 const shared_ptr<const string> end_key,
                                 bool end_key_inclusive,
-                                unique_ptr<string> &last_handled_key);
+                                unique_ptr<string> &last_handled_key,
+                                const RequestOptions &options = RequestOptions());
 
     KineticStatus MediaOptimize(const string &start_key,
                                 bool start_key_inclusive,
                                 const string &end_key,
                                 bool end_key_inclusive,
-                                unique_ptr<string> &last_handled_key);
+                                unique_ptr<string> &last_handled_key,
+                                const RequestOptions &options = RequestOptions());
 
     KineticStatus Put(const shared_ptr<const string> key,
                       const shared_ptr<const string> current_version,
                       WriteMode mode,
                       const shared_ptr<const KineticRecord> record,
-                      PersistMode persistMode);
+                      PersistMode persistMode,
+                      const RequestOptions &options = RequestOptions());
 
     KineticStatus Put(const string &key,
                       const string &current_version,
                       WriteMode mode,
                       const KineticRecord &record,
-                      PersistMode persistMode);
+                      PersistMode persistMode,
+                      const RequestOptions &options = RequestOptions());
 
     KineticStatus Put(const shared_ptr<const string> key,
                       const shared_ptr<const string> current_version,
                       WriteMode mode,
-                      const shared_ptr<const KineticRecord> record);
+                      const shared_ptr<const KineticRecord> record,
+                      const RequestOptions &options = RequestOptions());
 
     KineticStatus Put(const string &key,
                       const string &current_version,
                       WriteMode mode,
-                      const KineticRecord &record);
+                      const KineticRecord &record,
+                      const RequestOptions &options = RequestOptions());
 
     KineticStatus Delete(const shared_ptr<const string> key,
                          const shared_ptr<const string> version,
                          WriteMode mode,
-                         PersistMode persistMode);
+                         PersistMode persistMode,
+                         const RequestOptions &options = RequestOptions());
 
     KineticStatus Delete(const string &key,
                          const string &version,
                          WriteMode mode,
-                         PersistMode persistMode);
+                         PersistMode persistMode,
+                         const RequestOptions &options = RequestOptions());
 
     KineticStatus Delete(const shared_ptr<const string> key,
                          const shared_ptr<const string> version,
-                         WriteMode mode);
+                         WriteMode mode,
+                         const RequestOptions &options = RequestOptions());
 
     KineticStatus Delete(const string &key,
                          const string &version,
-                         WriteMode mode);
+                         WriteMode mode,
+                         const RequestOptions &options = RequestOptions());
 
-    KineticStatus GetLog(unique_ptr<DriveLog> &drive_log);
+    KineticStatus GetLog(unique_ptr<DriveLog> &drive_log, const RequestOptions &options = RequestOptions());
 
     KineticStatus GetLog(const vector<Command_GetLog_Type> &types,
-                         unique_ptr<DriveLog> &drive_log);
+                         unique_ptr<DriveLog> &drive_log,
+                         const RequestOptions &options = RequestOptions());
 
     KineticStatus P2PPush(const P2PPushRequest &push_request,
-                          unique_ptr<vector<KineticStatus>> &operation_statuses);
+                          unique_ptr<vector<KineticStatus>> &operation_statuses,
+                          const RequestOptions &options = RequestOptions());
 
     KineticStatus P2PPush(const shared_ptr<const P2PPushRequest> push_request,
-                          unique_ptr<vector<KineticStatus>> &operation_statuses);
+                          unique_ptr<vector<KineticStatus>> &operation_statuses,
+                          const RequestOptions &options = RequestOptions());
+
+    KineticStatus MultiGet(const vector<string> &keys,
+                           vector<unique_ptr<KineticRecord>> &records,
+                           unique_ptr<vector<KineticStatus>> &operation_statuses,
+                           size_t window = kDefaultMultiOperationWindow,
+                           const RequestOptions &options = RequestOptions());
+
+    KineticStatus MultiPut(const vector<PutOperation> &puts,
+                           PersistMode persistMode,
+                           unique_ptr<vector<KineticStatus>> &operation_statuses,
+                           size_t window = kDefaultMultiOperationWindow,
+                           const RequestOptions &options = RequestOptions());
 
-    KineticStatus Flush();
+    KineticStatus MultiDelete(const vector<DeleteOperation> &deletes,
+                              PersistMode persistMode,
+                              unique_ptr<vector<KineticStatus>> &operation_statuses,
+                              size_t window = kDefaultMultiOperationWindow,
+                              const RequestOptions &options = RequestOptions());
 
-    KineticStatus SetClusterVersion(int64_t cluster_version);
+    KineticStatus Flush(const RequestOptions &options = RequestOptions());
 
-    KineticStatus UpdateFirmware(const shared_ptr<const string> new_firmware);
+    KineticStatus SetClusterVersion(int64_t cluster_version, const RequestOptions &options = RequestOptions());
 
-    KineticStatus SetACLs(const shared_ptr<const list<ACL>> acls);
+    KineticStatus UpdateFirmware(const shared_ptr<const string> new_firmware,
+                                 const RequestOptions &options = RequestOptions());
+
+    KineticStatus SetACLs(const shared_ptr<const list<ACL>> acls, const RequestOptions &options = RequestOptions());
 
     KineticStatus SetErasePIN(const shared_ptr<const string> new_pin,
-                              const shared_ptr<const string> current_pin = make_shared<string>());
+                              const shared_ptr<const string> current_pin = make_shared<string>(),
+                              const RequestOptions &options = RequestOptions());
 
     KineticStatus SetErasePIN(const string &new_pin,
-                              const string &current_pin);
+                              const string &current_pin,
+                              const RequestOptions &options = RequestOptions());
 
     KineticStatus SetLockPIN(const shared_ptr<const string> new_pin,
-                             const shared_ptr<const string> current_pin = make_shared<string>());
+                             const shared_ptr<const string> current_pin = make_shared<string>(),
+                             const RequestOptions &options = RequestOptions());
 
     KineticStatus SetLockPIN(const string &new_pin,
-                             const string &current_pin);
+                             const string &current_pin,
+                             const RequestOptions &options = RequestOptions());
 
-    KineticStatus InstantErase(const shared_ptr<string> pin);
+    KineticStatus InstantErase(const shared_ptr<string> pin, const RequestOptions &options = RequestOptions());
 
-    KineticStatus InstantErase(const string &pin);
+    KineticStatus InstantErase(const string &pin, const RequestOptions &options = RequestOptions());
 
-    KineticStatus SecureErase(const shared_ptr<string> pin);
+    KineticStatus SecureErase(const shared_ptr<string> pin, const RequestOptions &options = RequestOptions());
 
-    KineticStatus SecureErase(const string &pin);
+    KineticStatus SecureErase(const string &pin, const RequestOptions &options = RequestOptions());
 
-    KineticStatus LockDevice(const shared_ptr<string> pin);
+    KineticStatus LockDevice(const shared_ptr<string> pin, const RequestOptions &options = RequestOptions());
 
-    KineticStatus LockDevice(const string &pin);
+    KineticStatus LockDevice(const string &pin, const RequestOptions &options = RequestOptions());
 
-    KineticStatus UnlockDevice(const shared_ptr<string> pin);
+    KineticStatus UnlockDevice(const shared_ptr<string> pin, const RequestOptions &options = RequestOptions());
 
-    KineticStatus UnlockDevice(const string &pin);
+    KineticStatus UnlockDevice(const string &pin, const RequestOptions &options = RequestOptions());
 
   private:
+    struct PendingOperation;
+    struct OperationWaiter;
+
     KineticStatus RunOperation(shared_ptr<BlockingCallbackState> callback,
                                HandlerKey handler_key);
 
+    KineticStatus RunOperations(const vector<shared_ptr<BlockingCallbackState>> &callbacks,
+                                const std::function<HandlerKey(size_t)> &submit,
+                                size_t window,
+                                unique_ptr<vector<KineticStatus>> &operation_statuses);
+
     /// Helper method for translating a StatusCode from the drive into an API client KineticStatus
     /// object
     KineticStatus GetKineticStatus(StatusCode code);
 
+    void Register(PendingOperation *operation);
+
+    void Wait(OperationWaiter *waiter, std::unique_lock<std::mutex> &lock);
+
+    void Lead(OperationWaiter *waiter, std::unique_lock<std::mutex> &lock);
+
+    void Finish(PendingOperation *operation, KineticStatus status, bool aborted);
+
     unique_ptr<NonblockingKineticConnection> nonblocking_connection_;
-    const unsigned int network_timeout_seconds_; DISALLOW_COPY_AND_ASSIGN(BlockingKineticConnection);
+    const unsigned int network_timeout_seconds_;
+
+    /// Guards everything below. The leader runs the connection without holding it, but only
+    /// the leader runs the connection or removes handlers from it.
+    std::mutex mutex_;
+    bool leading_;
+    /// Written to when a request is submitted while the leader may be polling, so that the
+    /// leader sends it rather than waiting for the socket or a timeout
+    int wake_fds_[2];
+    bool wake_pending_;
+    SocketInterest interest_;
+    std::list<PendingOperation *> operations_;
+    DISALLOW_COPY_AND_ASSIGN(BlockingKineticConnection);
 };
 
 } // namespace kinetic
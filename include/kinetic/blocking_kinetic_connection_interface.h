@@ -37,41 +37,74 @@ using std::vector;
 class KeyRangeIterator;
 class BlockingCallbackState;
 
+/// How many requests MultiGet, MultiPut and MultiDelete keep outstanding unless told otherwise
+const size_t kDefaultMultiOperationWindow = 32;
+
+/// A single put for MultiPut
+struct PutOperation {
+    string key;
+
+    /// The version the key is expected to have, as with a regular put
+    string current_version;
+
+    WriteMode mode;
+
+    shared_ptr<const KineticRecord> record;
+};
+
+/// A single delete for MultiDelete
+struct DeleteOperation {
+    string key;
+
+    /// The version the key is expected to have, as with a regular delete
+    string version;
+
+    WriteMode mode;
+};
+
 class BlockingKineticConnectionInterface {
   public:
     virtual ~BlockingKineticConnectionInterface() {}
 
     virtual void SetClientClusterVersion(int64_t cluster_version) = 0;
 
-    virtual KineticStatus NoOp() = 0;
+    virtual KineticStatus NoOp(const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus Get(const shared_ptr<const string> key,
-                              unique_ptr<KineticRecord> &record) = 0;
+                              unique_ptr<KineticRecord> &record,
+                              const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus Get(const string &key,
-                              unique_ptr<KineticRecord> &record) = 0;
+                              unique_ptr<KineticRecord> &record,
+                              const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus GetNext(const shared_ptr<const string> key,
                                   unique_ptr<string> &actual_key,
-                                  unique_ptr<KineticRecord> &record) = 0;
+                                  unique_ptr<KineticRecord> &record,
+                                  const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus GetNext(const string &key,
                                   unique_ptr<string> &actual_key,
-                                  unique_ptr<KineticRecord> &record) = 0;
+                                  unique_ptr<KineticRecord> &record,
+                                  const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus GetPrevious(const shared_ptr<const string> key,
                                       unique_ptr<string> &actual_key,
-                                      unique_ptr<KineticRecord> &record) = 0;
+                                      unique_ptr<KineticRecord> &record,
+                                      const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus GetPrevious(const string &key,
                                       unique_ptr<string> &actual_key,
-                                      unique_ptr<KineticRecord> &record) = 0;
+                                      unique_ptr<KineticRecord> &record,
+                                      const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus GetVersion(const shared_ptr<const string> key,
-                                     unique_ptr<string> &version) = 0;
+                                     unique_ptr<string> &version,
+                                     const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus GetVersion(const string &key,
-                                     unique_ptr<string> &version) = 0;
+                                     unique_ptr<string> &version,
+                                     const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus GetKeyRange(const shared_ptr<const string> start_key,
                                       bool start_key_inclusive,
@@ -79,7 +112,8 @@ class BlockingKineticConnectionInterface {
                                       bool end_key_inclusive,
                                       bool reverse_results,
                                       int32_t max_results,
-                                      unique_ptr<vector<string>> &keys) = 0;
+                                      unique_ptr<vector<string>> &keys,
+                                      const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus GetKeyRange(const string &start_key,
                                       bool start_key_inclusive,
@@ -87,7 +121,8 @@ class BlockingKineticConnectionInterface {
                                       bool end_key_inclusive,
                                       bool reverse_results,
                                       int32_t max_results,
-                                      unique_ptr<vector<string>> &keys) = 0;
+                                      unique_ptr<vector<string>> &keys,
+                                      const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KeyRangeIterator IterateKeyRange(const shared_ptr<const string> start_key,
                                              bool start_key_inclusive,
@@ -107,7 +142,8 @@ class BlockingKineticConnectionInterface {
                                     bool end_key_inclusive,
                                     int32_t max_results,
                                     unique_ptr<string> &last_handled_key,
-                                    unique_ptr<vector<string>> &keys) = 0;
+                                    unique_ptr<vector<string>> &keys,
+                                    const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus MediaScan(const string &start_key,
                                     bool start_key_inclusive,
@@ -115,106 +151,156 @@ class BlockingKineticConnectionInterface {
                                     bool end_key_inclusive,
                                     int32_t max_results,
                                     unique_ptr<string> &last_handled_key,
-                                    unique_ptr<vector<string>> &keys) = 0;
+                                    unique_ptr<vector<string>> &keys,
+                                    const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus MediaOptimize(const shared_ptr<const string> start_key,
                                         bool start_key_inclusive,
                                         const shared_ptr<const string> end_key,
                                         bool end_key_inclusive,
-                                        unique_ptr<string> &last_handled_key) = 0;
+                                        unique_ptr<string> &last_handled_key,
+                                        const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus MediaOptimize(const string &start_key,
                                         bool start_key_inclusive,
                                         const string &end_key,
                                         bool end_key_inclusive,
-                                        unique_ptr<string> &last_handled_key) = 0;
+                                        unique_ptr<string> &last_handled_key,
+                                        const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus Put(const shared_ptr<const string> key,
                               const shared_ptr<const string> current_version,
                               WriteMode mode,
                               const shared_ptr<const KineticRecord> record,
-                              PersistMode persistMode) = 0;
+                              PersistMode persistMode,
+                              const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus Put(const string &key,
                               const string &current_version,
                               WriteMode mode,
                               const KineticRecord &record,
-                              PersistMode persistMode) = 0;
+                              PersistMode persistMode,
+                              const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus Put(const shared_ptr<const string> key,
                               const shared_ptr<const string> current_version,
                               WriteMode mode,
-                              const shared_ptr<const KineticRecord> record) = 0;
+                              const shared_ptr<const KineticRecord> record,
+                              const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus Put(const string &key,
                               const string &current_version,
                               WriteMode mode,
-                              const KineticRecord &record) = 0;
+                              const KineticRecord &record,
+                              const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus Delete(const shared_ptr<const string> key,
                                  const shared_ptr<const string> version,
                                  WriteMode mode,
-                                 PersistMode persistMode) = 0;
+                                 PersistMode persistMode,
+                                 const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus Delete(const string &key,
                                  const string &version,
                                  WriteMode mode,
-                                 PersistMode persistMode) = 0;
+                                 PersistMode persistMode,
+                                 const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus Delete(const shared_ptr<const string> key,
                                  const shared_ptr<const string> version,
-                                 WriteMode mode) = 0;
+                                 WriteMode mode,
+                                 const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus Delete(const string &key,
                                  const string &version,
-                                 WriteMode mode) = 0;
+                                 WriteMode mode,
+                                 const RequestOptions &options = RequestOptions()) = 0;
 
-    virtual KineticStatus GetLog(unique_ptr<DriveLog> &drive_log) = 0;
+    virtual KineticStatus GetLog(unique_ptr<DriveLog> &drive_log, const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus GetLog(const vector<Command_GetLog_Type> &types,
-                                 unique_ptr<DriveLog> &drive_log) = 0;
+                                 unique_ptr<DriveLog> &drive_log,
+                                 const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus P2PPush(const P2PPushRequest &push_request,
-                                  unique_ptr<vector<KineticStatus>> &operation_statuses) = 0;
+                                  unique_ptr<vector<KineticStatus>> &operation_statuses,
+                                  const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus P2PPush(const shared_ptr<const P2PPushRequest> push_request,
-                                  unique_ptr<vector<KineticStatus>> &operation_statuses) = 0;
-
-    virtual KineticStatus Flush() = 0;
-
-    virtual KineticStatus SetClusterVersion(int64_t cluster_version) = 0;
-
-    virtual KineticStatus UpdateFirmware(const shared_ptr<const string> new_firmware) = 0;
-
-    virtual KineticStatus SetACLs(const shared_ptr<const list<ACL>> acls) = 0;
+                                  unique_ptr<vector<KineticStatus>> &operation_statuses,
+                                  const RequestOptions &options = RequestOptions()) = 0;
+
+    /// Gets every key, keeping up to window requests outstanding rather than waiting for each
+    /// response before sending the next request. records and operation_statuses are filled in the
+    /// order of keys; a key's record is null if its status is not ok. Returns OK if every get
+    /// succeeded and the first failure in key order otherwise. The network timeout applies
+    /// from the last completion, not to the call as a whole.
+    virtual KineticStatus MultiGet(const vector<string> &keys,
+                                   vector<unique_ptr<KineticRecord>> &records,
+                                   unique_ptr<vector<KineticStatus>> &operation_statuses,
+                                   size_t window = kDefaultMultiOperationWindow,
+                                   const RequestOptions &options = RequestOptions()) = 0;
+
+    /// Like MultiGet, for puts. Each put is applied independently of the others.
+    virtual KineticStatus MultiPut(const vector<PutOperation> &puts,
+                                   PersistMode persistMode,
+                                   unique_ptr<vector<KineticStatus>> &operation_statuses,
+                                   size_t window = kDefaultMultiOperationWindow,
+                                   const RequestOptions &options = RequestOptions()) = 0;
+
+    /// Like MultiGet, for deletes. Each delete is applied independently of the others.
+    virtual KineticStatus MultiDelete(const vector<DeleteOperation> &deletes,
+                                      PersistMode persistMode,
+                                      unique_ptr<vector<KineticStatus>> &operation_statuses,
+                                      size_t window = kDefaultMultiOperationWindow,
+                                      const RequestOptions &options = RequestOptions()) = 0;
+
+    virtual KineticStatus Flush(const RequestOptions &options = RequestOptions()) = 0;
+
+    virtual KineticStatus SetClusterVersion(int64_t cluster_version,
+                                            const RequestOptions &options = RequestOptions()) = 0;
+
+    virtual KineticStatus UpdateFirmware(const shared_ptr<const string> new_firmware,
+                                         const RequestOptions &options = RequestOptions()) = 0;
+
+    virtual KineticStatus SetACLs(const shared_ptr<const list<ACL>> acls,
+                                  const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus SetErasePIN(const shared_ptr<const string> new_pin,
-                                      const shared_ptr<const string> current_pin = make_shared<string>()) = 0;
+                                      const shared_ptr<const string> current_pin = make_shared<string>(),
+                                      const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus SetErasePIN(const string &new_pin,
-                                      const string &current_pin) = 0;
+                                      const string &current_pin,
+                                      const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus SetLockPIN(const shared_ptr<const string> new_pin,
-                                     const shared_ptr<const string> current_pin = make_shared<string>()) = 0;
+                                     const shared_ptr<const string> current_pin = make_shared<string>(),
+                                     const RequestOptions &options = RequestOptions()) = 0;
 
     virtual KineticStatus SetLockPIN(const string &new_pin,
-                                     const string &current_pin) = 0;
+                                     const string &current_pin,
+                                     const RequestOptions &options = RequestOptions()) = 0;
 
-    virtual KineticStatus InstantErase(const shared_ptr<string> pin) = 0;
+    virtual KineticStatus InstantErase(const shared_ptr<string> pin,
+                                       const RequestOptions &options = RequestOptions()) = 0;
 
-    virtual KineticStatus InstantErase(const string &pin) = 0;
+    virtual KineticStatus InstantErase(const string &pin, const RequestOptions &options = RequestOptions()) = 0;
 
-    virtual KineticStatus SecureErase(const shared_ptr<string> pin) = 0;
+    virtual KineticStatus SecureErase(const shared_ptr<string> pin,
+                                      const RequestOptions &options = RequestOptions()) = 0;
 
-    virtual KineticStatus SecureErase(const string &pin) = 0;
+    virtual KineticStatus SecureErase(const string &pin, const RequestOptions &options = RequestOptions()) = 0;
 
-    virtual KineticStatus LockDevice(const shared_ptr<string> pin) = 0;
+    virtual KineticStatus LockDevice(const shared_ptr<string> pin,
+                                     const RequestOptions &options = RequestOptions()) = 0;
 
-    virtual KineticStatus LockDevice(const string &pin) = 0;
+    virtual KineticStatus LockDevice(const string &pin, const RequestOptions &options = RequestOptions()) = 0;
 
-    virtual KineticStatus UnlockDevice(const shared_ptr<string> pin) = 0;
+    virtual KineticStatus UnlockDevice(const shared_ptr<string> pin,
+                                       const RequestOptions &options = RequestOptions()) = 0;
 
-    virtual KineticStatus UnlockDevice(const string &pin) = 0;
+    virtual KineticStatus UnlockDevice(const string &pin, const RequestOptions &options = RequestOptions()) = 0;
 };
 
 } // namespace kinetic
@@ -0,0 +1,67 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifndef KINETIC_CPP_CLIENT_CONNECTION_ATTEMPT_H_
+#define KINETIC_CPP_CLIENT_CONNECTION_ATTEMPT_H_
+
+#include <memory>
+
+#include "kinetic/nonblocking_kinetic_connection.h"
+#include "kinetic/nonblocking_packet_service_interface.h"
+#include "kinetic/status.h"
+
+namespace kinetic {
+
+using std::unique_ptr;
+
+/// Where a connection attempt has got to after a call to Run
+enum ConnectionAttemptStatus {
+    /// Waiting for the socket
+    kConnectionAttemptInProgress,
+    /// The connection is open and can be taken
+    kConnectionAttemptDone,
+    /// The attempt failed or timed out; it can't be resumed
+    kConnectionAttemptFailed
+};
+
+/// Opens a nonblocking connection without blocking the calling thread. The TCP connect, the TLS
+/// handshake if the connection uses SSL and the wait for the drive's handshake status are each
+/// carried forward when the socket is ready, so one thread can bring up many connections at
+/// once. Start one with KineticConnectionFactory::StartNonblockingConnection, then either drive
+/// it with Run or hand it to KineticReactor::AddConnectionAttempt.
+class ConnectionAttemptInterface {
+  public:
+    virtual ~ConnectionAttemptInterface() {}
+
+    /// Makes as much progress as the socket allows. While kConnectionAttemptInProgress is
+    /// returned, interest says which socket events to wait for, for at most remaining_ms, before
+    /// calling again. The socket may change between calls.
+    virtual ConnectionAttemptStatus Run(SocketInterest *interest) = 0;
+
+    /// Milliseconds left before the attempt times out, 0 once it has
+    virtual int remaining_ms() = 0;
+
+    /// Why the attempt failed
+    virtual Status error() = 0;
+
+    /// Hands over the connection once Run has returned kConnectionAttemptDone
+    virtual unique_ptr<NonblockingKineticConnection> TakeConnection() = 0;
+};
+
+} // namespace kinetic
+
+#endif  // KINETIC_CPP_CLIENT_CONNECTION_ATTEMPT_H_
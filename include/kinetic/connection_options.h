@@ -18,12 +18,23 @@
 #ifndef KINETIC_CPP_CLIENT_CONNECTION_OPTIONS_H_
 #define KINETIC_CPP_CLIENT_CONNECTION_OPTIONS_H_
 
+#include <cstddef>
 #include <string>
 
 namespace kinetic {
 
+/// Hash functions requests and responses can be authenticated with. OpenSSL picks the fastest
+/// implementation the CPU supports (e.g. the SHA extensions) at runtime.
+enum class HmacAlgorithm {
+  SHA1,
+  SHA256
+};
+
 /// Use this struct to pass all connection options to the KineticConnectionFactory.
 struct ConnectionOptions {
+  ConnectionOptions() : hmac_algorithm(HmacAlgorithm::SHA1), max_coalesced_requests(64),
+      max_coalesced_bytes(256 * 1024), zero_copy_threshold(0), connect_timeout_ms(30000) {}
+
   /// The host name or IP address of the kinetic server.
   std::string host;
 
@@ -39,6 +50,29 @@ struct ConnectionOptions {
 
   /// The HMAC key of the user specified in user_id.
   std::string hmac_key;
+
+  /// The algorithm messages are signed and validated with. The drive has to use the same one for
+  /// this user; kinetic protocol 3.0 only defines HMAC-SHA1, so anything else requires a drive
+  /// provisioned for it out of band.
+  HmacAlgorithm hmac_algorithm;
+
+  /// When several requests are waiting to be sent, up to this many of them are gathered into
+  /// each write to the socket. 1 writes every request on its own.
+  size_t max_coalesced_requests;
+
+  /// Requests are only added to a gathered write while it holds fewer than this many bytes of
+  /// messages and values. A single request larger than this is still sent, on its own.
+  size_t max_coalesced_bytes;
+
+  /// On plain TCP connections, nonblocking PUT values of at least this many bytes are sent
+  /// with MSG_ZEROCOPY where the kernel supports it, saving a copy into the socket buffer. The
+  /// page pinning and completion notifications only pay off for large values, from a few
+  /// hundred KB up. 0 turns this off.
+  size_t zero_copy_threshold;
+
+  /// Opening a connection fails if connecting, the TLS handshake and receiving the drive's
+  /// handshake status together take longer than this many milliseconds.
+  unsigned int connect_timeout_ms;
 };
 
 
@@ -0,0 +1,328 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without 
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or 
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public 
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifndef KINETIC_CPP_CLIENT_COROUTINE_KINETIC_CONNECTION_H_
+#define KINETIC_CPP_CLIENT_COROUTINE_KINETIC_CONNECTION_H_
+
+/// co_await-able operations on a nonblocking connection. The library itself is C++11, so this is
+/// only available to code compiled as C++20 with coroutine support.
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define KINETIC_HAVE_COROUTINES 1
+#endif
+#endif
+
+#ifdef KINETIC_HAVE_COROUTINES
+
+#include <atomic>
+#include <coroutine>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "kinetic/nonblocking_kinetic_connection_interface.h"
+
+namespace kinetic {
+
+/// What co_await gives back for operations that produce a value; value is only meaningful if
+/// status is ok
+template <typename T>
+struct KineticResult {
+    KineticStatus status;
+    T value;
+};
+
+/// Resumes the awaiting coroutine from the operation's callback, which runs wherever the
+/// connection is run: a response resumes it from within the receiver's dispatch, on the thread
+/// calling Run. If the operation completes while it's being issued the coroutine carries on
+/// without suspending.
+///
+/// The awaiter lives in the coroutine frame and is the operation's callback, so awaiting
+/// allocates nothing besides what the connection allocates for any request. A suspended
+/// coroutine must therefore not be destroyed until its operation has completed.
+class KineticAwaiterBase {
+  public:
+    KineticAwaiterBase() : state_(kIssuing), status_(StatusCode::OK, "") {}
+
+    KineticAwaiterBase(const KineticAwaiterBase &) = delete;
+    KineticAwaiterBase &operator=(const KineticAwaiterBase &) = delete;
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+  protected:
+    template <typename Issue>
+    bool Suspend(std::coroutine_handle<> handle, Issue &issue) {
+        handle_ = handle;
+        issue();
+        int expected = kIssuing;
+        return state_.compare_exchange_strong(expected, kSuspended, std::memory_order_acq_rel);
+    }
+
+    void Complete(KineticStatus status) {
+        status_ = status;
+        // The coroutine may finish and free this awaiter as soon as it's resumed
+        std::coroutine_handle<> handle = handle_;
+        if (state_.exchange(kCompleted, std::memory_order_acq_rel) == kSuspended) {
+            handle.resume();
+        }
+    }
+
+    /// Hands the awaiter to the connection as its callback. Aliasing an empty shared_ptr shares
+    /// the pointer without allocating or taking ownership.
+    template <typename Callback>
+    static shared_ptr<Callback> NonOwning(Callback *callback) {
+        return shared_ptr<Callback>(shared_ptr<Callback>(), callback);
+    }
+
+    KineticStatus &status() {
+        return status_;
+    }
+
+  private:
+    enum { kIssuing, kSuspended, kCompleted };
+
+    std::atomic<int> state_;
+    std::coroutine_handle<> handle_;
+    KineticStatus status_;
+};
+
+/// Awaits an operation that only succeeds or fails; co_await gives its KineticStatus
+template <typename Issue>
+class KineticStatusAwaiter : public KineticAwaiterBase, public SimpleCallbackInterface,
+    public PutCallbackInterface {
+  public:
+    explicit KineticStatusAwaiter(Issue issue) : issue_(std::move(issue)) {}
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        auto issue = [this]() { issue_(this); };
+        return Suspend(handle, issue);
+    }
+
+    KineticStatus await_resume() {
+        return status();
+    }
+
+    void Success() {
+        Complete(KineticStatus(StatusCode::OK, ""));
+    }
+
+    void Failure(KineticStatus error) {
+        Complete(error);
+    }
+
+    shared_ptr<SimpleCallbackInterface> simple_callback() {
+        return NonOwning<SimpleCallbackInterface>(this);
+    }
+
+    shared_ptr<PutCallbackInterface> put_callback() {
+        return NonOwning<PutCallbackInterface>(this);
+    }
+
+  private:
+    Issue issue_;
+};
+
+template <typename Issue>
+class KineticGetAwaiter : public KineticAwaiterBase, public GetCallbackInterface {
+  public:
+    explicit KineticGetAwaiter(Issue issue) : issue_(std::move(issue)), record_() {}
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        auto issue = [this]() { issue_(NonOwning<GetCallbackInterface>(this)); };
+        return Suspend(handle, issue);
+    }
+
+    KineticResult<unique_ptr<KineticRecord>> await_resume() {
+        return KineticResult<unique_ptr<KineticRecord>>{status(), std::move(record_)};
+    }
+
+    void Success(const string &key,
+                 unique_ptr<KineticRecord> record) {
+        record_ = std::move(record);
+        Complete(KineticStatus(StatusCode::OK, ""));
+    }
+
+    void Failure(KineticStatus error) {
+        Complete(error);
+    }
+
+  private:
+    Issue issue_;
+    unique_ptr<KineticRecord> record_;
+};
+
+template <typename Issue>
+class KineticGetVersionAwaiter : public KineticAwaiterBase, public GetVersionCallbackInterface {
+  public:
+    explicit KineticGetVersionAwaiter(Issue issue) : issue_(std::move(issue)), version_() {}
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        auto issue = [this]() { issue_(NonOwning<GetVersionCallbackInterface>(this)); };
+        return Suspend(handle, issue);
+    }
+
+    KineticResult<string> await_resume() {
+        return KineticResult<string>{status(), std::move(version_)};
+    }
+
+    void Success(const string &version) {
+        version_ = version;
+        Complete(KineticStatus(StatusCode::OK, ""));
+    }
+
+    void Failure(KineticStatus error) {
+        Complete(error);
+    }
+
+  private:
+    Issue issue_;
+    string version_;
+};
+
+template <typename Issue>
+class KineticGetKeyRangeAwaiter : public KineticAwaiterBase, public GetKeyRangeCallbackInterface {
+  public:
+    explicit KineticGetKeyRangeAwaiter(Issue issue) : issue_(std::move(issue)), keys_() {}
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        auto issue = [this]() { issue_(NonOwning<GetKeyRangeCallbackInterface>(this)); };
+        return Suspend(handle, issue);
+    }
+
+    KineticResult<unique_ptr<vector<string>>> await_resume() {
+        return KineticResult<unique_ptr<vector<string>>>{status(), std::move(keys_)};
+    }
+
+    void Success(unique_ptr<vector<string>> keys) {
+        keys_ = std::move(keys);
+        Complete(KineticStatus(StatusCode::OK, ""));
+    }
+
+    void Failure(KineticStatus error) {
+        Complete(error);
+    }
+
+  private:
+    Issue issue_;
+    unique_ptr<vector<string>> keys_;
+};
+
+/// Issues operations on a nonblocking connection as awaitables, for example
+/// `auto result = co_await connection.Get(key);`. Operations are issued when awaited, not when
+/// called. Something must keep running the underlying connection, such as a KineticReactor or the
+/// caller's own loop; with a reactor, start and await from its thread, for instance from a
+/// function passed to KineticReactor::Submit.
+class CoroutineKineticConnection {
+  public:
+    explicit CoroutineKineticConnection(NonblockingKineticConnectionInterface &connection)
+        : connection_(connection) {}
+
+    auto NoOp(const RequestOptions &options = RequestOptions()) {
+        return MakeStatusAwaiter([this, options](auto *awaiter) {
+            connection_.NoOp(awaiter->simple_callback(), options);
+        });
+    }
+
+    auto Get(string key,
+             const RequestOptions &options = RequestOptions()) {
+        return MakeGetAwaiter([this, key = std::move(key), options](shared_ptr<GetCallbackInterface> callback) {
+            connection_.Get(key, callback, options);
+        });
+    }
+
+    auto GetVersion(string key,
+                    const RequestOptions &options = RequestOptions()) {
+        return MakeGetVersionAwaiter([this, key = std::move(key), options](
+                shared_ptr<GetVersionCallbackInterface> callback) {
+            connection_.GetVersion(key, callback, options);
+        });
+    }
+
+    auto GetKeyRange(string start_key,
+                     bool start_key_inclusive,
+                     string end_key,
+                     bool end_key_inclusive,
+                     bool reverse_results,
+                     int32_t max_results,
+                     const RequestOptions &options = RequestOptions()) {
+        return MakeGetKeyRangeAwaiter([=, this](shared_ptr<GetKeyRangeCallbackInterface> callback) {
+            connection_.GetKeyRange(start_key, start_key_inclusive, end_key, end_key_inclusive,
+                reverse_results, max_results, callback, options);
+        });
+    }
+
+    auto Put(string key,
+             string current_version,
+             WriteMode mode,
+             const shared_ptr<const KineticRecord> record,
+             PersistMode persistMode = PersistMode::WRITE_BACK,
+             const RequestOptions &options = RequestOptions()) {
+        return MakeStatusAwaiter([=, this](auto *awaiter) {
+            connection_.Put(key, current_version, mode, record, awaiter->put_callback(), persistMode,
+                options);
+        });
+    }
+
+    auto Delete(string key,
+                string version,
+                WriteMode mode,
+                PersistMode persistMode = PersistMode::WRITE_BACK,
+                const RequestOptions &options = RequestOptions()) {
+        return MakeStatusAwaiter([=, this](auto *awaiter) {
+            connection_.Delete(key, version, mode, awaiter->simple_callback(), persistMode, options);
+        });
+    }
+
+    auto Flush(const RequestOptions &options = RequestOptions()) {
+        return MakeStatusAwaiter([this, options](auto *awaiter) {
+            connection_.Flush(awaiter->simple_callback(), options);
+        });
+    }
+
+  private:
+    template <typename Issue>
+    static KineticStatusAwaiter<Issue> MakeStatusAwaiter(Issue issue) {
+        return KineticStatusAwaiter<Issue>(std::move(issue));
+    }
+
+    template <typename Issue>
+    static KineticGetAwaiter<Issue> MakeGetAwaiter(Issue issue) {
+        return KineticGetAwaiter<Issue>(std::move(issue));
+    }
+
+    template <typename Issue>
+    static KineticGetVersionAwaiter<Issue> MakeGetVersionAwaiter(Issue issue) {
+        return KineticGetVersionAwaiter<Issue>(std::move(issue));
+    }
+
+    template <typename Issue>
+    static KineticGetKeyRangeAwaiter<Issue> MakeGetKeyRangeAwaiter(Issue issue) {
+        return KineticGetKeyRangeAwaiter<Issue>(std::move(issue));
+    }
+
+    NonblockingKineticConnectionInterface &connection_;
+};
+
+} // namespace kinetic
+
+#endif  // KINETIC_HAVE_COROUTINES
+
+#endif  // KINETIC_CPP_CLIENT_COROUTINE_KINETIC_CONNECTION_H_
@@ -18,7 +18,11 @@
 #ifndef KINETIC_CPP_CLIENT_HMAC_PROVIDER_H_
 #define KINETIC_CPP_CLIENT_HMAC_PROVIDER_H_
 
+#include <memory>
+#include <string>
+
 #include "kinetic_client.pb.h"
+#include "kinetic/connection_options.h"
 
 namespace kinetic {
 
@@ -27,13 +31,34 @@ using com::seagate::kinetic::client::proto::Message;
 /// Wrapper class that handles computing HMACs. The supplied implementation uses openssl,
 /// but users can supply an alternate implementation that uses a different library (e. g. one
 /// providing specialized HW accelaration)
+///
+/// The supplied implementation keys an HMAC context once and reuses it for every message signed
+/// or validated with the same key, so only the message itself is hashed per call. That context
+/// isn't shared between copies, and a single instance must not be used from several threads at
+/// once; each connection works on its own copy.
 class HmacProvider {
     public:
     HmacProvider();
+    explicit HmacProvider(HmacAlgorithm algorithm);
+    HmacProvider(const HmacProvider& other);
+    HmacProvider& operator=(const HmacProvider& other);
+    virtual ~HmacProvider();
+    HmacAlgorithm algorithm() const;
+    void set_algorithm(HmacAlgorithm algorithm);
     virtual std::string ComputeHmac(const Message& message,
         const std::string& key) const;
     virtual bool ValidateHmac(const Message& message,
         const std::string& key) const;
+    /// Variants for when the command bytes live outside the message, e.g. in a receive buffer
+    virtual std::string ComputeHmac(const char* command_bytes, size_t length,
+        const std::string& key) const;
+    virtual bool ValidateHmac(const Message& message, const char* command_bytes, size_t length,
+        const std::string& key) const;
+
+    private:
+    class KeyedContext;
+    HmacAlgorithm algorithm_;
+    mutable std::unique_ptr<KeyedContext> keyed_context_;
 };
 
 } // namespace kinetic
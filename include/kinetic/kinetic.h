@@ -21,7 +21,9 @@
 /// Applications should only include this file
 
 #include "kinetic/kinetic_connection_factory.h"
+#include "kinetic/async_kinetic_connection.h"
 #include "kinetic/key_range_iterator.h"
+#include "kinetic/kinetic_reactor.h"
 #include "kinetic/kinetic_status.h"
 
 #endif  // KINETIC_CPP_CLIENT_KINETIC_H_
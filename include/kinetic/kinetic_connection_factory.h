@@ -18,6 +18,7 @@
 #ifndef KINETIC_CPP_CLIENT_KINETIC_CONNECTION_FACTORY_H_
 #define KINETIC_CPP_CLIENT_KINETIC_CONNECTION_FACTORY_H_
 
+#include "kinetic/connection_attempt.h"
 #include "kinetic/connection_options.h"
 #include "kinetic/hmac_provider.h"
 #include "kinetic/blocking_kinetic_connection.h"
@@ -26,11 +27,22 @@
 #include "kinetic/threadsafe_blocking_kinetic_connection.h"
 #include "kinetic/status.h"
 #include <memory>
+#include <vector>
 
 namespace kinetic {
 
 using std::unique_ptr;
 
+/// The outcome of opening one of the connections requested from
+/// KineticConnectionFactory::NewNonblockingConnections
+struct ConnectionResult {
+    ConnectionResult() : status(Status::makeInternalError("Connection error: Not attempted")) {}
+
+    Status status;
+    /// Set if status is ok
+    unique_ptr<NonblockingKineticConnection> connection;
+};
+
 /// Factory class that builds KineticConnection instances. Rather than use the constructor
 /// developers should use NewKineticConnectionFactory.
 class KineticConnectionFactory {
@@ -57,6 +69,24 @@ class KineticConnectionFactory {
             const ConnectionOptions& options,
             shared_ptr <NonblockingKineticConnection>& connection);
 
+    /// Opens a nonblocking connection to each of many drives, up to max_concurrent of them at a
+    /// time from the calling thread, so that bringing up a rack takes about as long as the
+    /// slowest drive rather than the sum of all of them. Each connection is also bounded by its
+    /// own ConnectionOptions::connect_timeout_ms. Wrap the connections in a
+    /// BlockingKineticConnection where blocking calls are wanted.
+    ///
+    /// @param[in] options                  One entry per connection to open
+    /// @param[out] results                 One entry per entry of options, in the same order
+    /// @param[in] max_concurrent           How many connections may be opening at once
+    /// @param[in] timeout_ms               Connections not open after this many milliseconds fail,
+    ///                                     including any that haven't been started yet
+    /// @return                             Ok if every connection was opened
+    virtual Status NewNonblockingConnections(
+            const std::vector<ConnectionOptions>& options,
+            std::vector<ConnectionResult>& results,
+            size_t max_concurrent,
+            unsigned int timeout_ms);
+
     /// Like NewNonblockingConnection, except the connection is safe for use by multiple threads.
     virtual Status NewThreadsafeNonblockingConnection(
             const ConnectionOptions& options,
@@ -66,6 +96,17 @@ class KineticConnectionFactory {
             const ConnectionOptions& options,
             shared_ptr <ThreadsafeNonblockingKineticConnection>& connection);
 
+    /// Starts opening a nonblocking connection without waiting for any of it. Carry the attempt
+    /// forward with its Run method from an event loop, or hand it to
+    /// KineticReactor::AddConnectionAttempt. ConnectionOptions::connect_timeout_ms bounds how long
+    /// it may take.
+    ///
+    /// @param[in] options                  Specifies host, port, user id, etc
+    /// @param[out] attempt                 Populated with the attempt if it could be started
+    virtual Status StartNonblockingConnection(
+            const ConnectionOptions& options,
+            unique_ptr <ConnectionAttemptInterface>& attempt);
+
     /// Creates and opens a new blocking connection using the given options. If the returned
     /// Status indicates success then the connection is ready to perform
     /// actions and the caller should delete it when done using it. If the
@@ -0,0 +1,172 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifndef KINETIC_CPP_CLIENT_KINETIC_REACTOR_H_
+#define KINETIC_CPP_CLIENT_KINETIC_REACTOR_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "kinetic/common.h"
+#include "kinetic/connection_attempt.h"
+#include "kinetic/nonblocking_kinetic_connection_interface.h"
+#include "kinetic/status.h"
+
+namespace kinetic {
+
+using std::unique_ptr;
+
+class IoUringRing;
+struct IoUringOperation;
+
+/// How a KineticReactor waits for and performs socket I/O
+enum ReactorBackend {
+    /// Wait for readiness with epoll, then read and write with ordinary system calls
+    kEpollBackend,
+    /// Queue every connection's reads and writes on an io_uring and hand them to the kernel with
+    /// one system call per pass. SSL connections are still driven through epoll. Falls back to
+    /// kEpollBackend where io_uring isn't available.
+    kIoUringBackend
+};
+
+/// Drives many nonblocking connections from one thread using edge-triggered epoll, so the number
+/// of connections isn't limited by FD_SETSIZE and each pass only touches connections with
+/// something to do. Only available on Linux.
+///
+/// Work is issued through Submit, which schedules the connection for the next call to RunOnce.
+/// Callbacks may issue follow-up requests on their own connection directly, but requests on
+/// other connections must go through Submit so the reactor knows to run them.
+class KineticReactor {
+  public:
+    typedef uint64_t ConnectionId;
+    typedef std::function<void(ConnectionId id, const Status &status)> AttemptCallback;
+
+    explicit KineticReactor(ReactorBackend backend = kEpollBackend);
+    ~KineticReactor();
+
+    /// Takes ownership of the connection and starts watching its socket. Returns false, dropping
+    /// the connection, if it has already failed or the socket can't be registered.
+    ///
+    /// @param[in] connection   An open connection, usually from KineticConnectionFactory
+    /// @param[out] id          Identifies the connection in later calls
+    bool AddConnection(unique_ptr<NonblockingKineticConnectionInterface> connection,
+            ConnectionId *id);
+
+    /// Takes ownership of a connection attempt and carries it forward whenever its socket is
+    /// ready, so that many connections can be opened at once alongside those already running.
+    /// Once the attempt finishes, done is called with its id and the outcome. If it succeeded the
+    /// connection is then driven under that id like one passed to AddConnection. RunOnce waits no
+    /// longer than the earliest attempt deadline, so attempts time out on schedule.
+    ///
+    /// @param[in] attempt      Usually from KineticConnectionFactory::StartNonblockingConnection
+    /// @param[in] done         Called from RunOnce when the attempt succeeds or fails
+    /// @param[out] id          Identifies the attempt, and later the connection
+    bool AddConnectionAttempt(unique_ptr<ConnectionAttemptInterface> attempt,
+            const AttemptCallback &done, ConnectionId *id);
+
+    /// Stops watching the connection and destroys it, failing any requests still outstanding.
+    /// An unfinished connection attempt is abandoned without calling its callback. Returns false
+    /// if there's no such connection.
+    bool RemoveConnection(ConnectionId id);
+
+    /// Calls operation with the connection, typically to issue one or more requests, and
+    /// schedules the connection to be run. Returns false without calling operation if there's no
+    /// such connection, for example because it failed and was dropped.
+    bool Submit(ConnectionId id,
+            const std::function<void(NonblockingKineticConnectionInterface &)> &operation);
+
+    /// Waits up to timeout_ms milliseconds (-1 for no limit) for socket activity unless a
+    /// connection is already scheduled, then runs every connection that is ready. The wait is
+    /// cut short when a connection next needs running to enforce request deadlines set with
+    /// SetDeadline. Connections that fail are dropped after their callbacks have been told.
+    /// Returns false if waiting fails.
+    bool RunOnce(int timeout_ms);
+
+    /// Number of connections being driven
+    size_t connection_count() const {
+        return connections_.size();
+    }
+
+    /// Number of connection attempts still under way
+    size_t attempt_count() const {
+        return attempts_.size();
+    }
+
+    /// The backend actually in use, which may differ from the one requested
+    ReactorBackend backend() const;
+
+  private:
+    struct Connection {
+        unique_ptr<NonblockingKineticConnectionInterface> connection;
+        int fd;
+        bool scheduled;
+        bool in_epoll;
+        // When the connection's entry in deadlines_ is due, or max() if it has none
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    struct Attempt {
+        unique_ptr<ConnectionAttemptInterface> attempt;
+        AttemptCallback done;
+        std::chrono::steady_clock::time_point deadline;
+        // The socket last registered with epoll, or -1
+        int fd;
+        bool scheduled;
+    };
+
+    bool Adopt(ConnectionId id, unique_ptr<NonblockingKineticConnectionInterface> connection);
+    int ScheduleExpiredAttempts(int timeout_ms);
+    int ScheduleDueDeadlines(int timeout_ms);
+    bool WaitEpoll(int timeout_ms);
+    bool WaitIoUring(int timeout_ms);
+    void Schedule(ConnectionId id, bool *scheduled);
+    void Run(ConnectionId id);
+    void RunConnection(ConnectionId id);
+    void RunAttempt(ConnectionId id);
+    void DropConnection(ConnectionId id);
+    void Release();
+
+    int epoll_fd_;
+    // Only set when using io_uring. The epoll instance, which still watches SSL connections, is
+    // itself polled through the ring.
+    unique_ptr<IoUringRing> ring_;
+    unique_ptr<IoUringOperation> epoll_poll_;
+    ConnectionId next_id_;
+    std::unordered_map<ConnectionId, unique_ptr<Connection>> connections_;
+    // Attempts share the id space with connections and are always watched through epoll
+    std::unordered_map<ConnectionId, unique_ptr<Attempt>> attempts_;
+    std::vector<ConnectionId> scheduled_;
+    typedef std::pair<std::chrono::steady_clock::time_point, ConnectionId> Deadline;
+    // Earliest first. An entry is stale, and skipped, once it no longer matches its connection's
+    // deadline.
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> deadlines_;
+    // Connections removed while one of their calls may still be on the stack, and how many
+    // RunOnce or Submit calls are in progress
+    std::vector<unique_ptr<Connection>> retired_;
+    int busy_;
+    DISALLOW_COPY_AND_ASSIGN(KineticReactor);
+};
+
+} // namespace kinetic
+
+#endif  // KINETIC_CPP_CLIENT_KINETIC_REACTOR_H_
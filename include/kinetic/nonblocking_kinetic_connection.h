@@ -18,6 +18,8 @@
 #ifndef KINETIC_CPP_CLIENT_NONBLOCKING_KINETIC_CONNECTION_H_
 #define KINETIC_CPP_CLIENT_NONBLOCKING_KINETIC_CONNECTION_H_
 
+#include <atomic>
+
 #include "nonblocking_kinetic_connection_interface.h"
 
 namespace kinetic {
@@ -32,35 +34,80 @@ class NonblockingKineticConnection : public NonblockingKineticConnectionInterfac
              fd_set *write_fds,
              int *nfds);
 
+    bool Run(SocketInterest *interest);
+
+    bool SetSocketIo(shared_ptr<SocketIoInterface> io);
+
     bool RemoveHandler(HandlerKey handler_key);
 
+    void SetDeadline(HandlerKey handler_key, unsigned int timeout_ms);
+
+    int TimeUntilDeadline();
+
     void SetClientClusterVersion(int64_t cluster_version);
 
-    HandlerKey NoOp(const shared_ptr<SimpleCallbackInterface> callback);
+    HandlerKey NoOp(const shared_ptr<SimpleCallbackInterface> callback,
+                    const RequestOptions &options = RequestOptions());
 
     HandlerKey Get(const string key,
-                   const shared_ptr<GetCallbackInterface> callback);
+                   const shared_ptr<GetCallbackInterface> callback,
+                   const RequestOptions &options = RequestOptions());
 
     HandlerKey Get(const shared_ptr<const string> key,
-                   const shared_ptr<GetCallbackInterface> callback);
+                   const shared_ptr<GetCallbackInterface> callback,
+                   const RequestOptions &options = RequestOptions());
+
+    HandlerKey GetInto(const shared_ptr<const string> key,
+                       const shared_ptr<ValueBuffer> buffer,
+                       const shared_ptr<GetIntoCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
+
+    HandlerKey GetInto(const string key,
+                       const shared_ptr<ValueBuffer> buffer,
+                       const shared_ptr<GetIntoCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
+
+    HandlerKey GetInto(const shared_ptr<const string> key,
+                       const shared_ptr<ValueBufferPool> pool,
+                       const shared_ptr<GetIntoCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
+
+    HandlerKey GetInto(const string key,
+                       const shared_ptr<ValueBufferPool> pool,
+                       const shared_ptr<GetIntoCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
+
+    HandlerKey GetToFile(const shared_ptr<const string> key,
+                         const shared_ptr<GetToFileCallbackInterface> callback,
+                         const RequestOptions &options = RequestOptions());
+
+    HandlerKey GetToFile(const string key,
+                         const shared_ptr<GetToFileCallbackInterface> callback,
+                         const RequestOptions &options = RequestOptions());
 
     HandlerKey GetNext(const shared_ptr<const string> key,
-                       const shared_ptr<GetCallbackInterface> callback);
+                       const shared_ptr<GetCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
 
     HandlerKey GetNext(const string key,
-                       const shared_ptr<GetCallbackInterface> callback);
+                       const shared_ptr<GetCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
 
     HandlerKey GetPrevious(const shared_ptr<const string> key,
-                           const shared_ptr<GetCallbackInterface> callback);
+                           const shared_ptr<GetCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions());
 
     HandlerKey GetPrevious(const string key,
-                           const shared_ptr<GetCallbackInterface> callback);
+                           const shared_ptr<GetCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions());
 
     HandlerKey GetVersion(const shared_ptr<const string> key,
-                          const shared_ptr<GetVersionCallbackInterface> callback);
+                          const shared_ptr<GetVersionCallbackInterface> callback,
+                          const RequestOptions &options = RequestOptions());
 
     HandlerKey GetVersion(const string key,
-                          const shared_ptr<GetVersionCallbackInterface> callback);
+                          const shared_ptr<GetVersionCallbackInterface> callback,
+                          const RequestOptions &options = RequestOptions());
 
     HandlerKey GetKeyRange(const shared_ptr<const string> start_key,
                            bool start_key_inclusive,
@@ -68,7 +115,8 @@ class NonblockingKineticConnection : public NonblockingKineticConnectionInterfac
                            bool end_key_inclusive,
                            bool reverse_results,
                            int32_t max_results,
-                           const shared_ptr<GetKeyRangeCallbackInterface> callback);
+                           const shared_ptr<GetKeyRangeCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions());
 
     HandlerKey GetKeyRange(const string start_key,
                            bool start_key_inclusive,
@@ -76,160 +124,229 @@ class NonblockingKineticConnection : public NonblockingKineticConnectionInterfac
                            bool end_key_inclusive,
                            bool reverse_results,
                            int32_t max_results,
-                           const shared_ptr<GetKeyRangeCallbackInterface> callback);
+                           const shared_ptr<GetKeyRangeCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions());
 
     HandlerKey MediaScan(const shared_ptr<const string> start_key,
                          bool start_key_inclusive,
                          const shared_ptr<const string> end_key,
                          bool end_key_inclusive,
                          int32_t max_results,
-                         const shared_ptr<MediaScanCallbackInterface> callback);
+                         const shared_ptr<MediaScanCallbackInterface> callback,
+                         const RequestOptions &options = RequestOptions());
 
     HandlerKey MediaScan(const string start_key,
                          bool start_key_inclusive,
                          const string end_key,
                          bool end_key_inclusive,
                          int32_t max_results,
-                         const shared_ptr<MediaScanCallbackInterface> callback);
+                         const shared_ptr<MediaScanCallbackInterface> callback,
+                         const RequestOptions &options = RequestOptions());
 
     HandlerKey MediaOptimize(const shared_ptr<const string> start_key,
                              bool start_key_inclusive,
                              const shared_ptr<const string> end_key,
                              bool end_key_inclusive,
-                             const shared_ptr<MediaOptimizeCallbackInterface> callback);
+                             const shared_ptr<MediaOptimizeCallbackInterface> callback,
+                             const RequestOptions &options = RequestOptions());
 
     HandlerKey MediaOptimize(const string start_key,
                              bool start_key_inclusive,
                              const string end_key,
                              bool end_key_inclusive,
-                             const shared_ptr<MediaOptimizeCallbackInterface> callback);
+                             const shared_ptr<MediaOptimizeCallbackInterface> callback,
+                             const RequestOptions &options = RequestOptions());
+
+    HandlerKey Put(const shared_ptr<const string> key,
+                   const shared_ptr<const string> current_version,
+                   WriteMode mode,
+                   const shared_ptr<const KineticRecord> record,
+                   const shared_ptr<PutCallbackInterface> callback,
+                   const RequestOptions &options = RequestOptions());
+
+    HandlerKey Put(const string key,
+                   const string current_version,
+                   WriteMode mode,
+                   const shared_ptr<const KineticRecord> record,
+                   const shared_ptr<PutCallbackInterface> callback,
+                   const RequestOptions &options = RequestOptions());
 
     HandlerKey Put(const shared_ptr<const string> key,
                    const shared_ptr<const string> current_version,
                    WriteMode mode,
                    const shared_ptr<const KineticRecord> record,
-                   const shared_ptr<PutCallbackInterface> callback);
+                   const shared_ptr<PutCallbackInterface> callback,
+                   PersistMode persistMode,
+                   const RequestOptions &options = RequestOptions());
 
     HandlerKey Put(const string key,
                    const string current_version,
                    WriteMode mode,
                    const shared_ptr<const KineticRecord> record,
-                   const shared_ptr<PutCallbackInterface> callback);
+                   const shared_ptr<PutCallbackInterface> callback,
+                   PersistMode persistMode,
+                   const RequestOptions &options = RequestOptions());
 
     HandlerKey Put(const shared_ptr<const string> key,
                    const shared_ptr<const string> current_version,
                    WriteMode mode,
                    const shared_ptr<const KineticRecord> record,
+                   const shared_ptr<const OutgoingValueInterface> value,
                    const shared_ptr<PutCallbackInterface> callback,
-                   PersistMode persistMode);
+                   PersistMode persistMode,
+                   const RequestOptions &options = RequestOptions());
 
     HandlerKey Put(const string key,
                    const string current_version,
                    WriteMode mode,
                    const shared_ptr<const KineticRecord> record,
+                   const shared_ptr<const OutgoingValueInterface> value,
                    const shared_ptr<PutCallbackInterface> callback,
-                   PersistMode persistMode);
+                   PersistMode persistMode,
+                   const RequestOptions &options = RequestOptions());
 
     HandlerKey Delete(const shared_ptr<const string> key,
                       const shared_ptr<const string> version,
                       WriteMode mode,
                       const shared_ptr<SimpleCallbackInterface> callback,
-                      PersistMode persistMode);
+                      PersistMode persistMode,
+                      const RequestOptions &options = RequestOptions());
 
     HandlerKey Delete(const string key,
                       const string version,
                       WriteMode mode,
                       const shared_ptr<SimpleCallbackInterface> callback,
-                      PersistMode persistMode);
+                      PersistMode persistMode,
+                      const RequestOptions &options = RequestOptions());
 
     HandlerKey Delete(const shared_ptr<const string> key,
                       const shared_ptr<const string> version,
                       WriteMode mode,
-                      const shared_ptr<SimpleCallbackInterface> callback);
+                      const shared_ptr<SimpleCallbackInterface> callback,
+                      const RequestOptions &options = RequestOptions());
 
     HandlerKey Delete(const string key,
                       const string version,
                       WriteMode mode,
-                      const shared_ptr<SimpleCallbackInterface> callback);
+                      const shared_ptr<SimpleCallbackInterface> callback,
+                      const RequestOptions &options = RequestOptions());
+
+    vector<HandlerKey> SubmitBatch(const Batch &batch,
+                                   const shared_ptr<BatchCallbackInterface> callback,
+                                   const RequestOptions &options = RequestOptions());
 
     HandlerKey P2PPush(const P2PPushRequest &push_request,
-                       const shared_ptr<P2PPushCallbackInterface> callback);
+                       const shared_ptr<P2PPushCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
 
     HandlerKey P2PPush(const shared_ptr<const P2PPushRequest> push_request,
-                       const shared_ptr<P2PPushCallbackInterface> callback);
+                       const shared_ptr<P2PPushCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
 
-    HandlerKey GetLog(const shared_ptr<GetLogCallbackInterface> callback);
+    HandlerKey GetLog(const shared_ptr<GetLogCallbackInterface> callback,
+                      const RequestOptions &options = RequestOptions());
 
     HandlerKey GetLog(const vector<Command_GetLog_Type> &types,
-                      const shared_ptr<GetLogCallbackInterface> callback);
+                      const shared_ptr<GetLogCallbackInterface> callback,
+                      const RequestOptions &options = RequestOptions());
 
-    HandlerKey Flush(const shared_ptr<SimpleCallbackInterface> callback);
+    HandlerKey Flush(const shared_ptr<SimpleCallbackInterface> callback,
+                     const RequestOptions &options = RequestOptions());
 
     HandlerKey UpdateFirmware(const shared_ptr<const string> new_firmware,
-                              const shared_ptr<SimpleCallbackInterface> callback);
+                              const shared_ptr<SimpleCallbackInterface> callback,
+                              const RequestOptions &options = RequestOptions());
 
     HandlerKey SetClusterVersion(int64_t new_cluster_version,
-                                 const shared_ptr<SimpleCallbackInterface> callback);
+                                 const shared_ptr<SimpleCallbackInterface> callback,
+                                 const RequestOptions &options = RequestOptions());
 
     HandlerKey InstantErase(const shared_ptr<string> pin,
-                            const shared_ptr<SimpleCallbackInterface> callback);
+                            const shared_ptr<SimpleCallbackInterface> callback,
+                            const RequestOptions &options = RequestOptions());
 
     HandlerKey InstantErase(const string pin,
-                            const shared_ptr<SimpleCallbackInterface> callback);
+                            const shared_ptr<SimpleCallbackInterface> callback,
+                            const RequestOptions &options = RequestOptions());
 
     HandlerKey SecureErase(const shared_ptr<string> pin,
-                           const shared_ptr<SimpleCallbackInterface> callback);
+                           const shared_ptr<SimpleCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions());
 
     HandlerKey SecureErase(const string pin,
-                           const shared_ptr<SimpleCallbackInterface> callback);
+                           const shared_ptr<SimpleCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions());
 
     HandlerKey LockDevice(const shared_ptr<string> pin,
-                          const shared_ptr<SimpleCallbackInterface> callback);
+                          const shared_ptr<SimpleCallbackInterface> callback,
+                          const RequestOptions &options = RequestOptions());
 
     HandlerKey LockDevice(const string pin,
-                          const shared_ptr<SimpleCallbackInterface> callback);
+                          const shared_ptr<SimpleCallbackInterface> callback,
+                          const RequestOptions &options = RequestOptions());
 
     HandlerKey UnlockDevice(const shared_ptr<string> pin,
-                            const shared_ptr<SimpleCallbackInterface> callback);
+                            const shared_ptr<SimpleCallbackInterface> callback,
+                            const RequestOptions &options = RequestOptions());
 
     HandlerKey UnlockDevice(const string pin,
-                            const shared_ptr<SimpleCallbackInterface> callback);
+                            const shared_ptr<SimpleCallbackInterface> callback,
+                            const RequestOptions &options = RequestOptions());
 
     HandlerKey SetACLs(const shared_ptr<const list<ACL>> acls,
-                       const shared_ptr<SimpleCallbackInterface> callback);
+                       const shared_ptr<SimpleCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
 
     HandlerKey SetErasePIN(const shared_ptr<const string> new_pin,
                            const shared_ptr<const string> current_pin,
-                           const shared_ptr<SimpleCallbackInterface> callback);
+                           const shared_ptr<SimpleCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions());
 
     HandlerKey SetErasePIN(const string new_pin,
                            const string current_pin,
-                           const shared_ptr<SimpleCallbackInterface> callback);
+                           const shared_ptr<SimpleCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions());
 
     HandlerKey SetLockPIN(const shared_ptr<const string> new_pin,
                           const shared_ptr<const string> current_pin,
-                          const shared_ptr<SimpleCallbackInterface> callback);
+                          const shared_ptr<SimpleCallbackInterface> callback,
+                          const RequestOptions &options = RequestOptions());
 
     HandlerKey SetLockPIN(const string new_pin,
                           const string current_pin,
-                          const shared_ptr<SimpleCallbackInterface> callback);
+                          const shared_ptr<SimpleCallbackInterface> callback,
+                          const RequestOptions &options = RequestOptions());
 
   private:
     HandlerKey GenericGet(const shared_ptr<const string> key,
-                          const shared_ptr<GetCallbackInterface> callback,
-                          Command_MessageType message_type);
+                          unique_ptr<HandlerInterface> handler,
+                          Command_MessageType message_type,
+                          const RequestOptions &options);
 
     void PopulateP2PMessage(Command_P2POperation *mutable_p2pop,
                             const shared_ptr<const P2PPushRequest> push_request);
 
-    unique_ptr<Command> NewCommand(Command_MessageType message_type);
+    unique_ptr<Command> NewCommand(Command_MessageType message_type, const RequestOptions &options);
+
+    unique_ptr<Command> NewPutCommand(const shared_ptr<const string> key,
+                                      const shared_ptr<const string> current_version,
+                                      WriteMode mode,
+                                      const shared_ptr<const KineticRecord> record,
+                                      PersistMode persistMode,
+                                      const RequestOptions &options);
+
+    unique_ptr<Command> NewDeleteCommand(const shared_ptr<const string> key,
+                                         const shared_ptr<const string> version,
+                                         WriteMode mode,
+                                         PersistMode persistMode,
+                                         const RequestOptions &options);
 
     Command_Synchronization GetSynchronizationForPersistMode(PersistMode persistMode);
 
     NonblockingPacketServiceInterface *service_;
     const shared_ptr<const string> empty_str_;
 
-    int64_t cluster_version_;
+    std::atomic<int64_t> cluster_version_;
 
     DISALLOW_COPY_AND_ASSIGN(NonblockingKineticConnection);
 };
@@ -26,6 +26,8 @@
 #include "kinetic/kinetic_connection.h"
 #include "kinetic/kinetic_status.h"
 #include "kinetic/nonblocking_packet_service_interface.h"
+#include "kinetic/request_options.h"
+#include "kinetic/value_buffer.h"
 #include <memory>
 #include <string>
 #include <vector>
@@ -34,6 +36,7 @@
 namespace kinetic {
 
 using com::seagate::kinetic::client::proto::Command;
+using com::seagate::kinetic::client::proto::Command_Algorithm;
 using com::seagate::kinetic::client::proto::Command_MessageType;
 using com::seagate::kinetic::client::proto::Command_P2POperation;
 using com::seagate::kinetic::client::proto::Command_Synchronization;
@@ -97,6 +100,90 @@ class GetHandler : public HandlerInterface {
     const shared_ptr<GetCallbackInterface> callback_; DISALLOW_COPY_AND_ASSIGN(GetHandler);
 };
 
+class GetIntoCallbackInterface {
+  public:
+    virtual ~GetIntoCallbackInterface() {}
+
+    virtual void Success(const std::string &key,
+                         shared_ptr<ValueBuffer> value,
+                         const std::string &version,
+                         const std::string &tag,
+                         Command_Algorithm algorithm) = 0;
+
+    virtual void Failure(KineticStatus error) = 0;
+};
+
+/// Receives a GET value directly into a caller-supplied buffer, or into one leased from a pool
+/// once the value's size is known.
+class GetIntoHandler : public HandlerInterface {
+  public:
+    GetIntoHandler(const shared_ptr<ValueBuffer> buffer,
+                   const shared_ptr<GetIntoCallbackInterface> callback);
+
+    GetIntoHandler(const shared_ptr<ValueBufferPool> pool,
+                   const shared_ptr<GetIntoCallbackInterface> callback);
+
+    char *ValueDestination(const Command &response,
+                           size_t value_size);
+
+    void Handle(const Command &response,
+                unique_ptr<const string> value);
+
+    void Error(KineticStatus error,
+               Command const *const response);
+
+  private:
+    const shared_ptr<ValueBufferPool> pool_;
+    shared_ptr<ValueBuffer> buffer_;
+    const shared_ptr<GetIntoCallbackInterface> callback_;
+    bool received_directly_;
+    size_t value_size_; DISALLOW_COPY_AND_ASSIGN(GetIntoHandler);
+};
+
+class GetToFileCallbackInterface {
+  public:
+    virtual ~GetToFileCallbackInterface() {}
+
+    /// Called once the value's size is known and before any of it is received. Returns the
+    /// descriptor the value is to be written to, or -1 to fail the request. The value is written
+    /// starting at *offset, or at the descriptor's current position if *offset is left at -1.
+    /// The descriptor must stay open until Success or Failure is called.
+    virtual int Destination(const std::string &key,
+                            size_t value_size,
+                            off_t *offset) = 0;
+
+    virtual void Success(const std::string &key,
+                         size_t value_size,
+                         const std::string &version,
+                         const std::string &tag,
+                         Command_Algorithm algorithm) = 0;
+
+    virtual void Failure(KineticStatus error) = 0;
+};
+
+/// Writes a GET value to a file descriptor supplied by the callback as it comes off the socket,
+/// so the value is never held in memory in full.
+class GetToFileHandler : public HandlerInterface {
+  public:
+    explicit GetToFileHandler(const shared_ptr<GetToFileCallbackInterface> callback);
+
+    int ValueFile(const Command &response,
+                  size_t value_size,
+                  off_t *offset);
+
+    void Handle(const Command &response,
+                unique_ptr<const string> value);
+
+    void Error(KineticStatus error,
+               Command const *const response);
+
+  private:
+    const shared_ptr<GetToFileCallbackInterface> callback_;
+    bool received_directly_;
+    bool declined_;
+    size_t value_size_; DISALLOW_COPY_AND_ASSIGN(GetToFileHandler);
+};
+
 class GetVersionCallbackInterface {
   public:
     virtual ~GetVersionCallbackInterface() {}
@@ -298,6 +385,88 @@ struct P2PPushRequest {
     vector<P2PPushOperation> operations;
 };
 
+class BatchCallbackInterface {
+  public:
+    virtual ~BatchCallbackInterface() {}
+
+    virtual void Success() = 0;
+
+    /// error is the first failure; operation_statuses holds the outcome of every operation in the
+    /// order they were added to the batch
+    virtual void Failure(KineticStatus error,
+                         unique_ptr<vector<KineticStatus>> operation_statuses) = 0;
+};
+
+class BatchCompletion;
+
+/// Records the outcome of one operation of a batch; the batch's callback is called once every
+/// operation has completed. An operation whose handler is discarded without being called, as
+/// RemoveHandler does, counts as failed with CLIENT_SHUTDOWN.
+class BatchHandler : public HandlerInterface {
+  public:
+    BatchHandler(const shared_ptr<BatchCompletion> completion,
+                 size_t operation);
+
+    ~BatchHandler();
+
+    void Handle(const Command &response,
+                unique_ptr<const string> value);
+
+    void Error(KineticStatus error,
+               Command const *const response);
+
+  private:
+    const shared_ptr<BatchCompletion> completion_;
+    const size_t operation_;
+    bool completed_;
+    DISALLOW_COPY_AND_ASSIGN(BatchHandler);
+};
+
+/// A single put or delete in a Batch
+struct BatchOperation {
+    shared_ptr<const string> key;
+
+    /// The version the key is expected to have, as with a regular put or delete
+    shared_ptr<const string> version;
+
+    WriteMode mode;
+
+    /// The record to put, or null for a delete
+    shared_ptr<const KineticRecord> record;
+};
+
+/// Puts and deletes to be submitted together with SubmitBatch
+class Batch {
+  public:
+    explicit Batch(PersistMode persist_mode = PersistMode::WRITE_BACK);
+
+    void Put(const shared_ptr<const string> key,
+             const shared_ptr<const string> current_version,
+             WriteMode mode,
+             const shared_ptr<const KineticRecord> record);
+
+    void Put(const string key,
+             const string current_version,
+             WriteMode mode,
+             const shared_ptr<const KineticRecord> record);
+
+    void Delete(const shared_ptr<const string> key,
+                const shared_ptr<const string> version,
+                WriteMode mode);
+
+    void Delete(const string key,
+                const string version,
+                WriteMode mode);
+
+    const vector<BatchOperation> &operations() const;
+
+    PersistMode persist_mode() const;
+
+  private:
+    PersistMode persist_mode_;
+    vector<BatchOperation> operations_;
+};
+
 class NonblockingKineticConnectionInterface {
   public:
     virtual ~NonblockingKineticConnectionInterface() {}
@@ -308,33 +477,94 @@ class NonblockingKineticConnectionInterface {
                      fd_set *write_fds,
                      int *nfds) = 0;
 
+    /// Variant of Run for callers using poll or epoll rather than select; on success interest
+    /// describes the connection's socket and what it is waiting for. Requests issued from
+    /// callbacks during the call are sent before it returns.
+    virtual bool Run(SocketInterest *interest) = 0;
+
+    /// Has io perform the connection's socket reads and writes from now on. Returns false if the
+    /// connection can't hand them over, which is the case for SSL connections.
+    virtual bool SetSocketIo(shared_ptr<SocketIoInterface> io) = 0;
+
     virtual bool RemoveHandler(HandlerKey handler_key) = 0;
 
-    virtual HandlerKey NoOp(const shared_ptr<SimpleCallbackInterface> callback) = 0;
+    /// Fails the request with a CLIENT_IO_ERROR timeout unless it has completed within
+    /// timeout_ms. Deadlines are enforced by Run, so an event loop should wait no longer than
+    /// TimeUntilDeadline() before running the connection again. Safe to call from callbacks.
+    virtual void SetDeadline(HandlerKey handler_key, unsigned int timeout_ms) = 0;
+
+    /// Milliseconds until the connection next needs running to enforce deadlines, or -1 if no
+    /// deadlines are pending
+    virtual int TimeUntilDeadline() = 0;
+
+    virtual HandlerKey NoOp(const shared_ptr<SimpleCallbackInterface> callback,
+                            const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey Get(const string key,
-                           const shared_ptr<GetCallbackInterface> callback) = 0;
+                           const shared_ptr<GetCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey Get(const shared_ptr<const string> key,
-                           const shared_ptr<GetCallbackInterface> callback) = 0;
+                           const shared_ptr<GetCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions()) = 0;
+
+    /// Like Get, but the value is received straight from the socket into the given buffer
+    /// instead of a newly allocated string. The request fails if the value doesn't fit.
+    virtual HandlerKey GetInto(const shared_ptr<const string> key,
+                               const shared_ptr<ValueBuffer> buffer,
+                               const shared_ptr<GetIntoCallbackInterface> callback,
+                               const RequestOptions &options = RequestOptions()) = 0;
+
+    virtual HandlerKey GetInto(const string key,
+                               const shared_ptr<ValueBuffer> buffer,
+                               const shared_ptr<GetIntoCallbackInterface> callback,
+                               const RequestOptions &options = RequestOptions()) = 0;
+
+    /// Like Get, but the value is received into a buffer leased from the pool
+    virtual HandlerKey GetInto(const shared_ptr<const string> key,
+                               const shared_ptr<ValueBufferPool> pool,
+                               const shared_ptr<GetIntoCallbackInterface> callback,
+                               const RequestOptions &options = RequestOptions()) = 0;
+
+    virtual HandlerKey GetInto(const string key,
+                               const shared_ptr<ValueBufferPool> pool,
+                               const shared_ptr<GetIntoCallbackInterface> callback,
+                               const RequestOptions &options = RequestOptions()) = 0;
+
+    /// Like Get, but the value is written to a descriptor supplied by the callback as it
+    /// arrives. On plain connections the bytes are moved from the socket with splice; under TLS
+    /// they're copied through a bounded buffer.
+    virtual HandlerKey GetToFile(const shared_ptr<const string> key,
+                                 const shared_ptr<GetToFileCallbackInterface> callback,
+                                 const RequestOptions &options = RequestOptions()) = 0;
+
+    virtual HandlerKey GetToFile(const string key,
+                                 const shared_ptr<GetToFileCallbackInterface> callback,
+                                 const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey GetNext(const shared_ptr<const string> key,
-                               const shared_ptr<GetCallbackInterface> callback) = 0;
+                               const shared_ptr<GetCallbackInterface> callback,
+                               const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey GetNext(const string key,
-                               const shared_ptr<GetCallbackInterface> callback) = 0;
+                               const shared_ptr<GetCallbackInterface> callback,
+                               const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey GetPrevious(const shared_ptr<const string> key,
-                                   const shared_ptr<GetCallbackInterface> callback) = 0;
+                                   const shared_ptr<GetCallbackInterface> callback,
+                                   const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey GetPrevious(const string key,
-                                   const shared_ptr<GetCallbackInterface> callback) = 0;
+                                   const shared_ptr<GetCallbackInterface> callback,
+                                   const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey GetVersion(const shared_ptr<const string> key,
-                                  const shared_ptr<GetVersionCallbackInterface> callback) = 0;
+                                  const shared_ptr<GetVersionCallbackInterface> callback,
+                                  const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey GetVersion(const string key,
-                                  const shared_ptr<GetVersionCallbackInterface> callback) = 0;
+                                  const shared_ptr<GetVersionCallbackInterface> callback,
+                                  const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey GetKeyRange(const shared_ptr<const string> start_key,
                                    bool start_key_inclusive,
@@ -342,7 +572,8 @@ class NonblockingKineticConnectionInterface {
                                    bool end_key_inclusive,
                                    bool reverse_results,
                                    int32_t max_results,
-                                   const shared_ptr<GetKeyRangeCallbackInterface> callback) = 0;
+                                   const shared_ptr<GetKeyRangeCallbackInterface> callback,
+                                   const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey GetKeyRange(const string start_key,
                                    bool start_key_inclusive,
@@ -350,143 +581,211 @@ class NonblockingKineticConnectionInterface {
                                    bool end_key_inclusive,
                                    bool reverse_results,
                                    int32_t max_results,
-                                   const shared_ptr<GetKeyRangeCallbackInterface> callback) = 0;
+                                   const shared_ptr<GetKeyRangeCallbackInterface> callback,
+                                   const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey MediaScan(const shared_ptr<const string> start_key,
                                  bool start_key_inclusive,
                                  const shared_ptr<const string> end_key,
                                  bool end_key_inclusive,
                                  int32_t max_results,
-                                 const shared_ptr<MediaScanCallbackInterface> callback) = 0;
+                                 const shared_ptr<MediaScanCallbackInterface> callback,
+                                 const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey MediaScan(const string start_key,
                                  bool start_key_inclusive,
                                  const string end_key,
                                  bool end_key_inclusive,
                                  int32_t max_results,
-                                 const shared_ptr<MediaScanCallbackInterface> callback) = 0;
+                                 const shared_ptr<MediaScanCallbackInterface> callback,
+                                 const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey MediaOptimize(const shared_ptr<const string> start_key,
                                      bool start_key_inclusive,
                                      const shared_ptr<const string> end_key,
                                      bool end_key_inclusive,
-                                     const shared_ptr<MediaOptimizeCallbackInterface> callback) = 0;
+                                     const shared_ptr<MediaOptimizeCallbackInterface> callback,
+                                     const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey MediaOptimize(const string start_key,
                                      bool start_key_inclusive,
                                      const string end_key,
                                      bool end_key_inclusive,
-                                     const shared_ptr<MediaOptimizeCallbackInterface> callback) = 0;
+                                     const shared_ptr<MediaOptimizeCallbackInterface> callback,
+                                     const RequestOptions &options = RequestOptions()) = 0;
+
+    virtual HandlerKey Put(const shared_ptr<const string> key,
+                           const shared_ptr<const string> current_version,
+                           WriteMode mode,
+                           const shared_ptr<const KineticRecord> record,
+                           const shared_ptr<PutCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions()) = 0;
+
+    virtual HandlerKey Put(const string key,
+                           const string current_version,
+                           WriteMode mode,
+                           const shared_ptr<const KineticRecord> record,
+                           const shared_ptr<PutCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey Put(const shared_ptr<const string> key,
                            const shared_ptr<const string> current_version,
                            WriteMode mode,
                            const shared_ptr<const KineticRecord> record,
-                           const shared_ptr<PutCallbackInterface> callback) = 0;
+                           const shared_ptr<PutCallbackInterface> callback,
+                           PersistMode persistMode,
+                           const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey Put(const string key,
                            const string current_version,
                            WriteMode mode,
                            const shared_ptr<const KineticRecord> record,
-                           const shared_ptr<PutCallbackInterface> callback) = 0;
+                           const shared_ptr<PutCallbackInterface> callback,
+                           PersistMode persistMode,
+                           const RequestOptions &options = RequestOptions()) = 0;
 
+    /// Puts a value that is streamed to the drive as it is sent rather than held in memory, for
+    /// example an OutgoingFileValue covering part of a file. The record supplies the version, tag
+    /// and algorithm; its value is ignored.
     virtual HandlerKey Put(const shared_ptr<const string> key,
                            const shared_ptr<const string> current_version,
                            WriteMode mode,
                            const shared_ptr<const KineticRecord> record,
+                           const shared_ptr<const OutgoingValueInterface> value,
                            const shared_ptr<PutCallbackInterface> callback,
-                           PersistMode persistMode) = 0;
+                           PersistMode persistMode,
+                           const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey Put(const string key,
                            const string current_version,
                            WriteMode mode,
                            const shared_ptr<const KineticRecord> record,
+                           const shared_ptr<const OutgoingValueInterface> value,
                            const shared_ptr<PutCallbackInterface> callback,
-                           PersistMode persistMode) = 0;
+                           PersistMode persistMode,
+                           const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey Delete(const shared_ptr<const string> key,
                               const shared_ptr<const string> version,
                               WriteMode mode,
                               const shared_ptr<SimpleCallbackInterface> callback,
-                              PersistMode persistMode) = 0;
+                              PersistMode persistMode,
+                              const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey Delete(const string key,
                               const string version,
                               WriteMode mode,
                               const shared_ptr<SimpleCallbackInterface> callback,
-                              PersistMode persistMode) = 0;
+                              PersistMode persistMode,
+                              const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey Delete(const shared_ptr<const string> key,
                               const shared_ptr<const string> version,
                               WriteMode mode,
-                              const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                              const shared_ptr<SimpleCallbackInterface> callback,
+                              const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey Delete(const string key,
                               const string version,
                               WriteMode mode,
-                              const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                              const shared_ptr<SimpleCallbackInterface> callback,
+                              const RequestOptions &options = RequestOptions()) = 0;
+
+    /// Submits every operation in the batch back to back, so that they're coalesced into as few
+    /// writes as the connection allows, and calls callback once all of them have completed.
+    /// The protocol version in use has no batch messages, so the drive applies the operations
+    /// individually: a failed operation does not undo or stop the others, and operation_statuses
+    /// tells which ones took effect. Returns the key of every operation in the order they were
+    /// added, since the drive may answer them in any order; an empty batch is submitted as a NOOP,
+    /// whose key is returned, so that the callback still comes from Run. RemoveHandler and
+    /// SetDeadline apply to one operation at a time. An operation that is removed counts as
+    /// failed with CLIENT_SHUTDOWN, so removing every key cancels the batch, and the callback is
+    /// then called from the last RemoveHandler.
+    virtual vector<HandlerKey> SubmitBatch(const Batch &batch,
+                                           const shared_ptr<BatchCallbackInterface> callback,
+                                           const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey P2PPush(const P2PPushRequest &push_request,
-                               const shared_ptr<P2PPushCallbackInterface> callback) = 0;
+                               const shared_ptr<P2PPushCallbackInterface> callback,
+                               const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey P2PPush(const shared_ptr<const P2PPushRequest> push_request,
-                               const shared_ptr<P2PPushCallbackInterface> callback) = 0;
+                               const shared_ptr<P2PPushCallbackInterface> callback,
+                               const RequestOptions &options = RequestOptions()) = 0;
 
-    virtual HandlerKey GetLog(const shared_ptr<GetLogCallbackInterface> callback) = 0;
+    virtual HandlerKey GetLog(const shared_ptr<GetLogCallbackInterface> callback,
+                              const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey GetLog(const vector<Command_GetLog_Type> &types,
-                              const shared_ptr<GetLogCallbackInterface> callback) = 0;
+                              const shared_ptr<GetLogCallbackInterface> callback,
+                              const RequestOptions &options = RequestOptions()) = 0;
 
-    virtual HandlerKey Flush(const shared_ptr<SimpleCallbackInterface> callback) = 0;
+    virtual HandlerKey Flush(const shared_ptr<SimpleCallbackInterface> callback,
+                             const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey UpdateFirmware(const shared_ptr<const string> new_firmware,
-                                      const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                                      const shared_ptr<SimpleCallbackInterface> callback,
+                                      const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey SetClusterVersion(int64_t new_cluster_version,
-                                         const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                                         const shared_ptr<SimpleCallbackInterface> callback,
+                                         const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey SetACLs(const shared_ptr<const list<ACL>> acls,
-                               const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                               const shared_ptr<SimpleCallbackInterface> callback,
+                               const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey SetErasePIN(const shared_ptr<const string> new_pin,
                                    const shared_ptr<const string> current_pin,
-                                   const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                                   const shared_ptr<SimpleCallbackInterface> callback,
+                                   const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey SetErasePIN(const string new_pin,
                                    const string current_pin,
-                                   const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                                   const shared_ptr<SimpleCallbackInterface> callback,
+                                   const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey SetLockPIN(const shared_ptr<const string> new_pin,
                                   const shared_ptr<const string> current_pin,
-                                  const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                                  const shared_ptr<SimpleCallbackInterface> callback,
+                                  const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey SetLockPIN(const string new_pin,
                                   const string current_pin,
-                                  const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                                  const shared_ptr<SimpleCallbackInterface> callback,
+                                  const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey InstantErase(const shared_ptr<string> pin,
-                                    const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                                    const shared_ptr<SimpleCallbackInterface> callback,
+                                    const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey InstantErase(const string pin,
-                                    const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                                    const shared_ptr<SimpleCallbackInterface> callback,
+                                    const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey SecureErase(const shared_ptr<string> pin,
-                                   const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                                   const shared_ptr<SimpleCallbackInterface> callback,
+                                   const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey SecureErase(const string pin,
-                                   const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                                   const shared_ptr<SimpleCallbackInterface> callback,
+                                   const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey LockDevice(const shared_ptr<string> pin,
-                                  const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                                  const shared_ptr<SimpleCallbackInterface> callback,
+                                  const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey LockDevice(const string pin,
-                                  const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                                  const shared_ptr<SimpleCallbackInterface> callback,
+                                  const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey UnlockDevice(const shared_ptr<string> pin,
-                                    const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                                    const shared_ptr<SimpleCallbackInterface> callback,
+                                    const RequestOptions &options = RequestOptions()) = 0;
 
     virtual HandlerKey UnlockDevice(const string pin,
-                                    const shared_ptr<SimpleCallbackInterface> callback) = 0;
+                                    const shared_ptr<SimpleCallbackInterface> callback,
+                                    const RequestOptions &options = RequestOptions()) = 0;
 };
 
 } // namespace kinetic
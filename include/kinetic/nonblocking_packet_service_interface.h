@@ -19,9 +19,12 @@
 #define KINETIC_CPP_CLIENT_NONBLOCKING_PACKET_SERVICE_INTERFACE_H_
 
 #include <sys/select.h>
+#include <chrono>
 #include <memory>
 
 #include "kinetic/kinetic_status.h"
+#include "kinetic/outgoing_value.h"
+#include "kinetic/socket_io.h"
 #include "kinetic_client.pb.h"
 
 namespace kinetic {
@@ -35,6 +38,15 @@ using std::string;
 
 typedef uint64_t HandlerKey;
 
+/// Which events a connection's socket is waiting on after a call to Run. Unlike fd_sets this works
+/// for descriptors of any value.
+struct SocketInterest {
+    SocketInterest() : fd(-1), read(false), write(false) {}
+    int fd;
+    bool read;
+    bool write;
+};
+
 // Instances of this cannot be re-used for multiple requests as they are deleted after processing.
 class HandlerInterface {
     public:
@@ -43,6 +55,22 @@ class HandlerInterface {
     // response is re-used, so make sure to copy everything you need out of it
     virtual void Handle(const Command &response, unique_ptr<const string> value) = 0;
     virtual void Error(KineticStatus error, Command const * const response) = 0;
+
+    // Called once the response's command has been parsed but before its value is read. A handler
+    // can return memory of at least value_size bytes to have the value received straight into it,
+    // in which case Handle() is passed an empty value. Returning NULL delivers the value as a
+    // string as usual.
+    virtual char *ValueDestination(const Command &response, size_t value_size) {
+        return NULL;
+    }
+
+    // Asked when ValueDestination returned NULL. A handler can return a file descriptor to have
+    // the value written to it as it arrives, starting at *offset or at the descriptor's current
+    // position if *offset is left at -1; Handle() is then passed an empty value. Returning -1
+    // delivers the value as a string as usual.
+    virtual int ValueFile(const Command &response, size_t value_size, off_t *offset) {
+        return -1;
+    }
 };
 
 class NonblockingPacketServiceInterface {
@@ -51,8 +79,22 @@ class NonblockingPacketServiceInterface {
     // message is modified in this call hierarchy
     virtual HandlerKey Submit(unique_ptr<Message> message, unique_ptr<Command> command, const shared_ptr<const string> value,
             unique_ptr<HandlerInterface> handler) = 0;
+    // As above, but the value is streamed from value as it's sent rather than held in memory
+    virtual HandlerKey Submit(unique_ptr<Message> message, unique_ptr<Command> command,
+            const shared_ptr<const OutgoingValueInterface> value, unique_ptr<HandlerInterface> handler) = 0;
     virtual bool Run(fd_set *read_fds, fd_set *write_fds, int *nfds) = 0;
+    // Like the fd_set variant, but also sends anything handlers queued while receiving so
+    // edge-triggered callers don't have to run the service again without an event
+    virtual bool Run(SocketInterest *interest) = 0;
+    // Routes the socket's reads and writes through io; false if the socket can't do that
+    virtual bool SetSocketIo(shared_ptr<SocketIoInterface> io) = 0;
     virtual bool Remove(HandlerKey handler_key) = 0;
+    // Fails the request with a timeout error if it's still outstanding at deadline. Deadlines
+    // are checked by Run, so callers should run the service again within TimeUntilDeadline().
+    virtual void SetDeadline(HandlerKey handler_key,
+            std::chrono::steady_clock::time_point deadline) = 0;
+    // Milliseconds until Run next needs to check deadlines, or -1 if none are set
+    virtual int TimeUntilDeadline() = 0;
 };
 
 } // namespace kinetic
@@ -18,6 +18,8 @@
 #ifndef KINETIC_CPP_CLIENT_OUTGOING_VALUE_H_
 #define KINETIC_CPP_CLIENT_OUTGOING_VALUE_H_
 
+#include <sys/types.h>
+
 #include <string>
 
 #include "common.h"
@@ -30,6 +32,27 @@ class OutgoingValueInterface {
     virtual size_t size() const = 0;
     virtual bool TransferToSocket(int fd, int* err) const = 0;
     virtual bool ToString(std::string *result, int* err) const = 0;
+
+    /// Copies up to size bytes of the value starting at offset into buf. Returns the number of
+    /// bytes copied, or -1 with *err set. The nonblocking client uses this to send values in
+    /// bounded chunks. The default goes through ToString every time, so implementations should
+    /// override it.
+    virtual ssize_t ReadAt(size_t offset, char *buf, size_t size, int* err) const {
+        std::string value;
+        if (!ToString(&value, err)) {
+            return -1;
+        }
+        if (offset >= value.size()) {
+            return 0;
+        }
+        return value.copy(buf, size, offset);
+    }
+
+    /// If the value is stored in a file, returns the file's descriptor and sets *offset to where
+    /// the value starts, so that it can be sent with sendfile(2). Returns -1 otherwise.
+    virtual int SourceFile(off_t *offset) const {
+        return -1;
+    }
 };
 
 class OutgoingStringValue : public OutgoingValueInterface {
@@ -38,12 +61,32 @@ class OutgoingStringValue : public OutgoingValueInterface {
     size_t size() const;
     bool TransferToSocket(int fd, int* err) const;
     bool ToString(std::string *result, int* err) const;
+    ssize_t ReadAt(size_t offset, char *buf, size_t size, int* err) const;
 
     private:
     const std::string s_;
     DISALLOW_COPY_AND_ASSIGN(OutgoingStringValue);
 };
 
+/// A value made up of size bytes of a file starting at offset. On Linux it is sent with
+/// sendfile(2), so the bytes go from the page cache to the socket without passing through user
+/// space. The file descriptor is not owned and must stay open while the value is in use.
+class OutgoingFileValue : public OutgoingValueInterface {
+    public:
+    OutgoingFileValue(int fd, off_t offset, size_t size);
+    size_t size() const;
+    bool TransferToSocket(int fd, int* err) const;
+    bool ToString(std::string *result, int* err) const;
+    ssize_t ReadAt(size_t offset, char *buf, size_t size, int* err) const;
+    int SourceFile(off_t *offset) const;
+
+    private:
+    const int fd_;
+    const off_t offset_;
+    const size_t size_;
+    DISALLOW_COPY_AND_ASSIGN(OutgoingFileValue);
+};
+
 } // namespace kinetic
 
 #endif  // KINETIC_CPP_CLIENT_OUTGOING_VALUE_H_
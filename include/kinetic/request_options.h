@@ -0,0 +1,61 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifndef KINETIC_CPP_CLIENT_REQUEST_OPTIONS_H_
+#define KINETIC_CPP_CLIENT_REQUEST_OPTIONS_H_
+
+#include <cstdint>
+
+namespace kinetic {
+
+/// Where a request stands in the drive's queue relative to others
+enum class RequestPriority {
+  /// Whatever the operation normally uses; NORMAL except for MediaScan and MediaOptimize, which
+  /// run at LOWER so they don't hold up foreground traffic
+  DEFAULT,
+  LOWEST,
+  LOWER,
+  NORMAL,
+  HIGHER,
+  HIGHEST
+};
+
+/// Per-request settings carried in the command header, accepted by every connection operation.
+/// Anything left at its default is not sent and the drive's own defaults apply.
+struct RequestOptions {
+  RequestOptions() : timeout_ms(0), early_exit(false), priority(RequestPriority::DEFAULT),
+      time_quanta_ms(-1) {}
+
+  /// How long the drive may spend on the request, queueing included, in milliseconds. A request
+  /// still queued when it runs out fails with REMOTE_SERVICE_BUSY, one cut short with
+  /// REMOTE_EXPIRED or REMOTE_DATA_ERROR. 0 leaves it to the drive.
+  int64_t timeout_ms;
+
+  /// If true the drive gives up with REMOTE_DATA_ERROR rather than attempting lengthy error
+  /// recovery, even within the timeout
+  bool early_exit;
+
+  RequestPriority priority;
+
+  /// How long a long-running operation such as a media scan may run before checking for higher
+  /// priority work, in milliseconds. Negative leaves it to the drive.
+  int64_t time_quanta_ms;
+};
+
+} // namespace kinetic
+
+#endif  // KINETIC_CPP_CLIENT_REQUEST_OPTIONS_H_
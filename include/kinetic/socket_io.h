@@ -0,0 +1,47 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifndef KINETIC_CPP_CLIENT_SOCKET_IO_H_
+#define KINETIC_CPP_CLIENT_SOCKET_IO_H_
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace kinetic {
+
+/// Performs a connection's socket I/O on its behalf. This lets an event loop such as
+/// KineticReactor batch system calls across connections. Calls behave like writev and read on a
+/// nonblocking socket, with one difference: the operation may already be under way when EAGAIN is
+/// reported. The caller must therefore retry a write with the same buffers until it completes.
+class SocketIoInterface {
+  public:
+    virtual ~SocketIoInterface() {}
+
+    /// Writes from the given buffers, which must remain valid until a call reports completion
+    virtual ssize_t Writev(const struct iovec *iov, int iovcnt) = 0;
+
+    /// Reads up to size bytes into buf
+    virtual ssize_t Read(char *buf, size_t size) = 0;
+
+    /// Gives up on a write that hasn't completed. Once this returns the buffers passed to Writev
+    /// are no longer referenced.
+    virtual void AbandonWrite() = 0;
+};
+
+} // namespace kinetic
+
+#endif  // KINETIC_CPP_CLIENT_SOCKET_IO_H_
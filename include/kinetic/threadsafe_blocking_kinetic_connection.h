@@ -19,7 +19,6 @@
 #define KINETIC_CPP_CLIENT_THREADSAFE_BLOCKING_KINETIC_CONNECTION_H_
 
 #include "kinetic/blocking_kinetic_connection.h"
-#include <mutex>
 
 namespace kinetic {
 
@@ -31,35 +30,43 @@ class ThreadsafeBlockingKineticConnection : public BlockingKineticConnectionInte
 
     void SetClientClusterVersion(int64_t cluster_version);
 
-    KineticStatus NoOp();
+    KineticStatus NoOp(const RequestOptions &options = RequestOptions());
 
     KineticStatus Get(const shared_ptr<const string> key,
-                      unique_ptr<KineticRecord> &record);
+                      unique_ptr<KineticRecord> &record,
+                      const RequestOptions &options = RequestOptions());
 
     KineticStatus Get(const string &key,
-                      unique_ptr<KineticRecord> &record);
+                      unique_ptr<KineticRecord> &record,
+                      const RequestOptions &options = RequestOptions());
 
     KineticStatus GetNext(const shared_ptr<const string> key,
                           unique_ptr<string> &actual_key,
-                          unique_ptr<KineticRecord> &record);
+                          unique_ptr<KineticRecord> &record,
+                          const RequestOptions &options = RequestOptions());
 
     KineticStatus GetNext(const string &key,
                           unique_ptr<string> &actual_key,
-                          unique_ptr<KineticRecord> &record);
+                          unique_ptr<KineticRecord> &record,
+                          const RequestOptions &options = RequestOptions());
 
     KineticStatus GetPrevious(const shared_ptr<const string> key,
                               unique_ptr<string> &actual_key,
-                              unique_ptr<KineticRecord> &record);
+                              unique_ptr<KineticRecord> &record,
+                              const RequestOptions &options = RequestOptions());
 
     KineticStatus GetPrevious(const string &key,
                               unique_ptr<string> &actual_key,
-                              unique_ptr<KineticRecord> &record);
+                              unique_ptr<KineticRecord> &record,
+                              const RequestOptions &options = RequestOptions());
 
     KineticStatus GetVersion(const shared_ptr<const string> key,
-                             unique_ptr<string> &version);
+                             unique_ptr<string> &version,
+                             const RequestOptions &options = RequestOptions());
 
     KineticStatus GetVersion(const string &key,
-                             unique_ptr<string> &version);
+                             unique_ptr<string> &version,
+                             const RequestOptions &options = RequestOptions());
 
     KineticStatus GetKeyRange(const shared_ptr<const string> start_key,
                               bool start_key_inclusive,
@@ -67,7 +74,8 @@ class ThreadsafeBlockingKineticConnection : public BlockingKineticConnectionInte
                               bool end_key_inclusive,
                               bool reverse_results,
                               int32_t max_results,
-                              unique_ptr<vector<string>> &keys);
+                              unique_ptr<vector<string>> &keys,
+                              const RequestOptions &options = RequestOptions());
 
     KineticStatus GetKeyRange(const string &start_key,
                               bool start_key_inclusive,
@@ -75,7 +83,8 @@ class ThreadsafeBlockingKineticConnection : public BlockingKineticConnectionInte
                               bool end_key_inclusive,
                               bool reverse_results,
                               int32_t max_results,
-                              unique_ptr<vector<string>> &keys);
+                              unique_ptr<vector<string>> &keys,
+                              const RequestOptions &options = RequestOptions());
 
     KeyRangeIterator IterateKeyRange(const shared_ptr<const string> start_key,
                                      bool start_key_inclusive,
@@ -95,7 +104,8 @@ class ThreadsafeBlockingKineticConnection : public BlockingKineticConnectionInte
                             bool end_key_inclusive,
                             int32_t max_results,
                             unique_ptr<string> &last_handled_key,
-                            unique_ptr<vector<string>> &keys);
+                            unique_ptr<vector<string>> &keys,
+                            const RequestOptions &options = RequestOptions());
 
     KineticStatus MediaScan(const string &start_key,
                             bool start_key_inclusive,
@@ -103,109 +113,145 @@ class ThreadsafeBlockingKineticConnection : public BlockingKineticConnectionInte
                             bool end_key_inclusive,
                             int32_t max_results,
                             unique_ptr<string> &last_handled_key,
-                            unique_ptr<vector<string>> &keys);
+                            unique_ptr<vector<string>> &keys,
+                            const RequestOptions &options = RequestOptions());
 
     KineticStatus MediaOptimize(const shared_ptr<const string> start_key,
                                 bool start_key_inclusive,
                                 const shared_ptr<const string> end_key,
                                 bool end_key_inclusive,
-                                unique_ptr<string> &last_handled_key);
+                                unique_ptr<string> &last_handled_key,
+                                const RequestOptions &options = RequestOptions());
 
     KineticStatus MediaOptimize(const string &start_key,
                                 bool start_key_inclusive,
                                 const string &end_key,
                                 bool end_key_inclusive,
-                                unique_ptr<string> &last_handled_key);
+                                unique_ptr<string> &last_handled_key,
+                                const RequestOptions &options = RequestOptions());
 
     KineticStatus Put(const shared_ptr<const string> key,
                       const shared_ptr<const string> current_version,
                       WriteMode mode,
                       const shared_ptr<const KineticRecord> record,
-                      PersistMode persistMode);
+                      PersistMode persistMode,
+                      const RequestOptions &options = RequestOptions());
 
     KineticStatus Put(const string &key,
                       const string &current_version,
                       WriteMode mode,
                       const KineticRecord &record,
-                      PersistMode persistMode);
+                      PersistMode persistMode,
+                      const RequestOptions &options = RequestOptions());
 
     KineticStatus Put(const shared_ptr<const string> key,
                       const shared_ptr<const string> current_version,
                       WriteMode mode,
-                      const shared_ptr<const KineticRecord> record);
+                      const shared_ptr<const KineticRecord> record,
+                      const RequestOptions &options = RequestOptions());
 
     KineticStatus Put(const string &key,
                       const string &current_version,
                       WriteMode mode,
-                      const KineticRecord &record);
+                      const KineticRecord &record,
+                      const RequestOptions &options = RequestOptions());
 
     KineticStatus Delete(const shared_ptr<const string> key,
                          const shared_ptr<const string> version,
                          WriteMode mode,
-                         PersistMode persistMode);
+                         PersistMode persistMode,
+                         const RequestOptions &options = RequestOptions());
 
     KineticStatus Delete(const string &key,
                          const string &version,
                          WriteMode mode,
-                         PersistMode persistMode);
+                         PersistMode persistMode,
+                         const RequestOptions &options = RequestOptions());
 
     KineticStatus Delete(const shared_ptr<const string> key,
                          const shared_ptr<const string> version,
-                         WriteMode mode);
+                         WriteMode mode,
+                         const RequestOptions &options = RequestOptions());
 
     KineticStatus Delete(const string &key,
                          const string &version,
-                         WriteMode mode);
+                         WriteMode mode,
+                         const RequestOptions &options = RequestOptions());
 
-    KineticStatus GetLog(unique_ptr<DriveLog> &drive_log);
+    KineticStatus GetLog(unique_ptr<DriveLog> &drive_log, const RequestOptions &options = RequestOptions());
 
     KineticStatus GetLog(const vector<Command_GetLog_Type> &types,
-                         unique_ptr<DriveLog> &drive_log);
+                         unique_ptr<DriveLog> &drive_log,
+                         const RequestOptions &options = RequestOptions());
 
     KineticStatus P2PPush(const P2PPushRequest &push_request,
-                          unique_ptr<vector<KineticStatus>> &operation_statuses);
+                          unique_ptr<vector<KineticStatus>> &operation_statuses,
+                          const RequestOptions &options = RequestOptions());
 
     KineticStatus P2PPush(const shared_ptr<const P2PPushRequest> push_request,
-                          unique_ptr<vector<KineticStatus>> &operation_statuses);
+                          unique_ptr<vector<KineticStatus>> &operation_statuses,
+                          const RequestOptions &options = RequestOptions());
+
+    KineticStatus MultiGet(const vector<string> &keys,
+                           vector<unique_ptr<KineticRecord>> &records,
+                           unique_ptr<vector<KineticStatus>> &operation_statuses,
+                           size_t window = kDefaultMultiOperationWindow,
+                           const RequestOptions &options = RequestOptions());
+
+    KineticStatus MultiPut(const vector<PutOperation> &puts,
+                           PersistMode persistMode,
+                           unique_ptr<vector<KineticStatus>> &operation_statuses,
+                           size_t window = kDefaultMultiOperationWindow,
+                           const RequestOptions &options = RequestOptions());
+
+    KineticStatus MultiDelete(const vector<DeleteOperation> &deletes,
+                              PersistMode persistMode,
+                              unique_ptr<vector<KineticStatus>> &operation_statuses,
+                              size_t window = kDefaultMultiOperationWindow,
+                              const RequestOptions &options = RequestOptions());
 
-    KineticStatus Flush();
+    KineticStatus Flush(const RequestOptions &options = RequestOptions());
 
-    KineticStatus SetClusterVersion(int64_t cluster_version);
+    KineticStatus SetClusterVersion(int64_t cluster_version, const RequestOptions &options = RequestOptions());
 
-    KineticStatus UpdateFirmware(const shared_ptr<const string> new_firmware);
+    KineticStatus UpdateFirmware(const shared_ptr<const string> new_firmware,
+                                 const RequestOptions &options = RequestOptions());
 
-    KineticStatus SetACLs(const shared_ptr<const list <ACL>> acls);
+    KineticStatus SetACLs(const shared_ptr<const list <ACL>> acls, const RequestOptions &options = RequestOptions());
 
     KineticStatus SetErasePIN(const shared_ptr<const string> new_pin,
-                              const shared_ptr<const string> current_pin = make_shared<string>());
+                              const shared_ptr<const string> current_pin = make_shared<string>(),
+                              const RequestOptions &options = RequestOptions());
 
     KineticStatus SetErasePIN(const string &new_pin,
-                              const string &current_pin);
+                              const string &current_pin,
+                              const RequestOptions &options = RequestOptions());
 
     KineticStatus SetLockPIN(const shared_ptr<const string> new_pin,
-                             const shared_ptr<const string> current_pin = make_shared<string>());
+                             const shared_ptr<const string> current_pin = make_shared<string>(),
+                             const RequestOptions &options = RequestOptions());
 
     KineticStatus SetLockPIN(const string &new_pin,
-                             const string &current_pin);
+                             const string &current_pin,
+                             const RequestOptions &options = RequestOptions());
 
-    KineticStatus InstantErase(const shared_ptr<string> pin);
+    KineticStatus InstantErase(const shared_ptr<string> pin, const RequestOptions &options = RequestOptions());
 
-    KineticStatus InstantErase(const string &pin);
+    KineticStatus InstantErase(const string &pin, const RequestOptions &options = RequestOptions());
 
-    KineticStatus SecureErase(const shared_ptr<string> pin);
+    KineticStatus SecureErase(const shared_ptr<string> pin, const RequestOptions &options = RequestOptions());
 
-    KineticStatus SecureErase(const string &pin);
+    KineticStatus SecureErase(const string &pin, const RequestOptions &options = RequestOptions());
 
-    KineticStatus LockDevice(const shared_ptr<string> pin);
+    KineticStatus LockDevice(const shared_ptr<string> pin, const RequestOptions &options = RequestOptions());
 
-    KineticStatus LockDevice(const string &pin);
+    KineticStatus LockDevice(const string &pin, const RequestOptions &options = RequestOptions());
 
-    KineticStatus UnlockDevice(const shared_ptr<string> pin);
+    KineticStatus UnlockDevice(const shared_ptr<string> pin, const RequestOptions &options = RequestOptions());
 
-    KineticStatus UnlockDevice(const string &pin);
+    KineticStatus UnlockDevice(const string &pin, const RequestOptions &options = RequestOptions());
 
   private:
-    std::recursive_mutex mutex_;
     unique_ptr<BlockingKineticConnection> connection_;
 };
 
@@ -25,8 +25,10 @@
 namespace kinetic {
 
 /// Kinetic connection class variant that synchronizes concurrent access and allows non-blocking
-/// IO. Instead of constructing this class directly users should harness the
-/// KineticConnectionFactory
+/// IO. Requests are built, serialized and signed on the calling thread without taking the
+/// connection's lock, so producers only contend briefly for sequence numbers and the send queue;
+/// Run, RemoveHandler and SetSocketIo are serialized. Instead of constructing this class directly
+/// users should harness the KineticConnectionFactory
 class ThreadsafeNonblockingKineticConnection : public NonblockingKineticConnectionInterface {
   public:
     explicit ThreadsafeNonblockingKineticConnection(unique_ptr <NonblockingKineticConnection> connection);
@@ -37,35 +39,80 @@ class ThreadsafeNonblockingKineticConnection : public NonblockingKineticConnecti
              fd_set *write_fds,
              int *nfds);
 
+    bool Run(SocketInterest *interest);
+
+    bool SetSocketIo(shared_ptr<SocketIoInterface> io);
+
     bool RemoveHandler(HandlerKey handler_key);
 
+    void SetDeadline(HandlerKey handler_key, unsigned int timeout_ms);
+
+    int TimeUntilDeadline();
+
     void SetClientClusterVersion(int64_t cluster_version);
 
-    HandlerKey NoOp(const shared_ptr <SimpleCallbackInterface> callback);
+    HandlerKey NoOp(const shared_ptr <SimpleCallbackInterface> callback,
+                    const RequestOptions &options = RequestOptions());
 
     HandlerKey Get(const string key,
-                   const shared_ptr <GetCallbackInterface> callback);
+                   const shared_ptr <GetCallbackInterface> callback,
+                   const RequestOptions &options = RequestOptions());
 
     HandlerKey Get(const shared_ptr<const string> key,
-                   const shared_ptr <GetCallbackInterface> callback);
+                   const shared_ptr <GetCallbackInterface> callback,
+                   const RequestOptions &options = RequestOptions());
+
+    HandlerKey GetInto(const shared_ptr<const string> key,
+                       const shared_ptr<ValueBuffer> buffer,
+                       const shared_ptr <GetIntoCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
+
+    HandlerKey GetInto(const string key,
+                       const shared_ptr<ValueBuffer> buffer,
+                       const shared_ptr <GetIntoCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
+
+    HandlerKey GetInto(const shared_ptr<const string> key,
+                       const shared_ptr<ValueBufferPool> pool,
+                       const shared_ptr <GetIntoCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
+
+    HandlerKey GetInto(const string key,
+                       const shared_ptr<ValueBufferPool> pool,
+                       const shared_ptr <GetIntoCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
+
+    HandlerKey GetToFile(const shared_ptr<const string> key,
+                         const shared_ptr<GetToFileCallbackInterface> callback,
+                         const RequestOptions &options = RequestOptions());
+
+    HandlerKey GetToFile(const string key,
+                         const shared_ptr<GetToFileCallbackInterface> callback,
+                         const RequestOptions &options = RequestOptions());
 
     HandlerKey GetNext(const shared_ptr<const string> key,
-                       const shared_ptr <GetCallbackInterface> callback);
+                       const shared_ptr <GetCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
 
     HandlerKey GetNext(const string key,
-                       const shared_ptr <GetCallbackInterface> callback);
+                       const shared_ptr <GetCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
 
     HandlerKey GetPrevious(const shared_ptr<const string> key,
-                           const shared_ptr <GetCallbackInterface> callback);
+                           const shared_ptr <GetCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions());
 
     HandlerKey GetPrevious(const string key,
-                           const shared_ptr <GetCallbackInterface> callback);
+                           const shared_ptr <GetCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions());
 
     HandlerKey GetVersion(const shared_ptr<const string> key,
-                          const shared_ptr <GetVersionCallbackInterface> callback);
+                          const shared_ptr <GetVersionCallbackInterface> callback,
+                          const RequestOptions &options = RequestOptions());
 
     HandlerKey GetVersion(const string key,
-                          const shared_ptr <GetVersionCallbackInterface> callback);
+                          const shared_ptr <GetVersionCallbackInterface> callback,
+                          const RequestOptions &options = RequestOptions());
 
     HandlerKey GetKeyRange(const shared_ptr<const string> start_key,
                            bool start_key_inclusive,
@@ -73,7 +120,8 @@ class ThreadsafeNonblockingKineticConnection : public NonblockingKineticConnecti
                            bool end_key_inclusive,
                            bool reverse_results,
                            int32_t max_results,
-                           const shared_ptr <GetKeyRangeCallbackInterface> callback);
+                           const shared_ptr <GetKeyRangeCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions());
 
     HandlerKey GetKeyRange(const string start_key,
                            bool start_key_inclusive,
@@ -81,143 +129,198 @@ class ThreadsafeNonblockingKineticConnection : public NonblockingKineticConnecti
                            bool end_key_inclusive,
                            bool reverse_results,
                            int32_t max_results,
-                           const shared_ptr <GetKeyRangeCallbackInterface> callback);
+                           const shared_ptr <GetKeyRangeCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions());
 
     HandlerKey MediaScan(const shared_ptr<const string> start_key,
                          bool start_key_inclusive,
                          const shared_ptr<const string> end_key,
                          bool end_key_inclusive,
                          int32_t max_results,
-                         const shared_ptr <MediaScanCallbackInterface> callback);
+                         const shared_ptr <MediaScanCallbackInterface> callback,
+                         const RequestOptions &options = RequestOptions());
 
     HandlerKey MediaScan(const string start_key,
                          bool start_key_inclusive,
                          const string end_key,
                          bool end_key_inclusive,
                          int32_t max_results,
-                         const shared_ptr <MediaScanCallbackInterface> callback);
+                         const shared_ptr <MediaScanCallbackInterface> callback,
+                         const RequestOptions &options = RequestOptions());
 
     HandlerKey MediaOptimize(const shared_ptr<const string> start_key,
                              bool start_key_inclusive,
                              const shared_ptr<const string> end_key,
                              bool end_key_inclusive,
-                             const shared_ptr <MediaOptimizeCallbackInterface> callback);
+                             const shared_ptr <MediaOptimizeCallbackInterface> callback,
+                             const RequestOptions &options = RequestOptions());
 
     HandlerKey MediaOptimize(const string start_key,
                              bool start_key_inclusive,
                              const string end_key,
                              bool end_key_inclusive,
-                             const shared_ptr <MediaOptimizeCallbackInterface> callback);
+                             const shared_ptr <MediaOptimizeCallbackInterface> callback,
+                             const RequestOptions &options = RequestOptions());
 
     HandlerKey Put(const shared_ptr<const string> key,
                    const shared_ptr<const string> current_version,
                    WriteMode mode,
                    const shared_ptr<const KineticRecord> record,
-                   const shared_ptr <PutCallbackInterface> callback);
+                   const shared_ptr <PutCallbackInterface> callback,
+                   const RequestOptions &options = RequestOptions());
 
     HandlerKey Put(const string key,
                    const string current_version,
                    WriteMode mode,
                    const shared_ptr<const KineticRecord> record,
-                   const shared_ptr <PutCallbackInterface> callback);
+                   const shared_ptr <PutCallbackInterface> callback,
+                   const RequestOptions &options = RequestOptions());
 
     HandlerKey Put(const shared_ptr<const string> key,
                    const shared_ptr<const string> current_version,
                    WriteMode mode,
                    const shared_ptr<const KineticRecord> record,
                    const shared_ptr <PutCallbackInterface> callback,
-                   PersistMode persistMode);
+                   PersistMode persistMode,
+                   const RequestOptions &options = RequestOptions());
 
     HandlerKey Put(const string key,
                    const string current_version,
                    WriteMode mode,
                    const shared_ptr<const KineticRecord> record,
                    const shared_ptr <PutCallbackInterface> callback,
-                   PersistMode persistMode);
+                   PersistMode persistMode,
+                   const RequestOptions &options = RequestOptions());
+
+    HandlerKey Put(const shared_ptr<const string> key,
+                   const shared_ptr<const string> current_version,
+                   WriteMode mode,
+                   const shared_ptr<const KineticRecord> record,
+                   const shared_ptr<const OutgoingValueInterface> value,
+                   const shared_ptr <PutCallbackInterface> callback,
+                   PersistMode persistMode,
+                   const RequestOptions &options = RequestOptions());
+
+    HandlerKey Put(const string key,
+                   const string current_version,
+                   WriteMode mode,
+                   const shared_ptr<const KineticRecord> record,
+                   const shared_ptr<const OutgoingValueInterface> value,
+                   const shared_ptr <PutCallbackInterface> callback,
+                   PersistMode persistMode,
+                   const RequestOptions &options = RequestOptions());
 
     HandlerKey Delete(const shared_ptr<const string> key,
                       const shared_ptr<const string> version,
                       WriteMode mode,
                       const shared_ptr <SimpleCallbackInterface> callback,
-                      PersistMode persistMode);
+                      PersistMode persistMode,
+                      const RequestOptions &options = RequestOptions());
 
     HandlerKey Delete(const string key,
                       const string version,
                       WriteMode mode,
                       const shared_ptr <SimpleCallbackInterface> callback,
-                      PersistMode persistMode);
+                      PersistMode persistMode,
+                      const RequestOptions &options = RequestOptions());
 
     HandlerKey Delete(const shared_ptr<const string> key,
                       const shared_ptr<const string> version,
                       WriteMode mode,
-                      const shared_ptr <SimpleCallbackInterface> callback);
+                      const shared_ptr <SimpleCallbackInterface> callback,
+                      const RequestOptions &options = RequestOptions());
 
     HandlerKey Delete(const string key,
                       const string version,
                       WriteMode mode,
-                      const shared_ptr <SimpleCallbackInterface> callback);
+                      const shared_ptr <SimpleCallbackInterface> callback,
+                      const RequestOptions &options = RequestOptions());
+
+    vector<HandlerKey> SubmitBatch(const Batch &batch,
+                                   const shared_ptr <BatchCallbackInterface> callback,
+                                   const RequestOptions &options = RequestOptions());
 
     HandlerKey P2PPush(const P2PPushRequest &push_request,
-                       const shared_ptr <P2PPushCallbackInterface> callback);
+                       const shared_ptr <P2PPushCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
 
     HandlerKey P2PPush(const shared_ptr<const P2PPushRequest> push_request,
-                       const shared_ptr <P2PPushCallbackInterface> callback);
+                       const shared_ptr <P2PPushCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
 
-    HandlerKey GetLog(const shared_ptr <GetLogCallbackInterface> callback);
+    HandlerKey GetLog(const shared_ptr <GetLogCallbackInterface> callback,
+                      const RequestOptions &options = RequestOptions());
 
     HandlerKey GetLog(const vector <Command_GetLog_Type> &types,
-                      const shared_ptr <GetLogCallbackInterface> callback);
+                      const shared_ptr <GetLogCallbackInterface> callback,
+                      const RequestOptions &options = RequestOptions());
 
-    HandlerKey Flush(const shared_ptr <SimpleCallbackInterface> callback);
+    HandlerKey Flush(const shared_ptr <SimpleCallbackInterface> callback,
+                     const RequestOptions &options = RequestOptions());
 
     HandlerKey UpdateFirmware(const shared_ptr<const string> new_firmware,
-                              const shared_ptr <SimpleCallbackInterface> callback);
+                              const shared_ptr <SimpleCallbackInterface> callback,
+                              const RequestOptions &options = RequestOptions());
 
     HandlerKey SetClusterVersion(int64_t new_cluster_version,
-                                 const shared_ptr <SimpleCallbackInterface> callback);
+                                 const shared_ptr <SimpleCallbackInterface> callback,
+                                 const RequestOptions &options = RequestOptions());
 
     HandlerKey InstantErase(const shared_ptr <string> pin,
-                            const shared_ptr <SimpleCallbackInterface> callback);
+                            const shared_ptr <SimpleCallbackInterface> callback,
+                            const RequestOptions &options = RequestOptions());
 
     HandlerKey InstantErase(const string pin,
-                            const shared_ptr <SimpleCallbackInterface> callback);
+                            const shared_ptr <SimpleCallbackInterface> callback,
+                            const RequestOptions &options = RequestOptions());
 
     HandlerKey SecureErase(const shared_ptr <string> pin,
-                           const shared_ptr <SimpleCallbackInterface> callback);
+                           const shared_ptr <SimpleCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions());
 
     HandlerKey SecureErase(const string pin,
-                           const shared_ptr <SimpleCallbackInterface> callback);
+                           const shared_ptr <SimpleCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions());
 
     HandlerKey LockDevice(const shared_ptr <string> pin,
-                          const shared_ptr <SimpleCallbackInterface> callback);
+                          const shared_ptr <SimpleCallbackInterface> callback,
+                          const RequestOptions &options = RequestOptions());
 
     HandlerKey LockDevice(const string pin,
-                          const shared_ptr <SimpleCallbackInterface> callback);
+                          const shared_ptr <SimpleCallbackInterface> callback,
+                          const RequestOptions &options = RequestOptions());
 
     HandlerKey UnlockDevice(const shared_ptr <string> pin,
-                            const shared_ptr <SimpleCallbackInterface> callback);
+                            const shared_ptr <SimpleCallbackInterface> callback,
+                            const RequestOptions &options = RequestOptions());
 
     HandlerKey UnlockDevice(const string pin,
-                            const shared_ptr <SimpleCallbackInterface> callback);
+                            const shared_ptr <SimpleCallbackInterface> callback,
+                            const RequestOptions &options = RequestOptions());
 
     HandlerKey SetACLs(const shared_ptr<const list <ACL>> acls,
-                       const shared_ptr <SimpleCallbackInterface> callback);
+                       const shared_ptr <SimpleCallbackInterface> callback,
+                       const RequestOptions &options = RequestOptions());
 
     HandlerKey SetErasePIN(const shared_ptr<const string> new_pin,
                            const shared_ptr<const string> current_pin,
-                           const shared_ptr <SimpleCallbackInterface> callback);
+                           const shared_ptr <SimpleCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions());
 
     HandlerKey SetErasePIN(const string new_pin,
                            const string current_pin,
-                           const shared_ptr <SimpleCallbackInterface> callback);
+                           const shared_ptr <SimpleCallbackInterface> callback,
+                           const RequestOptions &options = RequestOptions());
 
     HandlerKey SetLockPIN(const shared_ptr<const string> new_pin,
                           const shared_ptr<const string> current_pin,
-                          const shared_ptr <SimpleCallbackInterface> callback);
+                          const shared_ptr <SimpleCallbackInterface> callback,
+                          const RequestOptions &options = RequestOptions());
 
     HandlerKey SetLockPIN(const string new_pin,
                           const string current_pin,
-                          const shared_ptr <SimpleCallbackInterface> callback);
+                          const shared_ptr <SimpleCallbackInterface> callback,
+                          const RequestOptions &options = RequestOptions());
 
   private:
     std::recursive_mutex mutex_;
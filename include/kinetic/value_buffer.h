@@ -0,0 +1,105 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifndef KINETIC_CPP_CLIENT_VALUE_BUFFER_H_
+#define KINETIC_CPP_CLIENT_VALUE_BUFFER_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "kinetic/common.h"
+
+namespace kinetic {
+
+using std::shared_ptr;
+using std::string;
+
+/// Memory that a GET value is received into straight from the socket. A ValueBuffer either
+/// wraps memory owned by the caller, which must stay valid until the request completes or its
+/// handler is removed, or is leased from a ValueBufferPool and goes back to the pool once the
+/// last reference to it is dropped.
+class ValueBuffer {
+    public:
+    /// Wraps caller-owned memory of the given capacity
+    ValueBuffer(char *data, size_t capacity) : data_(data), capacity_(capacity), size_(0) {}
+
+    /// Start of the buffer
+    char *data() const {
+        return data_;
+    }
+
+    /// Number of value bytes the buffer currently holds
+    size_t size() const {
+        return size_;
+    }
+
+    /// Number of bytes the buffer can hold
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    void set_size(size_t size) {
+        size_ = size;
+    }
+
+    /// Copies the value out into a string
+    string ToString() const {
+        return string(data_, size_);
+    }
+
+    private:
+    char *const data_;
+    const size_t capacity_;
+    size_t size_;
+    DISALLOW_COPY_AND_ASSIGN(ValueBuffer);
+};
+
+/// Hands out ValueBuffers rounded up to power-of-two size classes and keeps released buffers
+/// around for reuse, so that a steady stream of large GETs doesn't churn the allocator. Leases
+/// may be released from any thread, and may outlive the pool itself.
+class ValueBufferPool {
+    public:
+    /// @param max_idle_per_class   Released buffers kept per size class; extra ones are freed
+    explicit ValueBufferPool(size_t max_idle_per_class = 8);
+
+    /// Leases a buffer with a capacity of at least size bytes
+    shared_ptr<ValueBuffer> Lease(size_t size);
+
+    /// Smallest size class handed out
+    static const size_t kMinBufferSize = 4096;
+
+    private:
+    struct FreeLists {
+        explicit FreeLists(size_t max_idle) : max_idle_per_class(max_idle) {}
+        ~FreeLists();
+        void Release(size_t size_class, char *data);
+
+        std::mutex mutex;
+        const size_t max_idle_per_class;
+        std::vector<std::vector<char *>> idle;
+    };
+
+    shared_ptr<FreeLists> free_lists_;
+    DISALLOW_COPY_AND_ASSIGN(ValueBufferPool);
+};
+
+} // namespace kinetic
+
+#endif  // KINETIC_CPP_CLIENT_VALUE_BUFFER_H_
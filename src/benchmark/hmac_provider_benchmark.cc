@@ -0,0 +1,107 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+// Reports the cost of signing a message with each supported HMAC algorithm over command sizes from a
+// NOOP up to a large PUT's, both keying an HMAC context for every message and through HmacProvider,
+// which reuses one keyed context
+
+#include <arpa/inet.h>
+
+#include <string>
+
+#include <openssl/hmac.h>
+
+#include "benchmark/benchmark.h"
+#include "kinetic/hmac_provider.h"
+
+namespace kinetic {
+
+static const std::string kKey("asdfasdf");
+
+static HmacAlgorithm Algorithm(benchmark::State &state) {
+    HmacAlgorithm algorithm = static_cast<HmacAlgorithm>(state.range(1));
+    state.SetLabel(algorithm == HmacAlgorithm::SHA256 ? "sha256" : "sha1");
+    return algorithm;
+}
+
+// Every command size with every algorithm
+static void Sizes(benchmark::internal::Benchmark *benchmark) {
+    int algorithms[] = { static_cast<int>(HmacAlgorithm::SHA1), static_cast<int>(HmacAlgorithm::SHA256) };
+    for (int algorithm : algorithms) {
+        for (int size = 32; size <= 64 * 1024; size *= 4) {
+            benchmark->Args({size, algorithm});
+        }
+    }
+}
+
+// What every message used to cost: a fresh context keyed from scratch
+static void BM_HmacKeyedPerMessage(benchmark::State &state) {
+    std::string command(state.range(0), 'c');
+    const EVP_MD *digest = Algorithm(state) == HmacAlgorithm::SHA256 ? EVP_sha256() : EVP_sha1();
+    for (auto _ : state) {
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+        HMAC_CTX stack_ctx;
+        HMAC_CTX_init(&stack_ctx);
+        HMAC_CTX *ctx = &stack_ctx;
+#else
+        HMAC_CTX *ctx = HMAC_CTX_new();
+#endif
+        HMAC_Init_ex(ctx, kKey.data(), kKey.length(), digest, NULL);
+        uint32_t length_bigendian = htonl(command.size());
+        HMAC_Update(ctx, reinterpret_cast<unsigned char *>(&length_bigendian), sizeof(uint32_t));
+        HMAC_Update(ctx, reinterpret_cast<const unsigned char *>(command.data()), command.size());
+        unsigned char result[EVP_MAX_MD_SIZE];
+        unsigned int result_length = sizeof(result);
+        HMAC_Final(ctx, result, &result_length);
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+        HMAC_CTX_cleanup(ctx);
+#else
+        HMAC_CTX_free(ctx);
+#endif
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetBytesProcessed(state.iterations() * command.size());
+}
+BENCHMARK(BM_HmacKeyedPerMessage)->Apply(Sizes);
+
+static void BM_HmacProvider(benchmark::State &state) {
+    std::string command(state.range(0), 'c');
+    HmacProvider hmac_provider(Algorithm(state));
+    for (auto _ : state) {
+        std::string hmac = hmac_provider.ComputeHmac(command.data(), command.size(), kKey);
+        benchmark::DoNotOptimize(hmac.data());
+    }
+    state.SetBytesProcessed(state.iterations() * command.size());
+}
+BENCHMARK(BM_HmacProvider)->Apply(Sizes);
+
+// Validation as the receiver does it, including the constant time comparison
+static void BM_HmacProviderValidate(benchmark::State &state) {
+    std::string command(state.range(0), 'c');
+    HmacProvider hmac_provider(Algorithm(state));
+    Message message;
+    message.mutable_hmacauth()->set_hmac(hmac_provider.ComputeHmac(command.data(), command.size(),
+        kKey));
+    for (auto _ : state) {
+        bool valid = hmac_provider.ValidateHmac(message, command.data(), command.size(), kKey);
+        benchmark::DoNotOptimize(valid);
+    }
+    state.SetBytesProcessed(state.iterations() * command.size());
+}
+BENCHMARK(BM_HmacProviderValidate)->Apply(Sizes);
+
+} // namespace kinetic
@@ -0,0 +1,127 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+// Compares building key-value commands through protobuf with the hand-rolled codec
+
+#include <memory>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "kinetic_client.pb.h"
+#include "key_value_codec.h"
+
+namespace kinetic {
+
+using com::seagate::kinetic::client::proto::Command_Algorithm_SHA1;
+using com::seagate::kinetic::client::proto::Command_MessageType_GET;
+using com::seagate::kinetic::client::proto::Command_MessageType_PUT;
+using com::seagate::kinetic::client::proto::Command_Synchronization_WRITEBACK;
+using std::unique_ptr;
+
+static const string kKey(32, 'k');
+static const string kVersion("version");
+static const string kTag(20, 't');
+
+// What the connection does today: allocate a Command, fill it in and serialize it
+static void BM_EncodeGetProtobuf(benchmark::State &state) {
+    string out;
+    int64_t sequence = 0;
+    for (auto _ : state) {
+        unique_ptr<Command> command(new Command());
+        command->mutable_header()->set_clusterversion(0);
+        command->mutable_header()->set_connectionid(1234567890);
+        command->mutable_header()->set_sequence(sequence++);
+        command->mutable_header()->set_messagetype(Command_MessageType_GET);
+        command->mutable_body()->mutable_keyvalue()->set_key(kKey);
+        out.clear();
+        command->SerializeToString(&out);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_EncodeGetProtobuf);
+
+static void BM_EncodeGetHandRolled(benchmark::State &state) {
+    string out;
+    int64_t sequence = 0;
+    for (auto _ : state) {
+        KeyValueRequest request;
+        request.has_cluster_version = true;
+        request.has_connection_id = true;
+        request.connection_id = 1234567890;
+        request.has_sequence = true;
+        request.sequence = sequence++;
+        request.has_message_type = true;
+        request.message_type = Command_MessageType_GET;
+        request.has_key_value = true;
+        request.key = &kKey;
+        out.clear();
+        EncodeKeyValueRequest(request, &out);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_EncodeGetHandRolled);
+
+static void BM_EncodePutProtobuf(benchmark::State &state) {
+    string out;
+    int64_t sequence = 0;
+    for (auto _ : state) {
+        unique_ptr<Command> command(new Command());
+        command->mutable_header()->set_clusterversion(0);
+        command->mutable_header()->set_connectionid(1234567890);
+        command->mutable_header()->set_sequence(sequence++);
+        command->mutable_header()->set_messagetype(Command_MessageType_PUT);
+        auto key_value = command->mutable_body()->mutable_keyvalue();
+        key_value->set_key(kKey);
+        key_value->set_newversion(kVersion);
+        key_value->set_tag(kTag);
+        key_value->set_algorithm(Command_Algorithm_SHA1);
+        key_value->set_synchronization(Command_Synchronization_WRITEBACK);
+        out.clear();
+        command->SerializeToString(&out);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_EncodePutProtobuf);
+
+static void BM_EncodePutHandRolled(benchmark::State &state) {
+    string out;
+    int64_t sequence = 0;
+    for (auto _ : state) {
+        KeyValueRequest request;
+        request.has_cluster_version = true;
+        request.has_connection_id = true;
+        request.connection_id = 1234567890;
+        request.has_sequence = true;
+        request.sequence = sequence++;
+        request.has_message_type = true;
+        request.message_type = Command_MessageType_PUT;
+        request.has_key_value = true;
+        request.key = &kKey;
+        request.new_version = &kVersion;
+        request.tag = &kTag;
+        request.has_algorithm = true;
+        request.algorithm = Command_Algorithm_SHA1;
+        request.has_synchronization = true;
+        request.synchronization = Command_Synchronization_WRITEBACK;
+        out.clear();
+        EncodeKeyValueRequest(request, &out);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_EncodePutHandRolled);
+
+} // namespace kinetic
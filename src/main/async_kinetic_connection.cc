@@ -0,0 +1,230 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without 
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or 
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public 
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include "kinetic/async_kinetic_connection.h"
+
+#include "connection_poll.h"
+
+namespace kinetic {
+
+using std::make_shared;
+using std::move;
+using std::chrono::seconds;
+
+class AsyncSimpleState : public AsyncState, public SimpleCallbackInterface {
+  public:
+    void Success() {
+        Finish(KineticStatus(StatusCode::OK, ""));
+    }
+
+    void Failure(KineticStatus error) {
+        Finish(error);
+    }
+};
+
+class AsyncPutState : public AsyncState, public PutCallbackInterface {
+  public:
+    void Success() {
+        Finish(KineticStatus(StatusCode::OK, ""));
+    }
+
+    void Failure(KineticStatus error) {
+        Finish(error);
+    }
+};
+
+class AsyncGetState : public AsyncValueState<unique_ptr<KineticRecord>>, public GetCallbackInterface {
+  public:
+    void Success(const string &key,
+                 unique_ptr<KineticRecord> record) {
+        value() = move(record);
+        Finish(KineticStatus(StatusCode::OK, ""));
+    }
+
+    void Failure(KineticStatus error) {
+        Finish(error);
+    }
+};
+
+class AsyncGetVersionState : public AsyncValueState<string>, public GetVersionCallbackInterface {
+  public:
+    void Success(const string &version) {
+        value() = version;
+        Finish(KineticStatus(StatusCode::OK, ""));
+    }
+
+    void Failure(KineticStatus error) {
+        Finish(error);
+    }
+};
+
+class AsyncGetKeyRangeState : public AsyncValueState<unique_ptr<vector<string>>>,
+    public GetKeyRangeCallbackInterface {
+  public:
+    void Success(unique_ptr<vector<string>> keys) {
+        value() = move(keys);
+        Finish(KineticStatus(StatusCode::OK, ""));
+    }
+
+    void Failure(KineticStatus error) {
+        Finish(error);
+    }
+};
+
+AsyncKineticConnection::AsyncKineticConnection(unique_ptr<NonblockingKineticConnection> nonblocking_connection,
+                                               unsigned int network_timeout_seconds)
+    : nonblocking_connection_(move(nonblocking_connection)), network_timeout_seconds_(network_timeout_seconds) {}
+
+NonblockingKineticConnection &AsyncKineticConnection::nonblocking_connection() {
+    return *nonblocking_connection_;
+}
+
+bool AsyncKineticConnection::Run(SocketInterest *interest) {
+    return nonblocking_connection_->Run(interest);
+}
+
+KineticFuture<void> AsyncKineticConnection::NoOp(const RequestOptions &options) {
+    auto state = make_shared<AsyncSimpleState>();
+    nonblocking_connection_->NoOp(state, options);
+    return KineticFuture<void>(state);
+}
+
+KineticFuture<unique_ptr<KineticRecord>> AsyncKineticConnection::Get(const string &key,
+                                                                     const RequestOptions &options) {
+    auto state = make_shared<AsyncGetState>();
+    nonblocking_connection_->Get(key, state, options);
+    return KineticFuture<unique_ptr<KineticRecord>>(state);
+}
+
+KineticFuture<string> AsyncKineticConnection::GetVersion(const string &key,
+                                                         const RequestOptions &options) {
+    auto state = make_shared<AsyncGetVersionState>();
+    nonblocking_connection_->GetVersion(key, state, options);
+    return KineticFuture<string>(state);
+}
+
+KineticFuture<unique_ptr<vector<string>>> AsyncKineticConnection::GetKeyRange(const string &start_key,
+                                                                              bool start_key_inclusive,
+                                                                              const string &end_key,
+                                                                              bool end_key_inclusive,
+                                                                              bool reverse_results,
+                                                                              int32_t max_results,
+                                                                              const RequestOptions &options) {
+    auto state = make_shared<AsyncGetKeyRangeState>();
+    nonblocking_connection_->GetKeyRange(start_key, start_key_inclusive, end_key, end_key_inclusive,
+        reverse_results, max_results, state, options);
+    return KineticFuture<unique_ptr<vector<string>>>(state);
+}
+
+KineticFuture<void> AsyncKineticConnection::Put(const string &key,
+                                                const string &current_version,
+                                                WriteMode mode,
+                                                const shared_ptr<const KineticRecord> record,
+                                                PersistMode persistMode,
+                                                const RequestOptions &options) {
+    auto state = make_shared<AsyncPutState>();
+    nonblocking_connection_->Put(key, current_version, mode, record, state, persistMode, options);
+    return KineticFuture<void>(state);
+}
+
+KineticFuture<void> AsyncKineticConnection::Delete(const string &key,
+                                                   const string &version,
+                                                   WriteMode mode,
+                                                   PersistMode persistMode,
+                                                   const RequestOptions &options) {
+    auto state = make_shared<AsyncSimpleState>();
+    nonblocking_connection_->Delete(key, version, mode, state, persistMode, options);
+    return KineticFuture<void>(state);
+}
+
+KineticFuture<void> AsyncKineticConnection::Flush(const RequestOptions &options) {
+    auto state = make_shared<AsyncSimpleState>();
+    nonblocking_connection_->Flush(state, options);
+    return KineticFuture<void>(state);
+}
+
+KineticStatus AsyncKineticConnection::Wait(const KineticFutureBase &future) {
+    KineticStatus status = RunUntil([&]() {
+        return future.ready() ? 0 : 1;
+    });
+    // A future completed before the connection failed still has its own outcome
+    return future.ready() ? future.status() : status;
+}
+
+KineticStatus AsyncKineticConnection::WaitAll(const vector<KineticFutureBase> &futures) {
+    return RunUntil([&]() {
+        size_t pending = 0;
+        for (auto it = futures.begin(); it != futures.end(); ++it) {
+            if (!it->ready()) {
+                pending++;
+            }
+        }
+        return pending;
+    });
+}
+
+KineticStatus AsyncKineticConnection::WaitAny(const vector<KineticFutureBase> &futures,
+                                              size_t *ready_index) {
+    if (futures.empty()) {
+        return KineticStatus(StatusCode::CLIENT_INTERNAL_ERROR, "No futures to wait for");
+    }
+
+    KineticStatus status = RunUntil([&]() {
+        for (size_t i = 0; i < futures.size(); ++i) {
+            if (futures[i].ready()) {
+                *ready_index = i;
+                return size_t(0);
+            }
+        }
+        return futures.size();
+    });
+    return status;
+}
+
+// Runs the connection until pending, which counts the futures still being waited for, reaches
+// zero. The network timeout starts over whenever that count goes down. The connection isn't run
+// at all when nothing is pending, so waiting on completed futures succeeds even after it failed.
+KineticStatus AsyncKineticConnection::RunUntil(const std::function<size_t()> &pending) {
+    size_t remaining = pending();
+    if (remaining == 0) {
+        return KineticStatus(StatusCode::OK, "");
+    }
+
+    // Send whatever was issued since the connection last ran before waiting on the socket
+    SocketInterest interest;
+    if (!nonblocking_connection_->Run(&interest)) {
+        return KineticStatus(StatusCode::CLIENT_IO_ERROR, "Connection failed");
+    }
+
+    remaining = pending();
+    auto timeout_time = std::chrono::system_clock::now() + seconds(network_timeout_seconds_);
+    while (remaining > 0) {
+        KineticStatus status = PollAndRun(nonblocking_connection_.get(), &interest, timeout_time);
+        if (!status.ok()) {
+            return status;
+        }
+
+        size_t still_pending = pending();
+        if (still_pending < remaining) {
+            timeout_time = std::chrono::system_clock::now() + seconds(network_timeout_seconds_);
+        }
+        remaining = still_pending;
+    }
+    return KineticStatus(StatusCode::OK, "");
+}
+
+} // namespace kinetic
@@ -15,28 +15,43 @@
  * See www.openkinetic.org for more project information
  */
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <memory>
-#include <sys/select.h>
-#include <errno.h>
 #include <stdexcept>
 #include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <glog/logging.h>
 #include "kinetic/blocking_kinetic_connection.h"
+#include "connection_poll.h"
 
 namespace kinetic {
 
 using std::make_shared;
 using std::move;
-using std::chrono::duration_cast;
-using std::chrono::microseconds;
+using std::list;
 using std::chrono::seconds;
 
 BlockingKineticConnection::BlockingKineticConnection(unique_ptr<NonblockingKineticConnection> nonblocking_connection,
                                                      unsigned int network_timeout_seconds) : network_timeout_seconds_(
-    network_timeout_seconds) {
+    network_timeout_seconds), leading_(false), wake_pending_(false) {
     nonblocking_connection_ = std::move(nonblocking_connection);
+    if (pipe2(wake_fds_, O_NONBLOCK | O_CLOEXEC) != 0) {
+        // Requests submitted while another thread polls then wait for the socket to be ready
+        PLOG(WARNING) << "Failed to create wake pipe";
+        wake_fds_[0] = wake_fds_[1] = -1;
+    }
 }
 
-BlockingKineticConnection::~BlockingKineticConnection() {}
+BlockingKineticConnection::~BlockingKineticConnection() {
+    if (wake_fds_[0] >= 0) {
+        close(wake_fds_[0]);
+        close(wake_fds_[1]);
+    }
+}
 
 class BlockingCallbackState {
     friend class BlockingKineticConnection;
@@ -47,19 +62,21 @@ class BlockingCallbackState {
     virtual ~BlockingCallbackState() {}
 
   protected:
-    bool done_;
+    // Set last, once the outcome is in place. A packet service may complete a request from the
+    // submitting thread while another thread leads, so it's read without the lock held.
+    std::atomic<bool> done_;
     bool success_;
     KineticStatus error_;
 
     void OnSuccess() {
-        done_ = true;
         success_ = true;
+        done_ = true;
     }
 
     void OnError(KineticStatus error) {
-        done_ = true;
         success_ = false;
         error_ = error;
+        done_ = true;
     }
 };
 
@@ -76,9 +93,9 @@ class SimpleCallback : public SimpleCallbackInterface, public BlockingCallbackSt
   private:
 };
 
-KineticStatus BlockingKineticConnection::NoOp() {
+KineticStatus BlockingKineticConnection::NoOp(const RequestOptions &options) {
     auto handler = make_shared<SimpleCallback>();
-    return RunOperation(handler, nonblocking_connection_->NoOp(handler));
+    return RunOperation(handler, nonblocking_connection_->NoOp(handler, options));
 }
 
 class BlockingGetCallback : public GetCallbackInterface, public BlockingCallbackState {
@@ -206,15 +223,17 @@ void BlockingKineticConnection::SetClientClusterVersion(int64_t cluster_version)
 }
 
 KineticStatus BlockingKineticConnection::Get(const shared_ptr<const string> key,
-                                             unique_ptr<KineticRecord> &record) {
+                                             unique_ptr<KineticRecord> &record,
+                                             const RequestOptions &options) {
     unique_ptr<string> actual_key;
     auto handler = make_shared<BlockingGetCallback>(actual_key, record, false);
-    return RunOperation(handler, nonblocking_connection_->Get(key, handler));
+    return RunOperation(handler, nonblocking_connection_->Get(key, handler, options));
 }
 
 KineticStatus BlockingKineticConnection::Get(const string &key,
-                                             unique_ptr<KineticRecord> &record) {
-    return this->Get(make_shared<string>(key), record);
+                                             unique_ptr<KineticRecord> &record,
+                                             const RequestOptions &options) {
+    return this->Get(make_shared<string>(key), record, options);
 }
 
 class BlockingPutCallback : public PutCallbackInterface, public BlockingCallbackState {
@@ -234,95 +253,106 @@ KineticStatus BlockingKineticConnection::Put(const shared_ptr<const string> key,
                                              const shared_ptr<const string> current_version,
                                              WriteMode mode,
                                              const shared_ptr<const KineticRecord> record,
-                                             PersistMode persistMode) {
+                                             PersistMode persistMode,
+                                             const RequestOptions &options) {
     auto handler = make_shared<BlockingPutCallback>();
 
     return RunOperation(handler,
-                        nonblocking_connection_->Put(key, current_version, mode, record, handler, persistMode));
+                        nonblocking_connection_->Put(key, current_version, mode, record, handler, persistMode,
+                                                     options));
 }
 
 KineticStatus BlockingKineticConnection::Put(const string &key,
                                              const string &current_version,
                                              WriteMode mode,
                                              const KineticRecord &record,
-                                             PersistMode persistMode) {
+                                             PersistMode persistMode,
+                                             const RequestOptions &options) {
     return this->Put(make_shared<string>(key),
                      make_shared<string>(current_version),
                      mode,
                      make_shared<KineticRecord>(record),
-                     persistMode);
+                     persistMode,
+                     options);
 }
 
 KineticStatus BlockingKineticConnection::Put(const shared_ptr<const string> key,
                                              const shared_ptr<const string> current_version,
                                              WriteMode mode,
-                                             const shared_ptr<const KineticRecord> record) {
+                                             const shared_ptr<const KineticRecord> record,
+                                             const RequestOptions &options) {
     auto handler = make_shared<BlockingPutCallback>();
 
     // Rely on nonblocking_connection to handle the default PersistMode case
-    return RunOperation(handler, nonblocking_connection_->Put(key, current_version, mode, record, handler));
+    return RunOperation(handler, nonblocking_connection_->Put(key, current_version, mode, record, handler, options));
 }
 
 KineticStatus BlockingKineticConnection::Put(const string &key,
                                              const string &current_version,
                                              WriteMode mode,
-                                             const KineticRecord &record) {
+                                             const KineticRecord &record,
+                                             const RequestOptions &options) {
     return this->Put(make_shared<string>(key),
                      make_shared<string>(current_version),
                      mode,
-                     make_shared<KineticRecord>(record));
+                     make_shared<KineticRecord>(record),
+                     options);
 }
 
 KineticStatus BlockingKineticConnection::Delete(const shared_ptr<const string> key,
                                                 const shared_ptr<const string> version,
                                                 WriteMode mode,
-                                                PersistMode persistMode) {
+                                                PersistMode persistMode,
+                                                const RequestOptions &options) {
     auto callback = make_shared<SimpleCallback>();
-    return RunOperation(callback, nonblocking_connection_->Delete(key, version, mode, callback, persistMode));
+    return RunOperation(callback, nonblocking_connection_->Delete(key, version, mode, callback, persistMode, options));
 }
 
 KineticStatus BlockingKineticConnection::Delete(const string &key,
                                                 const string &version,
                                                 WriteMode mode,
-                                                PersistMode persistMode) {
-    return this->Delete(make_shared<string>(key), make_shared<string>(version), mode, persistMode);
+                                                PersistMode persistMode,
+                                                const RequestOptions &options) {
+    return this->Delete(make_shared<string>(key), make_shared<string>(version), mode, persistMode, options);
 }
 
 KineticStatus BlockingKineticConnection::Delete(const shared_ptr<const string> key,
                                                 const shared_ptr<const string> version,
-                                                WriteMode mode) {
+                                                WriteMode mode,
+                                                const RequestOptions &options) {
     auto callback = make_shared<SimpleCallback>();
     // Let the nonblocking_connection handle the default persistOption
-    return RunOperation(callback, nonblocking_connection_->Delete(key, version, mode, callback));
+    return RunOperation(callback, nonblocking_connection_->Delete(key, version, mode, callback, options));
 }
 
 KineticStatus BlockingKineticConnection::Delete(const string &key,
                                                 const string &version,
-                                                WriteMode mode) {
-    return this->Delete(make_shared<string>(key), make_shared<string>(version), mode);
+                                                WriteMode mode,
+                                                const RequestOptions &options) {
+    return this->Delete(make_shared<string>(key), make_shared<string>(version), mode, options);
 }
 
-KineticStatus BlockingKineticConnection::InstantErase(const shared_ptr<string> pin) {
+KineticStatus BlockingKineticConnection::InstantErase(const shared_ptr<string> pin, const RequestOptions &options) {
     auto callback = make_shared<SimpleCallback>();
-    return RunOperation(callback, nonblocking_connection_->InstantErase(pin, callback));
+    return RunOperation(callback, nonblocking_connection_->InstantErase(pin, callback, options));
 }
 
-KineticStatus BlockingKineticConnection::InstantErase(const string &pin) {
-    return this->InstantErase(make_shared<string>(pin));
+KineticStatus BlockingKineticConnection::InstantErase(const string &pin, const RequestOptions &options) {
+    return this->InstantErase(make_shared<string>(pin), options);
 }
 
-KineticStatus BlockingKineticConnection::SecureErase(const shared_ptr<string> pin) {
+KineticStatus BlockingKineticConnection::SecureErase(const shared_ptr<string> pin, const RequestOptions &options) {
     auto callback = make_shared<SimpleCallback>();
-    return RunOperation(callback, nonblocking_connection_->SecureErase(pin, callback));
+    return RunOperation(callback, nonblocking_connection_->SecureErase(pin, callback, options));
 }
 
-KineticStatus BlockingKineticConnection::SecureErase(const string &pin) {
-    return this->SecureErase(make_shared<string>(pin));
+KineticStatus BlockingKineticConnection::SecureErase(const string &pin, const RequestOptions &options) {
+    return this->SecureErase(make_shared<string>(pin), options);
 }
 
-KineticStatus BlockingKineticConnection::SetClusterVersion(int64_t new_cluster_version) {
+KineticStatus BlockingKineticConnection::SetClusterVersion(int64_t new_cluster_version, const RequestOptions &options) {
     auto callback = make_shared<SimpleCallback>();
-    return RunOperation(callback, nonblocking_connection_->SetClusterVersion(new_cluster_version, callback));
+    return RunOperation(callback, nonblocking_connection_->SetClusterVersion(new_cluster_version, callback, options));
 }
 
 class GetLogCallback : public GetLogCallbackInterface, public BlockingCallbackState {
@@ -342,107 +372,178 @@ class GetLogCallback : public GetLogCallbackInterface, public BlockingCallbackSt
     unique_ptr<DriveLog> &drive_log_;
 };
 
-KineticStatus BlockingKineticConnection::GetLog(unique_ptr<DriveLog> &drive_log) {
+KineticStatus BlockingKineticConnection::GetLog(unique_ptr<DriveLog> &drive_log, const RequestOptions &options) {
     auto callback = make_shared<GetLogCallback>(drive_log);
-    return RunOperation(callback, nonblocking_connection_->GetLog(callback));
+    return RunOperation(callback, nonblocking_connection_->GetLog(callback, options));
 }
 
 KineticStatus BlockingKineticConnection::GetLog(const vector<Command_GetLog_Type> &types,
-                                                unique_ptr<DriveLog> &drive_log) {
+                                                unique_ptr<DriveLog> &drive_log,
+                                                const RequestOptions &options) {
     auto callback = make_shared<GetLogCallback>(drive_log);
-    return RunOperation(callback, nonblocking_connection_->GetLog(types, callback));
+    return RunOperation(callback, nonblocking_connection_->GetLog(types, callback, options));
 }
 
-KineticStatus BlockingKineticConnection::Flush() {
+KineticStatus BlockingKineticConnection::MultiGet(const vector<string> &keys,
+                                                  vector<unique_ptr<KineticRecord>> &records,
+                                                  unique_ptr<vector<KineticStatus>> &operation_statuses,
+                                                  size_t window,
+                                                  const RequestOptions &options) {
+    records.clear();
+    records.resize(keys.size());
+    // Nothing asks for the actual key, but the callback wants somewhere to put it
+    unique_ptr<string> actual_key;
+    vector<shared_ptr<BlockingCallbackState>> callbacks;
+    vector<shared_ptr<BlockingGetCallback>> handlers;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        handlers.push_back(make_shared<BlockingGetCallback>(actual_key, records[i], false));
+        callbacks.push_back(handlers.back());
+    }
+
+    return RunOperations(callbacks, [&](size_t i) {
+        return nonblocking_connection_->Get(keys[i], handlers[i], options);
+    }, window, operation_statuses);
+}
+
+KineticStatus BlockingKineticConnection::MultiPut(const vector<PutOperation> &puts,
+                                                  PersistMode persistMode,
+                                                  unique_ptr<vector<KineticStatus>> &operation_statuses,
+                                                  size_t window,
+                                                  const RequestOptions &options) {
+    vector<shared_ptr<BlockingCallbackState>> callbacks;
+    vector<shared_ptr<BlockingPutCallback>> handlers;
+    for (size_t i = 0; i < puts.size(); ++i) {
+        handlers.push_back(make_shared<BlockingPutCallback>());
+        callbacks.push_back(handlers.back());
+    }
+
+    return RunOperations(callbacks, [&](size_t i) {
+        const PutOperation &put = puts[i];
+        return nonblocking_connection_->Put(make_shared<string>(put.key), make_shared<string>(put.current_version),
+            put.mode, put.record, handlers[i], persistMode, options);
+    }, window, operation_statuses);
+}
+
+KineticStatus BlockingKineticConnection::MultiDelete(const vector<DeleteOperation> &deletes,
+                                                     PersistMode persistMode,
+                                                     unique_ptr<vector<KineticStatus>> &operation_statuses,
+                                                     size_t window,
+                                                     const RequestOptions &options) {
+    vector<shared_ptr<BlockingCallbackState>> callbacks;
+    vector<shared_ptr<SimpleCallback>> handlers;
+    for (size_t i = 0; i < deletes.size(); ++i) {
+        handlers.push_back(make_shared<SimpleCallback>());
+        callbacks.push_back(handlers.back());
+    }
+
+    return RunOperations(callbacks, [&](size_t i) {
+        const DeleteOperation &del = deletes[i];
+        return nonblocking_connection_->Delete(del.key, del.version, del.mode, handlers[i], persistMode, options);
+    }, window, operation_statuses);
+}
+
+KineticStatus BlockingKineticConnection::Flush(const RequestOptions &options) {
     auto callback = make_shared<SimpleCallback>();
-    return RunOperation(callback, nonblocking_connection_->Flush(callback));
+    return RunOperation(callback, nonblocking_connection_->Flush(callback, options));
 }
 
-KineticStatus BlockingKineticConnection::UpdateFirmware(const shared_ptr<const string> new_firmware) {
+KineticStatus BlockingKineticConnection::UpdateFirmware(const shared_ptr<const string> new_firmware,
+                                                        const RequestOptions &options) {
     auto callback = make_shared<SimpleCallback>();
-    return RunOperation(callback, nonblocking_connection_->UpdateFirmware(new_firmware, callback));
+    return RunOperation(callback, nonblocking_connection_->UpdateFirmware(new_firmware, callback, options));
 }
 
-KineticStatus BlockingKineticConnection::SetACLs(const shared_ptr<const list<ACL>> acls) {
+KineticStatus BlockingKineticConnection::SetACLs(const shared_ptr<const list<ACL>> acls,
+                                                 const RequestOptions &options) {
     auto callback = make_shared<SimpleCallback>();
-    return RunOperation(callback, nonblocking_connection_->SetACLs(acls, callback));
+    return RunOperation(callback, nonblocking_connection_->SetACLs(acls, callback, options));
 }
 
 KineticStatus BlockingKineticConnection::SetErasePIN(const shared_ptr<const string> new_pin,
-                                                     const shared_ptr<const string> current_pin) {
+                                                     const shared_ptr<const string> current_pin,
+                                                     const RequestOptions &options) {
     auto callback = make_shared<SimpleCallback>();
-    return RunOperation(callback, nonblocking_connection_->SetErasePIN(new_pin, current_pin, callback));
+    return RunOperation(callback, nonblocking_connection_->SetErasePIN(new_pin, current_pin, callback, options));
 }
 
 KineticStatus BlockingKineticConnection::SetErasePIN(const string &new_pin,
-                                                     const string &current_pin) {
-    return this->SetErasePIN(make_shared<string>(new_pin), make_shared<string>(current_pin));
+                                                     const string &current_pin,
+                                                     const RequestOptions &options) {
+    return this->SetErasePIN(make_shared<string>(new_pin), make_shared<string>(current_pin), options);
 }
 
 KineticStatus BlockingKineticConnection::SetLockPIN(const shared_ptr<const string> new_pin,
-                                                    const shared_ptr<const string> current_pin) {
+                                                    const shared_ptr<const string> current_pin,
+                                                    const RequestOptions &options) {
     auto callback = make_shared<SimpleCallback>();
-    return RunOperation(callback, nonblocking_connection_->SetLockPIN(new_pin, current_pin, callback));
+    return RunOperation(callback, nonblocking_connection_->SetLockPIN(new_pin, current_pin, callback, options));
 }
 
 KineticStatus BlockingKineticConnection::SetLockPIN(const string &new_pin,
-                                                    const string &current_pin) {
-    return this->SetLockPIN(make_shared<string>(new_pin), make_shared<string>(current_pin));
+                                                    const string &current_pin,
+                                                    const RequestOptions &options) {
+    return this->SetLockPIN(make_shared<string>(new_pin), make_shared<string>(current_pin), options);
 }
 
-KineticStatus BlockingKineticConnection::LockDevice(const shared_ptr<string> pin) {
+KineticStatus BlockingKineticConnection::LockDevice(const shared_ptr<string> pin, const RequestOptions &options) {
     auto callback = make_shared<SimpleCallback>();
-    return RunOperation(callback, nonblocking_connection_->LockDevice(pin, callback));
+    return RunOperation(callback, nonblocking_connection_->LockDevice(pin, callback, options));
 }
 
-KineticStatus BlockingKineticConnection::LockDevice(const string &pin) {
-    return this->LockDevice(make_shared<string>(pin));
+KineticStatus BlockingKineticConnection::LockDevice(const string &pin, const RequestOptions &options) {
+    return this->LockDevice(make_shared<string>(pin), options);
 }
 
-KineticStatus BlockingKineticConnection::UnlockDevice(const shared_ptr<string> pin) {
+KineticStatus BlockingKineticConnection::UnlockDevice(const shared_ptr<string> pin, const RequestOptions &options) {
     auto callback = make_shared<SimpleCallback>();
-    return RunOperation(callback, nonblocking_connection_->UnlockDevice(pin, callback));
+    return RunOperation(callback, nonblocking_connection_->UnlockDevice(pin, callback, options));
 }
 
-KineticStatus BlockingKineticConnection::UnlockDevice(const string &pin) {
-    return this->UnlockDevice(make_shared<string>(pin));
+KineticStatus BlockingKineticConnection::UnlockDevice(const string &pin, const RequestOptions &options) {
+    return this->UnlockDevice(make_shared<string>(pin), options);
 }
 
 KineticStatus BlockingKineticConnection::GetNext(const shared_ptr<const string> key,
                                                  unique_ptr<string> &actual_key,
-                                                 unique_ptr<KineticRecord> &record) {
+                                                 unique_ptr<KineticRecord> &record,
+                                                 const RequestOptions &options) {
     auto callback = make_shared<BlockingGetCallback>(actual_key, record, true);
-    return RunOperation(callback, nonblocking_connection_->GetNext(key, callback));
+    return RunOperation(callback, nonblocking_connection_->GetNext(key, callback, options));
 }
 
 KineticStatus BlockingKineticConnection::GetNext(const string &key,
                                                  unique_ptr<string> &actual_key,
-                                                 unique_ptr<KineticRecord> &record) {
-    return this->GetNext(make_shared<string>(key), actual_key, record);
+                                                 unique_ptr<KineticRecord> &record,
+                                                 const RequestOptions &options) {
+    return this->GetNext(make_shared<string>(key), actual_key, record, options);
 }
 
 KineticStatus BlockingKineticConnection::GetPrevious(const shared_ptr<const string> key,
                                                      unique_ptr<string> &actual_key,
-                                                     unique_ptr<KineticRecord> &record) {
+                                                     unique_ptr<KineticRecord> &record,
+                                                     const RequestOptions &options) {
     auto callback = make_shared<BlockingGetCallback>(actual_key, record, true);
-    return RunOperation(callback, nonblocking_connection_->GetPrevious(key, callback));
+    return RunOperation(callback, nonblocking_connection_->GetPrevious(key, callback, options));
 }
 
 KineticStatus BlockingKineticConnection::GetPrevious(const string &key,
                                                      unique_ptr<string> &actual_key,
-                                                     unique_ptr<KineticRecord> &record) {
-    return this->GetPrevious(make_shared<string>(key), actual_key, record);
+                                                     unique_ptr<KineticRecord> &record,
+                                                     const RequestOptions &options) {
+    return this->GetPrevious(make_shared<string>(key), actual_key, record, options);
 }
 
 KineticStatus BlockingKineticConnection::GetVersion(const shared_ptr<const string> key,
-                                                    unique_ptr<string> &version) {
+                                                    unique_ptr<string> &version,
+                                                    const RequestOptions &options) {
     auto callback = make_shared<BlockingGetVersionCallback>(version);
-    return RunOperation(callback, nonblocking_connection_->GetVersion(key, callback));
+    return RunOperation(callback, nonblocking_connection_->GetVersion(key, callback, options));
 }
 
 KineticStatus BlockingKineticConnection::GetVersion(const string &key,
-                                                    unique_ptr<string> &version) {
-    return this->GetVersion(make_shared<string>(key), version);
+                                                    unique_ptr<string> &version,
+                                                    const RequestOptions &options) {
+    return this->GetVersion(make_shared<string>(key), version, options);
 }
 
 KineticStatus BlockingKineticConnection::GetKeyRange(const shared_ptr<const string> start_key,
@@ -451,7 +552,8 @@ KineticStatus BlockingKineticConnection::GetKeyRange(const shared_ptr<const stri
                                                      bool end_key_inclusive,
                                                      bool reverse_results,
                                                      int32_t max_results,
-                                                     unique_ptr<vector<string>> &keys) {
+                                                     unique_ptr<vector<string>> &keys,
+                                                     const RequestOptions &options) {
     auto callback = make_shared<BlockingGetKeyRangeCallback>(keys);
 
     return RunOperation(callback,
@@ -461,7 +563,8 @@ KineticStatus BlockingKineticConnection::GetKeyRange(const shared_ptr<const stri
                                                              end_key_inclusive,
                                                              reverse_results,
                                                              max_results,
-                                                             callback));
+                                                             callback,
+                                                             options));
 }
 
 KineticStatus BlockingKineticConnection::GetKeyRange(const string &start_key,
@@ -470,14 +573,16 @@ KineticStatus BlockingKineticConnection::GetKeyRange(const string &start_key,
                                                      bool end_key_inclusive,
                                                      bool reverse_results,
                                                      int32_t max_results,
-                                                     unique_ptr<vector<string>> &keys) {
+                                                     unique_ptr<vector<string>> &keys,
+                                                     const RequestOptions &options) {
     return this->GetKeyRange(make_shared<string>(start_key),
                              start_key_inclusive,
                              make_shared<string>(end_key),
                              end_key_inclusive,
                              reverse_results,
                              max_results,
-                             keys);
+                             keys,
+                             options);
 }
 
 KeyRangeIterator BlockingKineticConnection::IterateKeyRange(const shared_ptr<const string> start_key,
@@ -502,8 +607,9 @@ KeyRangeIterator BlockingKineticConnection::IterateKeyRange(const string &start_
 }
 
 KineticStatus BlockingKineticConnection::P2PPush(const P2PPushRequest &push_request,
-                                                 unique_ptr<vector<KineticStatus>> &operation_statuses) {
-    return this->P2PPush(make_shared<P2PPushRequest>(push_request), operation_statuses);
+                                                 unique_ptr<vector<KineticStatus>> &operation_statuses,
+                                                 const RequestOptions &options) {
+    return this->P2PPush(make_shared<P2PPushRequest>(push_request), operation_statuses, options);
 }
 
 class BlockingP2PPushCallback : public P2PPushCallbackInterface, public BlockingCallbackState {
@@ -526,37 +632,42 @@ class BlockingP2PPushCallback : public P2PPushCallbackInterface, public Blocking
 };
 
 KineticStatus BlockingKineticConnection::P2PPush(const shared_ptr<const P2PPushRequest> push_request,
-                                                 unique_ptr<vector<KineticStatus>> &operation_statuses) {
+                                                 unique_ptr<vector<KineticStatus>> &operation_statuses,
+                                                 const RequestOptions &options) {
     auto callback = make_shared<BlockingP2PPushCallback>(operation_statuses);
-    return RunOperation(callback, nonblocking_connection_->P2PPush(push_request, callback));
+    return RunOperation(callback, nonblocking_connection_->P2PPush(push_request, callback, options));
 }
 
 KineticStatus BlockingKineticConnection::MediaOptimize(const shared_ptr<const string> start_key,
                                                        bool start_key_inclusive,
                                                        const shared_ptr<const string> end_key,
                                                        bool end_key_inclusive,
-                                                       unique_ptr<string> &last_handled_key) {
+                                                       unique_ptr<string> &last_handled_key,
+                                                       const RequestOptions &options) {
     auto callback = make_shared<BlockingMediaOptimizeCallback>(last_handled_key);
     return RunOperation(callback,
                         nonblocking_connection_->MediaOptimize(start_key,
                                                                start_key_inclusive,
                                                                end_key,
                                                                end_key_inclusive,
-                                                               callback));
+                                                               callback,
+                                                               options));
 }
 
 KineticStatus BlockingKineticConnection::MediaOptimize(const string &start_key,
                                                        bool start_key_inclusive,
                                                        const string &end_key,
                                                        bool end_key_inclusive,
-                                                       unique_ptr<string> &last_handled_key) {
+                                                       unique_ptr<string> &last_handled_key,
+                                                       const RequestOptions &options) {
     auto callback = make_shared<BlockingMediaOptimizeCallback>(last_handled_key);
     return RunOperation(callback,
                         nonblocking_connection_->MediaOptimize(start_key,
                                                                start_key_inclusive,
                                                                end_key,
                                                                end_key_inclusive,
-                                                               callback));
+                                                               callback,
+                                                               options));
 }
 
 KineticStatus BlockingKineticConnection::MediaScan(const shared_ptr<const string> start_key,
@@ -565,7 +676,8 @@ KineticStatus BlockingKineticConnection::MediaScan(const shared_ptr<const string
                                                    bool end_key_inclusive,
                                                    int32_t max_results,
                                                    unique_ptr<string> &last_handled_key,
-                                                   unique_ptr<vector<string>> &keys) {
+                                                   unique_ptr<vector<string>> &keys,
+                                                   const RequestOptions &options) {
     auto callback = make_shared<BlockingMediaScanCallback>(keys, last_handled_key);
     return RunOperation(callback,
                         nonblocking_connection_->MediaScan(start_key,
@@ -573,7 +685,8 @@ KineticStatus BlockingKineticConnection::MediaScan(const shared_ptr<const string
                                                            end_key,
                                                            end_key_inclusive,
                                                            max_results,
-                                                           callback));
+                                                           callback,
+                                                           options));
 }
 
 KineticStatus BlockingKineticConnection::MediaScan(const string &start_key,
@@ -582,7 +695,8 @@ KineticStatus BlockingKineticConnection::MediaScan(const string &start_key,
                                                    bool end_key_inclusive,
                                                    int32_t max_results,
                                                    unique_ptr<string> &last_handled_key,
-                                                   unique_ptr<vector<string>> &keys) {
+                                                   unique_ptr<vector<string>> &keys,
+                                                   const RequestOptions &options) {
     auto callback = make_shared<BlockingMediaScanCallback>(keys, last_handled_key);
     return RunOperation(callback,
                         nonblocking_connection_->MediaScan(start_key,
@@ -590,57 +704,204 @@ KineticStatus BlockingKineticConnection::MediaScan(const string &start_key,
                                                            end_key,
                                                            end_key_inclusive,
                                                            max_results,
-                                                           callback));
-}
+                                                           callback,
+                                                           options));
+}
+
+// A request that a thread is blocked on
+struct BlockingKineticConnection::PendingOperation {
+    PendingOperation(BlockingCallbackState *callback, HandlerKey handler_key, OperationWaiter *waiter,
+                     std::chrono::system_clock::time_point timeout_time)
+        : callback(callback), handler_key(handler_key), waiter(waiter), timeout_time(timeout_time),
+          finished(false), aborted(false), status(KineticStatus(StatusCode::OK, "")) {}
+
+    BlockingCallbackState *callback;
+    HandlerKey handler_key;
+    OperationWaiter *waiter;
+    std::chrono::system_clock::time_point timeout_time;
+    bool finished;
+    // The request was removed unanswered, because it timed out or the connection failed
+    bool aborted;
+    KineticStatus status;
+};
+
+// A thread blocked on one or more requests
+struct BlockingKineticConnection::OperationWaiter {
+    OperationWaiter() : finished(0) {}
+
+    std::condition_variable wakeup;
+    // How many of the thread's requests have finished since it last looked
+    size_t finished;
+};
 
 KineticStatus BlockingKineticConnection::RunOperation(shared_ptr<BlockingCallbackState> callback,
                                                       HandlerKey handler_key) {
-    fd_set read_fds, write_fds;
-    int nfds;
+    OperationWaiter waiter;
+    PendingOperation operation(callback.get(), handler_key, &waiter,
+                               std::chrono::system_clock::now() + seconds(network_timeout_seconds_));
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    Register(&operation);
+    Wait(&waiter, lock);
+    return operation.status;
+}
+
+KineticStatus BlockingKineticConnection::RunOperations(const vector<shared_ptr<BlockingCallbackState>> &callbacks,
+                                                       const std::function<HandlerKey(size_t)> &submit,
+                                                       size_t window,
+                                                       unique_ptr<vector<KineticStatus>> &operation_statuses) {
+    size_t count = callbacks.size();
+    operation_statuses.reset(new vector<KineticStatus>(count, KineticStatus(StatusCode::OK, "")));
+    window = std::max<size_t>(window, 1);
+
+    OperationWaiter waiter;
+    // Paired with the index of the operation; list elements stay put while they're registered
+    list<std::pair<size_t, PendingOperation>> outstanding;
+    size_t next = 0;
+    unique_ptr<KineticStatus> failure;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        for (auto it = outstanding.begin(); it != outstanding.end();) {
+            if (!it->second.finished) {
+                ++it;
+                continue;
+            }
+            (*operation_statuses)[it->first] = it->second.status;
+            if (it->second.aborted && !failure) {
+                failure.reset(new KineticStatus(it->second.status));
+            }
+            waiter.finished--;
+            it = outstanding.erase(it);
+        }
+
+        // Once a request has timed out or the connection has failed, nothing more is submitted
+        if (!failure && next < count && outstanding.size() < window) {
+            size_t first = next;
+            size_t end = std::min(count, next + window - outstanding.size());
+            vector<HandlerKey> handler_keys;
+            lock.unlock();
+            for (; next < end; ++next) {
+                handler_keys.push_back(submit(next));
+            }
+            lock.lock();
 
-    if (!nonblocking_connection_->Run(&read_fds, &write_fds, &nfds)) {
-        nonblocking_connection_->RemoveHandler(handler_key);
-        return KineticStatus(StatusCode::CLIENT_IO_ERROR, "Connection failed");
+            auto timeout_time = std::chrono::system_clock::now() + seconds(network_timeout_seconds_);
+            for (size_t i = first; i < end; ++i) {
+                outstanding.emplace_back(i, PendingOperation(callbacks[i].get(), handler_keys[i - first],
+                                                             &waiter, timeout_time));
+                Register(&outstanding.back().second);
+            }
+        }
+        if (outstanding.empty()) {
+            break;
+        }
+        Wait(&waiter, lock);
     }
-    auto timeout_time = std::chrono::system_clock::now() + seconds(network_timeout_seconds_);
+    lock.unlock();
 
-    while (!(callback->done_)) {
-        struct timeval tv {0, 0};
+    if (failure) {
+        for (; next < count; ++next) {
+            (*operation_statuses)[next] = *failure;
+        }
+        return *failure;
+    }
+    for (auto it = operation_statuses->begin(); it != operation_statuses->end(); ++it) {
+        if (!it->ok()) {
+            return *it;
+        }
+    }
+    return KineticStatus(StatusCode::OK, "");
+}
+
+void BlockingKineticConnection::Register(PendingOperation *operation) {
+    operations_.push_back(operation);
+    // A new leader always runs the connection before polling, so only one that may already be
+    // polling has to be told about the request
+    if (leading_ && !wake_pending_ && wake_fds_[1] >= 0) {
+        wake_pending_ = true;
+        char wake = 0;
+        if (write(wake_fds_[1], &wake, 1) < 0) {
+            // The pipe is full, so the leader is woken anyway
+        }
+    }
+}
 
-        auto current_time = std::chrono::system_clock::now();
-        if (timeout_time > current_time) {
-            auto remaining_sec = duration_cast<seconds>(timeout_time - current_time);
-            auto remaining_usec =
-                duration_cast<microseconds>(timeout_time - current_time) - duration_cast<microseconds>(remaining_sec);
-            tv.tv_sec = remaining_sec.count();
-            tv.tv_usec = remaining_usec.count();
+void BlockingKineticConnection::Wait(OperationWaiter *waiter, std::unique_lock<std::mutex> &lock) {
+    while (waiter->finished == 0) {
+        if (leading_) {
+            waiter->wakeup.wait(lock);
+            continue;
         }
 
-        int number_ready_fds = select(nfds, &read_fds, &write_fds, NULL, &tv);
-        if (number_ready_fds < 0 && errno != EINTR) {
-            // select() returned an error
-            nonblocking_connection_->RemoveHandler(handler_key);
-            return KineticStatus(StatusCode::CLIENT_IO_ERROR, strerror(errno));
-        } else if (number_ready_fds == 0) {
-            // select() returned before any sockets were ready meaning the connection timed out
-            nonblocking_connection_->RemoveHandler(handler_key);
-            return KineticStatus(StatusCode::CLIENT_IO_ERROR, "Network timeout");
-        } else {
-            // At least one FD was ready meaning that the connection is ready
-            // to make some progress
-            if (!nonblocking_connection_->Run(&read_fds, &write_fds, &nfds)) {
-                nonblocking_connection_->RemoveHandler(handler_key);
-                return KineticStatus(StatusCode::CLIENT_IO_ERROR, "Connection failed");
+        leading_ = true;
+        Lead(waiter, lock);
+        leading_ = false;
+
+        // Hand the connection over to a thread that's still waiting
+        for (auto it = operations_.begin(); it != operations_.end(); ++it) {
+            if ((*it)->waiter != waiter) {
+                (*it)->waiter->wakeup.notify_one();
+                break;
             }
         }
     }
+}
+
+void BlockingKineticConnection::Lead(OperationWaiter *waiter, std::unique_lock<std::mutex> &lock) {
+    // Requests may have been submitted while nobody was leading, so send them straight away
+    // rather than waiting for the socket first
+    bool run_now = true;
+
+    while (waiter->finished == 0) {
+        wake_pending_ = false;
+        auto timeout_time = operations_.front()->timeout_time;
+        for (auto it = operations_.begin(); it != operations_.end(); ++it) {
+            timeout_time = std::min(timeout_time, (*it)->timeout_time);
+        }
+
+        lock.unlock();
+        KineticStatus status = KineticStatus(StatusCode::OK, "");
+        bool timed_out = false;
+        if (run_now) {
+            if (!nonblocking_connection_->Run(&interest_)) {
+                status = KineticStatus(StatusCode::CLIENT_IO_ERROR, "Connection failed");
+            }
+        } else {
+            status = PollAndRun(nonblocking_connection_.get(), &interest_, wake_fds_[0], timeout_time,
+                                &timed_out);
+        }
+        lock.lock();
+        // A request registered since wake_pending_ was cleared may have been submitted after the
+        // connection ran, with its wake byte already drained
+        run_now = wake_pending_;
 
-    // done was set, meaning handler was invoked and therefore removed internally
-    if (callback->success_) {
-        return KineticStatus(StatusCode::OK, "");
-    } else {
-        return callback->error_;
+        auto current_time = std::chrono::system_clock::now();
+        for (auto it = operations_.begin(); it != operations_.end();) {
+            PendingOperation *operation = *it++;
+            BlockingCallbackState *callback = operation->callback;
+            if (callback->done_) {
+                // done was set, meaning handler was invoked and therefore removed internally
+                Finish(operation, callback->success_ ? KineticStatus(StatusCode::OK, "") : callback->error_,
+                       false);
+            } else if (!status.ok()) {
+                nonblocking_connection_->RemoveHandler(operation->handler_key);
+                Finish(operation, status, true);
+            } else if (current_time >= operation->timeout_time) {
+                nonblocking_connection_->RemoveHandler(operation->handler_key);
+                Finish(operation, KineticStatus(StatusCode::CLIENT_IO_ERROR, "Network timeout"), true);
+            }
+        }
     }
 }
 
+void BlockingKineticConnection::Finish(PendingOperation *operation, KineticStatus status, bool aborted) {
+    operations_.remove(operation);
+    operation->finished = true;
+    operation->aborted = aborted;
+    operation->status = status;
+    operation->waiter->finished++;
+    operation->waiter->wakeup.notify_one();
+}
+
 } // namespace kinetic
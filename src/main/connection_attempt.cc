@@ -0,0 +1,163 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include "connection_attempt.h"
+
+#include <exception>
+
+#include "nonblocking_packet_service.h"
+
+namespace kinetic {
+
+using std::make_shared;
+using std::move;
+using std::string;
+using std::unique_ptr;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+// Learns whether the drive accepted the connection
+class HandshakeHandler : public HandlerInterface {
+    public:
+    HandshakeHandler() : done(false), success(false) {}
+    void Handle(const Command &response, unique_ptr<const string> value) {
+        done = success = true;
+    }
+    void Error(KineticStatus error, Command const * const response) {
+        done = true;
+    }
+
+    bool done;
+    bool success;
+};
+
+NonblockingConnectionAttempt::NonblockingConnectionAttempt(const ConnectionOptions &options,
+        HmacProvider hmac_provider)
+    : options_(options), hmac_provider_(hmac_provider),
+    deadline_(steady_clock::now() + milliseconds(options.connect_timeout_ms)),
+    state_(kResolving), error_(Status::makeOk()),
+    socket_wrapper_(make_shared<SocketWrapper>(options.host, options.port, options.use_ssl, true)),
+    handshake_(make_shared<HandshakeHandler>()) {
+    hmac_provider_.set_algorithm(options.hmac_algorithm);
+}
+
+ConnectionAttemptStatus NonblockingConnectionAttempt::Run(SocketInterest *interest) {
+    if (state_ == kDone) {
+        return kConnectionAttemptDone;
+    }
+    if (state_ == kFailed) {
+        return kConnectionAttemptFailed;
+    }
+    if (steady_clock::now() >= deadline_) {
+        return Fail("Timed out after " + std::to_string(options_.connect_timeout_ms) + " ms.");
+    }
+
+    switch (state_) {
+        case kResolving:
+            if (!socket_wrapper_->StartConnect()) {
+                return Fail("Could not connect to socket.");
+            }
+            state_ = kConnecting;
+            // fall through
+        case kConnecting: {
+            ConnectProgress progress = socket_wrapper_->ContinueConnect(interest);
+            if (progress == kConnectInProgress) {
+                return kConnectionAttemptInProgress;
+            }
+            if (progress == kConnectFailed) {
+                return Fail("Could not connect to socket.");
+            }
+            if (options_.zero_copy_threshold > 0 && !options_.use_ssl) {
+                // Falls back to ordinary sends if unsupported
+                socket_wrapper_->EnableZeroCopy(options_.zero_copy_threshold);
+            }
+            receiver_.reset(new NonblockingReceiver(socket_wrapper_, hmac_provider_, options_,
+                handshake_));
+            state_ = kHandshaking;
+        }
+            // fall through
+        case kHandshaking: {
+            NonblockingPacketServiceStatus status = receiver_->Receive();
+            if (handshake_->done) {
+                if (!handshake_->success) {
+                    return Fail("Could not complete handshake.");
+                }
+                FinishConnection();
+                return state_ == kDone ? kConnectionAttemptDone : kConnectionAttemptFailed;
+            }
+            if (status == kError) {
+                return Fail("Could not complete handshake.");
+            }
+            interest->fd = socket_wrapper_->fd();
+            interest->read = true;
+            interest->write = false;
+            return kConnectionAttemptInProgress;
+        }
+        default:
+            return kConnectionAttemptFailed;
+    }
+}
+
+// Puts the rest of the connection together around the receiver, which already holds anything
+// that arrived after the handshake
+void NonblockingConnectionAttempt::FinishConnection() {
+    try {
+        auto writer_factory =
+            shared_ptr<NonblockingPacketWriterFactoryInterface>(new NonblockingPacketWriterFactory());
+        auto sender = unique_ptr<NonblockingSenderInterface>(new NonblockingSender(socket_wrapper_,
+                                                                                   receiver_,
+                                                                                   writer_factory,
+                                                                                   hmac_provider_,
+                                                                                   options_));
+
+        NonblockingPacketService *service = new NonblockingPacketService(socket_wrapper_,
+            move(sender), receiver_);
+        connection_.reset(new NonblockingKineticConnection(service));
+    } catch (std::exception &e) {
+        Fail(e.what());
+        return;
+    }
+    receiver_.reset();
+    socket_wrapper_.reset();
+    state_ = kDone;
+}
+
+ConnectionAttemptStatus NonblockingConnectionAttempt::Fail(const string &error) {
+    error_ = Status::makeInternalError("Connection error: " + error);
+    state_ = kFailed;
+    // Close the socket now rather than whenever the attempt is destroyed
+    receiver_.reset();
+    socket_wrapper_.reset();
+    return kConnectionAttemptFailed;
+}
+
+int NonblockingConnectionAttempt::remaining_ms() {
+    // Rounded up, so that waiting this long means the deadline has passed
+    auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(
+        deadline_ - steady_clock::now()).count();
+    return remaining > 0 ? static_cast<int>((remaining + 999) / 1000) : 0;
+}
+
+Status NonblockingConnectionAttempt::error() {
+    return error_;
+}
+
+unique_ptr<NonblockingKineticConnection> NonblockingConnectionAttempt::TakeConnection() {
+    return move(connection_);
+}
+
+} // namespace kinetic
@@ -0,0 +1,74 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifndef KINETIC_CPP_CLIENT_NONBLOCKING_CONNECTION_ATTEMPT_H_
+#define KINETIC_CPP_CLIENT_NONBLOCKING_CONNECTION_ATTEMPT_H_
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "kinetic/common.h"
+#include "kinetic/connection_attempt.h"
+#include "kinetic/connection_options.h"
+#include "kinetic/hmac_provider.h"
+#include "nonblocking_packet_receiver.h"
+#include "socket_wrapper.h"
+
+namespace kinetic {
+
+using std::shared_ptr;
+
+class HandshakeHandler;
+
+// Connects the socket, runs the TLS handshake and then receives the drive's handshake status,
+// one after the other, before assembling the connection. The deadline covers all of it.
+class NonblockingConnectionAttempt : public ConnectionAttemptInterface {
+    public:
+    NonblockingConnectionAttempt(const ConnectionOptions &options, HmacProvider hmac_provider);
+    ConnectionAttemptStatus Run(SocketInterest *interest);
+    int remaining_ms();
+    Status error();
+    unique_ptr<NonblockingKineticConnection> TakeConnection();
+
+    private:
+    enum State {
+        kResolving,
+        kConnecting,
+        kHandshaking,
+        kDone,
+        kFailed
+    };
+
+    ConnectionAttemptStatus Fail(const std::string &error);
+    void FinishConnection();
+
+    const ConnectionOptions options_;
+    HmacProvider hmac_provider_;
+    const std::chrono::steady_clock::time_point deadline_;
+    State state_;
+    Status error_;
+    shared_ptr<SocketWrapper> socket_wrapper_;
+    shared_ptr<HandshakeHandler> handshake_;
+    shared_ptr<NonblockingReceiverInterface> receiver_;
+    unique_ptr<NonblockingKineticConnection> connection_;
+    DISALLOW_COPY_AND_ASSIGN(NonblockingConnectionAttempt);
+};
+
+} // namespace kinetic
+
+#endif  // KINETIC_CPP_CLIENT_NONBLOCKING_CONNECTION_ATTEMPT_H_
@@ -0,0 +1,87 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without 
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or 
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public 
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include "connection_poll.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace kinetic {
+
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+
+KineticStatus PollAndRun(NonblockingKineticConnectionInterface *connection,
+                         SocketInterest *interest,
+                         std::chrono::system_clock::time_point timeout_time) {
+    bool timed_out;
+    KineticStatus status = PollAndRun(connection, interest, -1, timeout_time, &timed_out);
+    if (timed_out) {
+        // poll() returned before the socket was ready meaning the connection timed out
+        return KineticStatus(StatusCode::CLIENT_IO_ERROR, "Network timeout");
+    }
+    return status;
+}
+
+KineticStatus PollAndRun(NonblockingKineticConnectionInterface *connection,
+                         SocketInterest *interest,
+                         int wake_fd,
+                         std::chrono::system_clock::time_point timeout_time,
+                         bool *timed_out) {
+    *timed_out = false;
+    int timeout_ms = 0;
+
+    auto current_time = std::chrono::system_clock::now();
+    if (timeout_time > current_time) {
+        // Round up so we don't spin on a sub-millisecond remainder
+        timeout_ms = duration_cast<milliseconds>(timeout_time - current_time).count() + 1;
+    }
+
+    // poll() skips entries with a negative fd, so there's no wake entry without a wake_fd
+    struct pollfd poll_fds[2];
+    poll_fds[0].fd = interest->fd;
+    poll_fds[0].events = (interest->read ? POLLIN : 0) | (interest->write ? POLLOUT : 0);
+    poll_fds[0].revents = 0;
+    poll_fds[1].fd = wake_fd;
+    poll_fds[1].events = POLLIN;
+    poll_fds[1].revents = 0;
+
+    int number_ready_fds = poll(poll_fds, 2, timeout_ms);
+    if (number_ready_fds < 0 && errno != EINTR) {
+        // poll() returned an error
+        return KineticStatus(StatusCode::CLIENT_IO_ERROR, strerror(errno));
+    } else if (number_ready_fds == 0) {
+        *timed_out = true;
+        return KineticStatus(StatusCode::OK, "");
+    }
+
+    if (poll_fds[1].revents != 0) {
+        char buffer[64];
+        while (read(wake_fd, buffer, sizeof(buffer)) > 0) {}
+    }
+
+    // At least one FD was ready meaning that the connection is ready
+    // to make some progress
+    if (!connection->Run(interest)) {
+        return KineticStatus(StatusCode::CLIENT_IO_ERROR, "Connection failed");
+    }
+    return KineticStatus(StatusCode::OK, "");
+}
+
+} // namespace kinetic
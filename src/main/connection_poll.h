@@ -0,0 +1,46 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without 
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or 
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public 
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifndef KINETIC_CPP_CLIENT_CONNECTION_POLL_H_
+#define KINETIC_CPP_CLIENT_CONNECTION_POLL_H_
+
+#include <chrono>
+
+#include "kinetic/kinetic_status.h"
+#include "kinetic/nonblocking_kinetic_connection_interface.h"
+
+namespace kinetic {
+
+/// Waits until the socket described by interest is ready or timeout_time passes, then runs the
+/// connection once, which updates interest. Used by the wrappers that drive a nonblocking
+/// connection from the calling thread.
+KineticStatus PollAndRun(NonblockingKineticConnectionInterface *connection,
+                         SocketInterest *interest,
+                         std::chrono::system_clock::time_point timeout_time);
+
+/// Like PollAndRun, but for a connection shared by several waiting threads. The wait also ends
+/// when wake_fd becomes readable, which is drained before the connection runs, and reaching
+/// timeout_time isn't an error: timed_out is set and the connection isn't run.
+KineticStatus PollAndRun(NonblockingKineticConnectionInterface *connection,
+                         SocketInterest *interest,
+                         int wake_fd,
+                         std::chrono::system_clock::time_point timeout_time,
+                         bool *timed_out);
+
+} // namespace kinetic
+
+#endif  // KINETIC_CPP_CLIENT_CONNECTION_POLL_H_
@@ -24,36 +24,133 @@
 #include <openssl/sha.h>
 #include "glog/logging.h"
 
+#include "kinetic/common.h"
+
 namespace kinetic {
 
 using com::seagate::kinetic::client::proto::Message;
 
-HmacProvider::HmacProvider() {}
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+// Before 1.1 OpenSSL has no allocator for HMAC contexts
+static HMAC_CTX *NewHmacContext() {
+    HMAC_CTX *ctx = new HMAC_CTX;
+    HMAC_CTX_init(ctx);
+    return ctx;
+}
+
+static void FreeHmacContext(HMAC_CTX *ctx) {
+    HMAC_CTX_cleanup(ctx);
+    delete ctx;
+}
+#else
+static HMAC_CTX *NewHmacContext() {
+    return HMAC_CTX_new();
+}
+
+static void FreeHmacContext(HMAC_CTX *ctx) {
+    HMAC_CTX_free(ctx);
+}
+#endif
+
+static const EVP_MD *Digest(HmacAlgorithm algorithm) {
+    switch (algorithm) {
+        case HmacAlgorithm::SHA256:
+            return EVP_sha256();
+        case HmacAlgorithm::SHA1:
+        default:
+            return EVP_sha1();
+    }
+}
+
+// An HMAC context keyed once. OpenSSL keeps the state after hashing the key's inner and outer pads,
+// so starting a new message from it only has to copy that state.
+class HmacProvider::KeyedContext {
+    public:
+    KeyedContext(const std::string& key, const EVP_MD *digest)
+        : key_(key), ctx_(NewHmacContext()) {
+        CHECK(HMAC_Init_ex(ctx_, key.data(), key.length(), digest, NULL));
+    }
+
+    ~KeyedContext() {
+        FreeHmacContext(ctx_);
+    }
+
+    const std::string& key() const {
+        return key_;
+    }
+
+    // Returns the context ready for a new message under the same key
+    HMAC_CTX *Reset() {
+        CHECK(HMAC_Init_ex(ctx_, NULL, 0, NULL, NULL));
+        return ctx_;
+    }
+
+    private:
+    const std::string key_;
+    HMAC_CTX *ctx_;
+    DISALLOW_COPY_AND_ASSIGN(KeyedContext);
+};
+
+HmacProvider::HmacProvider() : algorithm_(HmacAlgorithm::SHA1), keyed_context_() {}
+
+HmacProvider::HmacProvider(HmacAlgorithm algorithm) : algorithm_(algorithm), keyed_context_() {}
+
+HmacProvider::HmacProvider(const HmacProvider& other)
+    : algorithm_(other.algorithm_), keyed_context_() {}
+
+HmacProvider& HmacProvider::operator=(const HmacProvider& other) {
+    algorithm_ = other.algorithm_;
+    keyed_context_.reset();
+    return *this;
+}
+
+HmacProvider::~HmacProvider() {}
+
+HmacAlgorithm HmacProvider::algorithm() const {
+    return algorithm_;
+}
+
+void HmacProvider::set_algorithm(HmacAlgorithm algorithm) {
+    if (algorithm != algorithm_) {
+        algorithm_ = algorithm;
+        keyed_context_.reset();
+    }
+}
 
 std::string HmacProvider::ComputeHmac(const Message& message,
         const std::string& key) const {
-    HMAC_CTX ctx;
-    HMAC_CTX_init(&ctx);
-    HMAC_Init_ex(&ctx, key.c_str(), key.length(), EVP_sha1(), NULL);
+    return ComputeHmac(message.commandbytes().data(), message.commandbytes().length(), key);
+}
 
-    if (message.commandbytes().length() != 0) {
-        uint32_t message_length_bigendian = htonl(message.commandbytes().length());
-        HMAC_Update(&ctx, reinterpret_cast<unsigned char *>(&message_length_bigendian),
+std::string HmacProvider::ComputeHmac(const char* command_bytes, size_t length,
+        const std::string& key) const {
+    if (!keyed_context_ || keyed_context_->key() != key) {
+        keyed_context_.reset(new KeyedContext(key, Digest(algorithm_)));
+    }
+    HMAC_CTX *ctx = keyed_context_->Reset();
+
+    if (length != 0) {
+        uint32_t message_length_bigendian = htonl(length);
+        HMAC_Update(ctx, reinterpret_cast<unsigned char *>(&message_length_bigendian),
             sizeof(uint32_t));
-        HMAC_Update(&ctx, reinterpret_cast<const unsigned char *>(message.commandbytes().c_str()),
-            message.commandbytes().length());
+        HMAC_Update(ctx, reinterpret_cast<const unsigned char *>(command_bytes), length);
     }
 
-    unsigned char result[SHA_DIGEST_LENGTH];
-    unsigned int result_length = SHA_DIGEST_LENGTH;
-    HMAC_Final(&ctx, result, &result_length);
-    HMAC_CTX_cleanup(&ctx);
+    unsigned char result[EVP_MAX_MD_SIZE];
+    unsigned int result_length = sizeof(result);
+    HMAC_Final(ctx, result, &result_length);
 
     return std::string(reinterpret_cast<char *>(result), result_length);
 }
 
 bool HmacProvider::ValidateHmac(const Message& message, const std::string& key) const {
-    std::string correct_hmac(ComputeHmac(message, key));
+    return ValidateHmac(message, message.commandbytes().data(), message.commandbytes().length(),
+        key);
+}
+
+bool HmacProvider::ValidateHmac(const Message& message, const char* command_bytes, size_t length,
+        const std::string& key) const {
+    std::string correct_hmac(ComputeHmac(command_bytes, length, key));
 
     if (!message.has_hmacauth()) {
         return false;
@@ -0,0 +1,188 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include "in_flight_table.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace kinetic {
+
+using std::move;
+
+const size_t InFlightTable::kDefaultCapacity;
+
+static size_t RoundUpToPowerOfTwo(size_t n) {
+    size_t rounded = 1;
+    while (rounded < n) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+InFlightTable::InFlightTable(size_t capacity)
+    : mask_(RoundUpToPowerOfTwo(capacity) - 1), size_(0), requests_(mask_ + 1),
+    keys_(mask_ + 1) {}
+
+bool InFlightTable::Insert(google::int64 sequence, shared_ptr<HandlerInterface> handler,
+        HandlerKey handler_key) {
+    if (Find(sequence) != NULL) {
+        LOG(WARNING) << "Found existing handler for sequence " << sequence;
+        return false;
+    }
+    google::int64 existing_sequence;
+    if (FindSequence(handler_key, &existing_sequence)) {
+        LOG(WARNING) << "Found existing sequence " << existing_sequence << " for handler_key "
+            << handler_key;
+        return false;
+    }
+
+    InFlightRequest *request = RingSlot(sequence);
+    if (request == NULL || request->sequence >= 0) {
+        request = &overflow_requests_[sequence];
+    }
+    request->sequence = sequence;
+    request->handler = move(handler);
+    request->handler_key = handler_key;
+
+    KeySlot *key_slot = RingKeySlot(handler_key);
+    if (key_slot->used) {
+        overflow_keys_[handler_key] = sequence;
+    } else {
+        key_slot->used = true;
+        key_slot->handler_key = handler_key;
+        key_slot->sequence = sequence;
+    }
+    size_++;
+    return true;
+}
+
+const InFlightRequest *InFlightTable::Find(google::int64 sequence) const {
+    if (sequence >= 0) {
+        const InFlightRequest &request = requests_[sequence & mask_];
+        if (request.sequence == sequence) {
+            return &request;
+        }
+    }
+    if (overflow_requests_.empty()) {
+        return NULL;
+    }
+    auto overflow = overflow_requests_.find(sequence);
+    return overflow == overflow_requests_.end() ? NULL : &overflow->second;
+}
+
+bool InFlightTable::Take(google::int64 sequence, InFlightRequest *request) {
+    InFlightRequest *slot = RingSlot(sequence);
+    if (slot != NULL && slot->sequence == sequence) {
+        *request = move(*slot);
+        slot->sequence = -1;
+    } else {
+        auto overflow = overflow_requests_.empty() ? overflow_requests_.end() :
+            overflow_requests_.find(sequence);
+        if (overflow == overflow_requests_.end()) {
+            return false;
+        }
+        *request = move(overflow->second);
+        overflow_requests_.erase(overflow);
+    }
+    EraseKey(request->handler_key);
+    size_--;
+    return true;
+}
+
+bool InFlightTable::TakeByKey(HandlerKey handler_key, InFlightRequest *request) {
+    google::int64 sequence;
+    if (!FindSequence(handler_key, &sequence)) {
+        return false;
+    }
+    CHECK(Take(sequence, request)) << "Handler key " << handler_key << " mapped to seq "
+        << sequence << " but no handler entry for that seq";
+    return true;
+}
+
+void InFlightTable::TakeAll(vector<InFlightRequest> *requests) {
+    requests->clear();
+    requests->reserve(size_);
+    for (auto &overflow : overflow_requests_) {
+        requests->push_back(move(overflow.second));
+    }
+    overflow_requests_.clear();
+    overflow_keys_.clear();
+    for (size_t i = 0; i <= mask_ && requests->size() < size_; i++) {
+        if (requests_[i].sequence >= 0) {
+            requests->push_back(move(requests_[i]));
+            requests_[i].sequence = -1;
+        }
+    }
+    for (auto &key_slot : keys_) {
+        key_slot.used = false;
+    }
+    size_ = 0;
+    std::sort(requests->begin(), requests->end(),
+        [](const InFlightRequest &a, const InFlightRequest &b) {
+            return a.sequence < b.sequence;
+        });
+}
+
+bool InFlightTable::empty() const {
+    return size_ == 0;
+}
+
+size_t InFlightTable::size() const {
+    return size_;
+}
+
+size_t InFlightTable::overflowed() const {
+    return overflow_requests_.size();
+}
+
+InFlightRequest *InFlightTable::RingSlot(google::int64 sequence) {
+    return sequence < 0 ? NULL : &requests_[sequence & mask_];
+}
+
+InFlightTable::KeySlot *InFlightTable::RingKeySlot(HandlerKey handler_key) {
+    return &keys_[handler_key & mask_];
+}
+
+bool InFlightTable::FindSequence(HandlerKey handler_key, google::int64 *sequence) const {
+    const KeySlot &key_slot = keys_[handler_key & mask_];
+    if (key_slot.used && key_slot.handler_key == handler_key) {
+        *sequence = key_slot.sequence;
+        return true;
+    }
+    if (overflow_keys_.empty()) {
+        return false;
+    }
+    auto overflow = overflow_keys_.find(handler_key);
+    if (overflow == overflow_keys_.end()) {
+        return false;
+    }
+    *sequence = overflow->second;
+    return true;
+}
+
+void InFlightTable::EraseKey(HandlerKey handler_key) {
+    KeySlot *key_slot = RingKeySlot(handler_key);
+    if (key_slot->used && key_slot->handler_key == handler_key) {
+        key_slot->used = false;
+        return;
+    }
+    CHECK_EQ((size_t) 1, overflow_keys_.erase(handler_key))
+        << "Couldn't delete handler key to sequence entry for handler_key " << handler_key;
+}
+
+} // namespace kinetic
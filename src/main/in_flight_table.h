@@ -0,0 +1,98 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifndef KINETIC_CPP_CLIENT_IN_FLIGHT_TABLE_H_
+#define KINETIC_CPP_CLIENT_IN_FLIGHT_TABLE_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "kinetic/common.h"
+#include "kinetic/nonblocking_packet_service_interface.h"
+
+namespace kinetic {
+
+using std::shared_ptr;
+using std::unordered_map;
+using std::vector;
+
+struct InFlightRequest {
+    InFlightRequest() : sequence(-1), handler(), handler_key(0) {}
+    google::int64 sequence;
+    shared_ptr<HandlerInterface> handler;
+    HandlerKey handler_key;
+};
+
+// The handlers of requests that have been sent and are waiting for their response, findable by
+// sequence when the response arrives and by handler key when a request is cancelled. The sender
+// hands out sequences densely from 0, so requests live in a ring indexed by sequence modulo the
+// capacity and each slot is tagged with the sequence it holds; a second ring does the same for
+// handler keys. A request whose slot is still held by one that is capacity requests older, and
+// one with a negative sequence such as the handshake, goes to a small overflow map instead.
+class InFlightTable {
+    public:
+    static const size_t kDefaultCapacity = 256;
+
+    // The capacity is rounded up to a power of two
+    explicit InFlightTable(size_t capacity = kDefaultCapacity);
+    // Returns false, leaving the table unchanged, if the sequence or the handler key is already
+    // in use.
+    bool Insert(google::int64 sequence, shared_ptr<HandlerInterface> handler,
+        HandlerKey handler_key);
+    // Returns NULL if no request has the sequence. The pointer is good until the table changes.
+    const InFlightRequest *Find(google::int64 sequence) const;
+    // Move the request out of the table. Return false if there is none.
+    bool Take(google::int64 sequence, InFlightRequest *request);
+    bool TakeByKey(HandlerKey handler_key, InFlightRequest *request);
+    // Empties the table, oldest request first
+    void TakeAll(vector<InFlightRequest> *requests);
+    bool empty() const;
+    size_t size() const;
+    // The number of requests that didn't fit in the ring
+    size_t overflowed() const;
+
+    private:
+    struct KeySlot {
+        KeySlot() : used(false), handler_key(0), sequence(-1) {}
+        bool used;
+        HandlerKey handler_key;
+        google::int64 sequence;
+    };
+
+    InFlightRequest *RingSlot(google::int64 sequence);
+    KeySlot *RingKeySlot(HandlerKey handler_key);
+    bool FindSequence(HandlerKey handler_key, google::int64 *sequence) const;
+    void EraseKey(HandlerKey handler_key);
+
+    const size_t mask_;
+    size_t size_;
+    // A free slot holds sequence -1, since negative sequences never go in the ring
+    vector<InFlightRequest> requests_;
+    vector<KeySlot> keys_;
+    unordered_map<google::int64, InFlightRequest> overflow_requests_;
+    unordered_map<HandlerKey, google::int64> overflow_keys_;
+    DISALLOW_COPY_AND_ASSIGN(InFlightTable);
+};
+
+} // namespace kinetic
+
+#endif  // KINETIC_CPP_CLIENT_IN_FLIGHT_TABLE_H_
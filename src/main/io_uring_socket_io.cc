@@ -0,0 +1,321 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include "io_uring_socket_io.h"
+
+#ifdef KINETIC_HAVE_IO_URING
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "glog/logging.h"
+
+namespace kinetic {
+
+// Receives ask for at least this much so small reads still pick up several pipelined responses
+static const size_t kMinReceiveSize = 64 * 1024;
+// and at most this much, so a large value doesn't pin a buffer of its own size per connection
+static const size_t kMaxReceiveSize = 1024 * 1024;
+
+static int io_uring_setup(unsigned entries, struct io_uring_params *params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags,
+        NULL, 0));
+}
+
+template <typename T>
+static T *RingPointer(void *ring, unsigned offset) {
+    return reinterpret_cast<T *>(static_cast<char *>(ring) + offset);
+}
+
+IoUringRing::IoUringRing() : ring_fd_(-1), sq_ring_(MAP_FAILED), sq_ring_size_(0),
+        cq_ring_(MAP_FAILED), cq_ring_size_(0), sqes_(NULL), sqes_size_(0), sq_head_(NULL),
+        sq_tail_(NULL), sq_mask_(0), sq_entries_(0), sq_array_(NULL), sq_local_tail_(0),
+        cq_head_(NULL), cq_tail_(NULL), cq_mask_(0), cqes_(NULL) {
+    memset(&timeout_, 0, sizeof(timeout_));
+}
+
+IoUringRing::~IoUringRing() {
+    if (sqes_ != NULL) {
+        munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+        munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != MAP_FAILED) {
+        munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0) {
+        close(ring_fd_);
+    }
+}
+
+bool IoUringRing::Init(unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd_ = io_uring_setup(entries, &params);
+    if (ring_fd_ < 0) {
+        PLOG(WARNING) << "io_uring_setup failed";
+        return false;
+    }
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = mmap(NULL, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+        PLOG(WARNING) << "Failed to map io_uring submission queue";
+        return false;
+    }
+    if (single_mmap) {
+        cq_ring_ = sq_ring_;
+    } else {
+        cq_ring_ = mmap(NULL, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) {
+            PLOG(WARNING) << "Failed to map io_uring completion queue";
+            return false;
+        }
+    }
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(NULL, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        PLOG(WARNING) << "Failed to map io_uring submission entries";
+        return false;
+    }
+    sqes_ = static_cast<struct io_uring_sqe *>(sqes);
+
+    sq_head_ = RingPointer<unsigned>(sq_ring_, params.sq_off.head);
+    sq_tail_ = RingPointer<unsigned>(sq_ring_, params.sq_off.tail);
+    sq_mask_ = *RingPointer<unsigned>(sq_ring_, params.sq_off.ring_mask);
+    sq_entries_ = *RingPointer<unsigned>(sq_ring_, params.sq_off.ring_entries);
+    sq_array_ = RingPointer<unsigned>(sq_ring_, params.sq_off.array);
+    sq_local_tail_ = *sq_tail_;
+    cq_head_ = RingPointer<unsigned>(cq_ring_, params.cq_off.head);
+    cq_tail_ = RingPointer<unsigned>(cq_ring_, params.cq_off.tail);
+    cq_mask_ = *RingPointer<unsigned>(cq_ring_, params.cq_off.ring_mask);
+    cqes_ = RingPointer<struct io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+    return true;
+}
+
+struct io_uring_sqe *IoUringRing::NextSqe() {
+    if (sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+        if (!Submit(0, -1) ||
+                sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+            return NULL;
+        }
+    }
+    unsigned index = sq_local_tail_ & sq_mask_;
+    struct io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    sq_local_tail_++;
+    return sqe;
+}
+
+bool IoUringRing::Submit(unsigned wait_for, int timeout_ms) {
+    if (wait_for > 0 && timeout_ms >= 0) {
+        // Completes on its own after the timeout, or once wait_for other operations have
+        struct io_uring_sqe *sqe = NextSqe();
+        if (sqe == NULL) {
+            return false;
+        }
+        timeout_.tv_sec = timeout_ms / 1000;
+        timeout_.tv_nsec = (timeout_ms % 1000) * 1000000LL;
+        sqe->opcode = IORING_OP_TIMEOUT;
+        sqe->fd = -1;
+        sqe->addr = reinterpret_cast<uint64_t>(&timeout_);
+        sqe->len = 1;
+        sqe->off = wait_for;
+        sqe->user_data = 0;
+    }
+
+    __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+    unsigned to_submit = sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (to_submit == 0 && wait_for == 0) {
+        return true;
+    }
+    while (true) {
+        int result = io_uring_enter(ring_fd_, to_submit, wait_for,
+            wait_for > 0 ? IORING_ENTER_GETEVENTS : 0);
+        if (result >= 0) {
+            return true;
+        }
+        if (errno == EINTR) {
+            // Whatever was submitted before the interruption has been consumed
+            to_submit = sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+            continue;
+        }
+        if (errno == EBUSY || errno == EAGAIN) {
+            // The completion queue needs draining before the kernel takes more
+            return true;
+        }
+        PLOG(ERROR) << "io_uring_enter failed";
+        return false;
+    }
+}
+
+void IoUringRing::Dispatch() {
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const struct io_uring_cqe &cqe = cqes_[head & cq_mask_];
+        // Timeouts and cancellations carry no operation
+        if (cqe.user_data != 0) {
+            IoUringOperation *operation = reinterpret_cast<IoUringOperation *>(cqe.user_data);
+            operation->in_flight = false;
+            operation->completed = true;
+            operation->result = cqe.res;
+            ready_.push_back(operation->cookie);
+        }
+        head++;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+}
+
+IoUringSocketIo::IoUringSocketIo(IoUringRing *ring, int fd, uint64_t cookie)
+    : ring_(ring), fd_(fd), send_iov_(), receive_buffer_(), receive_consumed_(0) {
+    send_.cookie = cookie;
+    receive_.cookie = cookie;
+    memset(&send_msg_, 0, sizeof(send_msg_));
+}
+
+IoUringSocketIo::~IoUringSocketIo() {
+    Cancel(&send_);
+    Cancel(&receive_);
+}
+
+ssize_t IoUringSocketIo::Writev(const struct iovec *iov, int iovcnt) {
+    if (send_.completed) {
+        send_.completed = false;
+        if (send_.result < 0) {
+            errno = -send_.result;
+            return -1;
+        }
+        return send_.result;
+    }
+    if (send_.in_flight) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    struct io_uring_sqe *sqe = ring_->NextSqe();
+    if (sqe == NULL) {
+        errno = EIO;
+        return -1;
+    }
+    send_iov_.assign(iov, iov + iovcnt);
+    send_msg_.msg_iov = send_iov_.data();
+    send_msg_.msg_iovlen = send_iov_.size();
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(&send_msg_);
+    sqe->len = 1;
+    // Prevent SIGPIPE if the drive closes the connection
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = reinterpret_cast<uint64_t>(&send_);
+    send_.in_flight = true;
+    errno = EAGAIN;
+    return -1;
+}
+
+ssize_t IoUringSocketIo::Read(char *buf, size_t size) {
+    if (receive_.completed) {
+        if (receive_.result <= 0) {
+            receive_.completed = false;
+            if (receive_.result == 0) {
+                return 0;
+            }
+            errno = -receive_.result;
+            return -1;
+        }
+        size_t n = std::min(size, static_cast<size_t>(receive_.result) - receive_consumed_);
+        memcpy(buf, receive_buffer_.data() + receive_consumed_, n);
+        receive_consumed_ += n;
+        if (receive_consumed_ == static_cast<size_t>(receive_.result)) {
+            receive_.completed = false;
+            receive_consumed_ = 0;
+        }
+        return n;
+    }
+    if (receive_.in_flight) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    struct io_uring_sqe *sqe = ring_->NextSqe();
+    if (sqe == NULL) {
+        errno = EIO;
+        return -1;
+    }
+    size_t receive_size = std::min(std::max(size, kMinReceiveSize), kMaxReceiveSize);
+    if (receive_buffer_.size() < receive_size) {
+        receive_buffer_.resize(receive_size);
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(receive_buffer_.data());
+    sqe->len = receive_buffer_.size();
+    sqe->user_data = reinterpret_cast<uint64_t>(&receive_);
+    receive_.in_flight = true;
+    errno = EAGAIN;
+    return -1;
+}
+
+void IoUringSocketIo::AbandonWrite() {
+    Cancel(&send_);
+    send_.completed = false;
+}
+
+// Blocks until the operation is no longer in flight, either because it was cancelled or because
+// it completed in the meantime. Other completions that arrive while waiting are recorded as usual.
+void IoUringSocketIo::Cancel(IoUringOperation *operation) {
+    if (!operation->in_flight) {
+        return;
+    }
+    struct io_uring_sqe *sqe = ring_->NextSqe();
+    if (sqe != NULL) {
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = reinterpret_cast<uint64_t>(operation);
+        sqe->user_data = 0;
+    }
+    while (operation->in_flight) {
+        if (!ring_->Submit(1, -1)) {
+            LOG(ERROR) << "Could not wait for io_uring operation on fd " << fd_ << " to finish";
+            return;
+        }
+        ring_->Dispatch();
+    }
+}
+
+} // namespace kinetic
+
+#endif  // KINETIC_HAVE_IO_URING
@@ -0,0 +1,125 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifndef KINETIC_CPP_CLIENT_IO_URING_SOCKET_IO_H_
+#define KINETIC_CPP_CLIENT_IO_URING_SOCKET_IO_H_
+
+#ifdef KINETIC_HAVE_IO_URING
+
+#include <linux/io_uring.h>
+#include <sys/socket.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "kinetic/common.h"
+#include "kinetic/socket_io.h"
+
+namespace kinetic {
+
+// An operation submitted to an IoUringRing. When its completion arrives the ring records the
+// result and adds cookie to the ring's ready list.
+struct IoUringOperation {
+    IoUringOperation() : cookie(0), in_flight(false), completed(false), result(0) {}
+    uint64_t cookie;
+    bool in_flight;
+    bool completed;
+    int32_t result;
+};
+
+// Minimal io_uring driven through the raw system calls, so that no liburing is needed. Not
+// thread safe; it's meant to be owned by a single event loop.
+class IoUringRing {
+    public:
+    IoUringRing();
+    ~IoUringRing();
+
+    bool Init(unsigned entries);
+
+    // Returns a zeroed submission entry to fill in. If the submission queue is full, the queued
+    // entries are handed to the kernel first. Returns NULL if that fails.
+    struct io_uring_sqe *NextSqe();
+
+    // Submits everything queued and waits until at least wait_for operations have completed or
+    // timeout_ms has passed (negative means no limit)
+    bool Submit(unsigned wait_for, int timeout_ms);
+
+    // Processes all available completions
+    void Dispatch();
+
+    // Cookies of operations completed by Dispatch; the caller clears it
+    std::vector<uint64_t> &ready() {
+        return ready_;
+    }
+
+    private:
+    int ring_fd_;
+    void *sq_ring_;
+    size_t sq_ring_size_;
+    void *cq_ring_;
+    size_t cq_ring_size_;
+    struct io_uring_sqe *sqes_;
+    size_t sqes_size_;
+    unsigned *sq_head_;
+    unsigned *sq_tail_;
+    unsigned sq_mask_;
+    unsigned sq_entries_;
+    unsigned *sq_array_;
+    unsigned sq_local_tail_;
+    unsigned *cq_head_;
+    unsigned *cq_tail_;
+    unsigned cq_mask_;
+    struct io_uring_cqe *cqes_;
+    struct __kernel_timespec timeout_;
+    std::vector<uint64_t> ready_;
+    DISALLOW_COPY_AND_ASSIGN(IoUringRing);
+};
+
+// Performs one socket's reads and writes as operations on a shared ring. Nothing reaches the
+// kernel until the ring's owner submits, so a whole pass over many connections costs a single
+// system call. Reads land in a buffer owned by this object and are copied out on the next call,
+// which keeps the kernel from writing into memory the caller may have released in the meantime.
+class IoUringSocketIo : public SocketIoInterface {
+    public:
+    // ring must outlive this object; cookie identifies the socket in the ring's ready list
+    IoUringSocketIo(IoUringRing *ring, int fd, uint64_t cookie);
+    ~IoUringSocketIo();
+
+    ssize_t Writev(const struct iovec *iov, int iovcnt);
+    ssize_t Read(char *buf, size_t size);
+    void AbandonWrite();
+
+    private:
+    void Cancel(IoUringOperation *operation);
+
+    IoUringRing *ring_;
+    int fd_;
+    IoUringOperation send_;
+    std::vector<struct iovec> send_iov_;
+    struct msghdr send_msg_;
+    IoUringOperation receive_;
+    std::vector<char> receive_buffer_;
+    // Completed receive bytes before this offset have already been copied out
+    size_t receive_consumed_;
+    DISALLOW_COPY_AND_ASSIGN(IoUringSocketIo);
+};
+
+} // namespace kinetic
+
+#endif  // KINETIC_HAVE_IO_URING
+
+#endif  // KINETIC_CPP_CLIENT_IO_URING_SOCKET_IO_H_
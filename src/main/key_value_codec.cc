@@ -0,0 +1,336 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include "key_value_codec.h"
+
+#include <string.h>
+
+namespace kinetic {
+
+using com::seagate::kinetic::client::proto::Command_Algorithm_INVALID_ALGORITHM;
+using com::seagate::kinetic::client::proto::Command_MessageType_DELETE;
+using com::seagate::kinetic::client::proto::Command_MessageType_GET;
+using com::seagate::kinetic::client::proto::Command_MessageType_GETNEXT;
+using com::seagate::kinetic::client::proto::Command_MessageType_GETPREVIOUS;
+using com::seagate::kinetic::client::proto::Command_MessageType_INVALID_MESSAGE_TYPE;
+using com::seagate::kinetic::client::proto::Command_MessageType_PUT;
+using com::seagate::kinetic::client::proto::Command_Priority_NORMAL;
+using com::seagate::kinetic::client::proto::Command_Synchronization_INVALID_SYNCHRONIZATION;
+
+namespace {
+
+// Protobuf wire types
+const int kVarint = 0;
+const int kLengthDelimited = 2;
+
+// Field numbers from kinetic.proto
+const int kCommandHeader = 1;
+const int kCommandBody = 2;
+
+const int kHeaderClusterVersion = 1;
+const int kHeaderConnectionId = 3;
+const int kHeaderSequence = 4;
+const int kHeaderMessageType = 7;
+const int kHeaderTimeout = 9;
+const int kHeaderEarlyExit = 10;
+const int kHeaderPriority = 12;
+const int kHeaderTimeQuanta = 13;
+
+const int kBodyKeyValue = 1;
+
+const int kKeyValueNewVersion = 2;
+const int kKeyValueKey = 3;
+const int kKeyValueDbVersion = 4;
+const int kKeyValueTag = 5;
+const int kKeyValueAlgorithm = 6;
+const int kKeyValueMetadataOnly = 7;
+const int kKeyValueForce = 8;
+const int kKeyValueSynchronization = 9;
+
+// All field numbers used here are below 16, so every tag is a single byte
+inline uint8_t Tag(int field, int wire_type) {
+    return static_cast<uint8_t>((field << 3) | wire_type);
+}
+
+inline size_t VarintSize(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+// int32 and enum fields are sign extended, so negative values take ten bytes like int64 ones
+inline uint64_t EnumValue(int value) {
+    return static_cast<uint64_t>(static_cast<int64_t>(value));
+}
+
+inline size_t VarintFieldSize(uint64_t value) {
+    return 1 + VarintSize(value);
+}
+
+inline size_t BytesFieldSize(size_t length) {
+    return 1 + VarintSize(length) + length;
+}
+
+inline uint8_t *WriteVarint(uint64_t value, uint8_t *p) {
+    while (value >= 0x80) {
+        *p++ = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = static_cast<uint8_t>(value);
+    return p;
+}
+
+inline uint8_t *WriteVarintField(int field, uint64_t value, uint8_t *p) {
+    *p++ = Tag(field, kVarint);
+    return WriteVarint(value, p);
+}
+
+inline uint8_t *WriteBytesField(int field, const string &value, uint8_t *p) {
+    *p++ = Tag(field, kLengthDelimited);
+    p = WriteVarint(value.size(), p);
+    memcpy(p, value.data(), value.size());
+    return p + value.size();
+}
+
+size_t HeaderSize(const KeyValueRequest &request) {
+    size_t size = 0;
+    if (request.has_cluster_version) {
+        size += VarintFieldSize(request.cluster_version);
+    }
+    if (request.has_connection_id) {
+        size += VarintFieldSize(request.connection_id);
+    }
+    if (request.has_sequence) {
+        size += VarintFieldSize(request.sequence);
+    }
+    if (request.has_message_type) {
+        size += VarintFieldSize(EnumValue(request.message_type));
+    }
+    if (request.has_timeout) {
+        size += VarintFieldSize(request.timeout);
+    }
+    if (request.has_early_exit) {
+        size += VarintFieldSize(request.early_exit ? 1 : 0);
+    }
+    if (request.has_priority) {
+        size += VarintFieldSize(EnumValue(request.priority));
+    }
+    if (request.has_time_quanta) {
+        size += VarintFieldSize(request.time_quanta);
+    }
+    return size;
+}
+
+size_t KeyValueSize(const KeyValueRequest &request) {
+    size_t size = 0;
+    if (request.new_version) {
+        size += BytesFieldSize(request.new_version->size());
+    }
+    if (request.key) {
+        size += BytesFieldSize(request.key->size());
+    }
+    if (request.db_version) {
+        size += BytesFieldSize(request.db_version->size());
+    }
+    if (request.tag) {
+        size += BytesFieldSize(request.tag->size());
+    }
+    if (request.has_algorithm) {
+        size += VarintFieldSize(EnumValue(request.algorithm));
+    }
+    if (request.has_metadata_only) {
+        size += 2;
+    }
+    if (request.has_force) {
+        size += 2;
+    }
+    if (request.has_synchronization) {
+        size += VarintFieldSize(EnumValue(request.synchronization));
+    }
+    return size;
+}
+
+} // namespace
+
+KeyValueRequest::KeyValueRequest()
+    : has_cluster_version(false), cluster_version(0),
+    has_connection_id(false), connection_id(0),
+    has_sequence(false), sequence(0),
+    has_message_type(false), message_type(Command_MessageType_INVALID_MESSAGE_TYPE),
+    has_timeout(false), timeout(0), has_early_exit(false), early_exit(false),
+    has_priority(false), priority(Command_Priority_NORMAL), has_time_quanta(false), time_quanta(0),
+    has_body(false), has_key_value(false),
+    new_version(NULL), key(NULL), db_version(NULL), tag(NULL),
+    has_algorithm(false), algorithm(Command_Algorithm_INVALID_ALGORITHM),
+    has_metadata_only(false), metadata_only(false),
+    has_force(false), force(false),
+    has_synchronization(false), synchronization(Command_Synchronization_INVALID_SYNCHRONIZATION) {}
+
+void EncodeKeyValueRequest(const KeyValueRequest &request, string *out) {
+    size_t header_size = HeaderSize(request);
+    size_t key_value_size = KeyValueSize(request);
+    size_t body_size = request.has_key_value ? BytesFieldSize(key_value_size) : 0;
+    bool has_header = request.has_cluster_version || request.has_connection_id ||
+        request.has_sequence || request.has_message_type || request.has_timeout ||
+        request.has_early_exit || request.has_priority || request.has_time_quanta;
+    bool has_body = request.has_body || request.has_key_value;
+
+    size_t total_size = 0;
+    if (has_header) {
+        total_size += BytesFieldSize(header_size);
+    }
+    if (has_body) {
+        total_size += BytesFieldSize(body_size);
+    }
+
+    size_t offset = out->size();
+    out->resize(offset + total_size);
+    uint8_t *p = reinterpret_cast<uint8_t *>(&(*out)[0]) + offset;
+
+    if (has_header) {
+        *p++ = Tag(kCommandHeader, kLengthDelimited);
+        p = WriteVarint(header_size, p);
+        if (request.has_cluster_version) {
+            p = WriteVarintField(kHeaderClusterVersion, request.cluster_version, p);
+        }
+        if (request.has_connection_id) {
+            p = WriteVarintField(kHeaderConnectionId, request.connection_id, p);
+        }
+        if (request.has_sequence) {
+            p = WriteVarintField(kHeaderSequence, request.sequence, p);
+        }
+        if (request.has_message_type) {
+            p = WriteVarintField(kHeaderMessageType, EnumValue(request.message_type), p);
+        }
+        if (request.has_timeout) {
+            p = WriteVarintField(kHeaderTimeout, request.timeout, p);
+        }
+        if (request.has_early_exit) {
+            p = WriteVarintField(kHeaderEarlyExit, request.early_exit ? 1 : 0, p);
+        }
+        if (request.has_priority) {
+            p = WriteVarintField(kHeaderPriority, EnumValue(request.priority), p);
+        }
+        if (request.has_time_quanta) {
+            p = WriteVarintField(kHeaderTimeQuanta, request.time_quanta, p);
+        }
+    }
+
+    if (has_body) {
+        *p++ = Tag(kCommandBody, kLengthDelimited);
+        p = WriteVarint(body_size, p);
+    }
+    if (request.has_key_value) {
+        *p++ = Tag(kBodyKeyValue, kLengthDelimited);
+        p = WriteVarint(key_value_size, p);
+        if (request.new_version) {
+            p = WriteBytesField(kKeyValueNewVersion, *request.new_version, p);
+        }
+        if (request.key) {
+            p = WriteBytesField(kKeyValueKey, *request.key, p);
+        }
+        if (request.db_version) {
+            p = WriteBytesField(kKeyValueDbVersion, *request.db_version, p);
+        }
+        if (request.tag) {
+            p = WriteBytesField(kKeyValueTag, *request.tag, p);
+        }
+        if (request.has_algorithm) {
+            p = WriteVarintField(kKeyValueAlgorithm, EnumValue(request.algorithm), p);
+        }
+        if (request.has_metadata_only) {
+            p = WriteVarintField(kKeyValueMetadataOnly, request.metadata_only ? 1 : 0, p);
+        }
+        if (request.has_force) {
+            p = WriteVarintField(kKeyValueForce, request.force ? 1 : 0, p);
+        }
+        if (request.has_synchronization) {
+            p = WriteVarintField(kKeyValueSynchronization, EnumValue(request.synchronization), p);
+        }
+    }
+}
+
+bool KeyValueRequestFromCommand(const Command &command, KeyValueRequest *request) {
+    if (command.has_status() || !command.header().has_messagetype()) {
+        return false;
+    }
+    switch (command.header().messagetype()) {
+        case Command_MessageType_GET:
+        case Command_MessageType_GETNEXT:
+        case Command_MessageType_GETPREVIOUS:
+        case Command_MessageType_PUT:
+        case Command_MessageType_DELETE:
+            break;
+        default:
+            return false;
+    }
+
+    const auto &header = command.header();
+    if (header.has_acksequence()) {
+        return false;
+    }
+    const auto &body = command.body();
+    if (body.has_range() || body.has_setup() || body.has_p2poperation() || body.has_getlog() ||
+            body.has_security() || body.has_pinop()) {
+        return false;
+    }
+    // Fields this encoder doesn't know about would be silently dropped
+    if (command.unknown_fields().field_count() != 0 || header.unknown_fields().field_count() != 0 ||
+            body.unknown_fields().field_count() != 0 ||
+            body.keyvalue().unknown_fields().field_count() != 0) {
+        return false;
+    }
+
+    request->has_cluster_version = header.has_clusterversion();
+    request->cluster_version = header.clusterversion();
+    request->has_connection_id = header.has_connectionid();
+    request->connection_id = header.connectionid();
+    request->has_sequence = header.has_sequence();
+    request->sequence = header.sequence();
+    request->has_message_type = true;
+    request->message_type = header.messagetype();
+    request->has_timeout = header.has_timeout();
+    request->timeout = header.timeout();
+    request->has_early_exit = header.has_earlyexit();
+    request->early_exit = header.earlyexit();
+    request->has_priority = header.has_priority();
+    request->priority = header.priority();
+    request->has_time_quanta = header.has_timequanta();
+    request->time_quanta = header.timequanta();
+
+    const auto &key_value = body.keyvalue();
+    request->has_body = command.has_body();
+    request->has_key_value = body.has_keyvalue();
+    request->new_version = key_value.has_newversion() ? &key_value.newversion() : NULL;
+    request->key = key_value.has_key() ? &key_value.key() : NULL;
+    request->db_version = key_value.has_dbversion() ? &key_value.dbversion() : NULL;
+    request->tag = key_value.has_tag() ? &key_value.tag() : NULL;
+    request->has_algorithm = key_value.has_algorithm();
+    request->algorithm = key_value.algorithm();
+    request->has_metadata_only = key_value.has_metadataonly();
+    request->metadata_only = key_value.metadataonly();
+    request->has_force = key_value.has_force();
+    request->force = key_value.force();
+    request->has_synchronization = key_value.has_synchronization();
+    request->synchronization = key_value.synchronization();
+    return true;
+}
+
+} // namespace kinetic
@@ -0,0 +1,90 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifndef KINETIC_CPP_CLIENT_KEY_VALUE_CODEC_H_
+#define KINETIC_CPP_CLIENT_KEY_VALUE_CODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "kinetic_client.pb.h"
+
+namespace kinetic {
+
+using com::seagate::kinetic::client::proto::Command;
+using com::seagate::kinetic::client::proto::Command_Algorithm;
+using com::seagate::kinetic::client::proto::Command_MessageType;
+using com::seagate::kinetic::client::proto::Command_Priority;
+using com::seagate::kinetic::client::proto::Command_Synchronization;
+
+using std::string;
+
+// Hand-rolled encoding for the key-value commands on the hot path (GET, GETNEXT, GETPREVIOUS,
+// PUT and DELETE). The encoder produces exactly the bytes Command::SerializeToString would for
+// the same fields, without building or walking a Command.
+
+// The fields of a key-value command. Header and key-value fields are only encoded if their has_
+// flag is set or, for byte fields, if the pointer is non-NULL. The strings aren't copied and must
+// outlive the call to EncodeKeyValueRequest.
+struct KeyValueRequest {
+    KeyValueRequest();
+
+    bool has_cluster_version;
+    int64_t cluster_version;
+    bool has_connection_id;
+    int64_t connection_id;
+    bool has_sequence;
+    int64_t sequence;
+    bool has_message_type;
+    Command_MessageType message_type;
+    bool has_timeout;
+    int64_t timeout;
+    bool has_early_exit;
+    bool early_exit;
+    bool has_priority;
+    Command_Priority priority;
+    bool has_time_quanta;
+    int64_t time_quanta;
+
+    // Whether to encode a body at all, and a key-value within it
+    bool has_body;
+    bool has_key_value;
+    const string *new_version;
+    const string *key;
+    const string *db_version;
+    const string *tag;
+    bool has_algorithm;
+    Command_Algorithm algorithm;
+    bool has_metadata_only;
+    bool metadata_only;
+    bool has_force;
+    bool force;
+    bool has_synchronization;
+    Command_Synchronization synchronization;
+};
+
+// Appends the encoded command to out
+void EncodeKeyValueRequest(const KeyValueRequest &request, string *out);
+
+// Fills in request from command if command only uses fields EncodeKeyValueRequest knows about.
+// The request points into command, which must outlive it.
+bool KeyValueRequestFromCommand(const Command &command, KeyValueRequest *request);
+
+} // namespace kinetic
+
+#endif  // KINETIC_CPP_CLIENT_KEY_VALUE_CODEC_H_
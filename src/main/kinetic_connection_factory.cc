@@ -16,14 +16,23 @@
  */
 
 #include "kinetic/kinetic_connection_factory.h"
-#include "socket_wrapper.h"
-#include "nonblocking_packet_service.h"
+#include "connection_attempt.h"
+#include <poll.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
 #include <exception>
 #include <stdexcept>
+#include "glog/logging.h"
 
 
 namespace kinetic {
 
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+using std::move;
+using std::vector;
+
 KineticConnectionFactory NewKineticConnectionFactory() {
     HmacProvider hmac_provider;
     return KineticConnectionFactory(hmac_provider);
@@ -50,6 +59,123 @@ Status KineticConnectionFactory::NewNonblockingConnection(
     return status;
 }
 
+Status KineticConnectionFactory::NewNonblockingConnections(
+        const vector<ConnectionOptions>& options,
+        vector<ConnectionResult>& results,
+        size_t max_concurrent,
+        unsigned int timeout_ms) {
+    results.clear();
+    results.resize(options.size());
+    if (max_concurrent == 0) {
+        max_concurrent = 1;
+    }
+    auto deadline = steady_clock::now() + milliseconds(timeout_ms);
+
+    // The attempts under way, which drive each one is for and what its socket is waiting on. A
+    // negative fd marks an attempt that hasn't been run yet.
+    vector<unique_ptr<ConnectionAttemptInterface>> attempts;
+    vector<size_t> drives;
+    vector<struct pollfd> pfds;
+    size_t next = 0;
+    size_t failed = 0;
+
+    while (next < options.size() || !attempts.empty()) {
+        while (attempts.size() < max_concurrent && next < options.size()) {
+            unique_ptr<ConnectionAttemptInterface> attempt;
+            Status status = StartNonblockingConnection(options[next], attempt);
+            if (status.ok()) {
+                struct pollfd pfd;
+                pfd.fd = -1;
+                pfd.events = 0;
+                pfd.revents = 0;
+                attempts.push_back(move(attempt));
+                drives.push_back(next);
+                pfds.push_back(pfd);
+            } else {
+                results[next].status = status;
+                failed++;
+            }
+            next++;
+        }
+
+        int wait_ms = -1;
+        size_t i = 0;
+        while (i < attempts.size()) {
+            ConnectionAttemptInterface *attempt = attempts[i].get();
+            if (pfds[i].fd >= 0 && pfds[i].revents == 0 && attempt->remaining_ms() > 0) {
+                // Still waiting
+                if (wait_ms < 0 || attempt->remaining_ms() < wait_ms) {
+                    wait_ms = attempt->remaining_ms();
+                }
+                i++;
+                continue;
+            }
+
+            SocketInterest interest;
+            ConnectionAttemptStatus attempt_status = attempt->Run(&interest);
+            if (attempt_status == kConnectionAttemptInProgress) {
+                pfds[i].fd = interest.fd;
+                pfds[i].events = (interest.read ? POLLIN : 0) | (interest.write ? POLLOUT : 0);
+                pfds[i].revents = 0;
+                if (wait_ms < 0 || attempt->remaining_ms() < wait_ms) {
+                    wait_ms = attempt->remaining_ms();
+                }
+                i++;
+                continue;
+            }
+
+            ConnectionResult &result = results[drives[i]];
+            if (attempt_status == kConnectionAttemptDone) {
+                result.status = Status::makeOk();
+                result.connection = attempt->TakeConnection();
+            } else {
+                result.status = attempt->error();
+                failed++;
+            }
+            // Order doesn't matter, so fill the gap with the last attempt
+            attempts[i] = move(attempts.back());
+            attempts.pop_back();
+            drives[i] = drives.back();
+            drives.pop_back();
+            pfds[i] = pfds.back();
+            pfds.pop_back();
+        }
+        if (attempts.empty()) {
+            continue;
+        }
+
+        auto remaining = std::chrono::duration_cast<milliseconds>(deadline - steady_clock::now());
+        if (remaining.count() <= 0) {
+            break;
+        }
+        if (wait_ms < 0 || remaining.count() < wait_ms) {
+            wait_ms = static_cast<int>(remaining.count());
+        }
+        if (poll(pfds.data(), pfds.size(), wait_ms) < 0 && errno != EINTR) {
+            PLOG(ERROR) << "Failed waiting for connections";
+            break;
+        }
+    }
+
+    // Whatever is left ran out of time
+    for (auto drive : drives) {
+        results[drive].status = Status::makeInternalError("Connection error: Timed out after " +
+            std::to_string(timeout_ms) + " ms.");
+        failed++;
+    }
+    for (; next < options.size(); next++) {
+        results[next].status = Status::makeInternalError("Connection error: Timed out after " +
+            std::to_string(timeout_ms) + " ms.");
+        failed++;
+    }
+
+    if (failed > 0) {
+        return Status::makeInternalError(std::to_string(failed) + " of " +
+            std::to_string(options.size()) + " connections could not be opened");
+    }
+    return Status::makeOk();
+}
+
 Status KineticConnectionFactory::NewThreadsafeNonblockingConnection(
         const ConnectionOptions& options,
         unique_ptr<ThreadsafeNonblockingKineticConnection>& connection) {
@@ -114,31 +240,44 @@ Status KineticConnectionFactory::NewThreadsafeBlockingConnection(
     return status;
 }
 
-Status KineticConnectionFactory::doNewConnection(
-        ConnectionOptions const& options,
-        unique_ptr <NonblockingKineticConnection>& connection) {
+Status KineticConnectionFactory::StartNonblockingConnection(
+        const ConnectionOptions& options,
+        unique_ptr<ConnectionAttemptInterface>& attempt) {
     try{
-        auto socket_wrapper = make_shared<SocketWrapper>(options.host, options.port, options.use_ssl, true);
-        if (!socket_wrapper->Connect())
-            throw std::runtime_error("Could not connect to socket.");
-
-        shared_ptr<NonblockingReceiverInterface> receiver;
-        receiver = shared_ptr<NonblockingReceiverInterface>(new NonblockingReceiver(socket_wrapper, hmac_provider_, options));
-
-        auto writer_factory =
-            shared_ptr<NonblockingPacketWriterFactoryInterface>(new NonblockingPacketWriterFactory());
-        auto sender = unique_ptr<NonblockingSenderInterface>(new NonblockingSender(socket_wrapper,
-                                                                                   receiver,
-                                                                                   writer_factory,
-                                                                                   hmac_provider_,
-                                                                                   options));
-
-        NonblockingPacketService *service = new NonblockingPacketService(socket_wrapper, move(sender), receiver);
-        connection.reset(new NonblockingKineticConnection(service));
-
+        attempt.reset(new NonblockingConnectionAttempt(options, hmac_provider_));
     } catch(std::exception& e){
            return Status::makeInternalError("Connection error: "+std::string(e.what()));
     }
     return Status::makeOk();
 }
+
+Status KineticConnectionFactory::doNewConnection(
+        ConnectionOptions const& options,
+        unique_ptr <NonblockingKineticConnection>& connection) {
+    unique_ptr<ConnectionAttemptInterface> attempt;
+    Status status = StartNonblockingConnection(options, attempt);
+    if (status.notOk()) {
+        return status;
+    }
+
+    // Sleep in poll between steps; the attempt fails by itself once its deadline has passed
+    while (true) {
+        SocketInterest interest;
+        ConnectionAttemptStatus attempt_status = attempt->Run(&interest);
+        if (attempt_status == kConnectionAttemptDone) {
+            connection = attempt->TakeConnection();
+            return Status::makeOk();
+        }
+        if (attempt_status == kConnectionAttemptFailed) {
+            return attempt->error();
+        }
+        struct pollfd pfd;
+        pfd.fd = interest.fd;
+        pfd.events = (interest.read ? POLLIN : 0) | (interest.write ? POLLOUT : 0);
+        pfd.revents = 0;
+        if (poll(&pfd, 1, attempt->remaining_ms()) < 0 && errno != EINTR) {
+            return Status::makeInternalError("Connection error: " + std::string(strerror(errno)));
+        }
+    }
+}
 } // namespace kinetic
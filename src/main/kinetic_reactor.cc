@@ -0,0 +1,449 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include "kinetic/kinetic_reactor.h"
+
+#ifdef __linux__
+
+#include <poll.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "glog/logging.h"
+#include "io_uring_socket_io.h"
+
+namespace kinetic {
+
+#ifndef KINETIC_HAVE_IO_URING
+// Never instantiated; only here so the members in the header can be destroyed
+class IoUringRing {};
+struct IoUringOperation {};
+#endif
+
+using std::move;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+// Upper bound on events collected per epoll_wait; more ready sockets are picked up next pass
+static const int kMaxEvents = 256;
+// Size of the io_uring submission queue. A pass queues at most a send and a receive per
+// connection; if there are more, the queue is flushed early.
+static const unsigned kRingEntries = 4096;
+// Cookie of the ring operation that polls the epoll instance
+static const uint64_t kEpollCookie = UINT64_MAX;
+
+KineticReactor::KineticReactor(ReactorBackend backend) : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)),
+        next_id_(0), busy_(0) {
+    if (epoll_fd_ < 0) {
+        PLOG(ERROR) << "Failed to create epoll instance";
+        return;
+    }
+    if (backend == kIoUringBackend) {
+#ifdef KINETIC_HAVE_IO_URING
+        ring_.reset(new IoUringRing());
+        if (ring_->Init(kRingEntries)) {
+            epoll_poll_.reset(new IoUringOperation());
+            epoll_poll_->cookie = kEpollCookie;
+        } else {
+            LOG(WARNING) << "io_uring unavailable, falling back to epoll";
+            ring_.reset();
+        }
+#else
+        LOG(WARNING) << "Built without io_uring support, falling back to epoll";
+#endif
+    }
+}
+
+KineticReactor::~KineticReactor() {
+    // Destroying the connections fails their outstanding requests, whose callbacks could call
+    // back into the reactor, so take them out of the map first
+    std::unordered_map<ConnectionId, unique_ptr<Connection>> connections;
+    connections.swap(connections_);
+    connections.clear();
+    attempts_.clear();
+    retired_.clear();
+    // Closing the ring cancels the epoll poll
+    ring_.reset();
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+    }
+}
+
+ReactorBackend KineticReactor::backend() const {
+    return ring_ ? kIoUringBackend : kEpollBackend;
+}
+
+bool KineticReactor::AddConnection(unique_ptr<NonblockingKineticConnectionInterface> connection,
+        ConnectionId *id) {
+    if (epoll_fd_ < 0) {
+        return false;
+    }
+
+    ConnectionId new_id = next_id_++;
+    if (!Adopt(new_id, move(connection))) {
+        return false;
+    }
+    *id = new_id;
+    return true;
+}
+
+bool KineticReactor::AddConnectionAttempt(unique_ptr<ConnectionAttemptInterface> attempt,
+        const AttemptCallback &done, ConnectionId *id) {
+    if (epoll_fd_ < 0) {
+        return false;
+    }
+
+    ConnectionId new_id = next_id_++;
+    unique_ptr<Attempt> entry(new Attempt());
+    entry->deadline = steady_clock::now() + milliseconds(attempt->remaining_ms());
+    entry->attempt = move(attempt);
+    entry->done = done;
+    entry->fd = -1;
+    entry->scheduled = false;
+    Attempt *added = entry.get();
+    attempts_[new_id] = move(entry);
+    // Resolving the host and starting to connect happen on the next pass
+    Schedule(new_id, &added->scheduled);
+    *id = new_id;
+    return true;
+}
+
+// Starts driving the connection under the given id
+bool KineticReactor::Adopt(ConnectionId id,
+        unique_ptr<NonblockingKineticConnectionInterface> connection) {
+    // Running once reports the socket and sends anything queued before the connection was added
+    SocketInterest interest;
+    if (!connection->Run(&interest)) {
+        return false;
+    }
+
+    bool in_epoll = true;
+#ifdef KINETIC_HAVE_IO_URING
+    if (ring_) {
+        auto io = std::make_shared<IoUringSocketIo>(ring_.get(), interest.fd, id);
+        in_epoll = !connection->SetSocketIo(io);
+    }
+#endif
+    if (in_epoll) {
+        struct epoll_event event;
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.u64 = id;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, interest.fd, &event) != 0) {
+            PLOG(ERROR) << "Failed to register fd " << interest.fd << " with epoll";
+            return false;
+        }
+    }
+
+    unique_ptr<Connection> entry(new Connection());
+    entry->connection = move(connection);
+    entry->fd = interest.fd;
+    entry->scheduled = false;
+    entry->in_epoll = in_epoll;
+    entry->deadline = steady_clock::time_point::max();
+    Connection *added = entry.get();
+    connections_[id] = move(entry);
+    // A connection handed to the ring has nothing in flight yet, so nothing would prompt it to
+    // continue a partly written request or start reading
+    Schedule(id, &added->scheduled);
+    return true;
+}
+
+bool KineticReactor::RemoveConnection(ConnectionId id) {
+    // An attempt never calls out of the reactor while running, so it can go straight away. Its
+    // socket leaves the epoll set when closed.
+    if (attempts_.erase(id) != 0) {
+        return true;
+    }
+    if (connections_.find(id) == connections_.end()) {
+        return false;
+    }
+    DropConnection(id);
+    return true;
+}
+
+bool KineticReactor::Submit(ConnectionId id,
+        const std::function<void(NonblockingKineticConnectionInterface &)> &operation) {
+    auto it = connections_.find(id);
+    if (it == connections_.end()) {
+        return false;
+    }
+    busy_++;
+    operation(*it->second->connection);
+    // The operation may have removed the connection
+    it = connections_.find(id);
+    if (it != connections_.end()) {
+        Schedule(id, &it->second->scheduled);
+    }
+    Release();
+    return true;
+}
+
+bool KineticReactor::RunOnce(int timeout_ms) {
+    if (epoll_fd_ < 0) {
+        return false;
+    }
+    timeout_ms = ScheduleExpiredAttempts(timeout_ms);
+    timeout_ms = ScheduleDueDeadlines(timeout_ms);
+    if (!scheduled_.empty()) {
+        timeout_ms = 0;
+    }
+    if (!(ring_ ? WaitIoUring(timeout_ms) : WaitEpoll(timeout_ms))) {
+        return false;
+    }
+
+    // Anything submitted by callbacks during this pass waits for the next one
+    std::vector<ConnectionId> ready;
+    ready.swap(scheduled_);
+    busy_++;
+    for (auto id : ready) {
+        Run(id);
+    }
+    Release();
+    return true;
+}
+
+// Schedules the attempts whose deadline has passed, so that they fail, and shortens timeout_ms to
+// the earliest deadline still to come. Attempts only exist while connections are being opened,
+// so looking at each of them once per pass is cheap next to running them.
+int KineticReactor::ScheduleExpiredAttempts(int timeout_ms) {
+    if (attempts_.empty()) {
+        return timeout_ms;
+    }
+    auto now = steady_clock::now();
+    for (auto &entry : attempts_) {
+        Attempt *attempt = entry.second.get();
+        if (attempt->scheduled) {
+            continue;
+        }
+        auto remaining_us = duration_cast<microseconds>(attempt->deadline - now).count();
+        if (remaining_us <= 0) {
+            Schedule(entry.first, &attempt->scheduled);
+            continue;
+        }
+        int remaining_ms = static_cast<int>((remaining_us + 999) / 1000);
+        if (timeout_ms < 0 || remaining_ms < timeout_ms) {
+            timeout_ms = remaining_ms;
+        }
+    }
+    return timeout_ms;
+}
+
+// Schedules the connections with request deadlines due, so that running them fails the expired
+// requests, and shortens timeout_ms to the next deadline still to come
+int KineticReactor::ScheduleDueDeadlines(int timeout_ms) {
+    auto now = steady_clock::now();
+    while (!deadlines_.empty()) {
+        Deadline deadline = deadlines_.top();
+        auto it = connections_.find(deadline.second);
+        if (it == connections_.end() || it->second->deadline != deadline.first) {
+            deadlines_.pop();
+            continue;
+        }
+        auto remaining_us = duration_cast<microseconds>(deadline.first - now).count();
+        if (remaining_us > 0) {
+            int remaining_ms = static_cast<int>((remaining_us + 999) / 1000);
+            if (timeout_ms < 0 || remaining_ms < timeout_ms) {
+                timeout_ms = remaining_ms;
+            }
+            break;
+        }
+        deadlines_.pop();
+        it->second->deadline = steady_clock::time_point::max();
+        Schedule(it->first, &it->second->scheduled);
+    }
+    return timeout_ms;
+}
+
+bool KineticReactor::WaitEpoll(int timeout_ms) {
+    struct epoll_event events[kMaxEvents];
+    int n = epoll_wait(epoll_fd_, events, kMaxEvents, timeout_ms);
+    if (n < 0) {
+        if (errno == EINTR) {
+            return true;
+        }
+        PLOG(ERROR) << "epoll_wait failed";
+        return false;
+    }
+    for (int i = 0; i < n; i++) {
+        ConnectionId id = events[i].data.u64;
+        auto it = connections_.find(id);
+        if (it != connections_.end()) {
+            Schedule(id, &it->second->scheduled);
+            continue;
+        }
+        auto attempt = attempts_.find(id);
+        if (attempt != attempts_.end()) {
+            Schedule(id, &attempt->second->scheduled);
+        }
+    }
+    return true;
+}
+
+// Hands the kernel all reads and writes queued since the last pass and schedules the connections
+// whose operations have completed
+bool KineticReactor::WaitIoUring(int timeout_ms) {
+#ifdef KINETIC_HAVE_IO_URING
+    if (!epoll_poll_->in_flight) {
+        struct io_uring_sqe *sqe = ring_->NextSqe();
+        if (sqe == NULL) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = epoll_fd_;
+        sqe->poll32_events = POLLIN;
+        sqe->user_data = reinterpret_cast<uint64_t>(epoll_poll_.get());
+        epoll_poll_->in_flight = true;
+    }
+    if (!ring_->Submit(timeout_ms == 0 ? 0 : 1, timeout_ms)) {
+        return false;
+    }
+    ring_->Dispatch();
+
+    std::vector<uint64_t> completed;
+    completed.swap(ring_->ready());
+    for (auto cookie : completed) {
+        if (cookie == kEpollCookie) {
+            epoll_poll_->completed = false;
+            if (!WaitEpoll(0)) {
+                return false;
+            }
+            continue;
+        }
+        auto it = connections_.find(cookie);
+        if (it != connections_.end()) {
+            Schedule(it->first, &it->second->scheduled);
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void KineticReactor::Schedule(ConnectionId id, bool *scheduled) {
+    if (!*scheduled) {
+        *scheduled = true;
+        scheduled_.push_back(id);
+    }
+}
+
+void KineticReactor::Run(ConnectionId id) {
+    if (attempts_.find(id) != attempts_.end()) {
+        RunAttempt(id);
+    } else {
+        RunConnection(id);
+    }
+}
+
+void KineticReactor::RunConnection(ConnectionId id) {
+    auto it = connections_.find(id);
+    if (it == connections_.end()) {
+        // Removed earlier in this pass
+        return;
+    }
+    Connection *connection = it->second.get();
+    connection->scheduled = false;
+
+    // The interest reported here isn't needed. With epoll the socket is registered for both
+    // directions once, and the service only stops short of completion on EAGAIN, which
+    // guarantees another edge. With io_uring, stopping short means an operation was queued.
+    SocketInterest interest;
+    if (!connection->connection->Run(&interest)) {
+        LOG(WARNING) << "Dropping failed connection on fd " << connection->fd;
+        DropConnection(id);
+        return;
+    }
+
+    // Requests issued through Submit or from callbacks may have brought the next deadline
+    // forward. A later one is picked up when the current entry comes due.
+    int remaining_ms = connection->connection->TimeUntilDeadline();
+    if (remaining_ms >= 0) {
+        auto deadline = steady_clock::now() + milliseconds(remaining_ms);
+        if (deadline < connection->deadline) {
+            connection->deadline = deadline;
+            deadlines_.push(Deadline(deadline, id));
+        }
+    }
+}
+
+void KineticReactor::RunAttempt(ConnectionId id) {
+    Attempt *attempt = attempts_[id].get();
+    attempt->scheduled = false;
+
+    SocketInterest interest;
+    ConnectionAttemptStatus status = attempt->attempt->Run(&interest);
+    if (status == kConnectionAttemptInProgress) {
+        // Watch the attempt's current socket for just what it's waiting on. Modifying the
+        // registration reports readiness that already exists, so no edge is lost between steps.
+        // A socket the attempt closed to try another address has left the epoll set by itself.
+        struct epoll_event event;
+        event.events = (interest.read ? EPOLLIN : 0u) | (interest.write ? EPOLLOUT : 0u) |
+            EPOLLRDHUP | EPOLLET;
+        event.data.u64 = id;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, interest.fd, &event) == 0 ||
+                (errno == ENOENT && epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, interest.fd, &event) == 0)) {
+            attempt->fd = interest.fd;
+            return;
+        }
+        PLOG(ERROR) << "Failed to register fd " << interest.fd << " with epoll";
+    }
+
+    unique_ptr<Attempt> finished = move(attempts_[id]);
+    attempts_.erase(id);
+    if (status == kConnectionAttemptFailed) {
+        finished->done(id, finished->attempt->error());
+        return;
+    }
+    if (status == kConnectionAttemptInProgress) {
+        finished->done(id, Status::makeInternalError("Connection error: Could not watch socket."));
+        return;
+    }
+
+    // The connection registers its socket afresh
+    if (finished->fd >= 0 && epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, finished->fd, NULL) != 0) {
+        PLOG(WARNING) << "Failed to unregister fd " << finished->fd << " from epoll";
+    }
+    if (Adopt(id, finished->attempt->TakeConnection())) {
+        finished->done(id, Status::makeOk());
+    } else {
+        finished->done(id, Status::makeInternalError("Connection error: Could not drive connection."));
+    }
+}
+
+void KineticReactor::DropConnection(ConnectionId id) {
+    auto it = connections_.find(id);
+    unique_ptr<Connection> connection = move(it->second);
+    connections_.erase(it);
+    if (connection->in_epoll && epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, connection->fd, NULL) != 0) {
+        PLOG(WARNING) << "Failed to unregister fd " << connection->fd << " from epoll";
+    }
+    if (busy_ > 0) {
+        retired_.push_back(move(connection));
+    }
+}
+
+void KineticReactor::Release() {
+    if (--busy_ == 0) {
+        retired_.clear();
+    }
+}
+
+} // namespace kinetic
+
+#endif  // __linux__
@@ -17,7 +17,12 @@
 
 #include "kinetic/nonblocking_kinetic_connection.h"
 #include "nonblocking_packet_service.h"
+#include <unistd.h>
+#include <errno.h>
+#include <chrono>
+#include <cstring>
 #include <memory>
+#include <mutex>
 #include <glog/logging.h>
 
 namespace kinetic {
@@ -46,6 +51,117 @@ void GetHandler::Error(KineticStatus error,
     callback_->Failure(error);
 }
 
+GetIntoHandler::GetIntoHandler(const shared_ptr<ValueBuffer> buffer,
+                               const shared_ptr<GetIntoCallbackInterface> callback)
+    : pool_(), buffer_(buffer), callback_(callback), received_directly_(false), value_size_(0) {}
+
+GetIntoHandler::GetIntoHandler(const shared_ptr<ValueBufferPool> pool,
+                               const shared_ptr<GetIntoCallbackInterface> callback)
+    : pool_(pool), buffer_(), callback_(callback), received_directly_(false), value_size_(0) {}
+
+char *GetIntoHandler::ValueDestination(const Command &response,
+                                       size_t value_size) {
+    if (response.status().code() != Command_Status_StatusCode_SUCCESS) {
+        return NULL;
+    }
+    if (pool_) {
+        buffer_ = pool_->Lease(value_size);
+    } else if (value_size > buffer_->capacity()) {
+        // Let the value arrive as a string so Handle() can report the failure
+        return NULL;
+    }
+    received_directly_ = true;
+    value_size_ = value_size;
+    return buffer_->data();
+}
+
+void GetIntoHandler::Handle(const Command &response,
+                            unique_ptr<const string> value) {
+    if (!received_directly_) {
+        // The value wasn't handed to us ahead of time, so fall back to copying it
+        if (pool_) {
+            buffer_ = pool_->Lease(value->size());
+        } else if (value->size() > buffer_->capacity()) {
+            callback_->Failure(KineticStatus(StatusCode::CLIENT_INTERNAL_ERROR,
+                "Value is larger than the supplied buffer"));
+            return;
+        }
+        memcpy(buffer_->data(), value->data(), value->size());
+        value_size_ = value->size();
+    }
+    buffer_->set_size(value_size_);
+    callback_->Success(response.body().keyvalue().key(), buffer_,
+        response.body().keyvalue().dbversion(), response.body().keyvalue().tag(),
+        response.body().keyvalue().algorithm());
+}
+
+void GetIntoHandler::Error(KineticStatus error,
+                           Command const *const response) {
+    callback_->Failure(error);
+}
+
+GetToFileHandler::GetToFileHandler(const shared_ptr<GetToFileCallbackInterface> callback)
+    : callback_(callback), received_directly_(false), declined_(false), value_size_(0) {}
+
+int GetToFileHandler::ValueFile(const Command &response,
+                                size_t value_size,
+                                off_t *offset) {
+    if (response.status().code() != Command_Status_StatusCode_SUCCESS) {
+        return -1;
+    }
+    int fd = callback_->Destination(response.body().keyvalue().key(), value_size, offset);
+    if (fd < 0) {
+        declined_ = true;
+        return -1;
+    }
+    received_directly_ = true;
+    value_size_ = value_size;
+    return fd;
+}
+
+void GetToFileHandler::Handle(const Command &response,
+                              unique_ptr<const string> value) {
+    if (declined_) {
+        callback_->Failure(KineticStatus(StatusCode::CLIENT_INTERNAL_ERROR,
+            "No destination for value"));
+        return;
+    }
+    if (!received_directly_) {
+        // Empty values never go through ValueFile, so write whatever arrived ourselves
+        off_t offset = -1;
+        int fd = callback_->Destination(response.body().keyvalue().key(), value->size(), &offset);
+        if (fd < 0) {
+            callback_->Failure(KineticStatus(StatusCode::CLIENT_INTERNAL_ERROR,
+                "No destination for value"));
+            return;
+        }
+        size_t written = 0;
+        while (written < value->size()) {
+            ssize_t status = offset < 0 ?
+                write(fd, value->data() + written, value->size() - written) :
+                pwrite(fd, value->data() + written, value->size() - written, offset + written);
+            if (status < 0 && errno == EINTR) {
+                continue;
+            }
+            if (status <= 0) {
+                callback_->Failure(KineticStatus(StatusCode::CLIENT_IO_ERROR,
+                    "Could not write value to file"));
+                return;
+            }
+            written += status;
+        }
+        value_size_ = value->size();
+    }
+    callback_->Success(response.body().keyvalue().key(), value_size_,
+        response.body().keyvalue().dbversion(), response.body().keyvalue().tag(),
+        response.body().keyvalue().algorithm());
+}
+
+void GetToFileHandler::Error(KineticStatus error,
+                             Command const *const response) {
+    callback_->Failure(error);
+}
+
 GetVersionHandler::GetVersionHandler(const shared_ptr<GetVersionCallbackInterface> callback) : callback_(callback) {}
 
 void GetVersionHandler::Handle(const Command &response,
@@ -230,6 +346,115 @@ void P2PPushHandler::Error(KineticStatus error,
     callback_->Failure(error, response);
 }
 
+// Gathers the outcomes of a batch's operations, which may complete in any order
+class BatchCompletion {
+  public:
+    BatchCompletion(size_t operations,
+                    const shared_ptr<BatchCallbackInterface> callback)
+        : callback_(callback),
+        // An empty batch still waits for the NOOP standing in for it
+        remaining_(operations == 0 ? 1 : operations),
+        statuses_(new vector<KineticStatus>(operations, KineticStatus(StatusCode::OK, ""))) {}
+
+    void Complete(size_t operation,
+                  KineticStatus status) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (operation < statuses_->size()) {
+                (*statuses_)[operation] = status;
+            }
+            if (!status.ok() && !first_error_) {
+                first_error_.reset(new KineticStatus(status));
+            }
+            if (--remaining_ > 0) {
+                return;
+            }
+        }
+
+        if (first_error_) {
+            callback_->Failure(*first_error_, move(statuses_));
+        } else {
+            callback_->Success();
+        }
+    }
+
+  private:
+    const shared_ptr<BatchCallbackInterface> callback_;
+    std::mutex mutex_;
+    size_t remaining_;
+    unique_ptr<vector<KineticStatus>> statuses_;
+    unique_ptr<KineticStatus> first_error_;
+    DISALLOW_COPY_AND_ASSIGN(BatchCompletion);
+};
+
+BatchHandler::BatchHandler(const shared_ptr<BatchCompletion> completion,
+                           size_t operation) : completion_(completion), operation_(operation), completed_(false) {}
+
+BatchHandler::~BatchHandler() {
+    // Otherwise the batch would wait forever for an operation that was removed
+    if (!completed_) {
+        completion_->Complete(operation_,
+            KineticStatus(StatusCode::CLIENT_SHUTDOWN, "Operation removed before completing"));
+    }
+}
+
+void BatchHandler::Handle(const Command &response,
+                          unique_ptr<const string> value) {
+    completed_ = true;
+    completion_->Complete(operation_, KineticStatus(StatusCode::OK, ""));
+}
+
+void BatchHandler::Error(KineticStatus error,
+                         Command const *const response) {
+    completed_ = true;
+    completion_->Complete(operation_, error);
+}
+
+Batch::Batch(PersistMode persist_mode) : persist_mode_(persist_mode), operations_() {}
+
+void Batch::Put(const shared_ptr<const string> key,
+                const shared_ptr<const string> current_version,
+                WriteMode mode,
+                const shared_ptr<const KineticRecord> record) {
+    BatchOperation operation;
+    operation.key = key;
+    operation.version = current_version;
+    operation.mode = mode;
+    operation.record = record;
+    operations_.push_back(operation);
+}
+
+void Batch::Put(const string key,
+                const string current_version,
+                WriteMode mode,
+                const shared_ptr<const KineticRecord> record) {
+    Put(make_shared<string>(key), make_shared<string>(current_version), mode, record);
+}
+
+void Batch::Delete(const shared_ptr<const string> key,
+                   const shared_ptr<const string> version,
+                   WriteMode mode) {
+    BatchOperation operation;
+    operation.key = key;
+    operation.version = version;
+    operation.mode = mode;
+    operations_.push_back(operation);
+}
+
+void Batch::Delete(const string key,
+                   const string version,
+                   WriteMode mode) {
+    Delete(make_shared<string>(key), make_shared<string>(version), mode);
+}
+
+const vector<BatchOperation> &Batch::operations() const {
+    return operations_;
+}
+
+PersistMode Batch::persist_mode() const {
+    return persist_mode_;
+}
+
 NonblockingKineticConnection::NonblockingKineticConnection(NonblockingPacketServiceInterface *service) : service_(
     service), empty_str_(make_shared<string>("")), cluster_version_(0) {}
 
@@ -243,72 +468,163 @@ bool NonblockingKineticConnection::Run(fd_set *read_fds,
     return service_->Run(read_fds, write_fds, nfds);
 }
 
+bool NonblockingKineticConnection::Run(SocketInterest *interest) {
+    return service_->Run(interest);
+}
+
+bool NonblockingKineticConnection::SetSocketIo(shared_ptr<SocketIoInterface> io) {
+    return service_->SetSocketIo(io);
+}
+
 void NonblockingKineticConnection::SetClientClusterVersion(int64_t cluster_version) {
     cluster_version_ = cluster_version;
 }
 
-unique_ptr<Command> NonblockingKineticConnection::NewCommand(Command_MessageType message_type) {
+static Command_Priority ConvertPriority(RequestPriority priority) {
+    switch (priority) {
+        case RequestPriority::LOWEST:
+            return Command_Priority_LOWEST;
+        case RequestPriority::LOWER:
+            return Command_Priority_LOWER;
+        case RequestPriority::HIGHER:
+            return Command_Priority_HIGHER;
+        case RequestPriority::HIGHEST:
+            return Command_Priority_HIGHEST;
+        default:
+            return Command_Priority_NORMAL;
+    }
+}
+
+unique_ptr<Command> NonblockingKineticConnection::NewCommand(Command_MessageType message_type,
+                                                             const RequestOptions &options) {
     unique_ptr<Command> cmd(new Command());
     cmd->mutable_header()->set_messagetype(message_type);
     cmd->mutable_header()->set_clusterversion(cluster_version_);
+    if (options.timeout_ms > 0) {
+        cmd->mutable_header()->set_timeout(options.timeout_ms);
+    }
+    if (options.early_exit) {
+        cmd->mutable_header()->set_earlyexit(true);
+    }
+    if (options.priority != RequestPriority::DEFAULT) {
+        cmd->mutable_header()->set_priority(ConvertPriority(options.priority));
+    }
+    if (options.time_quanta_ms >= 0) {
+        cmd->mutable_header()->set_timequanta(options.time_quanta_ms);
+    }
     return cmd;
 }
 
-HandlerKey NonblockingKineticConnection::NoOp(const shared_ptr<SimpleCallbackInterface> callback) {
+HandlerKey NonblockingKineticConnection::NoOp(const shared_ptr<SimpleCallbackInterface> callback,
+                                              const RequestOptions &options) {
     unique_ptr<SimpleHandler> handler(new SimpleHandler(callback));
 
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_HMACAUTH);
 
-    unique_ptr<Command> request = NewCommand(Command_MessageType_NOOP);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_NOOP, options);
     return service_->Submit(move(msg), move(request), empty_str_, move(handler));
 }
 
 HandlerKey NonblockingKineticConnection::Get(const shared_ptr<const string> key,
-                                             const shared_ptr<GetCallbackInterface> callback) {
-    return GenericGet(key, callback, Command_MessageType_GET);
+                                             const shared_ptr<GetCallbackInterface> callback,
+                                             const RequestOptions &options) {
+    unique_ptr<GetHandler> handler(new GetHandler(callback));
+    return GenericGet(key, move(handler), Command_MessageType_GET, options);
 }
 
 HandlerKey NonblockingKineticConnection::Get(const string key,
-                                             const shared_ptr<GetCallbackInterface> callback) {
-    return this->Get(make_shared<string>(key), callback);
+                                             const shared_ptr<GetCallbackInterface> callback,
+                                             const RequestOptions &options) {
+    return this->Get(make_shared<string>(key), callback, options);
+}
+
+HandlerKey NonblockingKineticConnection::GetInto(const shared_ptr<const string> key,
+                                                 const shared_ptr<ValueBuffer> buffer,
+                                                 const shared_ptr<GetIntoCallbackInterface> callback,
+                                                 const RequestOptions &options) {
+    unique_ptr<GetIntoHandler> handler(new GetIntoHandler(buffer, callback));
+    return GenericGet(key, move(handler), Command_MessageType_GET, options);
+}
+
+HandlerKey NonblockingKineticConnection::GetInto(const string key,
+                                                 const shared_ptr<ValueBuffer> buffer,
+                                                 const shared_ptr<GetIntoCallbackInterface> callback,
+                                                 const RequestOptions &options) {
+    return this->GetInto(make_shared<string>(key), buffer, callback, options);
+}
+
+HandlerKey NonblockingKineticConnection::GetInto(const shared_ptr<const string> key,
+                                                 const shared_ptr<ValueBufferPool> pool,
+                                                 const shared_ptr<GetIntoCallbackInterface> callback,
+                                                 const RequestOptions &options) {
+    unique_ptr<GetIntoHandler> handler(new GetIntoHandler(pool, callback));
+    return GenericGet(key, move(handler), Command_MessageType_GET, options);
+}
+
+HandlerKey NonblockingKineticConnection::GetInto(const string key,
+                                                 const shared_ptr<ValueBufferPool> pool,
+                                                 const shared_ptr<GetIntoCallbackInterface> callback,
+                                                 const RequestOptions &options) {
+    return this->GetInto(make_shared<string>(key), pool, callback, options);
+}
+
+HandlerKey NonblockingKineticConnection::GetToFile(const shared_ptr<const string> key,
+                                                   const shared_ptr<GetToFileCallbackInterface> callback,
+                                                   const RequestOptions &options) {
+    unique_ptr<GetToFileHandler> handler(new GetToFileHandler(callback));
+    return GenericGet(key, move(handler), Command_MessageType_GET, options);
+}
+
+HandlerKey NonblockingKineticConnection::GetToFile(const string key,
+                                                   const shared_ptr<GetToFileCallbackInterface> callback,
+                                                   const RequestOptions &options) {
+    return this->GetToFile(make_shared<string>(key), callback, options);
 }
 
 HandlerKey NonblockingKineticConnection::GetNext(const shared_ptr<const string> key,
-                                                 const shared_ptr<GetCallbackInterface> callback) {
-    return GenericGet(key, callback, Command_MessageType_GETNEXT);
+                                                 const shared_ptr<GetCallbackInterface> callback,
+                                                 const RequestOptions &options) {
+    unique_ptr<GetHandler> handler(new GetHandler(callback));
+    return GenericGet(key, move(handler), Command_MessageType_GETNEXT, options);
 }
 
 HandlerKey NonblockingKineticConnection::GetNext(const string key,
-                                                 const shared_ptr<GetCallbackInterface> callback) {
-    return this->GetNext(make_shared<string>(key), callback);
+                                                 const shared_ptr<GetCallbackInterface> callback,
+                                                 const RequestOptions &options) {
+    return this->GetNext(make_shared<string>(key), callback, options);
 }
 
 HandlerKey NonblockingKineticConnection::GetPrevious(const shared_ptr<const string> key,
-                                                     const shared_ptr<GetCallbackInterface> callback) {
-    return GenericGet(key, callback, Command_MessageType_GETPREVIOUS);
+                                                     const shared_ptr<GetCallbackInterface> callback,
+                                                     const RequestOptions &options) {
+    unique_ptr<GetHandler> handler(new GetHandler(callback));
+    return GenericGet(key, move(handler), Command_MessageType_GETPREVIOUS, options);
 }
 
 HandlerKey NonblockingKineticConnection::GetPrevious(const string key,
-                                                     const shared_ptr<GetCallbackInterface> callback) {
-    return this->GetPrevious(make_shared<string>(key), callback);
+                                                     const shared_ptr<GetCallbackInterface> callback,
+                                                     const RequestOptions &options) {
+    return this->GetPrevious(make_shared<string>(key), callback, options);
 }
 
 HandlerKey NonblockingKineticConnection::GetVersion(const shared_ptr<const string> key,
-                                                    const shared_ptr<GetVersionCallbackInterface> callback) {
+                                                    const shared_ptr<GetVersionCallbackInterface> callback,
+                                                    const RequestOptions &options) {
     unique_ptr<GetVersionHandler> handler(new GetVersionHandler(callback));
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_HMACAUTH);
 
-    unique_ptr<Command> request = NewCommand(Command_MessageType_GETVERSION);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_GETVERSION, options);
     request->mutable_body()->mutable_keyvalue()->set_key(*key);
 
     return service_->Submit(move(msg), move(request), empty_str_, move(handler));
 }
 
 HandlerKey NonblockingKineticConnection::GetVersion(const string key,
-                                                    const shared_ptr<GetVersionCallbackInterface> callback) {
-    return this->GetVersion(make_shared<string>(key), callback);
+                                                    const shared_ptr<GetVersionCallbackInterface> callback,
+                                                    const RequestOptions &options) {
+    return this->GetVersion(make_shared<string>(key), callback, options);
 }
 
 HandlerKey NonblockingKineticConnection::GetKeyRange(const shared_ptr<const string> start_key,
@@ -317,13 +633,14 @@ HandlerKey NonblockingKineticConnection::GetKeyRange(const shared_ptr<const stri
                                                      bool end_key_inclusive,
                                                      bool reverse_results,
                                                      int32_t max_results,
-                                                     const shared_ptr<GetKeyRangeCallbackInterface> callback) {
+                                                     const shared_ptr<GetKeyRangeCallbackInterface> callback,
+                                                     const RequestOptions &options) {
     unique_ptr<GetKeyRangeHandler> handler(new GetKeyRangeHandler(callback));
 
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_HMACAUTH);
 
-    unique_ptr<Command> request = NewCommand(Command_MessageType_GETKEYRANGE);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_GETKEYRANGE, options);
     request->mutable_body()->mutable_range()->set_startkey(*start_key);
     request->mutable_body()->mutable_range()->set_startkeyinclusive(start_key_inclusive);
     request->mutable_body()->mutable_range()->set_endkey(*end_key);
@@ -340,28 +657,25 @@ HandlerKey NonblockingKineticConnection::GetKeyRange(const string start_key,
                                                      bool end_key_inclusive,
                                                      bool reverse_results,
                                                      int32_t max_results,
-                                                     const shared_ptr<GetKeyRangeCallbackInterface> callback) {
+                                                     const shared_ptr<GetKeyRangeCallbackInterface> callback,
+                                                     const RequestOptions &options) {
     return this->GetKeyRange(make_shared<string>(start_key),
                              start_key_inclusive,
                              make_shared<string>(end_key),
                              end_key_inclusive,
                              reverse_results,
                              max_results,
-                             callback);
+                             callback,
+                             options);
 }
 
-HandlerKey NonblockingKineticConnection::Put(const shared_ptr<const string> key,
-                                             const shared_ptr<const string> current_version,
-                                             WriteMode mode,
-                                             const shared_ptr<const KineticRecord> record,
-                                             const shared_ptr<PutCallbackInterface> callback,
-                                             PersistMode persistMode) {
-    unique_ptr<PutHandler> handler(new PutHandler(callback));
-
-    unique_ptr<Message> msg(new Message());
-    msg->set_authtype(Message_AuthType_HMACAUTH);
-
-    unique_ptr<Command> request = NewCommand(Command_MessageType_PUT);
+unique_ptr<Command> NonblockingKineticConnection::NewPutCommand(const shared_ptr<const string> key,
+                                                                const shared_ptr<const string> current_version,
+                                                                WriteMode mode,
+                                                                const shared_ptr<const KineticRecord> record,
+                                                                PersistMode persistMode,
+                                                                const RequestOptions &options) {
+    unique_ptr<Command> request = NewCommand(Command_MessageType_PUT, options);
 
     bool force = mode == WriteMode::IGNORE_VERSION;
     request->mutable_body()->mutable_keyvalue()->set_key(*key);
@@ -376,53 +690,115 @@ HandlerKey NonblockingKineticConnection::Put(const shared_ptr<const string> key,
     request->mutable_body()->mutable_keyvalue()->set_algorithm(record->algorithm());
 
     request->mutable_body()->mutable_keyvalue()->set_synchronization(GetSynchronizationForPersistMode(persistMode));
+    return request;
+}
+
+HandlerKey NonblockingKineticConnection::Put(const shared_ptr<const string> key,
+                                             const shared_ptr<const string> current_version,
+                                             WriteMode mode,
+                                             const shared_ptr<const KineticRecord> record,
+                                             const shared_ptr<PutCallbackInterface> callback,
+                                             PersistMode persistMode,
+                                             const RequestOptions &options) {
+    unique_ptr<PutHandler> handler(new PutHandler(callback));
+
+    unique_ptr<Message> msg(new Message());
+    msg->set_authtype(Message_AuthType_HMACAUTH);
+
+    unique_ptr<Command> request = NewPutCommand(key, current_version, mode, record, persistMode, options);
 
     return service_->Submit(move(msg), move(request), record->value(), move(handler));
 }
 
+HandlerKey NonblockingKineticConnection::Put(const shared_ptr<const string> key,
+                                             const shared_ptr<const string> current_version,
+                                             WriteMode mode,
+                                             const shared_ptr<const KineticRecord> record,
+                                             const shared_ptr<const OutgoingValueInterface> value,
+                                             const shared_ptr<PutCallbackInterface> callback,
+                                             PersistMode persistMode,
+                                             const RequestOptions &options) {
+    unique_ptr<PutHandler> handler(new PutHandler(callback));
+
+    unique_ptr<Message> msg(new Message());
+    msg->set_authtype(Message_AuthType_HMACAUTH);
+
+    unique_ptr<Command> request = NewPutCommand(key, current_version, mode, record, persistMode, options);
+
+    return service_->Submit(move(msg), move(request), value, move(handler));
+}
+
 HandlerKey NonblockingKineticConnection::Put(const string key,
                                              const string current_version,
                                              WriteMode mode,
                                              const shared_ptr<const KineticRecord> record,
+                                             const shared_ptr<const OutgoingValueInterface> value,
                                              const shared_ptr<PutCallbackInterface> callback,
-                                             PersistMode persistMode) {
+                                             PersistMode persistMode,
+                                             const RequestOptions &options) {
+    return this->Put(make_shared<string>(key), make_shared<string>(current_version), mode, record, value,
+        callback, persistMode,
+        options);
+}
+
+HandlerKey NonblockingKineticConnection::Put(const string key,
+                                             const string current_version,
+                                             WriteMode mode,
+                                             const shared_ptr<const KineticRecord> record,
+                                             const shared_ptr<PutCallbackInterface> callback,
+                                             PersistMode persistMode,
+                                             const RequestOptions &options) {
     return this->Put(make_shared<string>(key),
                      make_shared<string>(current_version),
                      mode,
                      record,
                      callback,
-                     persistMode);
+                     persistMode,
+                     options);
 }
 
 HandlerKey NonblockingKineticConnection::Put(const shared_ptr<const string> key,
                                              const shared_ptr<const string> current_version,
                                              WriteMode mode,
                                              const shared_ptr<const KineticRecord> record,
-                                             const shared_ptr<PutCallbackInterface> callback) {
+                                             const shared_ptr<PutCallbackInterface> callback,
+                                             const RequestOptions &options) {
     // Default to the WRITE_BACK case, which performs better but does
     // not guarantee immediate persistence
-    return this->Put(key, current_version, mode, record, callback, PersistMode::WRITE_BACK);
+    return this->Put(key, current_version, mode, record, callback, PersistMode::WRITE_BACK, options);
 }
 
 HandlerKey NonblockingKineticConnection::Put(const string key,
                                              const string current_version,
                                              WriteMode mode,
                                              const shared_ptr<const KineticRecord> record,
-                                             const shared_ptr<PutCallbackInterface> callback) {
-    return this->Put(make_shared<string>(key), make_shared<string>(current_version), mode, record, callback);
+                                             const shared_ptr<PutCallbackInterface> callback,
+                                             const RequestOptions &options) {
+    return this->Put(make_shared<string>(key), make_shared<string>(current_version), mode, record, callback, options);
 }
 
 HandlerKey NonblockingKineticConnection::Delete(const shared_ptr<const string> key,
                                                 const shared_ptr<const string> version,
                                                 WriteMode mode,
                                                 const shared_ptr<SimpleCallbackInterface> callback,
-                                                PersistMode persistMode) {
+                                                PersistMode persistMode,
+                                                const RequestOptions &options) {
     unique_ptr<SimpleHandler> handler(new SimpleHandler(callback));
 
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_HMACAUTH);
 
-    unique_ptr<Command> request = NewCommand(Command_MessageType_DELETE);
+    unique_ptr<Command> request = NewDeleteCommand(key, version, mode, persistMode, options);
+
+    return service_->Submit(move(msg), move(request), empty_str_, move(handler));
+}
+
+unique_ptr<Command> NonblockingKineticConnection::NewDeleteCommand(const shared_ptr<const string> key,
+                                                                   const shared_ptr<const string> version,
+                                                                   WriteMode mode,
+                                                                   PersistMode persistMode,
+                                                                   const RequestOptions &options) {
+    unique_ptr<Command> request = NewCommand(Command_MessageType_DELETE, options);
 
     bool force = mode == WriteMode::IGNORE_VERSION;
     request->mutable_body()->mutable_keyvalue()->set_key(*key);
@@ -430,143 +806,155 @@ HandlerKey NonblockingKineticConnection::Delete(const shared_ptr<const string> k
     request->mutable_body()->mutable_keyvalue()->set_dbversion(*version);
     request->mutable_body()->mutable_keyvalue()->set_force(force);
     request->mutable_body()->mutable_keyvalue()->set_synchronization(GetSynchronizationForPersistMode(persistMode));
-
-    return service_->Submit(move(msg), move(request), empty_str_, move(handler));
+    return request;
 }
 
 HandlerKey NonblockingKineticConnection::Delete(const string key,
                                                 const string version,
                                                 WriteMode mode,
                                                 const shared_ptr<SimpleCallbackInterface> callback,
-                                                PersistMode persistMode) {
-    return this->Delete(make_shared<string>(key), make_shared<string>(version), mode, callback, persistMode);
+                                                PersistMode persistMode,
+                                                const RequestOptions &options) {
+    return this->Delete(make_shared<string>(key), make_shared<string>(version), mode, callback, persistMode, options);
 }
 
 HandlerKey NonblockingKineticConnection::Delete(const shared_ptr<const string> key,
                                                 const shared_ptr<const string> version,
                                                 WriteMode mode,
-                                                const shared_ptr<SimpleCallbackInterface> callback) {
+                                                const shared_ptr<SimpleCallbackInterface> callback,
+                                                const RequestOptions &options) {
     // Default to the WRITE_BACK case, which performs better but does
     // not guarantee immediate persistence
-    return this->Delete(key, version, mode, callback, PersistMode::WRITE_BACK);
+    return this->Delete(key, version, mode, callback, PersistMode::WRITE_BACK, options);
 }
 
 HandlerKey NonblockingKineticConnection::Delete(const string key,
                                                 const string version,
                                                 WriteMode mode,
-                                                const shared_ptr<SimpleCallbackInterface> callback) {
-    return this->Delete(make_shared<string>(key), make_shared<string>(version), mode, callback);
+                                                const shared_ptr<SimpleCallbackInterface> callback,
+                                                const RequestOptions &options) {
+    return this->Delete(make_shared<string>(key), make_shared<string>(version), mode, callback, options);
 }
 
 HandlerKey NonblockingKineticConnection::SecureErase(const shared_ptr<string> pin,
-                                                     const shared_ptr<SimpleCallbackInterface> callback) {
+                                                     const shared_ptr<SimpleCallbackInterface> callback,
+                                                     const RequestOptions &options) {
     unique_ptr<SimpleHandler> handler(new SimpleHandler(callback));
 
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_PINAUTH);
     if (pin) msg->mutable_pinauth()->set_pin(*pin);
 
-    unique_ptr<Command> request = NewCommand(Command_MessageType_PINOP);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_PINOP, options);
     request->mutable_body()->mutable_pinop()->set_pinoptype(Command_PinOperation_PinOpType_SECURE_ERASE_PINOP);
 
     return service_->Submit(move(msg), move(request), empty_str_, move(handler));
 }
 
 HandlerKey NonblockingKineticConnection::SecureErase(const string pin,
-                                                     const shared_ptr<SimpleCallbackInterface> callback) {
-    return this->SecureErase(make_shared<string>(pin), callback);
+                                                     const shared_ptr<SimpleCallbackInterface> callback,
+                                                     const RequestOptions &options) {
+    return this->SecureErase(make_shared<string>(pin), callback, options);
 }
 
 HandlerKey NonblockingKineticConnection::InstantErase(const shared_ptr<string> pin,
-                                                      const shared_ptr<SimpleCallbackInterface> callback) {
+                                                      const shared_ptr<SimpleCallbackInterface> callback,
+                                                      const RequestOptions &options) {
     unique_ptr<SimpleHandler> handler(new SimpleHandler(callback));
 
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_PINAUTH);
     if (pin) msg->mutable_pinauth()->set_pin(*pin);
 
-    unique_ptr<Command> request = NewCommand(Command_MessageType_PINOP);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_PINOP, options);
     request->mutable_body()->mutable_pinop()->set_pinoptype(Command_PinOperation_PinOpType_ERASE_PINOP);
 
     return service_->Submit(move(msg), move(request), empty_str_, move(handler));
 }
 
 HandlerKey NonblockingKineticConnection::InstantErase(const string pin,
-                                                      const shared_ptr<SimpleCallbackInterface> callback) {
-    return this->InstantErase(make_shared<string>(pin), callback);
+                                                      const shared_ptr<SimpleCallbackInterface> callback,
+                                                      const RequestOptions &options) {
+    return this->InstantErase(make_shared<string>(pin), callback, options);
 }
 
 HandlerKey NonblockingKineticConnection::LockDevice(const shared_ptr<string> pin,
-                                                    const shared_ptr<SimpleCallbackInterface> callback) {
+                                                    const shared_ptr<SimpleCallbackInterface> callback,
+                                                    const RequestOptions &options) {
     unique_ptr<SimpleHandler> handler(new SimpleHandler(callback));
 
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_PINAUTH);
     if (pin) msg->mutable_pinauth()->set_pin(*pin);
 
-    unique_ptr<Command> request = NewCommand(Command_MessageType_PINOP);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_PINOP, options);
     request->mutable_body()->mutable_pinop()->set_pinoptype(Command_PinOperation_PinOpType_LOCK_PINOP);
     return service_->Submit(move(msg), move(request), empty_str_, move(handler));
 }
 
 HandlerKey NonblockingKineticConnection::LockDevice(const string pin,
-                                                    const shared_ptr<SimpleCallbackInterface> callback) {
-    return this->LockDevice(make_shared<string>(pin), callback);
+                                                    const shared_ptr<SimpleCallbackInterface> callback,
+                                                    const RequestOptions &options) {
+    return this->LockDevice(make_shared<string>(pin), callback, options);
 }
 
 HandlerKey NonblockingKineticConnection::UnlockDevice(const shared_ptr<string> pin,
-                                                      const shared_ptr<SimpleCallbackInterface> callback) {
+                                                      const shared_ptr<SimpleCallbackInterface> callback,
+                                                      const RequestOptions &options) {
     unique_ptr<SimpleHandler> handler(new SimpleHandler(callback));
 
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_PINAUTH);
     if (pin) msg->mutable_pinauth()->set_pin(*pin);
 
-    unique_ptr<Command> request = NewCommand(Command_MessageType_PINOP);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_PINOP, options);
     request->mutable_body()->mutable_pinop()->set_pinoptype(Command_PinOperation_PinOpType_UNLOCK_PINOP);
     return service_->Submit(move(msg), move(request), empty_str_, move(handler));
 }
 
 HandlerKey NonblockingKineticConnection::UnlockDevice(const string pin,
-                                                      const shared_ptr<SimpleCallbackInterface> callback) {
-    return this->UnlockDevice(make_shared<string>(pin), callback);
+                                                      const shared_ptr<SimpleCallbackInterface> callback,
+                                                      const RequestOptions &options) {
+    return this->UnlockDevice(make_shared<string>(pin), callback, options);
 }
 
 HandlerKey NonblockingKineticConnection::GenericGet(const shared_ptr<const string> key,
-                                                    const shared_ptr<GetCallbackInterface> callback,
-                                                    Command_MessageType message_type) {
-    unique_ptr<GetHandler> handler(new GetHandler(callback));
-
+                                                    unique_ptr<HandlerInterface> handler,
+                                                    Command_MessageType message_type,
+                                                    const RequestOptions &options) {
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_HMACAUTH);
-    unique_ptr<Command> request = NewCommand(message_type);
+    unique_ptr<Command> request = NewCommand(message_type, options);
 
     request->mutable_body()->mutable_keyvalue()->set_key(*key);
     return service_->Submit(move(msg), move(request), empty_str_, move(handler));
 }
 
-HandlerKey NonblockingKineticConnection::Flush(const shared_ptr<SimpleCallbackInterface> callback) {
+HandlerKey NonblockingKineticConnection::Flush(const shared_ptr<SimpleCallbackInterface> callback,
+                                               const RequestOptions &options) {
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_HMACAUTH);
-    unique_ptr<Command> request = NewCommand(Command_MessageType_FLUSHALLDATA);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_FLUSHALLDATA, options);
 
     unique_ptr<SimpleHandler> handler(new SimpleHandler(callback));
     return service_->Submit(move(msg), move(request), empty_str_, move(handler));
 }
 
 HandlerKey NonblockingKineticConnection::SetClusterVersion(int64_t new_cluster_version,
-                                                           const shared_ptr<SimpleCallbackInterface> callback) {
+                                                           const shared_ptr<SimpleCallbackInterface> callback,
+                                                           const RequestOptions &options) {
     unique_ptr<SimpleHandler> handler(new SimpleHandler(callback));
 
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_HMACAUTH);
-    unique_ptr<Command> request = NewCommand(Command_MessageType_SETUP);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_SETUP, options);
 
     request->mutable_body()->mutable_setup()->set_newclusterversion(new_cluster_version);
     return service_->Submit(move(msg), move(request), empty_str_, move(handler));
 }
 
-HandlerKey NonblockingKineticConnection::GetLog(const shared_ptr<GetLogCallbackInterface> callback) {
+HandlerKey NonblockingKineticConnection::GetLog(const shared_ptr<GetLogCallbackInterface> callback,
+                                                const RequestOptions &options) {
     vector<Command_GetLog_Type> types;
     types.push_back(Command_GetLog_Type_UTILIZATIONS);
     types.push_back(Command_GetLog_Type_TEMPERATURES);
@@ -576,14 +964,15 @@ HandlerKey NonblockingKineticConnection::GetLog(const shared_ptr<GetLogCallbackI
     types.push_back(Command_GetLog_Type_MESSAGES);
     types.push_back(Command_GetLog_Type_LIMITS);
 
-    return GetLog(types, callback);
+    return GetLog(types, callback, options);
 }
 
 HandlerKey NonblockingKineticConnection::GetLog(const vector<Command_GetLog_Type> &types,
-                                                const shared_ptr<GetLogCallbackInterface> callback) {
+                                                const shared_ptr<GetLogCallbackInterface> callback,
+                                                const RequestOptions &options) {
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_HMACAUTH);
-    unique_ptr<Command> request = NewCommand(Command_MessageType_GETLOG);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_GETLOG, options);
 
     for (auto iter = types.begin(); iter != types.end(); ++iter) {
         auto mutable_getlog = request->mutable_body()->mutable_getlog();
@@ -595,10 +984,11 @@ HandlerKey NonblockingKineticConnection::GetLog(const vector<Command_GetLog_Type
 }
 
 HandlerKey NonblockingKineticConnection::UpdateFirmware(const shared_ptr<const string> new_firmware,
-                                                        const shared_ptr<SimpleCallbackInterface> callback) {
+                                                        const shared_ptr<SimpleCallbackInterface> callback,
+                                                        const RequestOptions &options) {
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_HMACAUTH);
-    unique_ptr<Command> request = NewCommand(Command_MessageType_SETUP);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_SETUP, options);
 
     request->mutable_body()->mutable_setup()->set_firmwaredownload(true);
 
@@ -607,15 +997,17 @@ HandlerKey NonblockingKineticConnection::UpdateFirmware(const shared_ptr<const s
 }
 
 HandlerKey NonblockingKineticConnection::SetACLs(const shared_ptr<const list<ACL>> acls,
-                                                 const shared_ptr<SimpleCallbackInterface> callback) {
+                                                 const shared_ptr<SimpleCallbackInterface> callback,
+                                                 const RequestOptions &options) {
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_HMACAUTH);
-    unique_ptr<Command> request = NewCommand(Command_MessageType_SECURITY);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_SECURITY, options);
 
     for (auto it = acls->begin(); it != acls->end(); ++it) {
         Command_Security_ACL *acl = request->mutable_body()->mutable_security()->add_acl();
         acl->set_identity(it->identity);
         acl->set_key(it->hmac_key);
+        // HMAC-SHA1 is the only algorithm the protocol lets us assign to a user
         acl->set_hmacalgorithm(Command_Security_ACL_HMACAlgorithm_HmacSHA1);
 
         for (auto scope_it = it->scopes.begin(); scope_it != it->scopes.end(); ++scope_it) {
@@ -658,11 +1050,12 @@ HandlerKey NonblockingKineticConnection::SetACLs(const shared_ptr<const list<ACL
 
 HandlerKey NonblockingKineticConnection::SetLockPIN(const shared_ptr<const string> new_pin,
                                                     const shared_ptr<const string> current_pin,
-                                                    const shared_ptr<SimpleCallbackInterface> callback) {
+                                                    const shared_ptr<SimpleCallbackInterface> callback,
+                                                    const RequestOptions &options) {
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_HMACAUTH);
 
-    unique_ptr<Command> request = NewCommand(Command_MessageType_SECURITY);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_SECURITY, options);
     if (current_pin)
         request->mutable_body()->mutable_security()->set_oldlockpin(*current_pin);
     if (new_pin)
@@ -674,17 +1067,19 @@ HandlerKey NonblockingKineticConnection::SetLockPIN(const shared_ptr<const strin
 
 HandlerKey NonblockingKineticConnection::SetLockPIN(const string new_pin,
                                                     const string current_pin,
-                                                    const shared_ptr<SimpleCallbackInterface> callback) {
-    return this->SetLockPIN(make_shared<string>(new_pin), make_shared<string>(current_pin), callback);
+                                                    const shared_ptr<SimpleCallbackInterface> callback,
+                                                    const RequestOptions &options) {
+    return this->SetLockPIN(make_shared<string>(new_pin), make_shared<string>(current_pin), callback, options);
 }
 
 HandlerKey NonblockingKineticConnection::SetErasePIN(const shared_ptr<const string> new_pin,
                                                      const shared_ptr<const string> current_pin,
-                                                     const shared_ptr<SimpleCallbackInterface> callback) {
+                                                     const shared_ptr<SimpleCallbackInterface> callback,
+                                                     const RequestOptions &options) {
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_HMACAUTH);
 
-    unique_ptr<Command> request = NewCommand(Command_MessageType_SECURITY);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_SECURITY, options);
     if (current_pin)
         request->mutable_body()->mutable_security()->set_olderasepin(*current_pin);
     if (new_pin)
@@ -696,13 +1091,52 @@ HandlerKey NonblockingKineticConnection::SetErasePIN(const shared_ptr<const stri
 
 HandlerKey NonblockingKineticConnection::SetErasePIN(const string new_pin,
                                                      const string current_pin,
-                                                     const shared_ptr<SimpleCallbackInterface> callback) {
-    return this->SetErasePIN(make_shared<string>(new_pin), make_shared<string>(current_pin), callback);
+                                                     const shared_ptr<SimpleCallbackInterface> callback,
+                                                     const RequestOptions &options) {
+    return this->SetErasePIN(make_shared<string>(new_pin), make_shared<string>(current_pin), callback, options);
+}
+
+vector<HandlerKey> NonblockingKineticConnection::SubmitBatch(const Batch &batch,
+                                                             const shared_ptr<BatchCallbackInterface> callback,
+                                                             const RequestOptions &options) {
+    const vector<BatchOperation> &operations = batch.operations();
+    auto completion = make_shared<BatchCompletion>(operations.size(), callback);
+    vector<HandlerKey> keys;
+
+    if (operations.empty()) {
+        unique_ptr<BatchHandler> handler(new BatchHandler(completion, 0));
+        unique_ptr<Message> msg(new Message());
+        msg->set_authtype(Message_AuthType_HMACAUTH);
+        unique_ptr<Command> request = NewCommand(Command_MessageType_NOOP, options);
+        keys.push_back(service_->Submit(move(msg), move(request), empty_str_, move(handler)));
+        return keys;
+    }
+
+    keys.reserve(operations.size());
+    for (size_t i = 0; i < operations.size(); ++i) {
+        const BatchOperation &operation = operations[i];
+        unique_ptr<BatchHandler> handler(new BatchHandler(completion, i));
+
+        unique_ptr<Message> msg(new Message());
+        msg->set_authtype(Message_AuthType_HMACAUTH);
+
+        if (operation.record) {
+            unique_ptr<Command> request = NewPutCommand(operation.key, operation.version, operation.mode,
+                operation.record, batch.persist_mode(), options);
+            keys.push_back(service_->Submit(move(msg), move(request), operation.record->value(), move(handler)));
+        } else {
+            unique_ptr<Command> request = NewDeleteCommand(operation.key, operation.version, operation.mode,
+                batch.persist_mode(), options);
+            keys.push_back(service_->Submit(move(msg), move(request), empty_str_, move(handler)));
+        }
+    }
+    return keys;
 }
 
 HandlerKey NonblockingKineticConnection::P2PPush(const P2PPushRequest &push_request,
-                                                 const shared_ptr<P2PPushCallbackInterface> callback) {
-    return this->P2PPush(make_shared<P2PPushRequest>(push_request), callback);
+                                                 const shared_ptr<P2PPushCallbackInterface> callback,
+                                                 const RequestOptions &options) {
+    return this->P2PPush(make_shared<P2PPushRequest>(push_request), callback, options);
 }
 
 void NonblockingKineticConnection::PopulateP2PMessage(Command_P2POperation *mutable_p2pop,
@@ -728,10 +1162,11 @@ void NonblockingKineticConnection::PopulateP2PMessage(Command_P2POperation *muta
 }
 
 HandlerKey NonblockingKineticConnection::P2PPush(const shared_ptr<const P2PPushRequest> push_request,
-                                                 const shared_ptr<P2PPushCallbackInterface> callback) {
+                                                 const shared_ptr<P2PPushCallbackInterface> callback,
+                                                 const RequestOptions &options) {
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_HMACAUTH);
-    unique_ptr<Command> request = NewCommand(Command_MessageType_PEER2PEERPUSH);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_PEER2PEERPUSH, options);
 
     auto mutable_p2pop = request->mutable_body()->mutable_p2poperation();
     PopulateP2PMessage(mutable_p2pop, push_request);
@@ -745,14 +1180,17 @@ HandlerKey NonblockingKineticConnection::MediaScan(const shared_ptr<const string
                                                    const shared_ptr<const string> end_key,
                                                    bool end_key_inclusive,
                                                    int32_t max_results,
-                                                   const shared_ptr<MediaScanCallbackInterface> callback) {
+                                                   const shared_ptr<MediaScanCallbackInterface> callback,
+                                                   const RequestOptions &options) {
     unique_ptr<MediaScanHandler> handler(new MediaScanHandler(callback));
 
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_HMACAUTH);
 
-    unique_ptr<Command> request = NewCommand(Command_MessageType_MEDIASCAN);
-    request->mutable_header()->set_priority(Command_Priority_LOWER);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_MEDIASCAN, options);
+    if (!request->header().has_priority()) {
+        request->mutable_header()->set_priority(Command_Priority_LOWER);
+    }
 
     request->mutable_body()->mutable_range()->set_startkey(*start_key);
     request->mutable_body()->mutable_range()->set_startkeyinclusive(start_key_inclusive);
@@ -768,27 +1206,32 @@ HandlerKey NonblockingKineticConnection::MediaScan(const string start_key,
                                                    const string end_key,
                                                    bool end_key_inclusive,
                                                    int32_t max_results,
-                                                   const shared_ptr<MediaScanCallbackInterface> callback) {
+                                                   const shared_ptr<MediaScanCallbackInterface> callback,
+                                                   const RequestOptions &options) {
     return this->MediaScan(make_shared<string>(start_key),
                            start_key_inclusive,
                            make_shared<string>(end_key),
                            end_key_inclusive,
                            max_results,
-                           callback);
+                           callback,
+                           options);
 }
 
 HandlerKey NonblockingKineticConnection::MediaOptimize(const shared_ptr<const string> start_key,
                                                        bool start_key_inclusive,
                                                        const shared_ptr<const string> end_key,
                                                        bool end_key_inclusive,
-                                                       const shared_ptr<MediaOptimizeCallbackInterface> callback) {
+                                                       const shared_ptr<MediaOptimizeCallbackInterface> callback,
+                                                       const RequestOptions &options) {
     unique_ptr<MediaOptimizeHandler> handler(new MediaOptimizeHandler(callback));
 
     unique_ptr<Message> msg(new Message());
     msg->set_authtype(Message_AuthType_HMACAUTH);
 
-    unique_ptr<Command> request = NewCommand(Command_MessageType_MEDIAOPTIMIZE);
-    request->mutable_header()->set_priority(Command_Priority_LOWER);
+    unique_ptr<Command> request = NewCommand(Command_MessageType_MEDIAOPTIMIZE, options);
+    if (!request->header().has_priority()) {
+        request->mutable_header()->set_priority(Command_Priority_LOWER);
+    }
 
     request->mutable_body()->mutable_range()->set_startkey(*start_key);
     request->mutable_body()->mutable_range()->set_startkeyinclusive(start_key_inclusive);
@@ -802,18 +1245,29 @@ HandlerKey NonblockingKineticConnection::MediaOptimize(const string start_key,
                                                        bool start_key_inclusive,
                                                        const string end_key,
                                                        bool end_key_inclusive,
-                                                       const shared_ptr<MediaOptimizeCallbackInterface> callback) {
+                                                       const shared_ptr<MediaOptimizeCallbackInterface> callback,
+                                                       const RequestOptions &options) {
     return this->MediaOptimize(make_shared<string>(start_key),
                                start_key_inclusive,
                                make_shared<string>(end_key),
                                end_key_inclusive,
-                               callback);
+                               callback,
+                               options);
 }
 
 bool NonblockingKineticConnection::RemoveHandler(HandlerKey handler_key) {
     return service_->Remove(handler_key);
 }
 
+void NonblockingKineticConnection::SetDeadline(HandlerKey handler_key, unsigned int timeout_ms) {
+    service_->SetDeadline(handler_key,
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms));
+}
+
+int NonblockingKineticConnection::TimeUntilDeadline() {
+    return service_->TimeUntilDeadline();
+}
+
 Command_Synchronization NonblockingKineticConnection::GetSynchronizationForPersistMode(PersistMode persistMode) {
     Command_Synchronization sync_option;
     switch (persistMode) {
@@ -18,218 +18,747 @@
 #include "nonblocking_packet.h"
 #include <sys/types.h>
 #include <sys/socket.h>
-#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <unistd.h>
-#include <sys/stat.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
+#include <string.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+#include <algorithm>
 
 #include "glog/logging.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/wire_format_lite.h"
+
+#include "zero_copy_sender.h"
 
 namespace kinetic {
 
 using std::make_shared;
+using std::move;
 using std::string;
+using google::protobuf::internal::WireFormatLite;
 
-NonblockingPacketWriter::NonblockingPacketWriter(shared_ptr<SocketWrapperInterface> socket_wrapper, unique_ptr<const Message> message,
+NonblockingPacketWriter::NonblockingPacketWriter(shared_ptr<SocketWrapperInterface> socket_wrapper, unique_ptr<Message> message,
     const shared_ptr<const string> value)
-    : socket_wrapper_(socket_wrapper), message_(move(message)), value_(value), state_(kMagic),
-    writer_(new NonblockingStringWriter(socket_wrapper_, make_shared<string>("F"))) {}
+    : socket_wrapper_(socket_wrapper), packets_(), state_(kMagic), next_packet_(0), bytes_written_(0),
+    chunk_(), chunk_packet_(0), chunk_offset_(0), tls_buffer_() {
+    Append(move(message), value);
+}
+
+NonblockingPacketWriter::NonblockingPacketWriter(shared_ptr<SocketWrapperInterface> socket_wrapper, unique_ptr<Message> message,
+    const shared_ptr<const OutgoingValueInterface> value)
+    : socket_wrapper_(socket_wrapper), packets_(), state_(kMagic), next_packet_(0), bytes_written_(0),
+    chunk_(), chunk_packet_(0), chunk_offset_(0), tls_buffer_() {
+    Append(move(message), value);
+}
 
 NonblockingPacketWriter::~NonblockingPacketWriter() {
-    if (writer_ != NULL) {
-        delete writer_;
+    // A write handed to the socket's io may still refer to our buffers
+    SocketIoInterface *io = socket_wrapper_->io();
+    if (io != NULL && state_ != kMagic && state_ != kFinished) {
+        io->AbandonWrite();
     }
 }
 
+void NonblockingPacketWriter::Append(unique_ptr<Message> message, const shared_ptr<const string> value) {
+    AppendPacket(move(message), value, shared_ptr<const OutgoingValueInterface>());
+}
+
+void NonblockingPacketWriter::Append(unique_ptr<Message> message, const shared_ptr<const OutgoingValueInterface> value) {
+    AppendPacket(move(message), shared_ptr<const string>(), value);
+}
+
+void NonblockingPacketWriter::AppendPacket(unique_ptr<Message> message, const shared_ptr<const string> value,
+        const shared_ptr<const OutgoingValueInterface> source) {
+    CHECK_EQ(kMagic, state_);
+    Packet packet;
+    packet.message = move(message);
+    packet.value = value;
+    packet.source = source;
+#ifdef __linux__
+    off_t file_offset;
+    packet.sendfile = source && source->SourceFile(&file_offset) >= 0;
+#else
+    packet.sendfile = false;
+#endif
+    packet.end = 0;
+    packets_.push_back(move(packet));
+}
+
+size_t NonblockingPacketWriter::Packet::value_size() const {
+    return source ? source->size() : value->size();
+}
+
 NonblockingStringStatus NonblockingPacketWriter::Write() {
-    struct stat statbuf;
-    if (fstat(socket_wrapper_->fd(), &statbuf)) {
-        PLOG(ERROR) << "Unable to fstat socket";
-        return kFailed;
-    }
-#ifndef __APPLE__
-    if (S_ISSOCK(statbuf.st_mode)) {
-        int optval = 1;
-        setsockopt(socket_wrapper_->fd(), IPPROTO_TCP, TCP_CORK, &optval, sizeof(optval));
+    if (state_ == kMagic) {
+        size_t end = 0;
+        for (auto it = packets_.begin(); it != packets_.end(); ++it) {
+            if (!PrepareFrame(&*it)) {
+                return kFailed;
+            }
+            end += it->frame.size() + it->command_bytes.size() + it->value_size();
+            it->end = end;
+        }
+        state_ = kMessage;
     }
-#endif
 
     while (true) {
-        NonblockingStringStatus status = writer_->Write();
-        if (status != kDone) {
-            return status;
+        if (next_packet_ < packets_.size() && bytes_written_ >= packets_[next_packet_].end) {
+            // An earlier gather write may already have covered this packet
+            next_packet_++;
+            return kDone;
+        }
+        if (state_ == kFinished) {
+            return kFailed;
         }
 
-        // Transition to the next state
-        switch (state_) {
-            case kMagic:
-                if (!TransitionFromMagic()) {
-                    return kFailed;
-                }
-                break;
-            case kMessageLength:
-                TransitionFromMessageLength();
-                break;
-            case kValueLength:
-                TransitionFromValueLength();
-                break;
-            case kMessage:
-                TransitionFromMessage();
-                break;
-            case kValue:
-                TransitionFromValue();
-                break;
-            case kFinished:
-                if (fstat(socket_wrapper_->fd(), &statbuf)) {
-                    PLOG(ERROR) << "Unable to fstat socket";
-                    return kFailed;
-                }
-                if (S_ISSOCK(statbuf.st_mode)) {
-                    int optval = 0;
-#ifndef __APPLE__
-                    setsockopt(socket_wrapper_->fd(), IPPROTO_TCP, TCP_CORK, &optval, sizeof(optval));
-#endif
-                    optval = 1;
-                    setsockopt(socket_wrapper_->fd(), IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval));
-                }
-                return kDone;
-            default:
-                CHECK(false);
+        ssize_t status = WriteSegments();
+        if (status == 0) {
+            return kFailed;
+        }
+        if (status < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return kInProgress;
+            }
+            return kFailed;
+        }
+        bytes_written_ += status;
+        if (bytes_written_ == packets_.back().end) {
+            state_ = kFinished;
         }
     }
 }
 
-bool NonblockingPacketWriter::TransitionFromMagic() {
-    // Move on to the writing the message length
-    if (!message_->SerializeToString(&serialized_message_)) {
+bool NonblockingPacketWriter::PrepareFrame(Packet *packet) {
+    // The command bytes make up most of the message and, having the highest field number, are
+    // always serialized last. Move them out of the message so the rest can be serialized behind
+    // the header and the command bytes sent from their own buffer without another copy.
+    Message *message = packet->message.get();
+    bool has_command = message->has_commandbytes();
+    packet->command_bytes.swap(*message->mutable_commandbytes());
+    message->clear_commandbytes();
+
+    string &frame = packet->frame;
+    frame.assign(9, '\0');
+    if (!message->AppendToString(&frame)) {
         // Serialization can fail if the message is missing required fields
         return false;
     }
-    uint32_t size = htonl(serialized_message_.size());
-    delete writer_;
-    std::string encoded_size(reinterpret_cast<char *>(&size), sizeof(size));
-    writer_ = new NonblockingStringWriter(socket_wrapper_, make_shared<string>(encoded_size));
-    state_ = kMessageLength;
+    if (has_command) {
+        // One byte of tag plus at most five bytes of varint length
+        uint8_t field_header[6];
+        field_header[0] = WireFormatLite::MakeTag(Message::kCommandBytesFieldNumber,
+            WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+        uint8_t *end = google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(
+            packet->command_bytes.size(), field_header + 1);
+        frame.append(reinterpret_cast<char *>(field_header), end - field_header);
+    }
+
+    uint32_t message_size = htonl(frame.size() - 9 + packet->command_bytes.size());
+    uint32_t value_size = htonl(packet->value_size());
+    frame[0] = 'F';
+    frame.replace(1, sizeof(message_size), reinterpret_cast<char *>(&message_size), sizeof(message_size));
+    frame.replace(5, sizeof(value_size), reinterpret_cast<char *>(&value_size), sizeof(value_size));
     return true;
 }
 
-void NonblockingPacketWriter::TransitionFromMessageLength() {
-    // Move on to writing the value length
-    uint32_t size = htonl(value_->size());
-    delete writer_;
-    std::string encoded_size(reinterpret_cast<char *>(&size), sizeof(size));
-    writer_ = new NonblockingStringWriter(socket_wrapper_, make_shared<string>(encoded_size));
-    state_ = kValueLength;
+// Largest payload of a single TLS record
+static const size_t kTlsRecordSize = 16384;
+
+// TLS has no gather write, and with TCP_NODELAY set every SSL_write of a small segment would go
+// out as its own record and TCP segment. Segments are copied into one buffer of up to a record
+// first, so a small request is sent whole; a segment at least a record long is written in place.
+ssize_t NonblockingPacketWriter::WriteTls(const struct iovec *iov, int iovcnt) {
+    SSL *ssl = socket_wrapper_->getSSL();
+    if (tls_buffer_.empty()) {
+        if (iov[0].iov_len >= kTlsRecordSize) {
+            return SSL_write(ssl, iov[0].iov_base, iov[0].iov_len);
+        }
+        for (int i = 0; i < iovcnt && tls_buffer_.size() < kTlsRecordSize; i++) {
+            tls_buffer_.append(static_cast<const char *>(iov[i].iov_base),
+                std::min(iov[i].iov_len, kTlsRecordSize - tls_buffer_.size()));
+        }
+    }
+
+    int status = SSL_write(ssl, tls_buffer_.data(), tls_buffer_.size());
+    if (status > 0) {
+        tls_buffer_.erase(0, status);
+    }
+    return status;
 }
 
-void NonblockingPacketWriter::TransitionFromValueLength() {
-    // Move on to writing the serialized message
-    delete writer_;
-    writer_ = new NonblockingStringWriter(socket_wrapper_, make_shared<string>(serialized_message_));
-    state_ = kMessage;
+// Most segments handed to a single gather write; three per packet
+static const int kMaxSegments = 192;
+
+ssize_t NonblockingPacketWriter::WriteSegments() {
+    SocketIoInterface *io = socket_wrapper_->io();
+    ZeroCopySender *zero_copy = io == NULL ? socket_wrapper_->zero_copy() : NULL;
+
+    struct iovec iov[kMaxSegments];
+    int iovcnt = 0;
+    // Set when the only thing to send is a value large enough to go out without being copied
+    const Packet *zero_copy_packet = NULL;
+    // Set when what's been gathered is followed by a value to be sent with sendfile
+    bool more = false;
+    bool gathered = false;
+    // Everything before next_packet_ has been written out
+    size_t offset = bytes_written_ - (next_packet_ > 0 ? packets_[next_packet_ - 1].end : 0);
+    for (size_t i = next_packet_; i < packets_.size() && iovcnt < kMaxSegments && !gathered; i++) {
+        Packet &packet = packets_[i];
+        const string *segments[] = { &packet.frame, &packet.command_bytes, packet.value.get() };
+        for (size_t j = 0; j < sizeof(segments) / sizeof(segments[0]) && iovcnt < kMaxSegments; j++) {
+            if (j == 2 && packet.source) {
+                // A streamed value, which ends the gather
+                if (offset >= packet.source->size()) {
+                    offset -= packet.source->size();
+                    continue;
+                }
+                if (packet.sendfile && io == NULL && !socket_wrapper_->getSSL()) {
+                    if (iovcnt > 0) {
+                        more = true;
+                    } else {
+                        return SendFile(&packet, offset);
+                    }
+                } else {
+                    const string *chunk = SourceChunk(i, offset);
+                    if (chunk == NULL) {
+                        return -1;
+                    }
+                    iov[iovcnt].iov_base = const_cast<char *>(chunk->data() + offset - chunk_offset_);
+                    iov[iovcnt].iov_len = chunk->size() - (offset - chunk_offset_);
+                    iovcnt++;
+                    offset = 0;
+                }
+                gathered = true;
+                break;
+            }
+            const string *segment = segments[j];
+            if (offset >= segment->size()) {
+                offset -= segment->size();
+                continue;
+            }
+            bool large_value = zero_copy != NULL && segment == packet.value.get() &&
+                segment->size() >= zero_copy->threshold();
+            if (large_value && iovcnt > 0) {
+                // Send whatever precedes it the usual way first
+                gathered = true;
+                break;
+            }
+            iov[iovcnt].iov_base = const_cast<char *>(segment->data() + offset);
+            iov[iovcnt].iov_len = segment->size() - offset;
+            iovcnt++;
+            offset = 0;
+            if (large_value) {
+                zero_copy_packet = &packet;
+                gathered = true;
+                break;
+            }
+        }
+    }
+    CHECK_GT(iovcnt, 0);
+
+    if (io != NULL) {
+        return io->Writev(iov, iovcnt);
+    }
+    if (zero_copy_packet != NULL) {
+        ssize_t status = zero_copy->Send(iov, iovcnt, zero_copy_packet->value);
+        if (status >= 0 || errno != ENOBUFS) {
+            return status;
+        }
+        // The kernel is tracking as many zero-copy sends as it will; copy this one instead
+    }
+    if (socket_wrapper_->getSSL()) {
+        return WriteTls(iov, iovcnt);
+    }
+    if (socket_wrapper_->descriptor_type() == kPlainDescriptor) {
+        // Tests use pipes, which don't support sendmsg
+        return writev(socket_wrapper_->fd(), iov, iovcnt);
+    }
+
+    int flags = 0;
+    // Prevent sending SIGPIPE signal on Linux. SIGPIPE is undesirable because the library
+    // client will crash if the remote server closes the connection.
+    #ifdef MSG_NOSIGNAL
+    flags |= MSG_NOSIGNAL;
+    #endif
+    #ifdef MSG_MORE
+    if (more) {
+        // Hold the header back briefly so it can share a segment with the start of the value
+        flags |= MSG_MORE;
+    }
+    #endif
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+    return sendmsg(socket_wrapper_->fd(), &msg, flags);
 }
 
-void NonblockingPacketWriter::TransitionFromMessage() {
-    // Move on to writing the value
-    delete writer_;
-    writer_ = new NonblockingStringWriter(socket_wrapper_, value_);
-    state_ = kValue;
+// How much of a streamed value is read into memory at a time
+static const size_t kSourceChunkSize = 64 * 1024;
+
+const string *NonblockingPacketWriter::SourceChunk(size_t packet, size_t offset) {
+    if (packet == chunk_packet_ && offset >= chunk_offset_ && offset < chunk_offset_ + chunk_.size()) {
+        // Still sending the chunk read last time
+        return &chunk_;
+    }
+    const OutgoingValueInterface &source = *packets_[packet].source;
+    chunk_.resize(std::min(kSourceChunkSize, source.size() - offset));
+    int err = 0;
+    ssize_t status = source.ReadAt(offset, &chunk_[0], chunk_.size(), &err);
+    if (status <= 0) {
+        LOG(WARNING) << "Failed to read value to send";
+        chunk_.clear();
+        errno = status < 0 && err != 0 ? err : EIO;
+        return NULL;
+    }
+    chunk_.resize(status);
+    chunk_packet_ = packet;
+    chunk_offset_ = offset;
+    return &chunk_;
 }
 
-void NonblockingPacketWriter::TransitionFromValue() {
-    // We're done!
-    state_ = kFinished;
+ssize_t NonblockingPacketWriter::SendFile(Packet *packet, size_t offset) {
+#ifdef __linux__
+    off_t file_offset;
+    int file = packet->source->SourceFile(&file_offset);
+    file_offset += offset;
+
+    // Unlike send, sendfile can't be told not to raise SIGPIPE, so it's blocked for the duration
+    // of the call and one raised by the call is discarded
+    sigset_t sigpipe, pending, old_mask;
+    sigemptyset(&sigpipe);
+    sigaddset(&sigpipe, SIGPIPE);
+    sigpending(&pending);
+    bool already_pending = sigismember(&pending, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigpipe, &old_mask);
+    ssize_t status = sendfile(socket_wrapper_->fd(), file, &file_offset, packet->source->size() - offset);
+    int saved_errno = errno;
+    if (status < 0 && saved_errno == EPIPE && !already_pending) {
+        struct timespec no_wait = { 0, 0 };
+        sigtimedwait(&sigpipe, NULL, &no_wait);
+    }
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    errno = saved_errno;
+
+    if (status < 0 && (errno == EINVAL || errno == ENOSYS)) {
+        // Not something sendfile can read from; read it in chunks instead
+        packet->sendfile = false;
+        errno = EINTR;
+    }
+    return status;
+#else
+    packet->sendfile = false;
+    errno = EINTR;
+    return -1;
+#endif
 }
 
+// Size of the header preceding every packet: magic byte, message length and value length
+static const size_t kHeaderLength = 9;
+// How much we try to pull off the socket per read. Values at least this large bypass the
+// receive buffer and are read straight into their final storage.
+static const size_t kReadChunkSize = 64 * 1024;
+// How much of a value is spliced into the pipe at once; the pipe is grown to hold this much
+static const size_t kSpliceChunkSize = 1024 * 1024;
+
 NonblockingPacketReader::NonblockingPacketReader(shared_ptr<SocketWrapperInterface> socket_wrapper, Message* response,
-        unique_ptr<const string> &value)
-    : socket_wrapper_(socket_wrapper), response_(response), state_(kMagic), value_(value), magic_(),
-    reader_(new NonblockingStringReader(socket_wrapper_, 1, magic_)) {
+        unique_ptr<const string> &value, PacketMessageListenerInterface *listener)
+    : socket_wrapper_(socket_wrapper), response_(response), state_(kMagic), value_(value),
+    buffer_(kReadChunkSize), buffer_start_(0), buffer_end_(0), message_length_(0), value_length_(0),
+    listener_(listener), pending_value_(), value_target_(NULL),
+    value_target_external_(false), value_bytes_read_(0), value_fd_(-1), value_fd_offset_(-1),
+    value_splice_(false), value_discard_(false), value_file_error_(0) {
+    pipe_[0] = pipe_[1] = -1;
 }
 
 NonblockingPacketReader::~NonblockingPacketReader() {
-    if (reader_ != NULL) {
-        delete reader_;
+    if (pipe_[0] >= 0) {
+        close(pipe_[0]);
+        close(pipe_[1]);
     }
 }
 
 NonblockingStringStatus NonblockingPacketReader::Read() {
     while (true) {
-        NonblockingStringStatus status = reader_->Read();
-        if (status != kDone) {
-            return status;
-        }
-
-        // Transition to the next state
         switch (state_) {
-            case kMagic:
-                if (!TransitionFromMagic()) {
+            case kMagic: {
+                const char *header = buffer_.data() + buffer_start_;
+                if (buffered() > 0 && header[0] != 'F') {
+                    // Reject a bad magic byte without waiting for the rest of the header
                     return kFailed;
                 }
+                if (buffered() < kHeaderLength) {
+                    NonblockingStringStatus status = Fill(kHeaderLength);
+                    if (status != kDone) {
+                        return status;
+                    }
+                    break;
+                }
+                memcpy(&message_length_, header + 1, sizeof(message_length_));
+                memcpy(&value_length_, header + 5, sizeof(value_length_));
+                message_length_ = ntohl(message_length_);
+                value_length_ = ntohl(value_length_);
+                buffer_start_ += kHeaderLength;
+                state_ = kMessage;
                 break;
-            case kMessageLength:
-                TransitionFromMessageLength();
-                break;
-            case kValueLength:
-                TransitionFromValueLength();
-                break;
-            case kMessage:
-                TransitionFromMessage();
-                break;
-            case kValue:
-                if (!TransitionFromValue()) {
+            }
+            case kMessage: {
+                if (buffered() < message_length_) {
+                    NonblockingStringStatus status = Fill(message_length_);
+                    if (status != kDone) {
+                        return status;
+                    }
+                    break;
+                }
+                pending_value_.reset(new string());
+                ResetValueTarget();
+                value_file_error_ = 0;
+                if (!ParseMessage()) {
                     return kFailed;
                 }
+                buffer_start_ += message_length_;
+                if (!value_target_external_ && value_fd_ < 0) {
+                    pending_value_->reserve(value_length_);
+                }
+                value_bytes_read_ = 0;
+                state_ = kValue;
                 break;
-            case kFinished:
-                return kDone;
+            }
+            case kValue: {
+                NonblockingStringStatus status = ReadValue();
+                if (status != kDone) {
+                    return status;
+                }
+                if (value_bytes_read_ == value_length_) {
+                    // When the value went elsewhere pending_value_ is simply empty
+                    value_ = move(pending_value_);
+                    ResetValueTarget();
+                    state_ = kMagic;
+                    return kDone;
+                }
                 break;
+            }
             default:
                 CHECK(false);
         }
     }
 }
 
-bool NonblockingPacketReader::TransitionFromMagic() {
-    // Check the magic byte and move on to reading the message length
-    if (*magic_ != "F") {
+// Parses the message straight out of the receive buffer. When there's a listener the command
+// bytes, which make up most of the message, are handed to it in place instead of being copied
+// into the message.
+bool NonblockingPacketReader::ParseMessage() {
+    const char *data = buffer_.data() + buffer_start_;
+    if (listener_ == NULL) {
+        return response_->ParseFromArray(data, message_length_);
+    }
+
+    // The command bytes have the highest field number so they're normally the last field; find
+    // where they start and parse only what comes before them
+    size_t envelope_length = message_length_;
+    const char *command_bytes = NULL;
+    size_t command_length = 0;
+    google::protobuf::io::CodedInputStream input(reinterpret_cast<const uint8_t *>(data),
+        message_length_);
+    while (true) {
+        size_t field_start = input.CurrentPosition();
+        uint32_t tag = input.ReadTag();
+        if (tag == 0) {
+            break;
+        }
+        if (tag == WireFormatLite::MakeTag(Message::kCommandBytesFieldNumber,
+                WireFormatLite::WIRETYPE_LENGTH_DELIMITED)) {
+            uint32_t length;
+            if (!input.ReadVarint32(&length)) {
+                return false;
+            }
+            size_t position = input.CurrentPosition();
+            if (position + length == message_length_) {
+                envelope_length = field_start;
+                command_bytes = data + position;
+                command_length = length;
+                break;
+            }
+            if (!input.Skip(length)) {
+                return false;
+            }
+        } else if (!WireFormatLite::SkipField(&input, tag)) {
+            return false;
+        }
+    }
+
+    if (!response_->ParseFromArray(data, envelope_length)) {
         return false;
     }
-    delete reader_;
-    reader_ = new NonblockingStringReader(socket_wrapper_, 4, message_length_);
-    state_ = kMessageLength;
+    if (command_bytes == NULL) {
+        // Unusual field order; the parse above already copied the command bytes
+        command_bytes = response_->commandbytes().data();
+        command_length = response_->commandbytes().size();
+    }
+    value_target_ = listener_->MessageReceived(*response_, command_bytes, command_length,
+        value_length_);
+    value_target_external_ = value_target_ != NULL;
+    if (value_target_ == NULL && value_length_ > 0) {
+        value_fd_ = listener_->ValueFile(value_length_, &value_fd_offset_);
+#ifdef __linux__
+        value_splice_ = value_fd_ >= 0 && socket_wrapper_->io() == NULL &&
+            socket_wrapper_->getSSL() == NULL;
+#endif
+    }
     return true;
 }
 
-void NonblockingPacketReader::TransitionFromMessageLength() {
-    // Move on to reading the value length
-    delete reader_;
-    reader_ = new NonblockingStringReader(socket_wrapper_, 4, value_length_);
-    state_ = kValueLength;
+void NonblockingPacketReader::ResetValueTarget() {
+    value_target_ = NULL;
+    value_target_external_ = false;
+    value_fd_ = -1;
+    value_fd_offset_ = -1;
+    value_splice_ = false;
+    value_discard_ = false;
 }
 
-void NonblockingPacketReader::TransitionFromValueLength() {
-    // Move on to reading the message
-    delete reader_;
-    CHECK_EQ(4u, message_length_->size());
-    uint32_t length = ntohl(*reinterpret_cast<const uint32_t *>(message_length_->data()));
-    reader_ = new NonblockingStringReader(socket_wrapper_, length, message_);
-    state_ = kMessage;
+int NonblockingPacketReader::value_file_error() const {
+    return value_file_error_;
 }
 
-void NonblockingPacketReader::TransitionFromMessage() {
-    // Move on to reading the value
-    delete reader_;
-    CHECK_EQ(4u, value_length_->size());
-    uint32_t length = ntohl(*reinterpret_cast<const uint32_t *>(value_length_->data()));
-    reader_ = new NonblockingStringReader(socket_wrapper_, length, value_);
-    state_ = kValue;
+bool NonblockingPacketReader::in_progress() const {
+    return state_ != kMagic;
 }
 
-bool NonblockingPacketReader::TransitionFromValue() {
-    // We're done!
-    state_ = kFinished;
-    return response_->ParseFromString(*message_);
+size_t NonblockingPacketReader::buffered() const {
+    return buffer_end_ - buffer_start_;
+}
+
+// Makes progress on the value of the current packet. Returns kDone once some progress has been
+// made, which may or may not mean the whole value has arrived.
+NonblockingStringStatus NonblockingPacketReader::ReadValue() {
+    size_t remaining = value_length_ - value_bytes_read_;
+    if (remaining == 0) {
+        return kDone;
+    }
+
+    // Take whatever part of the value is already sitting in the receive buffer
+    size_t n = std::min(buffered(), remaining);
+    if (n > 0) {
+        ConsumeValue(buffer_.data() + buffer_start_, n);
+        buffer_start_ += n;
+        remaining -= n;
+        if (remaining == 0) {
+            return kDone;
+        }
+    }
+    if (remaining < kReadChunkSize) {
+        // Pull the tail in through the buffer; the same read may pick up the following packets
+        return Fill(remaining);
+    }
+
+    if (value_splice_) {
+        while (true) {
+            ssize_t status = SpliceToFile(remaining);
+            if (status > 0) {
+                return kDone;
+            }
+            if (status == 0) {
+                // Unexpected EOF
+                return kFailed;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return kInProgress;
+            }
+            if (errno != EINVAL && errno != ENOSYS) {
+                return kFailed;
+            }
+            // This socket can't be spliced from; copy the value instead
+            value_splice_ = false;
+            break;
+        }
+    }
+    if (value_fd_ >= 0 || value_discard_) {
+        // Only ever hold a buffer's worth of values that go to a file or nowhere
+        return Fill(kReadChunkSize);
+    }
+
+    // The buffer is drained at this point, so the rest can go directly to its destination
+    if (value_target_ == NULL) {
+        pending_value_->resize(value_length_);
+        value_target_ = &(*pending_value_)[0];
+    }
+    while (true) {
+        ssize_t status = ReadInto(value_target_ + value_bytes_read_, remaining);
+        if (status == 0) {
+            // Unexpected EOF
+            return kFailed;
+        }
+        if (status < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return kInProgress;
+            }
+            return kFailed;
+        }
+        value_bytes_read_ += status;
+        return kDone;
+    }
+}
+
+void NonblockingPacketReader::DetachValueDestination() {
+    if (state_ != kValue || (!value_target_external_ && value_fd_ < 0)) {
+        return;
+    }
+    ResetValueTarget();
+    value_discard_ = true;
+}
+
+// Hands the next n bytes of the current value to wherever it's going
+void NonblockingPacketReader::ConsumeValue(const char *data, size_t n) {
+    if (value_fd_ >= 0) {
+        WriteToFile(data, n);
+    } else if (value_target_ != NULL) {
+        memcpy(value_target_ + value_bytes_read_, data, n);
+    } else if (!value_discard_) {
+        pending_value_->append(data, n);
+    }
+    value_bytes_read_ += n;
+}
+
+// Writes bytes of the current value to its file. On failure the error is recorded and the rest of
+// the value is dropped.
+void NonblockingPacketReader::WriteToFile(const char *data, size_t n) {
+    off_t offset = value_fd_offset_ + value_bytes_read_;
+    while (n > 0) {
+        ssize_t status = value_fd_offset_ < 0 ? write(value_fd_, data, n) :
+            pwrite(value_fd_, data, n, offset);
+        if (status < 0 && errno == EINTR) {
+            continue;
+        }
+        if (status <= 0) {
+            value_file_error_ = status < 0 ? errno : EIO;
+            PLOG(WARNING) << "Failed to write value to file";
+            ResetValueTarget();
+            value_discard_ = true;
+            return;
+        }
+        data += status;
+        offset += status;
+        n -= status;
+    }
+}
+
+// Moves up to remaining bytes of the value from the socket into its file through pipe_, without
+// copying them into userspace. Returns what the splice off the socket returned; the bytes it took
+// have been written out (or dropped, if the file failed) by the time this returns.
+ssize_t NonblockingPacketReader::SpliceToFile(size_t remaining) {
+#ifdef __linux__
+    if (pipe_[0] < 0) {
+        if (pipe2(pipe_, O_CLOEXEC) != 0) {
+            PLOG(WARNING) << "Failed to create pipe";
+            pipe_[0] = pipe_[1] = -1;
+            errno = EINVAL;
+            return -1;
+        }
+        // Best effort; a smaller pipe just means more trips
+        fcntl(pipe_[1], F_SETPIPE_SZ, kSpliceChunkSize);
+    }
+    ssize_t status = splice(socket_wrapper_->fd(), NULL, pipe_[1], NULL,
+        std::min(remaining, kSpliceChunkSize), SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (status <= 0) {
+        return status;
+    }
+
+    size_t in_pipe = status;
+    while (in_pipe > 0 && value_splice_) {
+        loff_t offset = value_fd_offset_ + value_bytes_read_;
+        ssize_t moved = splice(pipe_[0], NULL, value_fd_, value_fd_offset_ < 0 ? NULL : &offset,
+            in_pipe, SPLICE_F_MOVE);
+        if (moved < 0 && errno == EINTR) {
+            continue;
+        }
+        if (moved <= 0) {
+            // The file can't take a splice (or failed); write out what's left in the pipe by hand,
+            // which also records any real error
+            value_splice_ = false;
+            break;
+        }
+        value_bytes_read_ += moved;
+        in_pipe -= moved;
+    }
+    // Copy out whatever the file didn't take through the receive buffer, which is empty here
+    while (in_pipe > 0) {
+        ssize_t n = read(pipe_[0], buffer_.data(), std::min(in_pipe, buffer_.size()));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        CHECK_GT(n, 0) << "Failed to drain pipe";
+        ConsumeValue(buffer_.data(), n);
+        in_pipe -= n;
+    }
+    return status;
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+// Reads as much as is available into the receive buffer, first making sure it has room for
+// at least `needed` unparsed bytes. Returns kDone if any bytes were read.
+NonblockingStringStatus NonblockingPacketReader::Fill(size_t needed) {
+    if (buffer_start_ > 0) {
+        // Only a partial packet is left, so moving it to the front is cheap
+        size_t n = buffered();
+        memmove(buffer_.data(), buffer_.data() + buffer_start_, n);
+        buffer_start_ = 0;
+        buffer_end_ = n;
+    }
+    if (buffer_.size() < needed) {
+        buffer_.resize(needed);
+    }
+
+    while (true) {
+        ssize_t status = ReadInto(buffer_.data() + buffer_end_, buffer_.size() - buffer_end_);
+        if (status == 0) {
+            // Unexpected EOF
+            return kFailed;
+        }
+        if (status < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return kInProgress;
+            }
+            // Encountered an irrecoverable error
+            return kFailed;
+        }
+        buffer_end_ += status;
+        return kDone;
+    }
+}
+
+ssize_t NonblockingPacketReader::ReadInto(char *buf, size_t size) {
+    SocketIoInterface *io = socket_wrapper_->io();
+    if (io != NULL) {
+        return io->Read(buf, size);
+    }
+    if (socket_wrapper_->getSSL()) {
+        return SSL_read(socket_wrapper_->getSSL(), buf, size);
+    }
+    return read(socket_wrapper_->fd(), buf, size);
 }
 
 } // namespace kinetic
@@ -19,8 +19,10 @@
 #define KINETIC_CPP_CLIENT_NONBLOCKING_PACKET_H_
 
 #include <memory>
+#include <vector>
 
 #include "kinetic/common.h"
+#include "kinetic/outgoing_value.h"
 
 #include "kinetic_client.pb.h"
 #include "nonblocking_string.h"
@@ -45,52 +47,149 @@ enum State {
 class NonblockingPacketWriterInterface {
     public:
     virtual ~NonblockingPacketWriterInterface() {}
+    // Returns kDone each time the next packet, in the order they were added, has been written out
+    // completely; callers keep calling Write() until every packet has been reported.
     virtual NonblockingStringStatus Write() = 0;
+    // Adds another packet to go out in the same gather writes. Only valid before the first Write().
+    virtual void Append(unique_ptr<Message> message, const shared_ptr<const string> value) = 0;
+    // As above, but the value is streamed from value rather than held in memory
+    virtual void Append(unique_ptr<Message> message, const shared_ptr<const OutgoingValueInterface> value) = 0;
 };
 
+// Writes one or more complete packets (9 byte header, serialized message and value) using a single
+// gather write per attempt that spans as many of them as possible. Partial writes are resumed on
+// the next call to Write(), wherever in the run of packets they stopped. Each message's command
+// bytes are sent from their own buffer rather than copied into the frame. Values given as an
+// OutgoingValueInterface are sent straight from their file with sendfile where possible, and
+// otherwise a bounded chunk at a time, so they are never held in memory in full.
 class NonblockingPacketWriter : public NonblockingPacketWriterInterface {
     public:
-    NonblockingPacketWriter(shared_ptr<SocketWrapperInterface> socket_wrapper, unique_ptr<const Message> message,
+    NonblockingPacketWriter(shared_ptr<SocketWrapperInterface> socket_wrapper, unique_ptr<Message> message,
             const shared_ptr<const string> value);
+    NonblockingPacketWriter(shared_ptr<SocketWrapperInterface> socket_wrapper, unique_ptr<Message> message,
+            const shared_ptr<const OutgoingValueInterface> value);
     ~NonblockingPacketWriter();
     NonblockingStringStatus Write();
+    void Append(unique_ptr<Message> message, const shared_ptr<const string> value);
+    void Append(unique_ptr<Message> message, const shared_ptr<const OutgoingValueInterface> value);
 
     private:
-    bool TransitionFromMagic();
-    void TransitionFromMessageLength();
-    void TransitionFromValueLength();
-    void TransitionFromMessage();
-    void TransitionFromValue();
+    struct Packet {
+        size_t value_size() const;
+        unique_ptr<Message> message;
+        // Exactly one of these holds the value
+        shared_ptr<const string> value;
+        shared_ptr<const OutgoingValueInterface> source;
+        // Whether source is still to be sent with sendfile
+        bool sendfile;
+        // The header followed by the serialized message minus its command bytes, which are sent
+        // straight from command_bytes; likewise the value is sent straight from value
+        std::string frame;
+        std::string command_bytes;
+        // Offset just past this packet in the stream of all packets' bytes
+        size_t end;
+    };
+
+    void AppendPacket(unique_ptr<Message> message, const shared_ptr<const string> value,
+            const shared_ptr<const OutgoingValueInterface> source);
+    bool PrepareFrame(Packet *packet);
+    ssize_t WriteSegments();
+    const string *SourceChunk(size_t packet, size_t offset);
+    ssize_t SendFile(Packet *packet, size_t offset);
+    ssize_t WriteTls(const struct iovec *iov, int iovcnt);
     shared_ptr<SocketWrapperInterface> socket_wrapper_;
-    unique_ptr<const Message> message_;
-    const shared_ptr<const string> value_;
+    std::vector<Packet> packets_;
     State state_;
-    NonblockingStringWriter *writer_;
-    std::string serialized_message_;
+    // Index of the next packet whose completion Write() will report
+    size_t next_packet_;
+    size_t bytes_written_;
+    // The part of a streamed value that is being sent: bytes [chunk_offset_, chunk_offset_ +
+    // chunk_.size()) of packet chunk_packet_'s source
+    std::string chunk_;
+    size_t chunk_packet_;
+    size_t chunk_offset_;
+    // Segments gathered into one TLS record; kept until SSL_write has taken all of it, since a
+    // write that would block has to be retried with the same bytes
+    std::string tls_buffer_;
     DISALLOW_COPY_AND_ASSIGN(NonblockingPacketWriter);
 };
 
+class PacketMessageListenerInterface {
+    public:
+    virtual ~PacketMessageListenerInterface() {}
+    // Called once a packet's message has been parsed and before its value is read. The command
+    // bytes are not copied into the message; they're passed separately and are only valid for the
+    // duration of the call. Returning memory of at least value_size bytes makes the value land
+    // there directly; returning NULL has it delivered as a string.
+    virtual char *MessageReceived(const Message &message, const char *command_bytes,
+            size_t command_length, size_t value_size) = 0;
+    // Asked when MessageReceived returned NULL for a non-empty value. Returning a file descriptor
+    // has the value written to it, starting at *offset or at the descriptor's current position if
+    // *offset is left at -1; returning -1 delivers the value as a string.
+    virtual int ValueFile(size_t value_size, off_t *offset) {
+        return -1;
+    }
+};
+
+// Reads packets off a connection. Bytes are pulled from the socket in large chunks into a receive
+// buffer that lives as long as the reader, and frames are parsed in place out of that buffer, so a
+// single read can complete many pipelined responses. Each call to Read() that returns kDone has
+// decoded one more packet into the response and value; leftover bytes are kept for the next call.
+// Values the listener wants in a file are moved there with splice through a pipe on plain sockets,
+// and through the receive buffer otherwise, so they're never held in memory in full.
 class NonblockingPacketReader {
     public:
-    NonblockingPacketReader(shared_ptr<SocketWrapperInterface> socket_wrapper, Message* response, unique_ptr<const string>& value);
+    NonblockingPacketReader(shared_ptr<SocketWrapperInterface> socket_wrapper, Message* response, unique_ptr<const string>& value,
+            PacketMessageListenerInterface *listener = NULL);
     ~NonblockingPacketReader();
     NonblockingStringStatus Read();
+    // Whether part of a packet has been consumed and the rest is still outstanding
+    bool in_progress() const;
+    // Stops receiving the current value into memory or a file obtained from the listener. The rest
+    // of the value is read and dropped instead.
+    void DetachValueDestination();
+    // The errno of a failed write of the last value to its file, or 0. The rest of such a value is
+    // read and dropped, so the connection stays usable.
+    int value_file_error() const;
 
     private:
-    bool TransitionFromMagic();
-    void TransitionFromMessageLength();
-    void TransitionFromValueLength();
-    void TransitionFromMessage();
-    bool TransitionFromValue();
+    size_t buffered() const;
+    NonblockingStringStatus Fill(size_t needed);
+    bool ParseMessage();
+    NonblockingStringStatus ReadValue();
+    void ConsumeValue(const char *data, size_t n);
+    void WriteToFile(const char *data, size_t n);
+    ssize_t SpliceToFile(size_t remaining);
+    void ResetValueTarget();
+    ssize_t ReadInto(char *buf, size_t size);
     shared_ptr<SocketWrapperInterface> socket_wrapper_;
     Message* const response_;
     State state_;
     unique_ptr<const string>& value_;
-    unique_ptr<const string> magic_;
-    unique_ptr<const string> message_length_;
-    unique_ptr<const string> value_length_;
-    unique_ptr<const string> message_;
-    NonblockingStringReader* reader_;
+    std::vector<char> buffer_;
+    // Unparsed bytes live in buffer_[buffer_start_, buffer_end_)
+    size_t buffer_start_;
+    size_t buffer_end_;
+    uint32_t message_length_;
+    uint32_t value_length_;
+    PacketMessageListenerInterface *listener_;
+    unique_ptr<string> pending_value_;
+    // Where the rest of the value goes once it no longer passes through pending_value_'s append;
+    // either memory from listener_ or pending_value_'s own storage
+    char *value_target_;
+    bool value_target_external_;
+    size_t value_bytes_read_;
+    // The file the current value goes to, if any, and where in it the value starts (-1 for the
+    // file's current position)
+    int value_fd_;
+    off_t value_fd_offset_;
+    // Whether the rest of the current value may be spliced into value_fd_
+    bool value_splice_;
+    // Whether the rest of the current value is to be dropped
+    bool value_discard_;
+    int value_file_error_;
+    // Carries spliced values from the socket to their file; opened on first use
+    int pipe_[2];
     DISALLOW_COPY_AND_ASSIGN(NonblockingPacketReader);
 };
 
@@ -98,13 +197,17 @@ class NonblockingPacketWriterFactoryInterface {
     public:
     virtual ~NonblockingPacketWriterFactoryInterface() {}
     virtual unique_ptr<NonblockingPacketWriterInterface> CreateWriter(shared_ptr<SocketWrapperInterface> socket_wrapper,
-        unique_ptr<const Message> message, const shared_ptr<const string> value) = 0;
+        unique_ptr<Message> message, const shared_ptr<const string> value) = 0;
+    virtual unique_ptr<NonblockingPacketWriterInterface> CreateWriter(shared_ptr<SocketWrapperInterface> socket_wrapper,
+        unique_ptr<Message> message, const shared_ptr<const OutgoingValueInterface> value) = 0;
 };
 
 class NonblockingPacketWriterFactory : public NonblockingPacketWriterFactoryInterface {
     public:
     unique_ptr<NonblockingPacketWriterInterface> CreateWriter(shared_ptr<SocketWrapperInterface> socket_wrapper,
-        unique_ptr<const Message> message, const shared_ptr<const string> value);
+        unique_ptr<Message> message, const shared_ptr<const string> value);
+    unique_ptr<NonblockingPacketWriterInterface> CreateWriter(shared_ptr<SocketWrapperInterface> socket_wrapper,
+        unique_ptr<Message> message, const shared_ptr<const OutgoingValueInterface> value);
 };
 
 } // namespace kinetic
@@ -16,9 +16,7 @@
  */
 
 #include "nonblocking_packet_receiver.h"
-#include <exception>
-#include <stdexcept>
-#include <ctime>
+#include <cstring>
 
 namespace kinetic {
 
@@ -28,7 +26,7 @@ using std::string;
 using std::shared_ptr;
 using std::unique_ptr;
 using std::move;
-using std::make_pair;
+using std::vector;
 
 
 
@@ -77,44 +75,28 @@ KineticStatus GetKineticStatus(StatusCode code, int64_t expected_cluster_version
     }
 }
 
-class HandshakeHandler : public HandlerInterface{
-public:
-    bool done;
-    bool success;
-    HandshakeHandler():done(false),success(false){}
-    void Handle(const Command &response, unique_ptr<const string> value){
-        done = success = true;
-    }
-    void Error(KineticStatus error, Command const * const response){
-        done = true;
-    }
+// Stands in for the handshake status when nobody is interested in it
+class IgnoreHandshakeHandler : public HandlerInterface {
+    public:
+    void Handle(const Command &response, unique_ptr<const string> value) {}
+    void Error(KineticStatus error, Command const * const response) {}
 };
 
 NonblockingReceiver::NonblockingReceiver(shared_ptr<SocketWrapperInterface> socket_wrapper,
-    HmacProvider hmac_provider, const ConnectionOptions &connection_options)
+    HmacProvider hmac_provider, const ConnectionOptions &connection_options,
+    shared_ptr<HandlerInterface> handshake)
 : socket_wrapper_(socket_wrapper), hmac_provider_(hmac_provider),
 connection_options_(connection_options), nonblocking_response_(NULL),
-connection_id_(0), handler_() {
-
-    shared_ptr<HandshakeHandler> hh = std::make_shared<HandshakeHandler>();
-    map_.insert(make_pair(-1,make_pair(hh,-1)));
-    handler_to_message_seq_map_.insert(make_pair(-1, -1));
-
-
-    auto start = std::time(0);
-
-    while(true){
-        if(Receive() == kError)
-            break;
-        if(hh->done)
-            break;
-        auto now = std::time(0);
-        if(now-start > 30)
-            break;
+connection_id_(0), handler_(), hmac_valid_(false), command_parsed_(false),
+value_destination_active_(false), value_destination_key_(0) {
+    // The reader and its receive buffer live as long as the connection, so any responses that
+    // arrive together with the handshake are kept for later
+    nonblocking_response_ = new NonblockingPacketReader(socket_wrapper_, &message_, value_, this);
+
+    if (!handshake) {
+        handshake = std::make_shared<IgnoreHandshakeHandler>();
     }
-    if(!hh->success)
-        throw std::runtime_error("Could not complete handshake.");
-
+    in_flight_.Insert(-1, handshake, -1);
 }
 
 NonblockingReceiver::~NonblockingReceiver() {
@@ -126,37 +108,14 @@ NonblockingReceiver::~NonblockingReceiver() {
 
 bool NonblockingReceiver::Enqueue(shared_ptr<HandlerInterface> handler, google::int64 sequence,
     HandlerKey handler_key) {
-    auto seq_to_handler_res = map_.insert(make_pair(sequence, make_pair(handler, handler_key)));
-    if (!seq_to_handler_res.second) {
-        LOG(WARNING) << "Found existing handler for sequence " << sequence;
-        return false;
-    }
-    auto handler_key_to_seq_res =
-        handler_to_message_seq_map_.insert(make_pair(handler_key, sequence));
-    if (!handler_key_to_seq_res.second) {
-        LOG(WARNING) << "Found existing sequence " << sequence << " for handler_key "
-            << handler_key;
-        auto handler_map_entry = map_.find(sequence);
-        CHECK(handler_map_entry != map_.end())
-                    << "Couldn't find just-inserted handler map entry for sequence "
-                    << sequence;
-        map_.erase(handler_map_entry);
-        return false;
-    }
-    return true;
+    return in_flight_.Insert(sequence, move(handler), handler_key);
 }
 
 
 NonblockingPacketServiceStatus NonblockingReceiver::Receive() {
     while (true) {
-        if (nonblocking_response_ == NULL) {
-            if (map_.empty()) {
-                return kIdle;
-            }
-
-            // Start working on the next thing in the request queue
-            nonblocking_response_ = new NonblockingPacketReader(
-                socket_wrapper_, &message_, value_);
+        if (!nonblocking_response_->in_progress() && in_flight_.empty()) {
+            return kIdle;
         }
 
         NonblockingStringStatus status = nonblocking_response_->Read();
@@ -167,19 +126,15 @@ NonblockingPacketServiceStatus NonblockingReceiver::Receive() {
             CallAllErrorHandlers(KineticStatus(StatusCode::CLIENT_IO_ERROR, "I/O read error"));
             return kError;
         }
+        value_destination_active_ = false;
 
-        // We're done receiving this response
-        delete nonblocking_response_;
-        nonblocking_response_ = NULL;
-
-        if(message_.has_hmacauth())
-        if (!hmac_provider_.ValidateHmac(message_, connection_options_.hmac_key)) {
+        if (!hmac_valid_) {
             LOG(INFO) << "Response HMAC mismatch";
             CallAllErrorHandlers(KineticStatus(StatusCode::CLIENT_RESPONSE_HMAC_VERIFICATION_ERROR,
                 "Response HMAC mismatch"));
             return kIdle;
         }
-        if(!command_.ParseFromString(message_.commandbytes())){
+        if(!command_parsed_){
             CallAllErrorHandlers(KineticStatus(StatusCode::CLIENT_IO_ERROR, "I/O read error parsing proto::Command"));
             return kError;
         }
@@ -197,21 +152,19 @@ NonblockingPacketServiceStatus NonblockingReceiver::Receive() {
             return kIdle;
         }
 
-        auto find_result = map_.find(command_.header().acksequence());
-        if (find_result == map_.end()) {
+        InFlightRequest request;
+        if (!in_flight_.Take(command_.header().acksequence(), &request)) {
             LOG(WARNING) << "Couldn't find a handler for acksequence " <<
                 command_.header().acksequence();
             continue;
         }
-        auto handler_pair = find_result->second;
-        handler_ = handler_pair.first;
-        map_.erase(find_result);
+        handler_ = move(request.handler);
 
-        CHECK_EQ((size_t) 1, handler_to_message_seq_map_.erase(handler_pair.second))
-                << "Couldn't delete handler key to sequence entry for handler_key "
-                << handler_pair.second;
-
-        if (command_.status().code() == Command_Status_StatusCode_SUCCESS) {
+        int file_error = nonblocking_response_->value_file_error();
+        if (file_error != 0) {
+            handler_->Error(KineticStatus(StatusCode::CLIENT_IO_ERROR,
+                string("Could not write value to file: ") + strerror(file_error)), &command_);
+        } else if (command_.status().code() == Command_Status_StatusCode_SUCCESS) {
             handler_->Handle(command_, move(value_));
         } else {
             handler_->Error(GetKineticStatus(ConvertFromProtoStatus(
@@ -223,6 +176,50 @@ NonblockingPacketServiceStatus NonblockingReceiver::Receive() {
     }
 }
 
+char *NonblockingReceiver::MessageReceived(const Message &message, const char *command_bytes,
+        size_t command_length, size_t value_size) {
+    hmac_valid_ = !message.has_hmacauth() || hmac_provider_.ValidateHmac(message, command_bytes,
+        command_length, connection_options_.hmac_key);
+    command_parsed_ = command_.ParseFromArray(command_bytes, command_length);
+    if (value_size == 0 || message.authtype() == Message_AuthType_UNSOLICITEDSTATUS) {
+        return NULL;
+    }
+    auto handler = ValueHandler();
+    if (handler == NULL) {
+        return NULL;
+    }
+    char *destination = handler->handler->ValueDestination(command_, value_size);
+    if (destination != NULL) {
+        value_destination_active_ = true;
+        value_destination_key_ = handler->handler_key;
+    }
+    return destination;
+}
+
+int NonblockingReceiver::ValueFile(size_t value_size, off_t *offset) {
+    if (message_.authtype() == Message_AuthType_UNSOLICITEDSTATUS) {
+        return -1;
+    }
+    auto handler = ValueHandler();
+    if (handler == NULL) {
+        return -1;
+    }
+    int fd = handler->handler->ValueFile(command_, value_size, offset);
+    if (fd >= 0) {
+        value_destination_active_ = true;
+        value_destination_key_ = handler->handler_key;
+    }
+    return fd;
+}
+
+// The handler waiting for the response whose command was just parsed, if the response checks out
+const InFlightRequest *NonblockingReceiver::ValueHandler() {
+    if (!hmac_valid_ || !command_parsed_ || !command_.header().has_acksequence()) {
+        return NULL;
+    }
+    return in_flight_.Find(command_.header().acksequence());
+}
+
 int64_t NonblockingReceiver::connection_id() {
     return connection_id_;
 }
@@ -233,41 +230,38 @@ void NonblockingReceiver::CallAllErrorHandlers(KineticStatus error) {
         handler_.reset();
     }
 
-    auto iter = map_.begin();
-    while (iter != map_.end()) {
-        auto handler_pair = iter->second;
-        shared_ptr<HandlerInterface> handler = handler_pair.first;
-        HandlerKey handler_key = handler_pair.second;
-
-        CHECK_EQ((size_t) 1, handler_to_message_seq_map_.erase(handler_key))
-                << "Couldn't delete handler to sequence entry for handler_key " << handler_key;
-
-        handler->Error(error, NULL);
-        handler.reset();
-        iter++;
+    vector<InFlightRequest> requests;
+    in_flight_.TakeAll(&requests);
+    for (auto &request : requests) {
+        request.handler->Error(error, NULL);
+        request.handler.reset();
     }
-    map_.clear();
 }
 
 bool NonblockingReceiver::Remove(HandlerKey key) {
-    auto handler_key_to_seq = handler_to_message_seq_map_.find(key);
-    if (handler_key_to_seq == handler_to_message_seq_map_.end()) {
+    InFlightRequest request;
+    return Take(key, &request);
+}
+
+bool NonblockingReceiver::Fail(HandlerKey key, KineticStatus error) {
+    InFlightRequest request;
+    if (!Take(key, &request)) {
         return false;
     }
+    request.handler->Error(error, NULL);
+    return true;
+}
 
-    google::protobuf::int64 seq = handler_key_to_seq->second;
-
-    handler_to_message_seq_map_.erase(handler_key_to_seq);
-
-    auto seq_to_handler = map_.find(seq);
-    CHECK(seq_to_handler != map_.end()) << "Handler key " << handler_key_to_seq->first
-        << " mapped to seq " << seq << " but no handler entry for that seq";
-
-    auto handler_pair = seq_to_handler->second;
-    auto handler_key = handler_pair.second;
-    CHECK_EQ(handler_key, key);
-    map_.erase(seq_to_handler);
+bool NonblockingReceiver::Take(HandlerKey key, InFlightRequest *request) {
+    if (!in_flight_.TakeByKey(key, request)) {
+        return false;
+    }
 
+    if (value_destination_active_ && value_destination_key_ == key) {
+        // The handler's memory may go away with it, so the rest of the value can't land there
+        nonblocking_response_->DetachValueDestination();
+        value_destination_active_ = false;
+    }
     return true;
 }
 
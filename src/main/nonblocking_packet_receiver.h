@@ -21,6 +21,7 @@
 #include <sys/select.h>
 #include <cstdint>
 
+#include <atomic>
 #include <queue>
 #include <unordered_map>
 #include <glog/logging.h>
@@ -29,6 +30,7 @@
 #include "kinetic/connection_options.h"
 #include "kinetic/hmac_provider.h"
 #include "kinetic_client.pb.h"
+#include "in_flight_table.h"
 #include "nonblocking_packet.h"
 #include "socket_wrapper_interface.h"
 
@@ -59,36 +61,55 @@ class NonblockingReceiverInterface {
     virtual NonblockingPacketServiceStatus Receive() = 0;
     virtual int64_t connection_id() = 0;
     virtual bool Remove(HandlerKey key) = 0;
+    // Like Remove, but the handler is told error. A response that arrives for the request later
+    // is dropped.
+    virtual bool Fail(HandlerKey key, KineticStatus error) = 0;
 };
 
-class NonblockingReceiver : public NonblockingReceiverInterface {
+class NonblockingReceiver : public NonblockingReceiverInterface, public PacketMessageListenerInterface {
     public:
-    explicit NonblockingReceiver(shared_ptr<SocketWrapperInterface> socket_wrapper,
-        HmacProvider hmac_provider, const ConnectionOptions &connection_options);
+    // The drive opens every connection with an unsolicited status, which is received like any
+    // response and passed to handshake. Nothing waits for it here.
+    NonblockingReceiver(shared_ptr<SocketWrapperInterface> socket_wrapper,
+        HmacProvider hmac_provider, const ConnectionOptions &connection_options,
+        shared_ptr<HandlerInterface> handshake = shared_ptr<HandlerInterface>());
     ~NonblockingReceiver();
     bool Enqueue(shared_ptr<HandlerInterface> handler, google::int64 sequence,
             HandlerKey handler_key);
     NonblockingPacketServiceStatus Receive();
     int64_t connection_id();
     bool Remove(HandlerKey key);
+    bool Fail(HandlerKey key, KineticStatus error);
+    char *MessageReceived(const Message &message, const char *command_bytes, size_t command_length,
+        size_t value_size);
+    int ValueFile(size_t value_size, off_t *offset);
 
     private:
     void CallAllErrorHandlers(KineticStatus error);
+    const InFlightRequest *ValueHandler();
+    bool Take(HandlerKey key, InFlightRequest *request);
 
     shared_ptr<SocketWrapperInterface> socket_wrapper_;
     HmacProvider hmac_provider_;
     ConnectionOptions connection_options_;
     NonblockingPacketReader *nonblocking_response_;
-    int64_t connection_id_;
+    // Read by the sender from whichever thread is enqueueing a request
+    std::atomic<int64_t> connection_id_;
     shared_ptr<HandlerInterface> handler_;
     Message message_;
     Command command_;
+    // The message is authenticated and its command parsed as soon as it arrives, straight from
+    // the receive buffer; the outcome is acted on once the value has been read as well
+    bool hmac_valid_;
+    bool command_parsed_;
+    // Set while a value is being received into memory or a file supplied by this handler
+    bool value_destination_active_;
+    HandlerKey value_destination_key_;
     unique_ptr<const string> value_;
-    unordered_map<google::protobuf::int64, pair<shared_ptr<HandlerInterface>, HandlerKey>> map_;
     // handler_key is separate from message sequence so that we don't tie handler identification
     // semantics to the message sequencing, since message sequence semantics are outside of our
     // control.
-    unordered_map<HandlerKey, google::protobuf::int64> handler_to_message_seq_map_;
+    InFlightTable in_flight_;
     DISALLOW_COPY_AND_ASSIGN(NonblockingReceiver);
 };
 
@@ -17,6 +17,11 @@
 
 #include "nonblocking_packet_sender.h"
 
+#include <algorithm>
+
+#include "key_value_codec.h"
+#include "zero_copy_sender.h"
+
 namespace kinetic {
 
 using std::string;
@@ -24,6 +29,7 @@ using std::shared_ptr;
 using std::unique_ptr;
 using std::move;
 using std::make_pair;
+using std::max;
 
 NonblockingSender::NonblockingSender(shared_ptr<SocketWrapperInterface> socket_wrapper,
                                      shared_ptr<NonblockingReceiverInterface> receiver,
@@ -35,33 +41,79 @@ NonblockingSender::NonblockingSender(shared_ptr<SocketWrapperInterface> socket_w
         packet_writer_factory_(packet_writer_factory),
         hmac_provider_(hmac_provider),
         connection_options_(connection_options),
-        sequence_number_(0),
         current_writer_(),
-        handler_()
+        pending_writes_(),
+        sequence_number_(0)
 {}
 
 void NonblockingSender::Enqueue(unique_ptr<Message> message, unique_ptr<Command> command,
     const shared_ptr<const string> value, unique_ptr<HandlerInterface> handler,
     HandlerKey handler_key) {
+    unique_ptr<Request> request(new Request());
+    request->value = value;
+    request->handler = move(handler);
+    request->handler_key = handler_key;
+    EnqueueRequest(move(message), move(command), move(request));
+}
+
+void NonblockingSender::Enqueue(unique_ptr<Message> message, unique_ptr<Command> command,
+    const shared_ptr<const OutgoingValueInterface> value, unique_ptr<HandlerInterface> handler,
+    HandlerKey handler_key) {
+    unique_ptr<Request> request(new Request());
+    request->value_source = value;
+    request->handler = move(handler);
+    request->handler_key = handler_key;
+    EnqueueRequest(move(message), move(command), move(request));
+}
+
+void NonblockingSender::EnqueueRequest(unique_ptr<Message> message, unique_ptr<Command> command,
+    unique_ptr<Request> request) {
+    int64_t sequence;
+    unique_ptr<HmacProvider> signer;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        sequence = sequence_number_++;
+        encoding_.insert(sequence);
+        if (!idle_signers_.empty()) {
+            signer = move(idle_signers_.back());
+            idle_signers_.pop_back();
+        }
+    }
+    if (!signer) {
+        signer.reset(new HmacProvider(hmac_provider_));
+    }
 
     command->mutable_header()->set_connectionid(receiver_->connection_id());
-    command->mutable_header()->set_sequence(sequence_number_++);
+    command->mutable_header()->set_sequence(sequence);
     /* COMMAND PART OF MESSAGE IS FINALIZED */
-    message->set_commandbytes(command->SerializeAsString());
+    // Serialize straight into the message; the packet writer sends these bytes as they are. GETs,
+    // PUTs and DELETEs skip the generic protobuf serializer and produce the same bytes directly.
+    KeyValueRequest key_value_request;
+    if (KeyValueRequestFromCommand(*command, &key_value_request)) {
+        EncodeKeyValueRequest(key_value_request, message->mutable_commandbytes());
+    } else {
+        command->SerializeToString(message->mutable_commandbytes());
+    }
 
     if(message->authtype() == com::seagate::kinetic::client::proto::Message_AuthType_HMACAUTH){
         message->mutable_hmacauth()->set_identity(connection_options_.user_id);
-        message->mutable_hmacauth()->set_hmac(hmac_provider_.ComputeHmac(*message, connection_options_.hmac_key));
+        message->mutable_hmacauth()->set_hmac(signer->ComputeHmac(*message, connection_options_.hmac_key));
     }
 
-    unique_ptr<Request> request(new Request());
     request->message = move(message);
     request->command = move(command);
-    request->value = value;
-    request->handler = move(handler);
-    request->handler_key = handler_key;
 
-    request_queue_.push_back(move(request));
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    encoding_.erase(sequence);
+    idle_signers_.push_back(move(signer));
+    // Another thread may have queued a later sequence number while this one was being signed
+    auto position = request_queue_.end();
+    while (position != request_queue_.begin() &&
+            (*(position - 1))->command->header().sequence() > sequence) {
+        --position;
+    }
+    queued_keys_.insert(request->handler_key);
+    request_queue_.insert(position, move(request));
 }
 
 NonblockingSender::~NonblockingSender() {
@@ -75,20 +127,16 @@ NonblockingSender::~NonblockingSender() {
 }
 
 NonblockingPacketServiceStatus NonblockingSender::Send() {
-    while (true) {
-        if (!current_writer_) {
-            if (request_queue_.empty()) {
-                return kIdle;
-            }
+    // Pending notifications make the socket poll as errored, so they're picked up on every pass
+    // and not just when another large value is written
+    ZeroCopySender *zero_copy = socket_wrapper_->zero_copy();
+    if (zero_copy != NULL) {
+        zero_copy->ReapCompletions();
+    }
 
-            // Start working on the next thing on the request queue
-            unique_ptr<Request> request = move(request_queue_.front());
-            request_queue_.pop_front();
-            message_sequence_ = request->command->header().sequence();
-            handler_key_ = request->handler_key;
-            current_writer_ =
-                packet_writer_factory_->CreateWriter(socket_wrapper_, move(request->message), request->value);
-            handler_ = move(request->handler);
+    while (true) {
+        if (!current_writer_ && !StartWriter()) {
+            return kIdle;
         }
 
         NonblockingStringStatus status = current_writer_->Write();
@@ -99,40 +147,159 @@ NonblockingPacketServiceStatus NonblockingSender::Send() {
 
             CHECK_EQ(kFailed, status);
 
-            handler_->Error(
-                    KineticStatus(StatusCode::CLIENT_IO_ERROR, "I/O write error"), NULL);
-            handler_.reset();
+            for (auto it = pending_writes_.begin(); it != pending_writes_.end(); ++it) {
+                if (!it->handler) {
+                    continue;
+                }
+                it->handler->Error(
+                        KineticStatus(StatusCode::CLIENT_IO_ERROR, "I/O write error"), NULL);
+            }
+            pending_writes_.clear();
 
-            while (!request_queue_.empty()) {
-                unique_ptr<Request> request = move(request_queue_.front());
-                request_queue_.pop_front();
-                request->handler->Error(KineticStatus(StatusCode::CLIENT_IO_ERROR,
+            // Handlers may enqueue more requests, so they're called without the queue locked
+            deque<unique_ptr<Request>> failed;
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex_);
+                failed.swap(request_queue_);
+                queued_keys_.clear();
+            }
+            for (auto it = failed.begin(); it != failed.end(); ++it) {
+                (*it)->handler->Error(KineticStatus(StatusCode::CLIENT_IO_ERROR,
                     "I/O write error"), NULL);
             }
             return kError;
         }
 
-        // We're done with this request
-        current_writer_.reset();
+        // The oldest packet in the writer has gone out; its response may arrive as soon as the
+        // receiver next runs, even if later packets are still only partly written
+        PendingWrite pending = pending_writes_.front();
+        pending_writes_.pop_front();
+        if (pending_writes_.empty()) {
+            current_writer_.reset();
+        }
+        if (!pending.handler) {
+            continue;
+        }
 
-        if (!receiver_->Enqueue(handler_, message_sequence_, handler_key_)) {
+        if (!receiver_->Enqueue(pending.handler, pending.sequence, pending.handler_key)) {
             LOG(WARNING) << "Could not enqueue handler; already had a handler for sequence " <<
-                message_sequence_ << " and handler key " << handler_key_;
-            handler_->Error(KineticStatus(StatusCode::CLIENT_INTERNAL_ERROR,
+                pending.sequence << " and handler key " << pending.handler_key;
+            pending.handler->Error(KineticStatus(StatusCode::CLIENT_INTERNAL_ERROR,
                 "Could not enqueue handler"), NULL);
         }
-        handler_.reset();
     }
 }
 
-bool NonblockingSender::Remove(HandlerKey key) {
+bool NonblockingSender::StartWriter() {
+    // Gather the front of the queue into one writer so that a burst of requests goes out in as
+    // few writes as possible, within the configured count and byte budget. The first request
+    // always goes, however large.
+    size_t max_requests = max<size_t>(connection_options_.max_coalesced_requests, 1);
+    size_t bytes = 0;
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    while (!request_queue_.empty() && pending_writes_.size() < max_requests) {
+        Request *request = request_queue_.front().get();
+        if (!encoding_.empty() &&
+                request->command->header().sequence() > *encoding_.begin()) {
+            // An earlier request is still being signed
+            break;
+        }
+        size_t request_bytes = request->message->commandbytes().size() +
+            (request->value_source ? request->value_source->size() : request->value->size());
+        if (!pending_writes_.empty() && bytes + request_bytes > connection_options_.max_coalesced_bytes) {
+            break;
+        }
+        bytes += request_bytes;
+
+        PendingWrite pending;
+        pending.handler = move(request->handler);
+        pending.sequence = request->command->header().sequence();
+        pending.handler_key = request->handler_key;
+        pending_writes_.push_back(pending);
+        if (current_writer_) {
+            if (request->value_source) {
+                current_writer_->Append(move(request->message), request->value_source);
+            } else {
+                current_writer_->Append(move(request->message), request->value);
+            }
+        } else if (request->value_source) {
+            current_writer_ =
+                packet_writer_factory_->CreateWriter(socket_wrapper_, move(request->message), request->value_source);
+        } else {
+            current_writer_ =
+                packet_writer_factory_->CreateWriter(socket_wrapper_, move(request->message), request->value);
+        }
+        queued_keys_.erase(request->handler_key);
+        request_queue_.pop_front();
+    }
+    return current_writer_ != NULL;
+}
+
+unique_ptr<NonblockingSender::Request> NonblockingSender::TakeQueued(HandlerKey key) {
+    unique_ptr<Request> request;
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (queued_keys_.erase(key) == 0) {
+        return request;
+    }
     for (auto it = request_queue_.begin(); it != request_queue_.end(); it++) {
         if ((*it)->handler_key == key) {
+            request = move(*it);
             request_queue_.erase(it);
+            break;
+        }
+    }
+    return request;
+}
+
+bool NonblockingSender::Remove(HandlerKey key) {
+    // Discarding a handler can call back into the client, so it's destroyed without the queue
+    // locked
+    unique_ptr<Request> request = TakeQueued(key);
+    if (request) {
+        return true;
+    }
+
+    // The packet may already be in the current writer; it still goes out, but its handler
+    // never reaches the receiver. pending_writes_ is only touched by Send(), which doesn't run
+    // concurrently with this.
+    for (auto it = pending_writes_.begin(); it != pending_writes_.end(); ++it) {
+        if (it->handler_key == key && it->handler) {
+            it->handler.reset();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool NonblockingSender::Fail(HandlerKey key, KineticStatus error) {
+    unique_ptr<Request> request = TakeQueued(key);
+    if (request) {
+        request->handler->Error(error, NULL);
+        return true;
+    }
+
+    // pending_writes_ is only touched by Send(), which doesn't run concurrently with this
+    for (auto it = pending_writes_.begin(); it != pending_writes_.end(); ++it) {
+        if (it->handler_key == key && it->handler) {
+            shared_ptr<HandlerInterface> handler = move(it->handler);
+            handler->Error(error, NULL);
             return true;
         }
     }
     return false;
 }
 
+void NonblockingSender::FailAll(KineticStatus error) {
+    // Handlers may enqueue more requests, so they're called without the queue locked
+    deque<unique_ptr<Request>> failed;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        failed.swap(request_queue_);
+        queued_keys_.clear();
+    }
+    for (auto it = failed.begin(); it != failed.end(); ++it) {
+        (*it)->handler->Error(error, NULL);
+    }
+}
+
 } // namespace kinetic
@@ -21,8 +21,12 @@
 #include <sys/select.h>
 #include <cstdint>
 
+#include <mutex>
 #include <queue>
+#include <set>
+#include <unordered_set>
 #include <unordered_map>
+#include <vector>
 #include <glog/logging.h>
 
 #include "kinetic/nonblocking_packet_service_interface.h"
@@ -48,13 +52,26 @@ using std::unordered_map;
 class NonblockingSenderInterface {
     public:
     virtual ~NonblockingSenderInterface() {}
-    // The HandlerKey returned will be unique for the lifespan of the Sender instance.
+    // The HandlerKey returned will be unique for the lifespan of the Sender instance. Enqueue may
+    // be called from several threads at once and while another thread is in Send(), Remove() or
+    // Fail(); those must not run concurrently with each other.
     virtual void Enqueue(unique_ptr<Message> message, unique_ptr<Command> command, const shared_ptr<const string> value,
             unique_ptr<HandlerInterface> handler, HandlerKey handler_key) = 0;
+    // As above, but the value is streamed from value as it's written
+    virtual void Enqueue(unique_ptr<Message> message, unique_ptr<Command> command,
+            const shared_ptr<const OutgoingValueInterface> value, unique_ptr<HandlerInterface> handler,
+            HandlerKey handler_key) = 0;
     virtual NonblockingPacketServiceStatus Send() = 0;
     // remove the handler if it hasn't already started being processed. Returns true if a handler
     // actually was removed.
     virtual bool Remove(HandlerKey key) = 0;
+    // Calls the handler's Error with error and forgets the request if it hasn't been handed to
+    // the receiver yet. A request whose packet is partly written still goes out, but its
+    // response is dropped. Returns true if the request was found.
+    virtual bool Fail(HandlerKey key, KineticStatus error) = 0;
+    // Calls Error with error on every request that hasn't started being written. Safe to call
+    // alongside Enqueue().
+    virtual void FailAll(KineticStatus error) = 0;
 };
 
 class NonblockingSender : public NonblockingSenderInterface {
@@ -66,29 +83,62 @@ class NonblockingSender : public NonblockingSenderInterface {
     ~NonblockingSender();
     void Enqueue(unique_ptr<Message> message, unique_ptr<Command> command, const shared_ptr<const string> value,
             unique_ptr<HandlerInterface> handler, HandlerKey handler_key);
+    void Enqueue(unique_ptr<Message> message, unique_ptr<Command> command,
+            const shared_ptr<const OutgoingValueInterface> value, unique_ptr<HandlerInterface> handler,
+            HandlerKey handler_key);
     NonblockingPacketServiceStatus Send();
     bool Remove(HandlerKey key);
+    bool Fail(HandlerKey key, KineticStatus error);
+    void FailAll(KineticStatus error);
 
     private:
     struct Request {
-        unique_ptr<const Message> message;
+        unique_ptr<Message> message;
         unique_ptr<const Command> command;
+        // Exactly one of these holds the value
         shared_ptr<const string> value;
+        shared_ptr<const OutgoingValueInterface> value_source;
         unique_ptr<HandlerInterface> handler;
         HandlerKey handler_key;
     };
 
+    // A request whose packet is part of current_writer_, waiting for its bytes to go out
+    struct PendingWrite {
+        // Reset if the request failed while being written
+        shared_ptr<HandlerInterface> handler;
+        google::int64 sequence;
+        HandlerKey handler_key;
+    };
+
+    void EnqueueRequest(unique_ptr<Message> message, unique_ptr<Command> command, unique_ptr<Request> request);
+    bool StartWriter();
+    // Takes the request with the given key out of request_queue_, if it's there
+    unique_ptr<Request> TakeQueued(HandlerKey key);
+
     shared_ptr<SocketWrapperInterface> socket_wrapper_;
     shared_ptr<NonblockingReceiverInterface> receiver_;
     shared_ptr<NonblockingPacketWriterFactoryInterface> packet_writer_factory_;
     HmacProvider hmac_provider_;
     ConnectionOptions connection_options_;
-    int64_t sequence_number_;
-    HandlerKey handler_key_;
     unique_ptr<NonblockingPacketWriterInterface> current_writer_;
-    shared_ptr<HandlerInterface> handler_;
+    // One entry per packet in current_writer_ not yet reported written, in the order written
+    deque<PendingWrite> pending_writes_;
+    // Requests are encoded and signed by whichever thread enqueues them, outside this lock; it
+    // only covers handing out sequence numbers and the queue itself
+    std::mutex queue_mutex_;
+    int64_t sequence_number_;
+    // Sorted by sequence
     deque<unique_ptr<Request>> request_queue_;
-    google::int64 message_sequence_;
+    // Handler keys of the requests in request_queue_. Most keys looked up by Remove() and Fail()
+    // are of requests long since written, such as those whose deadline passes after they were
+    // answered, and this spares scanning the queue for them.
+    std::unordered_set<HandlerKey> queued_keys_;
+    // Sequence numbers handed out whose requests are still being signed. Nothing from the lowest
+    // of them on is written yet, so requests signed concurrently still go out in sequence order.
+    std::set<int64_t> encoding_;
+    // Copies of hmac_provider_ not in use; each keeps its own keyed context and serves one
+    // Enqueue at a time
+    std::vector<unique_ptr<HmacProvider>> idle_signers_;
     DISALLOW_COPY_AND_ASSIGN(NonblockingSender);
 };
 
@@ -24,17 +24,18 @@ using std::shared_ptr;
 using std::unique_ptr;
 using std::move;
 using std::make_pair;
+using std::vector;
+using std::chrono::steady_clock;
 
 NonblockingPacketService::NonblockingPacketService(
         shared_ptr<SocketWrapperInterface> socket_wrapper,
         unique_ptr<NonblockingSenderInterface> sender,
         shared_ptr<NonblockingReceiverInterface> receiver)
     : socket_wrapper_(socket_wrapper), sender_(move(sender)), receiver_(receiver),
-        failed_(false), next_key_(0) {}
+        failed_(false), next_key_(0), deadlines_(steady_clock::now()) {}
 
-NonblockingPacketService::~NonblockingPacketService() {
-    CleanUp();
-}
+// The sender fails whatever is still queued when it's destroyed
+NonblockingPacketService::~NonblockingPacketService() {}
 
 HandlerKey NonblockingPacketService::Submit(unique_ptr<Message> message, unique_ptr<Command> command,
         const shared_ptr<const string> value, unique_ptr<HandlerInterface> handler) {
@@ -45,25 +46,60 @@ HandlerKey NonblockingPacketService::Submit(unique_ptr<Message> message, unique_
                 KineticStatus(StatusCode::CLIENT_SHUTDOWN, "Client already shut down"), NULL);
     } else {
         sender_->Enqueue(move(message), move(command), value, move(handler), key);
+        FailIfShutDown(key);
     }
 
     return key;
 }
 
-bool NonblockingPacketService::Run(fd_set *read_fds, fd_set *write_fds, int *nfds) {
+HandlerKey NonblockingPacketService::Submit(unique_ptr<Message> message, unique_ptr<Command> command,
+        const shared_ptr<const OutgoingValueInterface> value, unique_ptr<HandlerInterface> handler) {
+    HandlerKey key = next_key_++;
+
+    if (failed_) {
+        handler->Error(
+                KineticStatus(StatusCode::CLIENT_SHUTDOWN, "Client already shut down"), NULL);
+    } else {
+        sender_->Enqueue(move(message), move(command), value, move(handler), key);
+        FailIfShutDown(key);
+    }
+
+    return key;
+}
+
+// Another thread's Run() may have failed, and drained the sender's queue, between the check in
+// Submit() and the request being enqueued; nothing would send the request or fail it then.
+void NonblockingPacketService::FailIfShutDown(HandlerKey key) {
+    if (failed_) {
+        // Run() no longer touches the sender once failed_ is set, so this doesn't race with it
+        sender_->Fail(key, KineticStatus(StatusCode::CLIENT_SHUTDOWN, "Client already shut down"));
+    }
+}
+
+bool NonblockingPacketService::SendAndReceive(NonblockingPacketServiceStatus *sender_status,
+        NonblockingPacketServiceStatus *receiver_status) {
     if (failed_) {
         return false;
     }
-    NonblockingPacketServiceStatus sender_status = sender_->Send();
-    if (sender_status == kError) {
+    ExpireDeadlines();
+    *sender_status = sender_->Send();
+    if (*sender_status == kError) {
         CleanUp();
         return false;
     }
-    NonblockingPacketServiceStatus receiver_status = receiver_->Receive();
-    if (receiver_status == kError) {
+    *receiver_status = receiver_->Receive();
+    if (*receiver_status == kError) {
         CleanUp();
         return false;
     }
+    return true;
+}
+
+bool NonblockingPacketService::Run(fd_set *read_fds, fd_set *write_fds, int *nfds) {
+    NonblockingPacketServiceStatus sender_status, receiver_status;
+    if (!SendAndReceive(&sender_status, &receiver_status)) {
+        return false;
+    }
     FD_ZERO(read_fds);
     FD_ZERO(write_fds);
     *nfds = 0;
@@ -78,17 +114,75 @@ bool NonblockingPacketService::Run(fd_set *read_fds, fd_set *write_fds, int *nfd
     return true;
 }
 
+bool NonblockingPacketService::Run(SocketInterest *interest) {
+    NonblockingPacketServiceStatus sender_status, receiver_status;
+    if (!SendAndReceive(&sender_status, &receiver_status)) {
+        return false;
+    }
+    if (sender_status == kIdle) {
+        // Handlers may have issued follow-up requests; with edge-triggered notification nothing
+        // would prompt another run to send them
+        sender_status = sender_->Send();
+        if (sender_status == kError) {
+            CleanUp();
+            return false;
+        }
+    }
+    interest->fd = socket_wrapper_->fd();
+    interest->read = receiver_status == kIoWait;
+    interest->write = sender_status == kIoWait;
+    return true;
+}
+
+bool NonblockingPacketService::SetSocketIo(shared_ptr<SocketIoInterface> io) {
+    return socket_wrapper_->set_io(io);
+}
+
 // Free all allocated resources and mark the service as having encountered an
 // irrecoverable error. This function exists so that in the event of an error
 // we can close the connection immediately instead of leaving it open until the
-// destructor is called.
+// destructor is called. Requests that haven't been written yet fail now rather than when
+// the service is destroyed.
 void NonblockingPacketService::CleanUp() {
     failed_ = true;
+    sender_->FailAll(KineticStatus(StatusCode::CLIENT_SHUTDOWN, "Client already shut down"));
 }
 
 bool NonblockingPacketService::Remove(HandlerKey handler_key) {
     return sender_->Remove(handler_key) || receiver_->Remove(handler_key);
 }
 
+void NonblockingPacketService::SetDeadline(HandlerKey handler_key,
+        steady_clock::time_point deadline) {
+    std::lock_guard<std::mutex> lock(deadline_mutex_);
+    deadlines_.Add(handler_key, deadline);
+}
+
+int NonblockingPacketService::TimeUntilDeadline() {
+    std::lock_guard<std::mutex> lock(deadline_mutex_);
+    return deadlines_.NextTimeout(steady_clock::now());
+}
+
+void NonblockingPacketService::ExpireDeadlines() {
+    vector<HandlerKey> expired;
+    {
+        std::lock_guard<std::mutex> lock(deadline_mutex_);
+        if (deadlines_.empty()) {
+            return;
+        }
+        deadlines_.Advance(steady_clock::now(), &expired);
+    }
+
+    // Handlers are called without the lock so they can set deadlines on follow-up requests. Most
+    // expired requests are long since answered, so the receiver's lookup goes first; the sender
+    // only scans its queue for keys it still holds.
+    for (auto it = expired.begin(); it != expired.end(); ++it) {
+        KineticStatus timeout(StatusCode::CLIENT_IO_ERROR, "Request timed out");
+        if (!receiver_->Fail(*it, timeout)) {
+            sender_->Fail(*it, timeout);
+        }
+    }
+}
+
 
 } // namespace kinetic
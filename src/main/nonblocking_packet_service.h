@@ -21,6 +21,8 @@
 #include <sys/select.h>
 #include <cstdint>
 
+#include <atomic>
+#include <mutex>
 #include <queue>
 #include <unordered_map>
 #include <glog/logging.h>
@@ -33,6 +35,7 @@
 #include "socket_wrapper_interface.h"
 #include "nonblocking_packet_receiver.h"
 #include "nonblocking_packet_sender.h"
+#include "timer_wheel.h"
 
 namespace kinetic {
 using com::seagate::kinetic::client::proto::Message;
@@ -54,16 +57,32 @@ class NonblockingPacketService : public NonblockingPacketServiceInterface {
     // handler instances cannot be reused
     HandlerKey Submit(unique_ptr<Message> message, unique_ptr<Command> command, const shared_ptr<const string> value,
         unique_ptr<HandlerInterface> handler);
+    HandlerKey Submit(unique_ptr<Message> message, unique_ptr<Command> command,
+        const shared_ptr<const OutgoingValueInterface> value, unique_ptr<HandlerInterface> handler);
     bool Run(fd_set *read_fds, fd_set *write_fds, int *nfds);
+    bool Run(SocketInterest *interest);
+    bool SetSocketIo(shared_ptr<SocketIoInterface> io);
     bool Remove(HandlerKey handler_key);
+    void SetDeadline(HandlerKey handler_key, std::chrono::steady_clock::time_point deadline);
+    int TimeUntilDeadline();
 
     private:
     shared_ptr<SocketWrapperInterface> socket_wrapper_;
     unique_ptr<NonblockingSenderInterface> sender_;
     shared_ptr<NonblockingReceiverInterface> receiver_;
-    bool failed_;
-    HandlerKey next_key_;
+    // Submit() may be called from several threads at once
+    std::atomic<bool> failed_;
+    std::atomic<HandlerKey> next_key_;
+    // Deadlines are set from whichever thread submitted the request. Entries aren't removed when
+    // their request completes; when they expire, the receiver and the sender each find out in
+    // constant time that they no longer hold the request.
+    std::mutex deadline_mutex_;
+    TimerWheel deadlines_;
+    void ExpireDeadlines();
+    bool SendAndReceive(NonblockingPacketServiceStatus *sender_status,
+        NonblockingPacketServiceStatus *receiver_status);
     void CleanUp();
+    void FailIfShutDown(HandlerKey key);
     DISALLOW_COPY_AND_ASSIGN(NonblockingPacketService);
 };
 
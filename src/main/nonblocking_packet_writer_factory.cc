@@ -26,7 +26,14 @@ using std::move;
 using std::string;
 
 unique_ptr<NonblockingPacketWriterInterface> NonblockingPacketWriterFactory::CreateWriter(shared_ptr<SocketWrapperInterface> socket_wrapper,
-    unique_ptr<const Message> message, const shared_ptr<const string> value) {
+    unique_ptr<Message> message, const shared_ptr<const string> value) {
+    return
+        unique_ptr<NonblockingPacketWriterInterface>(
+            new NonblockingPacketWriter(socket_wrapper, move(message), value));
+}
+
+unique_ptr<NonblockingPacketWriterInterface> NonblockingPacketWriterFactory::CreateWriter(shared_ptr<SocketWrapperInterface> socket_wrapper,
+    unique_ptr<Message> message, const shared_ptr<const OutgoingValueInterface> value) {
     return
         unique_ptr<NonblockingPacketWriterInterface>(
             new NonblockingPacketWriter(socket_wrapper, move(message), value));
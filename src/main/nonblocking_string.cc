@@ -21,7 +21,6 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/socket.h>
-#include <sys/stat.h>
 
 #include "glog/logging.h"
 
@@ -82,15 +81,10 @@ NonblockingStringStatus NonblockingStringWriter::Write() {
         #endif
 
         // We need to use send() for sockets but tests use pipes so we can't assume sockets.
-        // To deal with this annoyance detect whether the FD is a socket and use the write
+        // The socket wrapper tells us which kind of descriptor we have so we can pick
         // send/write
-        struct stat statbuf;
-        if (fstat(socket_wrapper_->fd(), &statbuf)) {
-            PLOG(ERROR) << "Unable to fstat socket";
-            return kFailed;
-        }
         int status;
-        if (S_ISSOCK(statbuf.st_mode)) {
+        if (socket_wrapper_->descriptor_type() != kPlainDescriptor) {
             if(socket_wrapper_->getSSL())
                 status = SSL_write(socket_wrapper_->getSSL(), s_->data() + bytes_written_, s_->size() - bytes_written_);
             else
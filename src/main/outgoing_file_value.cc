@@ -0,0 +1,144 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include "kinetic/outgoing_value.h"
+
+#include <errno.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+#include <algorithm>
+
+#include "glog/logging.h"
+
+#include "kinetic/reader_writer.h"
+
+namespace kinetic {
+
+// Size of the chunks the file is copied in where it can't be sent directly
+static const size_t kCopyChunkSize = 64 * 1024;
+
+// Reports a failed or short read of the file
+static bool CheckRead(ssize_t status, size_t remaining, int* err) {
+    if (status < 0) {
+        *err = errno;
+        PLOG(WARNING) << "Failed to read file";
+        return false;
+    }
+    if (status == 0) {
+        LOG(WARNING) << "File ended " << remaining << " bytes before the end of the value";
+        *err = EIO;
+        return false;
+    }
+    return true;
+}
+
+OutgoingFileValue::OutgoingFileValue(int fd, off_t offset, size_t size)
+    : fd_(fd), offset_(offset), size_(size) {}
+
+size_t OutgoingFileValue::size() const {
+    return size_;
+}
+
+bool OutgoingFileValue::TransferToSocket(int fd, int* err) const {
+    off_t offset = offset_;
+    size_t remaining = size_;
+#ifdef __linux__
+    while (remaining > 0) {
+        ssize_t status = sendfile(fd, fd_, &offset, remaining);
+        if (status < 0 && errno == EINTR) {
+            continue;
+        }
+        if (status < 0 && (errno == EINVAL || errno == ENOSYS) && offset == offset_) {
+            // Not a descriptor sendfile can read from; copy it instead
+            break;
+        }
+        if (status < 0) {
+            *err = errno;
+            PLOG(WARNING) << "Failed to send file";
+            return false;
+        }
+        if (status == 0) {
+            LOG(WARNING) << "File ended " << remaining << " bytes before the end of the value";
+            *err = EIO;
+            return false;
+        }
+        remaining -= status;
+    }
+#endif
+
+    ReaderWriter reader_writer(fd);
+    char buffer[kCopyChunkSize];
+    while (remaining > 0) {
+        ssize_t status = pread(fd_, buffer, std::min(remaining, sizeof(buffer)), offset);
+        if (status < 0 && errno == EINTR) {
+            continue;
+        }
+        if (!CheckRead(status, remaining, err)) {
+            return false;
+        }
+        if (!reader_writer.Write(buffer, status)) {
+            *err = errno;
+            return false;
+        }
+        offset += status;
+        remaining -= status;
+    }
+    return true;
+}
+
+ssize_t OutgoingFileValue::ReadAt(size_t offset, char *buf, size_t size, int* err) const {
+    if (offset >= size_) {
+        return 0;
+    }
+    size = std::min(size, size_ - offset);
+    while (true) {
+        ssize_t status = pread(fd_, buf, size, offset_ + offset);
+        if (status < 0 && errno == EINTR) {
+            continue;
+        }
+        if (!CheckRead(status, size, err)) {
+            return -1;
+        }
+        return status;
+    }
+}
+
+int OutgoingFileValue::SourceFile(off_t *offset) const {
+    *offset = offset_;
+    return fd_;
+}
+
+bool OutgoingFileValue::ToString(std::string *result, int* err) const {
+    result->resize(size_);
+    size_t done = 0;
+    while (done < size_) {
+        ssize_t status = pread(fd_, &(*result)[done], size_ - done, offset_ + done);
+        if (status < 0 && errno == EINTR) {
+            continue;
+        }
+        if (!CheckRead(status, size_ - done, err)) {
+            return false;
+        }
+        done += status;
+    }
+    return true;
+}
+
+} // namespace kinetic
@@ -45,4 +45,11 @@ bool OutgoingStringValue::ToString(std::string *result, int* err) const {
     return true;
 }
 
+ssize_t OutgoingStringValue::ReadAt(size_t offset, char *buf, size_t size, int* err) const {
+    if (offset >= s_.size()) {
+        return 0;
+    }
+    return s_.copy(buf, size, offset);
+}
+
 } // namespace kinetic
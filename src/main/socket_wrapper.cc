@@ -19,9 +19,13 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/stat.h>
 #include <arpa/inet.h>
 #include <netdb.h>
+#include <poll.h>
 #include <unistd.h>
+#include <cstring>
 #include <string>
 #include <exception>
 #include <stdexcept>
@@ -108,7 +112,9 @@ SocketWrapper::SocketWrapper(const std::string& host,
                              int port,
                              bool use_ssl,
                              bool nonblocking)
-    : ctx_(NULL), ssl_(NULL), host_(host), port_(port), nonblocking_(nonblocking), fd_(-1) {
+    : ctx_(NULL), ssl_(NULL), host_(host), port_(port), nonblocking_(nonblocking), fd_(-1),
+      connect_state_(kUnconnected), addresses_(NULL), next_address_(NULL),
+      descriptor_type_(kPlainDescriptor) {
     if (use_ssl) {
         ctx_ = SSL_CTX_new(SSLv23_client_method());
         ssl_ = SSL_new(ctx_);
@@ -120,6 +126,12 @@ SocketWrapper::SocketWrapper(const std::string& host,
 }
 
 SocketWrapper::~SocketWrapper() {
+    // Let any operation still under way on the FD finish before it's closed
+    io_.reset();
+    // The kernel keeps its own references to pages it's still sending from, so values awaiting
+    // a zero-copy notification can be let go along with the connection
+    zero_copy_.reset();
+    FreeAddresses();
     if (fd_ != -1) {
         if (close(fd_)) {
             PLOG(ERROR) << "Error closing socket fd " << fd_;
@@ -134,6 +146,27 @@ SocketWrapper::~SocketWrapper() {
 }
 
 bool SocketWrapper::Connect() {
+    if (!StartConnect()) {
+        return false;
+    }
+    while (true) {
+        SocketInterest interest;
+        ConnectProgress progress = ContinueConnect(&interest);
+        if (progress != kConnectInProgress) {
+            return progress == kConnectDone;
+        }
+        struct pollfd pfd;
+        pfd.fd = interest.fd;
+        pfd.events = (interest.read ? POLLIN : 0) | (interest.write ? POLLOUT : 0);
+        pfd.revents = 0;
+        if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+            PLOG(ERROR) << "Failed waiting for connection to " << host_;
+            return false;
+        }
+    }
+}
+
+bool SocketWrapper::StartConnect() {
     struct addrinfo hints;
     memset(&hints, 0, sizeof(struct addrinfo));
 
@@ -143,120 +176,216 @@ bool SocketWrapper::Connect() {
     hints.ai_protocol = IPPROTO_TCP;
     hints.ai_flags = AI_NUMERICSERV;
 
-    struct addrinfo* result;
-
     string port_str = std::to_string(static_cast<long long>(port_));
 
-    if (int res = getaddrinfo(host_.c_str(), port_str.c_str(), &hints, &result) != 0) {
+    FreeAddresses();
+    if (int res = getaddrinfo(host_.c_str(), port_str.c_str(), &hints, &addresses_) != 0) {
         LOG(ERROR) << "Could not resolve host " << host_ << " port " << port_ << ": " << gai_strerror(res);
+        addresses_ = NULL;
+        connect_state_ = kFailed;
         return false;
     }
 
-    struct addrinfo* ai;
-    int socket_fd;
-    for (ai = result; ai != NULL; ai = ai->ai_next) {
-        char host[NI_MAXHOST];
-        char service[NI_MAXSERV];
-        if (int res = getnameinfo(ai->ai_addr,
-                                  ai->ai_addrlen,
-                                  host,
-                                  sizeof(host),
-                                  service,
-                                  sizeof(service),
-                                  NI_NUMERICHOST | NI_NUMERICSERV) != 0) {
-            LOG(ERROR) << "Could not get name info: " << gai_strerror(res);
-            continue;
-        }
+    next_address_ = addresses_;
+    connect_state_ = kConnectingTcp;
+    return ConnectNextAddress();
+}
 
-        socket_fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+// Creates a nonblocking, close-on-exec socket for the address, or returns -1
+int SocketWrapper::OpenSocket(const struct addrinfo *ai) {
+    char host[NI_MAXHOST];
+    char service[NI_MAXSERV];
+    if (int res = getnameinfo(ai->ai_addr,
+                              ai->ai_addrlen,
+                              host,
+                              sizeof(host),
+                              service,
+                              sizeof(service),
+                              NI_NUMERICHOST | NI_NUMERICSERV) != 0) {
+        LOG(ERROR) << "Could not get name info: " << gai_strerror(res);
+        return -1;
+    }
 
-        if (socket_fd == -1) {
-            LOG(WARNING) << "Could not create socket";
-            continue;
-        }
+    int socket_fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
 
-        // os x won't let us set close-on-exec when creating the socket, so set it separately
-        int current_fd_flags = fcntl(socket_fd, F_GETFD);
-        if (current_fd_flags == -1) {
-            PLOG(ERROR) << "Failed to get socket fd flags";
-            close(socket_fd);
-            continue;
-        }
-        if (fcntl(socket_fd, F_SETFD, current_fd_flags | FD_CLOEXEC) == -1) {
-            PLOG(ERROR) << "Failed to set socket close-on-exit";
-            close(socket_fd);
-            continue;
-        }
+    if (socket_fd == -1) {
+        LOG(WARNING) << "Could not create socket";
+        return -1;
+    }
+
+    // os x won't let us set close-on-exec when creating the socket, so set it separately
+    int current_fd_flags = fcntl(socket_fd, F_GETFD);
+    if (current_fd_flags == -1) {
+        PLOG(ERROR) << "Failed to get socket fd flags";
+        close(socket_fd);
+        return -1;
+    }
+    if (fcntl(socket_fd, F_SETFD, current_fd_flags | FD_CLOEXEC) == -1) {
+        PLOG(ERROR) << "Failed to set socket close-on-exit";
+        close(socket_fd);
+        return -1;
+    }
 
-        // On BSD-like systems we can set SO_NOSIGPIPE on the socket to prevent it from sending a
-        // PIPE signal and bringing down the whole application if the server closes the socket
-        // forcibly
+    // On BSD-like systems we can set SO_NOSIGPIPE on the socket to prevent it from sending a
+    // PIPE signal and bringing down the whole application if the server closes the socket
+    // forcibly
 #ifdef SO_NOSIGPIPE
-        int set = 1;
-        int setsockopt_result = setsockopt(socket_fd, SOL_SOCKET, SO_NOSIGPIPE, &set, sizeof(set));
-        // Allow ENOTSOCK because it allows tests to use pipes instead of real sockets
-        if (setsockopt_result != 0 && setsockopt_result != ENOTSOCK) {
-            PLOG(ERROR) << "Failed to set SO_NOSIGPIPE on socket";
-            close(socket_fd);
-            continue;
-        }
+    int set = 1;
+    int setsockopt_result = setsockopt(socket_fd, SOL_SOCKET, SO_NOSIGPIPE, &set, sizeof(set));
+    // Allow ENOTSOCK because it allows tests to use pipes instead of real sockets
+    if (setsockopt_result != 0 && setsockopt_result != ENOTSOCK) {
+        PLOG(ERROR) << "Failed to set SO_NOSIGPIPE on socket";
+        close(socket_fd);
+        return -1;
+    }
 #endif
 
-        if (connect(socket_fd, ai->ai_addr, ai->ai_addrlen) == -1) {
-            PLOG(WARNING) << "Unable to connect";
-            close(socket_fd);
+    // Connecting doesn't block either; blocking sockets are switched back once connected
+    if (fcntl(socket_fd, F_SETFL, O_NONBLOCK) != 0) {
+        PLOG(ERROR) << "Failed to set socket nonblocking";
+        close(socket_fd);
+        return -1;
+    }
+    return socket_fd;
+}
+
+// Starts connecting to the next address that gets that far
+bool SocketWrapper::ConnectNextAddress() {
+    while (next_address_ != NULL) {
+        struct addrinfo *ai = next_address_;
+        next_address_ = ai->ai_next;
+
+        int socket_fd = OpenSocket(ai);
+        if (socket_fd == -1) {
             continue;
         }
-
-        if (nonblocking_ && fcntl(socket_fd, F_SETFL, O_NONBLOCK) != 0) {
-            PLOG(ERROR) << "Failed to set socket nonblocking";
+        if (connect(socket_fd, ai->ai_addr, ai->ai_addrlen) == -1 && errno != EINPROGRESS) {
+            PLOG(WARNING) << "Unable to connect";
             close(socket_fd);
             continue;
         }
-
-        break;
+        fd_ = socket_fd;
+        return true;
     }
 
-    freeaddrinfo(result);
+    // we went through all addresses without finding one we could connect to
+    LOG(ERROR) << "Could not connect to " << host_ << " on port " << port_;
+    FailConnect();
+    return false;
+}
 
-    if (ai == NULL) {
-        // we went through all addresses without finding one we could bind to
-        LOG(ERROR) << "Could not connect to " << host_ << " on port " << port_;
-        return false;
+ConnectProgress SocketWrapper::ContinueConnect(SocketInterest *interest) {
+    interest->fd = fd_;
+    interest->read = false;
+    interest->write = false;
+
+    switch (connect_state_) {
+        case kConnectingTcp: {
+            // The connect has finished once the socket is writable
+            struct pollfd pfd;
+            pfd.fd = fd_;
+            pfd.events = POLLOUT;
+            pfd.revents = 0;
+            if (poll(&pfd, 1, 0) == 0) {
+                interest->write = true;
+                return kConnectInProgress;
+            }
+            int error = 0;
+            socklen_t error_len = sizeof(error);
+            if (getsockopt(fd_, SOL_SOCKET, SO_ERROR, &error, &error_len) != 0) {
+                error = errno;
+            }
+            if (error != 0) {
+                LOG(WARNING) << "Unable to connect: " << strerror(error);
+                close(fd_);
+                fd_ = -1;
+                if (!ConnectNextAddress()) {
+                    return kConnectFailed;
+                }
+                interest->fd = fd_;
+                interest->write = true;
+                return kConnectInProgress;
+            }
+
+            FreeAddresses();
+            ConfigureSocket();
+            if (!ssl_) {
+                return FinishConnect();
+            }
+            SSL_set_fd(ssl_, fd_);
+            connect_state_ = kConnectingTls;
+        }
+        // fall through
+        case kConnectingTls: {
+            int rtn = SSL_connect(ssl_);
+            if (rtn == 1) {
+                return FinishConnect();
+            }
+            int err = SSL_get_error(ssl_, rtn);
+            if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) {
+                interest->read = err == SSL_ERROR_WANT_READ;
+                interest->write = err == SSL_ERROR_WANT_WRITE;
+                return kConnectInProgress;
+            }
+            LOG(ERROR) << "TLS handshake with " << host_ << " on port " << port_ << " failed";
+            return FailConnect();
+        }
+        case kConnected:
+            return kConnectDone;
+        default:
+            return kConnectFailed;
     }
+}
 
-    fd_ = socket_fd;
-    if (ssl_) {
-        return ConnectSSL();
+ConnectProgress SocketWrapper::FinishConnect() {
+    if (!nonblocking_ && fcntl(fd_, F_SETFL, 0) != 0) {
+        PLOG(ERROR) << "Failed to set socket blocking";
+        return FailConnect();
     }
-    return true;
+    connect_state_ = kConnected;
+    return kConnectDone;
 }
 
-bool SocketWrapper::ConnectSSL() {
-    SSL_set_fd(ssl_, fd_);
-    int rtn = SSL_connect(ssl_);
-    if (rtn == 1) {
-        return true;
-    }
+ConnectProgress SocketWrapper::FailConnect() {
+    FreeAddresses();
+    connect_state_ = kFailed;
+    return kConnectFailed;
+}
 
-    int err = SSL_get_error(ssl_, rtn);
-    if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) {
-        fd_set read_fds, write_fds;
-        FD_ZERO(&read_fds);
-        FD_ZERO(&write_fds);
+void SocketWrapper::FreeAddresses() {
+    if (addresses_ != NULL) {
+        freeaddrinfo(addresses_);
+        addresses_ = NULL;
+        next_address_ = NULL;
+    }
+}
 
-        if (err == SSL_ERROR_WANT_READ) {
-            FD_SET(fd_, &read_fds);
-        }
-        if (err == SSL_ERROR_WANT_WRITE) {
-            FD_SET(fd_, &write_fds);
-        }
+// Determine what kind of descriptor we ended up with and apply socket options once, so that the
+// packet writers don't have to fstat or setsockopt on every write.
+void SocketWrapper::ConfigureSocket() {
+    struct stat statbuf;
+    if (fstat(fd_, &statbuf) != 0 || !S_ISSOCK(statbuf.st_mode)) {
+        descriptor_type_ = kPlainDescriptor;
+        return;
+    }
 
-        struct timeval tv = {1, 1};
-        select(fd_ + 1, &read_fds, &write_fds, NULL, &tv);
-        return ConnectSSL();
+    struct sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+    if (getsockname(fd_, reinterpret_cast<struct sockaddr *>(&addr), &addr_len) == 0 &&
+            addr.ss_family == AF_UNIX) {
+        descriptor_type_ = kUnixSocket;
+        return;
+    }
+    descriptor_type_ = kTcpSocket;
+
+    // On a plain TCP connection each packet is handed to the kernel in a single gather write, so
+    // there's nothing left for Nagle's algorithm to coalesce. TLS connections get the same from
+    // the packet writer gathering a frame into one record before writing it. Disabling it once
+    // here replaces toggling TCP_CORK around every packet.
+    int optval = 1;
+    if (setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval)) != 0) {
+        PLOG(WARNING) << "Failed to set TCP_NODELAY on socket";
     }
-    return false;
 }
 
 SSL* SocketWrapper::getSSL() {
@@ -267,4 +396,37 @@ int SocketWrapper::fd() {
     return fd_;
 }
 
+DescriptorType SocketWrapper::descriptor_type() {
+    return descriptor_type_;
+}
+
+SocketIoInterface *SocketWrapper::io() {
+    return io_.get();
+}
+
+bool SocketWrapper::set_io(std::shared_ptr<SocketIoInterface> io) {
+    // TLS records are produced by OpenSSL's own reads and writes
+    if (ssl_) {
+        return false;
+    }
+    io_ = io;
+    return true;
+}
+
+ZeroCopySender *SocketWrapper::zero_copy() {
+    return zero_copy_.get();
+}
+
+bool SocketWrapper::EnableZeroCopy(size_t threshold) {
+    if (ssl_ || descriptor_type_ != kTcpSocket) {
+        return false;
+    }
+    if (!ZeroCopySender::Enable(fd_)) {
+        PLOG(INFO) << "Zero-copy sends not available on fd " << fd_;
+        return false;
+    }
+    zero_copy_.reset(new ZeroCopySender(fd_, threshold));
+    return true;
+}
+
 }  // namespace kinetic
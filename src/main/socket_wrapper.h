@@ -18,22 +18,63 @@
 #ifndef KINETIC_CPP_CLIENT_SOCKET_WRAPPER_H_
 #define KINETIC_CPP_CLIENT_SOCKET_WRAPPER_H_
 
+#include <netdb.h>
+
 #include "socket_wrapper_interface.h"
+#include "zero_copy_sender.h"
 #include "kinetic/connection_options.h"
+#include "kinetic/nonblocking_packet_service_interface.h"
 
 
 namespace kinetic {
 
+/// How far a connection started with SocketWrapper::StartConnect has got
+enum ConnectProgress {
+    kConnectInProgress,
+    kConnectDone,
+    kConnectFailed
+};
+
 class SocketWrapper : public SocketWrapperInterface {
   public:
     explicit SocketWrapper(const std::string &host, int port, bool use_ssl, bool nonblocking = false);
+    /// Connects, waiting for the TCP connect and TLS handshake to complete
     bool Connect();
+    /// Resolves the host and starts a nonblocking connect to the first address that accepts
+    /// one. Returns false if there's nothing to connect to. Host names are resolved with the
+    /// blocking getaddrinfo; drives are normally addressed by IP, which doesn't wait.
+    bool StartConnect();
+    /// Carries the connect, and then the TLS handshake if the connection uses SSL, as far as the
+    /// socket allows without blocking. Falls back to the host's next address if connecting fails.
+    /// While kConnectInProgress is returned, interest says what to wait for before calling again;
+    /// its fd may change when a different address is tried.
+    ConnectProgress ContinueConnect(SocketInterest *interest);
     int  fd();
     SSL *getSSL();
+    DescriptorType descriptor_type();
+    SocketIoInterface *io();
+    bool set_io(std::shared_ptr<SocketIoInterface> io);
+    ZeroCopySender *zero_copy();
+    /// Sends values of at least threshold bytes with MSG_ZEROCOPY from now on. Only plain TCP
+    /// connections support this; returns false otherwise.
+    bool EnableZeroCopy(size_t threshold);
     ~SocketWrapper();
 
   private:
-    bool ConnectSSL();
+    enum ConnectState {
+        kUnconnected,
+        kConnectingTcp,
+        kConnectingTls,
+        kConnected,
+        kFailed
+    };
+
+    int OpenSocket(const struct addrinfo *ai);
+    bool ConnectNextAddress();
+    ConnectProgress FinishConnect();
+    ConnectProgress FailConnect();
+    void FreeAddresses();
+    void ConfigureSocket();
 
     SSL_CTX * ctx_;
     SSL * ssl_;
@@ -41,6 +82,13 @@ class SocketWrapper : public SocketWrapperInterface {
     int port_;
     bool nonblocking_;
     int fd_;
+    ConnectState connect_state_;
+    // The resolved addresses, kept while connecting in case the current one fails
+    struct addrinfo *addresses_;
+    struct addrinfo *next_address_;
+    DescriptorType descriptor_type_;
+    std::shared_ptr<SocketIoInterface> io_;
+    std::unique_ptr<ZeroCopySender> zero_copy_;
 };
 
 } // namespace kinetic
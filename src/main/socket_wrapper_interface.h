@@ -19,9 +19,23 @@
 #define KINETIC_CPP_CLIENT_SOCKET_WRAPPER_INTERFACE_H_
 
 #include <openssl/ssl.h>
+#include <memory>
+
+#include "kinetic/socket_io.h"
 
 namespace kinetic {
 
+class ZeroCopySender;
+
+/// The kind of descriptor a SocketWrapperInterface hands out. Sockets are written using
+/// send/sendmsg so that MSG_NOSIGNAL can be used, anything else (e. g. the pipes used by tests)
+/// falls back to write/writev.
+enum DescriptorType {
+    kPlainDescriptor,
+    kUnixSocket,
+    kTcpSocket
+};
+
 /// Simple wrapper around a socket FD that closes the FD
 /// in the destructor
 class SocketWrapperInterface {
@@ -38,6 +52,22 @@ class SocketWrapperInterface {
     /// Returns nullptr if SSL hasn't been initialized.
     virtual SSL* getSSL() = 0;
 
+    /// Returns the kind of descriptor returned by fd(). Implementations should determine this
+    /// once when connecting rather than on every call.
+    virtual DescriptorType descriptor_type() = 0;
+
+    /// Returns what performs reads and writes on the FD, or NULL if callers should use it
+    /// directly
+    virtual SocketIoInterface *io() = 0;
+
+    /// Hands reads and writes on the FD over to io. Returns false if that isn't possible, for
+    /// example because the connection uses SSL.
+    virtual bool set_io(std::shared_ptr<SocketIoInterface> io) = 0;
+
+    /// Returns what sends large values on the FD without copying them, or NULL if they should
+    /// be written normally
+    virtual ZeroCopySender *zero_copy() = 0;
+
     /// The destructor should close the FD if it was opened
     /// by connect
     virtual ~SocketWrapperInterface() {}
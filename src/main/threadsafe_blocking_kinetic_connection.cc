@@ -27,231 +27,251 @@ using std::string;
 using std::make_shared;
 using std::move;
 
+// Nothing here takes a lock: the wrapped connection lets any number of threads run requests at
+// once and pipelines them on its socket, so serializing them would only cost throughput.
+
 ThreadsafeBlockingKineticConnection::ThreadsafeBlockingKineticConnection(
     unique_ptr<BlockingKineticConnection> connection) : connection_(std::move(connection)) {
 }
 
 ThreadsafeBlockingKineticConnection::~ThreadsafeBlockingKineticConnection() {}
 
-KineticStatus ThreadsafeBlockingKineticConnection::NoOp() {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->NoOp();
+KineticStatus ThreadsafeBlockingKineticConnection::NoOp(const RequestOptions &options) {
+    return connection_->NoOp(options);
 }
 
 void ThreadsafeBlockingKineticConnection::SetClientClusterVersion(int64_t cluster_version) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
     return connection_->SetClientClusterVersion(cluster_version);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::Get(const shared_ptr<const string> key,
-                                                       unique_ptr<KineticRecord> &record) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Get(key, record);
+                                                       unique_ptr<KineticRecord> &record,
+                                                       const RequestOptions &options) {
+    return connection_->Get(key, record, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::Get(const string &key,
-                                                       unique_ptr<KineticRecord> &record) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Get(key, record);
+                                                       unique_ptr<KineticRecord> &record,
+                                                       const RequestOptions &options) {
+    return connection_->Get(key, record, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::Put(const shared_ptr<const string> key,
                                                        const shared_ptr<const string> current_version,
                                                        WriteMode mode,
                                                        const shared_ptr<const KineticRecord> record,
-                                                       PersistMode persistMode) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Put(key, current_version, mode, record, persistMode);
+                                                       PersistMode persistMode,
+                                                       const RequestOptions &options) {
+    return connection_->Put(key, current_version, mode, record, persistMode, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::Put(const string &key,
                                                        const string &current_version,
                                                        WriteMode mode,
                                                        const KineticRecord &record,
-                                                       PersistMode persistMode) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Put(key, current_version, mode, record, persistMode);
+                                                       PersistMode persistMode,
+                                                       const RequestOptions &options) {
+    return connection_->Put(key, current_version, mode, record, persistMode, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::Put(const shared_ptr<const string> key,
                                                        const shared_ptr<const string> current_version,
                                                        WriteMode mode,
-                                                       const shared_ptr<const KineticRecord> record) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Put(key, current_version, mode, record);
+                                                       const shared_ptr<const KineticRecord> record,
+                                                       const RequestOptions &options) {
+    return connection_->Put(key, current_version, mode, record, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::Put(const string &key,
                                                        const string &current_version,
                                                        WriteMode mode,
-                                                       const KineticRecord &record) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Put(key, current_version, mode, record);
+                                                       const KineticRecord &record,
+                                                       const RequestOptions &options) {
+    return connection_->Put(key, current_version, mode, record, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::Delete(const shared_ptr<const string> key,
                                                           const shared_ptr<const string> version,
                                                           WriteMode mode,
-                                                          PersistMode persistMode) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Delete(key, version, mode, persistMode);
+                                                          PersistMode persistMode,
+                                                          const RequestOptions &options) {
+    return connection_->Delete(key, version, mode, persistMode, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::Delete(const string &key,
                                                           const string &version,
                                                           WriteMode mode,
-                                                          PersistMode persistMode) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Delete(key, version, mode, persistMode);
+                                                          PersistMode persistMode,
+                                                          const RequestOptions &options) {
+    return connection_->Delete(key, version, mode, persistMode, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::Delete(const shared_ptr<const string> key,
                                                           const shared_ptr<const string> version,
-                                                          WriteMode mode) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Delete(key, version, mode);
+                                                          WriteMode mode,
+                                                          const RequestOptions &options) {
+    return connection_->Delete(key, version, mode, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::Delete(const string &key,
                                                           const string &version,
-                                                          WriteMode mode) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Delete(key, version, mode);
+                                                          WriteMode mode,
+                                                          const RequestOptions &options) {
+    return connection_->Delete(key, version, mode, options);
 }
 
-KineticStatus ThreadsafeBlockingKineticConnection::InstantErase(const shared_ptr<string> pin) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->InstantErase(pin);
+KineticStatus ThreadsafeBlockingKineticConnection::InstantErase(const shared_ptr<string> pin,
+                                                                const RequestOptions &options) {
+    return connection_->InstantErase(pin, options);
 }
 
-KineticStatus ThreadsafeBlockingKineticConnection::InstantErase(const string &pin) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->InstantErase(pin);
+KineticStatus ThreadsafeBlockingKineticConnection::InstantErase(const string &pin, const RequestOptions &options) {
+    return connection_->InstantErase(pin, options);
 }
 
-KineticStatus ThreadsafeBlockingKineticConnection::SecureErase(const shared_ptr<string> pin) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->InstantErase(pin);
+KineticStatus ThreadsafeBlockingKineticConnection::SecureErase(const shared_ptr<string> pin,
+                                                               const RequestOptions &options) {
+    return connection_->InstantErase(pin, options);
 }
 
-KineticStatus ThreadsafeBlockingKineticConnection::SecureErase(const string &pin) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->InstantErase(pin);
+KineticStatus ThreadsafeBlockingKineticConnection::SecureErase(const string &pin, const RequestOptions &options) {
+    return connection_->InstantErase(pin, options);
 }
 
-KineticStatus ThreadsafeBlockingKineticConnection::SetClusterVersion(int64_t new_cluster_version) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->SetClusterVersion(new_cluster_version);
+KineticStatus ThreadsafeBlockingKineticConnection::SetClusterVersion(int64_t new_cluster_version,
+                                                                     const RequestOptions &options) {
+    return connection_->SetClusterVersion(new_cluster_version, options);
 }
 
-KineticStatus ThreadsafeBlockingKineticConnection::GetLog(unique_ptr<DriveLog> &drive_log) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->GetLog(drive_log);
+KineticStatus ThreadsafeBlockingKineticConnection::GetLog(unique_ptr<DriveLog> &drive_log,
+                                                          const RequestOptions &options) {
+    return connection_->GetLog(drive_log, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::GetLog(const vector<Command_GetLog_Type> &types,
-                                                          unique_ptr<DriveLog> &drive_log) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->GetLog(types, drive_log);
+                                                          unique_ptr<DriveLog> &drive_log,
+                                                          const RequestOptions &options) {
+    return connection_->GetLog(types, drive_log, options);
+}
+
+KineticStatus ThreadsafeBlockingKineticConnection::MultiGet(const vector<string> &keys,
+                                                            vector<unique_ptr<KineticRecord>> &records,
+                                                            unique_ptr<vector<KineticStatus>> &operation_statuses,
+                                                            size_t window,
+                                                            const RequestOptions &options) {
+    return connection_->MultiGet(keys, records, operation_statuses, window, options);
+}
+
+KineticStatus ThreadsafeBlockingKineticConnection::MultiPut(const vector<PutOperation> &puts,
+                                                            PersistMode persistMode,
+                                                            unique_ptr<vector<KineticStatus>> &operation_statuses,
+                                                            size_t window,
+                                                            const RequestOptions &options) {
+    return connection_->MultiPut(puts, persistMode, operation_statuses, window, options);
+}
+
+KineticStatus ThreadsafeBlockingKineticConnection::MultiDelete(const vector<DeleteOperation> &deletes,
+                                                               PersistMode persistMode,
+                                                               unique_ptr<vector<KineticStatus>> &operation_statuses,
+                                                               size_t window,
+                                                               const RequestOptions &options) {
+    return connection_->MultiDelete(deletes, persistMode, operation_statuses, window, options);
 }
 
-KineticStatus ThreadsafeBlockingKineticConnection::Flush() {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Flush();
+KineticStatus ThreadsafeBlockingKineticConnection::Flush(const RequestOptions &options) {
+    return connection_->Flush(options);
 }
 
-KineticStatus ThreadsafeBlockingKineticConnection::UpdateFirmware(const shared_ptr<const string> new_firmware) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->UpdateFirmware(new_firmware);
+KineticStatus ThreadsafeBlockingKineticConnection::UpdateFirmware(const shared_ptr<const string> new_firmware,
+                                                                  const RequestOptions &options) {
+    return connection_->UpdateFirmware(new_firmware, options);
 }
 
-KineticStatus ThreadsafeBlockingKineticConnection::SetACLs(const shared_ptr<const list<ACL>> acls) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->SetACLs(acls);
+KineticStatus ThreadsafeBlockingKineticConnection::SetACLs(const shared_ptr<const list<ACL>> acls,
+                                                           const RequestOptions &options) {
+    return connection_->SetACLs(acls, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::SetErasePIN(const shared_ptr<const string> new_pin,
-                                                               const shared_ptr<const string> current_pin) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->SetErasePIN(new_pin, current_pin);
+                                                               const shared_ptr<const string> current_pin,
+                                                               const RequestOptions &options) {
+    return connection_->SetErasePIN(new_pin, current_pin, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::SetErasePIN(const string &new_pin,
-                                                               const string &current_pin) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->SetErasePIN(new_pin, current_pin);
+                                                               const string &current_pin,
+                                                               const RequestOptions &options) {
+    return connection_->SetErasePIN(new_pin, current_pin, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::SetLockPIN(const shared_ptr<const string> new_pin,
-                                                              const shared_ptr<const string> current_pin) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->SetLockPIN(new_pin, current_pin);
+                                                              const shared_ptr<const string> current_pin,
+                                                              const RequestOptions &options) {
+    return connection_->SetLockPIN(new_pin, current_pin, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::SetLockPIN(const string &new_pin,
-                                                              const string &current_pin) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->SetLockPIN(new_pin, current_pin);
+                                                              const string &current_pin,
+                                                              const RequestOptions &options) {
+    return connection_->SetLockPIN(new_pin, current_pin, options);
 }
 
-KineticStatus ThreadsafeBlockingKineticConnection::LockDevice(const shared_ptr<string> pin) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->LockDevice(pin);
+KineticStatus ThreadsafeBlockingKineticConnection::LockDevice(const shared_ptr<string> pin,
+                                                              const RequestOptions &options) {
+    return connection_->LockDevice(pin, options);
 }
 
-KineticStatus ThreadsafeBlockingKineticConnection::LockDevice(const string &pin) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->LockDevice(pin);
+KineticStatus ThreadsafeBlockingKineticConnection::LockDevice(const string &pin, const RequestOptions &options) {
+    return connection_->LockDevice(pin, options);
 }
 
-KineticStatus ThreadsafeBlockingKineticConnection::UnlockDevice(const shared_ptr<string> pin) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->UnlockDevice(pin);
+KineticStatus ThreadsafeBlockingKineticConnection::UnlockDevice(const shared_ptr<string> pin,
+                                                                const RequestOptions &options) {
+    return connection_->UnlockDevice(pin, options);
 }
 
-KineticStatus ThreadsafeBlockingKineticConnection::UnlockDevice(const string &pin) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->UnlockDevice(pin);
+KineticStatus ThreadsafeBlockingKineticConnection::UnlockDevice(const string &pin, const RequestOptions &options) {
+    return connection_->UnlockDevice(pin, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::GetNext(const shared_ptr<const string> key,
                                                            unique_ptr<string> &actual_key,
-                                                           unique_ptr<KineticRecord> &record) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->GetNext(key, actual_key, record);
+                                                           unique_ptr<KineticRecord> &record,
+                                                           const RequestOptions &options) {
+    return connection_->GetNext(key, actual_key, record, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::GetNext(const string &key,
                                                            unique_ptr<string> &actual_key,
-                                                           unique_ptr<KineticRecord> &record) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->GetNext(key, actual_key, record);
+                                                           unique_ptr<KineticRecord> &record,
+                                                           const RequestOptions &options) {
+    return connection_->GetNext(key, actual_key, record, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::GetPrevious(const shared_ptr<const string> key,
                                                                unique_ptr<string> &actual_key,
-                                                               unique_ptr<KineticRecord> &record) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->GetPrevious(key, actual_key, record);
+                                                               unique_ptr<KineticRecord> &record,
+                                                               const RequestOptions &options) {
+    return connection_->GetPrevious(key, actual_key, record, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::GetPrevious(const string &key,
                                                                unique_ptr<string> &actual_key,
-                                                               unique_ptr<KineticRecord> &record) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->GetPrevious(key, actual_key, record);
+                                                               unique_ptr<KineticRecord> &record,
+                                                               const RequestOptions &options) {
+    return connection_->GetPrevious(key, actual_key, record, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::GetVersion(const shared_ptr<const string> key,
-                                                              unique_ptr<string> &version) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->GetVersion(key, version);
+                                                              unique_ptr<string> &version,
+                                                              const RequestOptions &options) {
+    return connection_->GetVersion(key, version, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::GetVersion(const string &key,
-                                                              unique_ptr<string> &version) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->GetVersion(key, version);
+                                                              unique_ptr<string> &version,
+                                                              const RequestOptions &options) {
+    return connection_->GetVersion(key, version, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::GetKeyRange(const shared_ptr<const string> start_key,
@@ -260,15 +280,16 @@ KineticStatus ThreadsafeBlockingKineticConnection::GetKeyRange(const shared_ptr<
                                                                bool end_key_inclusive,
                                                                bool reverse_results,
                                                                int32_t max_results,
-                                                               unique_ptr<vector<string>> &keys) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
+                                                               unique_ptr<vector<string>> &keys,
+                                                               const RequestOptions &options) {
     return connection_->GetKeyRange(start_key,
                                     start_key_inclusive,
                                     end_key,
                                     end_key_inclusive,
                                     reverse_results,
                                     max_results,
-                                    keys);
+                                    keys,
+                                    options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::GetKeyRange(const string &start_key,
@@ -277,15 +298,16 @@ KineticStatus ThreadsafeBlockingKineticConnection::GetKeyRange(const string &sta
                                                                bool end_key_inclusive,
                                                                bool reverse_results,
                                                                int32_t max_results,
-                                                               unique_ptr<vector<string>> &keys) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
+                                                               unique_ptr<vector<string>> &keys,
+                                                               const RequestOptions &options) {
     return connection_->GetKeyRange(start_key,
                                     start_key_inclusive,
                                     end_key,
                                     end_key_inclusive,
                                     reverse_results,
                                     max_results,
-                                    keys);
+                                    keys,
+                                    options);
 }
 
 KeyRangeIterator ThreadsafeBlockingKineticConnection::IterateKeyRange(const shared_ptr<const string> start_key,
@@ -293,7 +315,6 @@ KeyRangeIterator ThreadsafeBlockingKineticConnection::IterateKeyRange(const shar
                                                                       const shared_ptr<const string> end_key,
                                                                       bool end_key_inclusive,
                                                                       unsigned int frame_size) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
     return connection_->IterateKeyRange(start_key, start_key_inclusive, end_key, end_key_inclusive, frame_size);
 }
 
@@ -302,20 +323,19 @@ KeyRangeIterator ThreadsafeBlockingKineticConnection::IterateKeyRange(const stri
                                                                       const string &end_key,
                                                                       bool end_key_inclusive,
                                                                       unsigned int frame_size) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
     return connection_->IterateKeyRange(start_key, start_key_inclusive, end_key, end_key_inclusive, frame_size);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::P2PPush(const shared_ptr<const P2PPushRequest> push_request,
-                                                           unique_ptr<vector<KineticStatus>> &operation_statuses) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->P2PPush(push_request, operation_statuses);
+                                                           unique_ptr<vector<KineticStatus>> &operation_statuses,
+                                                           const RequestOptions &options) {
+    return connection_->P2PPush(push_request, operation_statuses, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::P2PPush(const P2PPushRequest &push_request,
-                                                           unique_ptr<vector<KineticStatus>> &operation_statuses) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->P2PPush(push_request, operation_statuses);
+                                                           unique_ptr<vector<KineticStatus>> &operation_statuses,
+                                                           const RequestOptions &options) {
+    return connection_->P2PPush(push_request, operation_statuses, options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::MediaScan(const shared_ptr<const string> start_key,
@@ -324,15 +344,16 @@ KineticStatus ThreadsafeBlockingKineticConnection::MediaScan(const shared_ptr<co
                                                              bool end_key_inclusive,
                                                              int32_t max_results,
                                                              unique_ptr<string> &last_handled_key,
-                                                             unique_ptr<vector<string>> &keys) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
+                                                             unique_ptr<vector<string>> &keys,
+                                                             const RequestOptions &options) {
     return connection_->MediaScan(start_key,
                                   start_key_inclusive,
                                   end_key,
                                   end_key_inclusive,
                                   max_results,
                                   last_handled_key,
-                                  keys);
+                                  keys,
+                                  options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::MediaScan(const string &start_key,
@@ -341,33 +362,36 @@ KineticStatus ThreadsafeBlockingKineticConnection::MediaScan(const string &start
                                                              bool end_key_inclusive,
                                                              int32_t max_results,
                                                              unique_ptr<string> &last_handled_key,
-                                                             unique_ptr<vector<string>> &keys) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
+                                                             unique_ptr<vector<string>> &keys,
+                                                             const RequestOptions &options) {
     return connection_->MediaScan(start_key,
                                   start_key_inclusive,
                                   end_key,
                                   end_key_inclusive,
                                   max_results,
                                   last_handled_key,
-                                  keys);
+                                  keys,
+                                  options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::MediaOptimize(const shared_ptr<const string> start_key,
                                                                  bool start_key_inclusive,
                                                                  const shared_ptr<const string> end_key,
                                                                  bool end_key_inclusive,
-                                                                 unique_ptr<string> &last_handled_key) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->MediaOptimize(start_key, start_key_inclusive, end_key, end_key_inclusive, last_handled_key);
+                                                                 unique_ptr<string> &last_handled_key,
+                                                                 const RequestOptions &options) {
+    return connection_->MediaOptimize(start_key, start_key_inclusive, end_key, end_key_inclusive, last_handled_key,
+                                      options);
 }
 
 KineticStatus ThreadsafeBlockingKineticConnection::MediaOptimize(const string &start_key,
                                                                  bool start_key_inclusive,
                                                                  const string &end_key,
                                                                  bool end_key_inclusive,
-                                                                 unique_ptr<string> &last_handled_key) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->MediaOptimize(start_key, start_key_inclusive, end_key, end_key_inclusive, last_handled_key);
+                                                                 unique_ptr<string> &last_handled_key,
+                                                                 const RequestOptions &options) {
+    return connection_->MediaOptimize(start_key, start_key_inclusive, end_key, end_key_inclusive, last_handled_key,
+                                      options);
 }
 
 }// namespace kinetic
@@ -23,6 +23,10 @@ namespace kinetic {
 using std::shared_ptr;
 using std::string;
 
+// The request methods don't take mutex_: the packet service's Submit path is safe to call from
+// several threads at once and alongside Run(), and the wrapped connection keeps no other state
+// they change.
+
 ThreadsafeNonblockingKineticConnection::ThreadsafeNonblockingKineticConnection(
     unique_ptr<NonblockingKineticConnection> connection) {
     connection_ = std::move(connection);
@@ -38,67 +42,127 @@ bool ThreadsafeNonblockingKineticConnection::Run(fd_set *read_fds,
     return connection_->Run(read_fds, write_fds, nfds);
 }
 
+bool ThreadsafeNonblockingKineticConnection::Run(SocketInterest *interest) {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    return connection_->Run(interest);
+}
+
+bool ThreadsafeNonblockingKineticConnection::SetSocketIo(shared_ptr<SocketIoInterface> io) {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    return connection_->SetSocketIo(io);
+}
+
 bool ThreadsafeNonblockingKineticConnection::RemoveHandler(HandlerKey handler_key) {
     std::lock_guard<std::recursive_mutex> guard(mutex_);
     return connection_->RemoveHandler(handler_key);
 }
 
+// The packet service keeps its own lock for deadlines, so producers needn't wait for Run
+void ThreadsafeNonblockingKineticConnection::SetDeadline(HandlerKey handler_key,
+                                                         unsigned int timeout_ms) {
+    connection_->SetDeadline(handler_key, timeout_ms);
+}
+
+int ThreadsafeNonblockingKineticConnection::TimeUntilDeadline() {
+    return connection_->TimeUntilDeadline();
+}
+
 void ThreadsafeNonblockingKineticConnection::SetClientClusterVersion(int64_t cluster_version) {
     std::lock_guard<std::recursive_mutex> guard(mutex_);
     return connection_->SetClientClusterVersion(cluster_version);
 }
 
-HandlerKey ThreadsafeNonblockingKineticConnection::NoOp(const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->NoOp(callback);
+HandlerKey ThreadsafeNonblockingKineticConnection::NoOp(const shared_ptr<SimpleCallbackInterface> callback,
+                                                        const RequestOptions &options) {
+    return connection_->NoOp(callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::Get(const shared_ptr<const string> key,
-                                                       const shared_ptr<GetCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Get(key, callback);
+                                                       const shared_ptr<GetCallbackInterface> callback,
+                                                       const RequestOptions &options) {
+    return connection_->Get(key, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::Get(const string key,
-                                                       const shared_ptr<GetCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Get(key, callback);
+                                                       const shared_ptr<GetCallbackInterface> callback,
+                                                       const RequestOptions &options) {
+    return connection_->Get(key, callback, options);
+}
+
+HandlerKey ThreadsafeNonblockingKineticConnection::GetInto(const shared_ptr<const string> key,
+                                                           const shared_ptr<ValueBuffer> buffer,
+                                                           const shared_ptr<GetIntoCallbackInterface> callback,
+                                                           const RequestOptions &options) {
+    return connection_->GetInto(key, buffer, callback, options);
+}
+
+HandlerKey ThreadsafeNonblockingKineticConnection::GetInto(const string key,
+                                                           const shared_ptr<ValueBuffer> buffer,
+                                                           const shared_ptr<GetIntoCallbackInterface> callback,
+                                                           const RequestOptions &options) {
+    return connection_->GetInto(key, buffer, callback, options);
+}
+
+HandlerKey ThreadsafeNonblockingKineticConnection::GetInto(const shared_ptr<const string> key,
+                                                           const shared_ptr<ValueBufferPool> pool,
+                                                           const shared_ptr<GetIntoCallbackInterface> callback,
+                                                           const RequestOptions &options) {
+    return connection_->GetInto(key, pool, callback, options);
+}
+
+HandlerKey ThreadsafeNonblockingKineticConnection::GetInto(const string key,
+                                                           const shared_ptr<ValueBufferPool> pool,
+                                                           const shared_ptr<GetIntoCallbackInterface> callback,
+                                                           const RequestOptions &options) {
+    return connection_->GetInto(key, pool, callback, options);
+}
+
+HandlerKey ThreadsafeNonblockingKineticConnection::GetToFile(const shared_ptr<const string> key,
+                                                             const shared_ptr<GetToFileCallbackInterface> callback,
+                                                             const RequestOptions &options) {
+    return connection_->GetToFile(key, callback, options);
+}
+
+HandlerKey ThreadsafeNonblockingKineticConnection::GetToFile(const string key,
+                                                             const shared_ptr<GetToFileCallbackInterface> callback,
+                                                             const RequestOptions &options) {
+    return connection_->GetToFile(key, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::GetNext(const string key,
-                                                           const shared_ptr<GetCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->GetNext(key, callback);
+                                                           const shared_ptr<GetCallbackInterface> callback,
+                                                           const RequestOptions &options) {
+    return connection_->GetNext(key, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::GetNext(const shared_ptr<const string> key,
-                                                           const shared_ptr<GetCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->GetNext(key, callback);
+                                                           const shared_ptr<GetCallbackInterface> callback,
+                                                           const RequestOptions &options) {
+    return connection_->GetNext(key, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::GetPrevious(const shared_ptr<const string> key,
-                                                               const shared_ptr<GetCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->GetPrevious(key, callback);
+                                                               const shared_ptr<GetCallbackInterface> callback,
+                                                               const RequestOptions &options) {
+    return connection_->GetPrevious(key, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::GetPrevious(const string key,
-                                                               const shared_ptr<GetCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->GetPrevious(key, callback);
+                                                               const shared_ptr<GetCallbackInterface> callback,
+                                                               const RequestOptions &options) {
+    return connection_->GetPrevious(key, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::GetVersion(const string key,
-                                                              const shared_ptr<GetVersionCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->GetVersion(key, callback);
+                                                              const shared_ptr<GetVersionCallbackInterface> callback,
+                                                              const RequestOptions &options) {
+    return connection_->GetVersion(key, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::GetVersion(const shared_ptr<const string> key,
-                                                              const shared_ptr<GetVersionCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->GetVersion(key, callback);
+                                                              const shared_ptr<GetVersionCallbackInterface> callback,
+                                                              const RequestOptions &options) {
+    return connection_->GetVersion(key, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::GetKeyRange(const shared_ptr<const string> start_key,
@@ -107,15 +171,16 @@ HandlerKey ThreadsafeNonblockingKineticConnection::GetKeyRange(const shared_ptr<
                                                                bool end_key_inclusive,
                                                                bool reverse_results,
                                                                int32_t max_results,
-                                                              const shared_ptr<GetKeyRangeCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
+                                                              const shared_ptr<GetKeyRangeCallbackInterface> callback,
+                                                              const RequestOptions &options) {
     return connection_->GetKeyRange(start_key,
                                     start_key_inclusive,
                                     end_key,
                                     end_key_inclusive,
                                     reverse_results,
                                     max_results,
-                                    callback);
+                                    callback,
+                                    options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::GetKeyRange(const string start_key,
@@ -124,33 +189,34 @@ HandlerKey ThreadsafeNonblockingKineticConnection::GetKeyRange(const string star
                                                                bool end_key_inclusive,
                                                                bool reverse_results,
                                                                int32_t max_results,
-                                                              const shared_ptr<GetKeyRangeCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
+                                                              const shared_ptr<GetKeyRangeCallbackInterface> callback,
+                                                              const RequestOptions &options) {
     return connection_->GetKeyRange(start_key,
                                     start_key_inclusive,
                                     end_key,
                                     end_key_inclusive,
                                     reverse_results,
                                     max_results,
-                                    callback);
+                                    callback,
+                                    options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::Put(const shared_ptr<const string> key,
                                                        const shared_ptr<const string> current_version,
                                                        WriteMode mode,
                                                        const shared_ptr<const KineticRecord> record,
-                                                       const shared_ptr<PutCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Put(key, current_version, mode, record, callback);
+                                                       const shared_ptr<PutCallbackInterface> callback,
+                                                       const RequestOptions &options) {
+    return connection_->Put(key, current_version, mode, record, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::Put(const string key,
                                                        const string current_version,
                                                        WriteMode mode,
                                                        const shared_ptr<const KineticRecord> record,
-                                                       const shared_ptr<PutCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Put(key, current_version, mode, record, callback);
+                                                       const shared_ptr<PutCallbackInterface> callback,
+                                                       const RequestOptions &options) {
+    return connection_->Put(key, current_version, mode, record, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::Put(const shared_ptr<const string> key,
@@ -158,9 +224,9 @@ HandlerKey ThreadsafeNonblockingKineticConnection::Put(const shared_ptr<const st
                                                        WriteMode mode,
                                                        const shared_ptr<const KineticRecord> record,
                                                        const shared_ptr<PutCallbackInterface> callback,
-                                                       PersistMode persistMode) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Put(key, current_version, mode, record, callback, persistMode);
+                                                       PersistMode persistMode,
+                                                       const RequestOptions &options) {
+    return connection_->Put(key, current_version, mode, record, callback, persistMode, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::Put(const string key,
@@ -168,165 +234,193 @@ HandlerKey ThreadsafeNonblockingKineticConnection::Put(const string key,
                                                        WriteMode mode,
                                                        const shared_ptr<const KineticRecord> record,
                                                        const shared_ptr<PutCallbackInterface> callback,
-                                                       PersistMode persistMode) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Put(key, current_version, mode, record, callback, persistMode);
+                                                       PersistMode persistMode,
+                                                       const RequestOptions &options) {
+    return connection_->Put(key, current_version, mode, record, callback, persistMode, options);
+}
+
+HandlerKey ThreadsafeNonblockingKineticConnection::Put(const shared_ptr<const string> key,
+                                                       const shared_ptr<const string> current_version,
+                                                       WriteMode mode,
+                                                       const shared_ptr<const KineticRecord> record,
+                                                       const shared_ptr<const OutgoingValueInterface> value,
+                                                       const shared_ptr<PutCallbackInterface> callback,
+                                                       PersistMode persistMode,
+                                                       const RequestOptions &options) {
+    return connection_->Put(key, current_version, mode, record, value, callback, persistMode, options);
+}
+
+HandlerKey ThreadsafeNonblockingKineticConnection::Put(const string key,
+                                                       const string current_version,
+                                                       WriteMode mode,
+                                                       const shared_ptr<const KineticRecord> record,
+                                                       const shared_ptr<const OutgoingValueInterface> value,
+                                                       const shared_ptr<PutCallbackInterface> callback,
+                                                       PersistMode persistMode,
+                                                       const RequestOptions &options) {
+    return connection_->Put(key, current_version, mode, record, value, callback, persistMode, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::Delete(const shared_ptr<const string> key,
                                                           const shared_ptr<const string> version,
                                                           WriteMode mode,
                                                           const shared_ptr<SimpleCallbackInterface> callback,
-                                                          PersistMode persistMode) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Delete(key, version, mode, callback, persistMode);
+                                                          PersistMode persistMode,
+                                                          const RequestOptions &options) {
+    return connection_->Delete(key, version, mode, callback, persistMode, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::Delete(const string key,
                                                           const string version,
                                                           WriteMode mode,
                                                           const shared_ptr<SimpleCallbackInterface> callback,
-                                                          PersistMode persistMode) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Delete(key, version, mode, callback, persistMode);
+                                                          PersistMode persistMode,
+                                                          const RequestOptions &options) {
+    return connection_->Delete(key, version, mode, callback, persistMode, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::Delete(const shared_ptr<const string> key,
                                                           const shared_ptr<const string> version,
                                                           WriteMode mode,
-                                                          const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Delete(key, version, mode, callback);
+                                                          const shared_ptr<SimpleCallbackInterface> callback,
+                                                          const RequestOptions &options) {
+    return connection_->Delete(key, version, mode, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::Delete(const string key,
                                                           const string version,
                                                           WriteMode mode,
-                                                          const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Delete(key, version, mode, callback);
+                                                          const shared_ptr<SimpleCallbackInterface> callback,
+                                                          const RequestOptions &options) {
+    return connection_->Delete(key, version, mode, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::InstantErase(const string pin,
-                                                                const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->InstantErase(pin, callback);
+                                                                const shared_ptr<SimpleCallbackInterface> callback,
+                                                                const RequestOptions &options) {
+    return connection_->InstantErase(pin, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::InstantErase(const shared_ptr<string> pin,
-                                                                const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->InstantErase(pin, callback);
+                                                                const shared_ptr<SimpleCallbackInterface> callback,
+                                                                const RequestOptions &options) {
+    return connection_->InstantErase(pin, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::SecureErase(const string pin,
-                                                               const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->SecureErase(pin, callback);
+                                                               const shared_ptr<SimpleCallbackInterface> callback,
+                                                               const RequestOptions &options) {
+    return connection_->SecureErase(pin, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::SecureErase(const shared_ptr<string> pin,
-                                                               const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->SecureErase(pin, callback);
+                                                               const shared_ptr<SimpleCallbackInterface> callback,
+                                                               const RequestOptions &options) {
+    return connection_->SecureErase(pin, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::SetClusterVersion(int64_t new_cluster_version,
-                                                                   const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->SetClusterVersion(new_cluster_version, callback);
+                                                                   const shared_ptr<SimpleCallbackInterface> callback,
+                                                                   const RequestOptions &options) {
+    return connection_->SetClusterVersion(new_cluster_version, callback, options);
 }
 
-HandlerKey ThreadsafeNonblockingKineticConnection::GetLog(const shared_ptr<GetLogCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->GetLog(callback);
+HandlerKey ThreadsafeNonblockingKineticConnection::GetLog(const shared_ptr<GetLogCallbackInterface> callback,
+                                                          const RequestOptions &options) {
+    return connection_->GetLog(callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::GetLog(const vector<Command_GetLog_Type> &types,
-                                                          const shared_ptr<GetLogCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->GetLog(types, callback);
+                                                          const shared_ptr<GetLogCallbackInterface> callback,
+                                                          const RequestOptions &options) {
+    return connection_->GetLog(types, callback, options);
 }
 
-HandlerKey ThreadsafeNonblockingKineticConnection::Flush(const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->Flush(callback);
+HandlerKey ThreadsafeNonblockingKineticConnection::Flush(const shared_ptr<SimpleCallbackInterface> callback,
+                                                         const RequestOptions &options) {
+    return connection_->Flush(callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::UpdateFirmware(const shared_ptr<const string> new_firmware,
-                                                                  const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->UpdateFirmware(new_firmware, callback);
+                                                                  const shared_ptr<SimpleCallbackInterface> callback,
+                                                                  const RequestOptions &options) {
+    return connection_->UpdateFirmware(new_firmware, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::SetACLs(const shared_ptr<const list<ACL>> acls,
-                                                           const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->SetACLs(acls, callback);
+                                                           const shared_ptr<SimpleCallbackInterface> callback,
+                                                           const RequestOptions &options) {
+    return connection_->SetACLs(acls, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::SetErasePIN(const shared_ptr<const string> new_pin,
                                                                const shared_ptr<const string> current_pin,
-                                                               const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->SetErasePIN(new_pin, current_pin, callback);
+                                                               const shared_ptr<SimpleCallbackInterface> callback,
+                                                               const RequestOptions &options) {
+    return connection_->SetErasePIN(new_pin, current_pin, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::SetErasePIN(const string new_pin,
                                                                const string current_pin,
-                                                               const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->SetErasePIN(new_pin, current_pin, callback);
+                                                               const shared_ptr<SimpleCallbackInterface> callback,
+                                                               const RequestOptions &options) {
+    return connection_->SetErasePIN(new_pin, current_pin, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::LockDevice(const string pin,
-                                                              const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->LockDevice(pin, callback);
+                                                              const shared_ptr<SimpleCallbackInterface> callback,
+                                                              const RequestOptions &options) {
+    return connection_->LockDevice(pin, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::LockDevice(const shared_ptr<string> pin,
-                                                              const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->LockDevice(pin, callback);
+                                                              const shared_ptr<SimpleCallbackInterface> callback,
+                                                              const RequestOptions &options) {
+    return connection_->LockDevice(pin, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::UnlockDevice(const string pin,
-                                                                const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->UnlockDevice(pin, callback);
+                                                                const shared_ptr<SimpleCallbackInterface> callback,
+                                                                const RequestOptions &options) {
+    return connection_->UnlockDevice(pin, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::UnlockDevice(const shared_ptr<string> pin,
-                                                                const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->UnlockDevice(pin, callback);
+                                                                const shared_ptr<SimpleCallbackInterface> callback,
+                                                                const RequestOptions &options) {
+    return connection_->UnlockDevice(pin, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::SetLockPIN(const shared_ptr<const string> new_pin,
                                                               const shared_ptr<const string> current_pin,
-                                                              const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->SetLockPIN(new_pin, current_pin, callback);
+                                                              const shared_ptr<SimpleCallbackInterface> callback,
+                                                              const RequestOptions &options) {
+    return connection_->SetLockPIN(new_pin, current_pin, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::SetLockPIN(const string new_pin,
                                                               const string current_pin,
-                                                              const shared_ptr<SimpleCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->SetLockPIN(new_pin, current_pin, callback);
+                                                              const shared_ptr<SimpleCallbackInterface> callback,
+                                                              const RequestOptions &options) {
+    return connection_->SetLockPIN(new_pin, current_pin, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::P2PPush(const shared_ptr<const P2PPushRequest> push_request,
-                                                           const shared_ptr<P2PPushCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->P2PPush(push_request, callback);
+                                                           const shared_ptr<P2PPushCallbackInterface> callback,
+                                                           const RequestOptions &options) {
+    return connection_->P2PPush(push_request, callback, options);
+}
+
+vector<HandlerKey> ThreadsafeNonblockingKineticConnection::SubmitBatch(const Batch &batch,
+                                                                       const shared_ptr<BatchCallbackInterface> callback,
+                                                                       const RequestOptions &options) {
+    return connection_->SubmitBatch(batch, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::P2PPush(const P2PPushRequest &push_request,
-                                                           const shared_ptr<P2PPushCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->P2PPush(push_request, callback);
+                                                           const shared_ptr<P2PPushCallbackInterface> callback,
+                                                           const RequestOptions &options) {
+    return connection_->P2PPush(push_request, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::MediaScan(const shared_ptr<const string> start_key,
@@ -334,9 +428,10 @@ HandlerKey ThreadsafeNonblockingKineticConnection::MediaScan(const shared_ptr<co
                                                              const shared_ptr<const string> end_key,
                                                              bool end_key_inclusive,
                                                              int32_t max_results,
-                                                             const shared_ptr<MediaScanCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->MediaScan(start_key, start_key_inclusive, end_key, end_key_inclusive, max_results, callback);
+                                                             const shared_ptr<MediaScanCallbackInterface> callback,
+                                                             const RequestOptions &options) {
+    return connection_->MediaScan(start_key, start_key_inclusive, end_key, end_key_inclusive, max_results, callback,
+                                  options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::MediaScan(const string start_key,
@@ -344,27 +439,28 @@ HandlerKey ThreadsafeNonblockingKineticConnection::MediaScan(const string start_
                                                              const string end_key,
                                                              bool end_key_inclusive,
                                                              int32_t max_results,
-                                                             const shared_ptr<MediaScanCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->MediaScan(start_key, start_key_inclusive, end_key, end_key_inclusive, max_results, callback);
+                                                             const shared_ptr<MediaScanCallbackInterface> callback,
+                                                             const RequestOptions &options) {
+    return connection_->MediaScan(start_key, start_key_inclusive, end_key, end_key_inclusive, max_results, callback,
+                                  options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::MediaOptimize(const shared_ptr<const string> start_key,
                                                                  bool start_key_inclusive,
                                                                  const shared_ptr<const string> end_key,
                                                                  bool end_key_inclusive,
-                                                            const shared_ptr<MediaOptimizeCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->MediaOptimize(start_key, start_key_inclusive, end_key, end_key_inclusive, callback);
+                                                            const shared_ptr<MediaOptimizeCallbackInterface> callback,
+                                                            const RequestOptions &options) {
+    return connection_->MediaOptimize(start_key, start_key_inclusive, end_key, end_key_inclusive, callback, options);
 }
 
 HandlerKey ThreadsafeNonblockingKineticConnection::MediaOptimize(const string start_key,
                                                                  bool start_key_inclusive,
                                                                  const string end_key,
                                                                  bool end_key_inclusive,
-                                                            const shared_ptr<MediaOptimizeCallbackInterface> callback) {
-    std::lock_guard<std::recursive_mutex> guard(mutex_);
-    return connection_->MediaOptimize(start_key, start_key_inclusive, end_key, end_key_inclusive, callback);
+                                                            const shared_ptr<MediaOptimizeCallbackInterface> callback,
+                                                            const RequestOptions &options) {
+    return connection_->MediaOptimize(start_key, start_key_inclusive, end_key, end_key_inclusive, callback, options);
 }
 
 } // namespace kinetic
@@ -0,0 +1,165 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include "timer_wheel.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace kinetic {
+
+using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
+using std::chrono::duration_cast;
+
+const int TimerWheel::kLevels;
+const int TimerWheel::kSlotBits;
+const uint64_t TimerWheel::kSlots;
+const uint64_t TimerWheel::kNever;
+
+TimerWheel::TimerWheel(Clock::time_point start) : start_(start), now_(0), size_(0) {}
+
+void TimerWheel::Add(HandlerKey key, Clock::time_point deadline) {
+    Timer timer;
+    timer.key = key;
+    timer.tick = TickAt(deadline, true);
+    Place(timer);
+    size_++;
+}
+
+void TimerWheel::Advance(Clock::time_point now, vector<HandlerKey> *expired) {
+    uint64_t target = TickAt(now, false);
+    while (now_ < target) {
+        if (size_ == due_.size()) {
+            // Nothing left in the slots, so there's no need to visit them
+            now_ = target;
+            break;
+        }
+        now_++;
+
+        // Entering a new block of a level brings its timers down, coarsest level first
+        int level = 1;
+        while (level < kLevels && (now_ & ((uint64_t(1) << (kSlotBits * level)) - 1)) == 0) {
+            level++;
+        }
+        for (int cascade = level - 1; cascade >= 1; cascade--) {
+            Cascade(cascade);
+        }
+
+        vector<Timer> &slot = slots_[0][now_ & (kSlots - 1)];
+        due_.insert(due_.end(), slot.begin(), slot.end());
+        slot.clear();
+    }
+
+    for (auto it = due_.begin(); it != due_.end(); ++it) {
+        expired->push_back(it->key);
+    }
+    size_ -= due_.size();
+    due_.clear();
+}
+
+int TimerWheel::NextTimeout(Clock::time_point now) const {
+    uint64_t tick = NextTick();
+    if (tick == kNever) {
+        return -1;
+    }
+    Clock::time_point time = start_ + milliseconds(tick);
+    if (time <= now) {
+        return 0;
+    }
+    int64_t remaining_ms = duration_cast<milliseconds>(time - now + milliseconds(1) -
+        nanoseconds(1)).count();
+    return static_cast<int>(std::min<int64_t>(remaining_ms, INT_MAX));
+}
+
+bool TimerWheel::empty() const {
+    return size_ == 0;
+}
+
+size_t TimerWheel::size() const {
+    return size_;
+}
+
+uint64_t TimerWheel::TickAt(Clock::time_point time, bool round_up) const {
+    if (time <= start_) {
+        return 0;
+    }
+    int64_t ns = duration_cast<nanoseconds>(time - start_).count();
+    const int64_t ns_per_tick = 1000000;
+    return ns / ns_per_tick + (round_up && ns % ns_per_tick != 0 ? 1 : 0);
+}
+
+void TimerWheel::Place(const Timer &timer) {
+    if (timer.tick <= now_) {
+        due_.push_back(timer);
+        return;
+    }
+
+    uint64_t delta = timer.tick - now_;
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (uint64_t(1) << (kSlotBits * (level + 1)))) {
+        level++;
+    }
+    uint64_t tick = timer.tick;
+    const uint64_t range = uint64_t(1) << (kSlotBits * kLevels);
+    if (delta >= range) {
+        // Further out than the wheel reaches; it waits in the farthest slot and is placed again
+        // when that comes round
+        tick = now_ + range - 1;
+    }
+    slots_[level][(tick >> (kSlotBits * level)) & (kSlots - 1)].push_back(timer);
+}
+
+// Spreads the slot of the given level that now_ has just entered over the finer levels
+void TimerWheel::Cascade(int level) {
+    vector<Timer> timers;
+    timers.swap(slots_[level][(now_ >> (kSlotBits * level)) & (kSlots - 1)]);
+    for (auto it = timers.begin(); it != timers.end(); ++it) {
+        Place(*it);
+    }
+}
+
+// The earliest tick at which a timer comes due or has to be cascaded, or kNever
+uint64_t TimerWheel::NextTick() const {
+    if (!due_.empty()) {
+        return now_;
+    }
+    if (size_ == 0) {
+        return kNever;
+    }
+
+    uint64_t next = kNever;
+    for (uint64_t i = 1; i < kSlots; i++) {
+        if (!slots_[0][(now_ + i) & (kSlots - 1)].empty()) {
+            next = now_ + i;
+            break;
+        }
+    }
+    for (int level = 1; level < kLevels; level++) {
+        int shift = kSlotBits * level;
+        for (uint64_t i = 1; i <= kSlots; i++) {
+            uint64_t block = (now_ >> shift) + i;
+            if (!slots_[level][block & (kSlots - 1)].empty()) {
+                next = std::min(next, block << shift);
+                break;
+            }
+        }
+    }
+    return next;
+}
+
+} // namespace kinetic
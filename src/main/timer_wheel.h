@@ -0,0 +1,82 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifndef KINETIC_CPP_CLIENT_TIMER_WHEEL_H_
+#define KINETIC_CPP_CLIENT_TIMER_WHEEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <chrono>
+#include <vector>
+
+#include "kinetic/common.h"
+#include "kinetic/nonblocking_packet_service_interface.h"
+
+namespace kinetic {
+
+using std::vector;
+
+// Request deadlines, kept to the millisecond. A hierarchical timing wheel: each level has 64
+// slots, a slot in level n spanning 64^n ticks, and a timer goes in the finest level whose range
+// covers it. When the finest level wraps around, the next slot up is spread out over it. Adding a
+// timer and expiring one are constant time however many are pending. Timers can't be cancelled;
+// whoever acts on an expired key has to allow for its request having finished already.
+class TimerWheel {
+    public:
+    typedef std::chrono::steady_clock Clock;
+
+    explicit TimerWheel(Clock::time_point start);
+    void Add(HandlerKey key, Clock::time_point deadline);
+    // Moves the wheel on to now, appending the keys of every timer that has come due
+    void Advance(Clock::time_point now, vector<HandlerKey> *expired);
+    // Milliseconds from now until Advance next has something to do, or -1 if no timers are
+    // pending. This can come before the earliest deadline, when timers have to be moved down a
+    // level first.
+    int NextTimeout(Clock::time_point now) const;
+    bool empty() const;
+    size_t size() const;
+
+    private:
+    static const int kLevels = 4;
+    static const int kSlotBits = 6;
+    static const uint64_t kSlots = 1 << kSlotBits;
+    static const uint64_t kNever = UINT64_MAX;
+
+    struct Timer {
+        HandlerKey key;
+        uint64_t tick;
+    };
+
+    uint64_t TickAt(Clock::time_point time, bool round_up) const;
+    void Place(const Timer &timer);
+    void Cascade(int level);
+    uint64_t NextTick() const;
+
+    const Clock::time_point start_;
+    // The last tick Advance has run to
+    uint64_t now_;
+    size_t size_;
+    vector<Timer> slots_[kLevels][kSlots];
+    // Timers already due when placed, handed out by the next Advance
+    vector<Timer> due_;
+    DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+};
+
+} // namespace kinetic
+
+#endif  // KINETIC_CPP_CLIENT_TIMER_WHEEL_H_
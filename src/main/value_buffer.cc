@@ -0,0 +1,79 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include "kinetic/value_buffer.h"
+
+namespace kinetic {
+
+const size_t ValueBufferPool::kMinBufferSize;
+
+ValueBufferPool::ValueBufferPool(size_t max_idle_per_class)
+    : free_lists_(std::make_shared<FreeLists>(max_idle_per_class)) {}
+
+shared_ptr<ValueBuffer> ValueBufferPool::Lease(size_t size) {
+    size_t size_class = 0;
+    size_t capacity = kMinBufferSize;
+    while (capacity < size) {
+        capacity <<= 1;
+        size_class++;
+    }
+
+    char *data = NULL;
+    {
+        std::lock_guard<std::mutex> lock(free_lists_->mutex);
+        if (size_class < free_lists_->idle.size() && !free_lists_->idle[size_class].empty()) {
+            data = free_lists_->idle[size_class].back();
+            free_lists_->idle[size_class].pop_back();
+        }
+    }
+    if (data == NULL) {
+        data = new char[capacity];
+    }
+
+    // The deleter holds on to the free lists rather than the pool so a lease can safely be
+    // dropped after the pool is gone
+    shared_ptr<FreeLists> free_lists = free_lists_;
+    return shared_ptr<ValueBuffer>(new ValueBuffer(data, capacity),
+        [free_lists, size_class](ValueBuffer *buffer) {
+            free_lists->Release(size_class, buffer->data());
+            delete buffer;
+        });
+}
+
+ValueBufferPool::FreeLists::~FreeLists() {
+    for (auto size_class = idle.begin(); size_class != idle.end(); ++size_class) {
+        for (auto data = size_class->begin(); data != size_class->end(); ++data) {
+            delete[] *data;
+        }
+    }
+}
+
+void ValueBufferPool::FreeLists::Release(size_t size_class, char *data) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (idle.size() <= size_class) {
+            idle.resize(size_class + 1);
+        }
+        if (idle[size_class].size() < max_idle_per_class) {
+            idle[size_class].push_back(data);
+            return;
+        }
+    }
+    delete[] data;
+}
+
+} // namespace kinetic
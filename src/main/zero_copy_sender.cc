@@ -0,0 +1,124 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include "zero_copy_sender.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#ifdef __linux__
+#include <linux/errqueue.h>
+#endif
+
+#include "glog/logging.h"
+
+namespace kinetic {
+
+ZeroCopySender::ZeroCopySender(int fd, size_t threshold)
+    : fd_(fd), threshold_(threshold), next_id_(0), pending_() {}
+
+bool ZeroCopySender::Enable(int fd) {
+#if defined(__linux__) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+    int one = 1;
+    return setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0;
+#else
+    return false;
+#endif
+}
+
+size_t ZeroCopySender::threshold() const {
+    return threshold_;
+}
+
+size_t ZeroCopySender::outstanding() const {
+    return pending_.size();
+}
+
+ssize_t ZeroCopySender::Send(const struct iovec *iov, int iovcnt, shared_ptr<const string> owner) {
+#if defined(__linux__) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = const_cast<struct iovec *>(iov);
+    msg.msg_iovlen = iovcnt;
+    ssize_t sent = sendmsg(fd_, &msg, MSG_ZEROCOPY | MSG_NOSIGNAL);
+    if (sent > 0) {
+        // Every send that queued data takes the next notification id, whether or not the kernel
+        // ends up copying after all
+        PendingSend pending;
+        pending.id = next_id_++;
+        pending.completed = false;
+        pending.owner = owner;
+        pending_.push_back(pending);
+    }
+    return sent;
+#else
+    errno = ENOBUFS;
+    return -1;
+#endif
+}
+
+void ZeroCopySender::ReapCompletions() {
+#ifdef __linux__
+    while (!pending_.empty()) {
+        char control[CMSG_SPACE(sizeof(struct sock_extended_err)) + CMSG_SPACE(sizeof(struct sockaddr_in6))];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(fd_, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                PLOG(WARNING) << "Failed to read zero-copy notifications";
+            }
+            return;
+        }
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            bool recverr = (cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR);
+            if (!recverr) {
+                continue;
+            }
+            struct sock_extended_err err;
+            memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+            if (err.ee_errno == 0 && err.ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+                // The notification covers an inclusive range of send ids
+                Complete(err.ee_info, err.ee_data);
+            }
+        }
+    }
+#endif
+}
+
+void ZeroCopySender::Complete(uint32_t first, uint32_t last) {
+    uint32_t span = last - first;
+    for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+        if (it->id - first <= span) {
+            it->completed = true;
+            it->owner.reset();
+        }
+    }
+    // Notifications usually arrive in order but aren't guaranteed to
+    while (!pending_.empty() && pending_.front().completed) {
+        pending_.pop_front();
+    }
+}
+
+} // namespace kinetic
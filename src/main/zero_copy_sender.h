@@ -0,0 +1,74 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifndef KINETIC_CPP_CLIENT_ZERO_COPY_SENDER_H_
+#define KINETIC_CPP_CLIENT_ZERO_COPY_SENDER_H_
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <stdint.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "kinetic/common.h"
+
+namespace kinetic {
+
+using std::shared_ptr;
+using std::string;
+
+// Sends large buffers on a TCP socket with MSG_ZEROCOPY. The kernel reads them straight from user
+// memory after the send call has returned, so the string owning each buffer is held on to until
+// the notification for every send that referenced it has been read off the socket's error queue.
+class ZeroCopySender {
+    public:
+    // Only buffers of at least threshold bytes are worth the page pinning and notifications
+    ZeroCopySender(int fd, size_t threshold);
+    // Turns on SO_ZEROCOPY for a socket. Returns false if the kernel or the socket doesn't
+    // support it.
+    static bool Enable(int fd);
+    size_t threshold() const;
+    // Behaves like sendmsg on a nonblocking socket. The buffers must lie within owner. Fails with
+    // ENOBUFS when the kernel can't track more sends; the caller should copy instead.
+    ssize_t Send(const struct iovec *iov, int iovcnt, shared_ptr<const string> owner);
+    // Releases the owners of sends the kernel has finished with. Never blocks.
+    void ReapCompletions();
+    // The number of sends still waiting for their notification
+    size_t outstanding() const;
+
+    private:
+    struct PendingSend {
+        uint32_t id;
+        bool completed;
+        shared_ptr<const string> owner;
+    };
+
+    void Complete(uint32_t first, uint32_t last);
+
+    const int fd_;
+    const size_t threshold_;
+    // The kernel numbers zero-copy sends on a socket consecutively from 0
+    uint32_t next_id_;
+    std::deque<PendingSend> pending_;
+    DISALLOW_COPY_AND_ASSIGN(ZeroCopySender);
+};
+
+} // namespace kinetic
+
+#endif  // KINETIC_CPP_CLIENT_ZERO_COPY_SENDER_H_
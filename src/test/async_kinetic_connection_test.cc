@@ -0,0 +1,138 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without 
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or 
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public 
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include <unistd.h>
+
+#include "kinetic/kinetic.h"
+#include "matchers.h"
+
+#include "nonblocking_packet_service.h"
+#include "mock_nonblocking_packet_service.h"
+
+namespace kinetic {
+
+using ::testing::_;
+using ::testing::An;
+using ::testing::DoAll;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+
+using std::unique_ptr;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+class AsyncKineticConnectionTest : public ::testing::Test {
+    protected:
+    AsyncKineticConnectionTest()
+            : packet_service_(new NiceMock<MockNonblockingPacketService>),
+            connection_(unique_ptr<NonblockingKineticConnection>(
+                new NonblockingKineticConnection(packet_service_)), 0) {
+        ON_CALL(*packet_service_, Run(An<SocketInterest *>())).WillByDefault(Return(true));
+    }
+
+    // Completes requests as soon as they're submitted, failing those for keys starting with
+    // "missing" and leaving those for keys starting with "pending" outstanding
+    static HandlerKey Complete(const Message &message, const Command &command,
+            const shared_ptr<const string> value, HandlerInterface *handler) {
+        const string &key = command.body().keyvalue().key();
+        if (key.compare(0, 7, "pending") == 0) {
+            return 0;
+        }
+        if (key.compare(0, 7, "missing") == 0) {
+            handler->Error(KineticStatus(StatusCode::REMOTE_NOT_FOUND, "Key not found"), NULL);
+            return 0;
+        }
+        Command response;
+        response.mutable_body()->mutable_keyvalue()->set_key(key);
+        response.mutable_body()->mutable_keyvalue()->set_dbversion("version");
+        handler->Handle(response, unique_ptr<const string>(new string("value of " + key)));
+        return 0;
+    }
+
+    MockNonblockingPacketService* packet_service_;
+    AsyncKineticConnection connection_;
+};
+
+TEST_F(AsyncKineticConnectionTest, FuturesHoldTheirResults) {
+    EXPECT_CALL(*packet_service_, Submit_(_, _, _, _)).WillRepeatedly(Invoke(Complete));
+
+    auto found = connection_.Get("a");
+    auto missing = connection_.Get("missing");
+    auto version = connection_.GetVersion("b");
+    ASSERT_TRUE(connection_.WaitAll({found, missing, version}).ok());
+
+    ASSERT_TRUE(found.status().ok());
+    ASSERT_EQ("value of a", *found.value()->value());
+    ASSERT_EQ(StatusCode::REMOTE_NOT_FOUND, missing.status().statusCode());
+    ASSERT_EQ("version", version.value());
+    ASSERT_EQ(StatusCode::REMOTE_NOT_FOUND, connection_.Wait(missing).statusCode());
+}
+
+TEST_F(AsyncKineticConnectionTest, WaitAnyReturnsOnceOneFutureIsReady) {
+    EXPECT_CALL(*packet_service_, Submit_(_, _, _, _)).WillRepeatedly(Invoke(Complete));
+
+    auto pending = connection_.Get("pending");
+    auto found = connection_.Get("a");
+    size_t ready_index = 0;
+    ASSERT_TRUE(connection_.WaitAny({pending, found}, &ready_index).ok());
+
+    ASSERT_EQ(1u, ready_index);
+    ASSERT_FALSE(pending.ready());
+}
+
+TEST_F(AsyncKineticConnectionTest, WaitReturnsCompletedFutureStatusAfterConnectionFails) {
+    EXPECT_CALL(*packet_service_, Submit_(_, _, _, _)).WillRepeatedly(Invoke(Complete));
+    auto found = connection_.Get("a");
+    auto missing = connection_.Get("missing");
+    auto pending = connection_.Get("pending");
+
+    // The connection fails after the first two have completed
+    EXPECT_CALL(*packet_service_, Run(An<SocketInterest *>())).WillRepeatedly(Return(false));
+    ASSERT_EQ(StatusCode::CLIENT_IO_ERROR, connection_.Wait(pending).statusCode());
+
+    ASSERT_TRUE(connection_.Wait(found).ok());
+    ASSERT_EQ(StatusCode::REMOTE_NOT_FOUND, connection_.Wait(missing).statusCode());
+    ASSERT_TRUE(connection_.WaitAll({found, missing}).ok());
+    size_t ready_index = 0;
+    ASSERT_TRUE(connection_.WaitAny({pending, missing}, &ready_index).ok());
+    ASSERT_EQ(1u, ready_index);
+}
+
+TEST_F(AsyncKineticConnectionTest, WaitFailsWhenNothingCompletesWithinTheTimeout) {
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    SocketInterest interest;
+    interest.fd = fds[0];
+    interest.read = true;
+    EXPECT_CALL(*packet_service_, Run(An<SocketInterest *>()))
+            .WillRepeatedly(DoAll(SetArgPointee<0>(interest), Return(true)));
+    EXPECT_CALL(*packet_service_, Submit_(_, _, _, _)).WillRepeatedly(Invoke(Complete));
+
+    auto pending = connection_.Get("pending");
+    KineticStatus status = connection_.Wait(pending);
+
+    ASSERT_EQ(StatusCode::CLIENT_IO_ERROR, status.statusCode());
+    ASSERT_EQ("Network timeout", status.message());
+    ASSERT_FALSE(pending.ready());
+    close(fds[0]);
+    close(fds[1]);
+}
+
+}  // namespace kinetic
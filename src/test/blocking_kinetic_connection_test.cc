@@ -0,0 +1,179 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without 
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or 
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public 
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include <mutex>
+#include <thread>
+
+#include "kinetic/kinetic.h"
+#include "kinetic/blocking_kinetic_connection.h"
+#include "matchers.h"
+
+#include "nonblocking_packet_service.h"
+#include "mock_nonblocking_packet_service.h"
+
+namespace kinetic {
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+using std::make_shared;
+using std::unique_ptr;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+using std::pair;
+
+class BlockingKineticConnectionTest : public ::testing::Test {
+    protected:
+    BlockingKineticConnectionTest()
+            : packet_service_(new NiceMock<MockNonblockingPacketService>),
+            connection_(unique_ptr<NonblockingKineticConnection>(
+                new NonblockingKineticConnection(packet_service_)), 10) {
+    }
+
+    // Completes every request as soon as it's submitted, failing those for keys starting with
+    // "missing"
+    static HandlerKey Complete(const Message &message, const Command &command,
+            const shared_ptr<const string> value, HandlerInterface *handler) {
+        const string &key = command.body().keyvalue().key();
+        if (key.compare(0, 7, "missing") == 0) {
+            handler->Error(KineticStatus(StatusCode::REMOTE_NOT_FOUND, "Key not found"), NULL);
+        } else {
+            Command response;
+            response.mutable_body()->mutable_keyvalue()->set_key(key);
+            response.mutable_body()->mutable_keyvalue()->set_dbversion("version");
+            handler->Handle(response, unique_ptr<const string>(new string("value of " + key)));
+        }
+        return 0;
+    }
+
+    MockNonblockingPacketService* packet_service_;
+    BlockingKineticConnection connection_;
+};
+
+TEST_F(BlockingKineticConnectionTest, MultiGetReturnsRecordsAndStatusesInKeyOrder) {
+    EXPECT_CALL(*packet_service_, Submit_(_, _, _, _)).Times(3).WillRepeatedly(Invoke(Complete));
+    EXPECT_CALL(*packet_service_, Run(::testing::An<SocketInterest *>())).WillRepeatedly(Return(true));
+
+    vector<string> keys = {"a", "missing", "b"};
+    vector<unique_ptr<KineticRecord>> records;
+    unique_ptr<vector<KineticStatus>> statuses;
+    KineticStatus status = connection_.MultiGet(keys, records, statuses);
+
+    ASSERT_EQ(StatusCode::REMOTE_NOT_FOUND, status.statusCode());
+    ASSERT_EQ(3u, records.size());
+    ASSERT_EQ("value of a", *records[0]->value());
+    ASSERT_FALSE(records[1]);
+    ASSERT_EQ("value of b", *records[2]->value());
+    ASSERT_EQ(3u, statuses->size());
+    ASSERT_TRUE((*statuses)[0].ok());
+    ASSERT_EQ(StatusCode::REMOTE_NOT_FOUND, (*statuses)[1].statusCode());
+    ASSERT_TRUE((*statuses)[2].ok());
+}
+
+TEST_F(BlockingKineticConnectionTest, MultiPutSubmitsAWindowAtATime) {
+    EXPECT_CALL(*packet_service_, Submit_(_, _, StringSharedPtrEq("value"), _))
+            .Times(5).WillRepeatedly(Invoke(Complete));
+    // Every window is sent with one Run, and its responses are all in by then
+    EXPECT_CALL(*packet_service_, Run(::testing::An<SocketInterest *>()))
+            .Times(3).WillRepeatedly(Return(true));
+
+    auto record = make_shared<KineticRecord>("value", "new_version", "tag",
+            com::seagate::kinetic::client::proto::Command_Algorithm_SHA1);
+    vector<PutOperation> puts;
+    for (int i = 0; i < 5; ++i) {
+        PutOperation put;
+        put.key = "key" + std::to_string(i);
+        put.mode = WriteMode::IGNORE_VERSION;
+        put.record = record;
+        puts.push_back(put);
+    }
+    unique_ptr<vector<KineticStatus>> statuses;
+    ASSERT_TRUE(connection_.MultiPut(puts, PersistMode::WRITE_BACK, statuses, 2).ok());
+    ASSERT_EQ(5u, statuses->size());
+}
+
+TEST_F(BlockingKineticConnectionTest, MultiDeleteFailsEveryUnfinishedOperationWhenConnectionFails) {
+    EXPECT_CALL(*packet_service_, Submit_(_, _, _, _)).Times(2).WillRepeatedly(Return(0));
+    EXPECT_CALL(*packet_service_, Run(::testing::An<SocketInterest *>())).WillOnce(Return(false));
+    EXPECT_CALL(*packet_service_, Remove(_)).Times(2).WillRepeatedly(Return(true));
+
+    vector<DeleteOperation> deletes;
+    for (int i = 0; i < 3; ++i) {
+        DeleteOperation del;
+        del.key = "key" + std::to_string(i);
+        del.mode = WriteMode::IGNORE_VERSION;
+        deletes.push_back(del);
+    }
+    unique_ptr<vector<KineticStatus>> statuses;
+    KineticStatus status = connection_.MultiDelete(deletes, PersistMode::WRITE_BACK, statuses, 2);
+
+    ASSERT_EQ(StatusCode::CLIENT_IO_ERROR, status.statusCode());
+    ASSERT_EQ(3u, statuses->size());
+    for (auto it = statuses->begin(); it != statuses->end(); ++it) {
+        ASSERT_EQ(StatusCode::CLIENT_IO_ERROR, it->statusCode());
+    }
+}
+
+TEST_F(BlockingKineticConnectionTest, RequestsFromSeveralThreadsAreOutstandingTogether) {
+    const size_t kThreads = 8;
+    std::mutex mutex;
+    vector<pair<Command, HandlerInterface *>> submitted;
+    bool answered = false;
+    EXPECT_CALL(*packet_service_, Submit_(_, _, _, _)).Times(kThreads).WillRepeatedly(Invoke(
+            [&](const Message &message, const Command &command, const shared_ptr<const string> value,
+                    HandlerInterface *handler) {
+        std::lock_guard<std::mutex> lock(mutex);
+        submitted.push_back(std::make_pair(command, handler));
+        return static_cast<HandlerKey>(submitted.size());
+    }));
+    // Nothing is answered until every thread's request is outstanding, which never happens if the
+    // threads take turns on the connection
+    EXPECT_CALL(*packet_service_, Run(::testing::An<SocketInterest *>())).WillRepeatedly(Invoke(
+            [&](SocketInterest *interest) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!answered && submitted.size() == kThreads) {
+            answered = true;
+            for (auto it = submitted.begin(); it != submitted.end(); ++it) {
+                Complete(Message(), it->first, shared_ptr<const string>(), it->second);
+            }
+        }
+        return true;
+    }));
+    EXPECT_CALL(*packet_service_, Remove(_)).Times(0);
+
+    vector<unique_ptr<KineticRecord>> records(kThreads);
+    vector<StatusCode> status_codes(kThreads, StatusCode::CLIENT_INTERNAL_ERROR);
+    vector<std::thread> threads;
+    for (size_t i = 0; i < kThreads; ++i) {
+        threads.push_back(std::thread([&, i]() {
+            status_codes[i] = connection_.Get("key" + std::to_string(i), records[i]).statusCode();
+        }));
+    }
+    for (auto it = threads.begin(); it != threads.end(); ++it) {
+        it->join();
+    }
+
+    for (size_t i = 0; i < kThreads; ++i) {
+        ASSERT_EQ(StatusCode::OK, status_codes[i]);
+        ASSERT_EQ("value of key" + std::to_string(i), *records[i]->value());
+    }
+}
+
+}  // namespace kinetic
@@ -0,0 +1,213 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "kinetic/kinetic.h"
+
+namespace kinetic {
+
+using com::seagate::kinetic::client::proto::Command;
+using com::seagate::kinetic::client::proto::Command_Status_StatusCode_SUCCESS;
+using com::seagate::kinetic::client::proto::Message;
+using com::seagate::kinetic::client::proto::Message_AuthType_UNSOLICITEDSTATUS;
+
+class ConnectionAttemptTest : public ::testing::Test {
+    protected:
+    // Stands in for a drive listening on the loopback interface
+    void SetUp() {
+        listener_ = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_NE(-1, listener_);
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        ASSERT_EQ(0, bind(listener_, reinterpret_cast<struct sockaddr *>(&address), length));
+        ASSERT_EQ(0, listen(listener_, 1));
+        ASSERT_EQ(0, getsockname(listener_, reinterpret_cast<struct sockaddr *>(&address), &length));
+        options_.host = "127.0.0.1";
+        options_.port = ntohs(address.sin_port);
+        options_.use_ssl = false;
+        options_.user_id = 1;
+        options_.hmac_key = "asdfasdf";
+        drive_fd_ = -1;
+    }
+
+    void TearDown() {
+        if (drive_fd_ != -1) {
+            close(drive_fd_);
+        }
+        if (listener_ != -1) {
+            close(listener_);
+        }
+    }
+
+    void SendHandshake() {
+        drive_fd_ = accept(listener_, NULL, NULL);
+        ASSERT_NE(-1, drive_fd_);
+        WriteHandshake(drive_fd_);
+    }
+
+    static void WriteHandshake(int fd) {
+        Command command;
+        command.mutable_status()->set_code(Command_Status_StatusCode_SUCCESS);
+        command.mutable_header()->set_connectionid(1234);
+        Message message;
+        message.set_authtype(Message_AuthType_UNSOLICITEDSTATUS);
+        message.set_commandbytes(command.SerializeAsString());
+        std::string serialized = message.SerializeAsString();
+        std::string packet("F");
+        uint32_t message_length = htonl(serialized.size());
+        uint32_t value_length = 0;
+        packet.append(reinterpret_cast<char *>(&message_length), 4);
+        packet.append(reinterpret_cast<char *>(&value_length), 4);
+        packet.append(serialized);
+        ASSERT_EQ(static_cast<ssize_t>(packet.size()), write(fd, packet.data(), packet.size()));
+    }
+
+    // Runs the attempt, waiting for its socket in between, until it finishes
+    ConnectionAttemptStatus Drive(ConnectionAttemptInterface *attempt) {
+        while (true) {
+            SocketInterest interest;
+            ConnectionAttemptStatus status = attempt->Run(&interest);
+            if (status != kConnectionAttemptInProgress) {
+                return status;
+            }
+            struct pollfd pfd;
+            pfd.fd = interest.fd;
+            pfd.events = (interest.read ? POLLIN : 0) | (interest.write ? POLLOUT : 0);
+            pfd.revents = 0;
+            poll(&pfd, 1, attempt->remaining_ms());
+        }
+    }
+
+    int listener_;
+    int drive_fd_;
+    ConnectionOptions options_;
+};
+
+TEST_F(ConnectionAttemptTest, CompletesOnceDriveSendsHandshake) {
+    auto factory = NewKineticConnectionFactory();
+    unique_ptr<ConnectionAttemptInterface> attempt;
+    ASSERT_TRUE(factory.StartNonblockingConnection(options_, attempt).ok());
+
+    // Nothing blocks while the drive hasn't said anything
+    SocketInterest interest;
+    ASSERT_EQ(kConnectionAttemptInProgress, attempt->Run(&interest));
+    ASSERT_NE(-1, interest.fd);
+
+    SendHandshake();
+    ASSERT_EQ(kConnectionAttemptDone, Drive(attempt.get()));
+    auto connection = attempt->TakeConnection();
+    ASSERT_TRUE(connection != nullptr);
+}
+
+TEST_F(ConnectionAttemptTest, TimesOutWithoutHandshake) {
+    options_.connect_timeout_ms = 50;
+    auto factory = NewKineticConnectionFactory();
+    unique_ptr<ConnectionAttemptInterface> attempt;
+    ASSERT_TRUE(factory.StartNonblockingConnection(options_, attempt).ok());
+
+    ASSERT_EQ(kConnectionAttemptFailed, Drive(attempt.get()));
+    ASSERT_EQ(0, attempt->remaining_ms());
+    ASSERT_EQ("Connection error: Timed out after 50 ms.", attempt->error().ToString());
+    ASSERT_TRUE(attempt->TakeConnection() == nullptr);
+}
+
+TEST_F(ConnectionAttemptTest, FailsWhenNothingIsListening) {
+    ASSERT_EQ(0, close(listener_));
+    listener_ = -1;
+    auto factory = NewKineticConnectionFactory();
+    unique_ptr<ConnectionAttemptInterface> attempt;
+    ASSERT_TRUE(factory.StartNonblockingConnection(options_, attempt).ok());
+
+    ASSERT_EQ(kConnectionAttemptFailed, Drive(attempt.get()));
+    ASSERT_EQ("Connection error: Could not connect to socket.", attempt->error().ToString());
+}
+
+TEST_F(ConnectionAttemptTest, BlockingFactoryCallGivesUpAfterTimeout) {
+    options_.connect_timeout_ms = 50;
+    auto factory = NewKineticConnectionFactory();
+    unique_ptr<NonblockingKineticConnection> connection;
+    Status status = factory.NewNonblockingConnection(options_, connection);
+    ASSERT_FALSE(status.ok());
+    ASSERT_EQ("Connection error: Timed out after 50 ms.", status.ToString());
+}
+
+TEST_F(ConnectionAttemptTest, OpensManyConnectionsAtOnce) {
+    ConnectionOptions nothing_listening = options_;
+    int closed = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    ASSERT_EQ(0, bind(closed, reinterpret_cast<struct sockaddr *>(&address), length));
+    ASSERT_EQ(0, getsockname(closed, reinterpret_cast<struct sockaddr *>(&address), &length));
+    ASSERT_EQ(0, close(closed));
+    nothing_listening.port = ntohs(address.sin_port);
+
+    std::vector<ConnectionOptions> options = {options_, nothing_listening, options_};
+    // The drive only answers once both connections have reached it, so they have to be opened
+    // concurrently
+    int listener = listener_;
+    std::thread drive([listener]() {
+        int first = accept(listener, NULL, NULL);
+        int second = accept(listener, NULL, NULL);
+        WriteHandshake(first);
+        WriteHandshake(second);
+        close(first);
+        close(second);
+    });
+
+    auto factory = NewKineticConnectionFactory();
+    std::vector<ConnectionResult> results;
+    Status status = factory.NewNonblockingConnections(options, results, 3, 10000);
+    drive.join();
+
+    ASSERT_EQ("1 of 3 connections could not be opened", status.ToString());
+    ASSERT_EQ(3u, results.size());
+    ASSERT_TRUE(results[0].status.ok());
+    ASSERT_TRUE(results[0].connection != nullptr);
+    ASSERT_EQ("Connection error: Could not connect to socket.", results[1].status.ToString());
+    ASSERT_TRUE(results[1].connection == nullptr);
+    ASSERT_TRUE(results[2].status.ok());
+    ASSERT_TRUE(results[2].connection != nullptr);
+}
+
+TEST_F(ConnectionAttemptTest, ConnectionsStillWaitingAtDeadlineFail) {
+    std::vector<ConnectionOptions> options = {options_, options_, options_};
+    auto factory = NewKineticConnectionFactory();
+    std::vector<ConnectionResult> results;
+    // Nothing sends a handshake, and only one connection is opened at a time
+    Status status = factory.NewNonblockingConnections(options, results, 1, 50);
+
+    ASSERT_EQ("3 of 3 connections could not be opened", status.ToString());
+    for (auto &result : results) {
+        ASSERT_EQ("Connection error: Timed out after 50 ms.", result.status.ToString());
+    }
+}
+
+} // namespace kinetic
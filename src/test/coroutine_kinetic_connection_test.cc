@@ -0,0 +1,142 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without 
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or 
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public 
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include "kinetic/coroutine_kinetic_connection.h"
+
+#ifdef KINETIC_HAVE_COROUTINES
+
+#include <exception>
+
+#include "kinetic/kinetic.h"
+#include "matchers.h"
+
+#include "nonblocking_packet_service.h"
+#include "mock_nonblocking_packet_service.h"
+
+namespace kinetic {
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::SaveArg;
+
+using std::make_shared;
+using std::unique_ptr;
+using std::string;
+
+// Runs eagerly and is never awaited; enough to drive the awaitables from a test
+struct DetachedCoroutine {
+    struct promise_type {
+        DetachedCoroutine get_return_object() {
+            return DetachedCoroutine();
+        }
+        std::suspend_never initial_suspend() noexcept {
+            return std::suspend_never();
+        }
+        std::suspend_never final_suspend() noexcept {
+            return std::suspend_never();
+        }
+        void return_void() {}
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+};
+
+class CoroutineKineticConnectionTest : public ::testing::Test {
+    protected:
+    CoroutineKineticConnectionTest()
+            : packet_service_(new NiceMock<MockNonblockingPacketService>),
+            nonblocking_connection_(packet_service_), connection_(nonblocking_connection_) {
+    }
+
+    MockNonblockingPacketService* packet_service_;
+    NonblockingKineticConnection nonblocking_connection_;
+    CoroutineKineticConnection connection_;
+};
+
+DetachedCoroutine GetInto(CoroutineKineticConnection &connection, const string &key,
+        KineticResult<unique_ptr<KineticRecord>> *result, bool *finished) {
+    *result = co_await connection.Get(key);
+    *finished = true;
+}
+
+DetachedCoroutine PutInto(CoroutineKineticConnection &connection, KineticStatus *status,
+        bool *finished) {
+    auto record = make_shared<KineticRecord>("value", "new_version", "tag",
+            com::seagate::kinetic::client::proto::Command_Algorithm_SHA1);
+    *status = co_await connection.Put("key", "old_version", WriteMode::REQUIRE_SAME_VERSION, record);
+    *finished = true;
+}
+
+TEST_F(CoroutineKineticConnectionTest, GetResumesWhenTheResponseIsDispatched) {
+    Command request;
+    EXPECT_CALL(*packet_service_, Submit_(_, _, _, _)).WillOnce(DoAll(SaveArg<1>(&request), Return(0)));
+
+    KineticResult<unique_ptr<KineticRecord>> result{KineticStatus(StatusCode::CLIENT_INTERNAL_ERROR, ""),
+        unique_ptr<KineticRecord>()};
+    bool finished = false;
+    GetInto(connection_, "key", &result, &finished);
+    ASSERT_EQ("key", request.body().keyvalue().key());
+    ASSERT_FALSE(finished);
+
+    Command response;
+    response.mutable_body()->mutable_keyvalue()->set_key("key");
+    packet_service_->submitted_handlers.back()->Handle(response,
+            unique_ptr<const string>(new string("value")));
+
+    ASSERT_TRUE(finished);
+    ASSERT_TRUE(result.status.ok());
+    ASSERT_EQ("value", *result.value->value());
+}
+
+TEST_F(CoroutineKineticConnectionTest, PutResumesWithTheFailure) {
+    EXPECT_CALL(*packet_service_, Submit_(_, _, StringSharedPtrEq("value"), _)).WillOnce(Return(0));
+
+    KineticStatus status(StatusCode::OK, "");
+    bool finished = false;
+    PutInto(connection_, &status, &finished);
+    ASSERT_FALSE(finished);
+
+    packet_service_->submitted_handlers.back()->Error(
+            KineticStatus(StatusCode::REMOTE_VERSION_MISMATCH, "Version mismatch"), NULL);
+
+    ASSERT_TRUE(finished);
+    ASSERT_EQ(StatusCode::REMOTE_VERSION_MISMATCH, status.statusCode());
+}
+
+TEST_F(CoroutineKineticConnectionTest, OperationCompletedWhileIssuedDoesNotSuspend) {
+    EXPECT_CALL(*packet_service_, Submit_(_, _, _, _)).WillOnce(::testing::Invoke(
+            [](const Message &message, const Command &command, const shared_ptr<const string> value,
+                    HandlerInterface *handler) {
+        handler->Error(KineticStatus(StatusCode::CLIENT_SHUTDOWN, "Client already shut down"), NULL);
+        return HandlerKey(0);
+    }));
+
+    KineticResult<unique_ptr<KineticRecord>> result{KineticStatus(StatusCode::OK, ""),
+        unique_ptr<KineticRecord>()};
+    bool finished = false;
+    GetInto(connection_, "key", &result, &finished);
+
+    ASSERT_TRUE(finished);
+    ASSERT_EQ(StatusCode::CLIENT_SHUTDOWN, result.status.statusCode());
+}
+
+}  // namespace kinetic
+
+#endif  // KINETIC_HAVE_COROUTINES
@@ -15,6 +15,10 @@
  * See www.openkinetic.org for more project information
  */
 
+#include <arpa/inet.h>
+
+#include <openssl/hmac.h>
+
 #include "gtest/gtest.h"
 
 #include "kinetic_client.pb.h"
@@ -127,4 +131,79 @@ TEST(HmacProviderTest, ValidateHmacReturnsFalseOnInvalidHmac) {
 }
 
 
+TEST(HmacProviderTest, ValidateHmacAcceptsCommandBytesOutsideMessage) {
+    HmacProvider hmac_provider;
+    Command command;
+    command.mutable_status()->set_code(Command_Status_StatusCode_SUCCESS);
+    std::string command_bytes = command.SerializeAsString();
+
+    Message message;
+    message.set_authtype(Message_AuthType_HMACAUTH);
+    message.mutable_hmacauth()->set_identity(1);
+    message.mutable_hmacauth()->set_hmac(
+        hmac_provider.ComputeHmac(command_bytes.data(), command_bytes.size(), "asdfasdf"));
+
+    // The message itself carries no command bytes; they're validated from where they lie
+    EXPECT_TRUE(hmac_provider.ValidateHmac(message, command_bytes.data(), command_bytes.size(),
+        "asdfasdf"));
+    EXPECT_FALSE(hmac_provider.ValidateHmac(message, "asdfasdf"));
+}
+
+// Computes the HMAC in one go, without any context being kept around
+static std::string ReferenceHmac(const std::string &data, const std::string &key,
+        const EVP_MD *digest = EVP_sha1()) {
+    std::string input;
+    if (!data.empty()) {
+        uint32_t length_bigendian = htonl(data.size());
+        input.append(reinterpret_cast<char *>(&length_bigendian), sizeof(length_bigendian));
+        input.append(data);
+    }
+    unsigned char result[EVP_MAX_MD_SIZE];
+    unsigned int result_length = 0;
+    HMAC(digest, key.data(), key.size(), reinterpret_cast<const unsigned char *>(input.data()),
+        input.size(), result, &result_length);
+    return std::string(reinterpret_cast<char *>(result), result_length);
+}
+
+TEST(HmacProviderTest, ReusesKeyedContextAcrossMessagesAndKeys) {
+    HmacProvider hmac_provider;
+    std::string long_key(100, 'k');
+    std::string messages[] = { "first", std::string(1000, 'm'), "", "last" };
+    std::string keys[] = { "asdfasdf", "asdfasdf", long_key, "asdfasdf" };
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(ReferenceHmac(messages[i], keys[i]),
+            hmac_provider.ComputeHmac(messages[i].data(), messages[i].size(), keys[i]));
+    }
+
+    // Copies start out unkeyed and don't disturb the original
+    HmacProvider copy(hmac_provider);
+    EXPECT_EQ(ReferenceHmac("copy", "other"), copy.ComputeHmac("copy", 4, "other"));
+    EXPECT_EQ(ReferenceHmac("again", "asdfasdf"), hmac_provider.ComputeHmac("again", 5, "asdfasdf"));
+    copy = hmac_provider;
+    EXPECT_EQ(ReferenceHmac("assigned", "asdfasdf"), copy.ComputeHmac("assigned", 8, "asdfasdf"));
+}
+
+TEST(HmacProviderTest, ComputesHmacSha256) {
+    HmacProvider hmac_provider(HmacAlgorithm::SHA256);
+    ASSERT_EQ(HmacAlgorithm::SHA256, hmac_provider.algorithm());
+    std::string hmac = hmac_provider.ComputeHmac("message", 7, "asdfasdf");
+    EXPECT_EQ(32u, hmac.size());
+    EXPECT_EQ(ReferenceHmac("message", "asdfasdf", EVP_sha256()), hmac);
+
+    Message message;
+    message.set_commandbytes("message");
+    message.mutable_hmacauth()->set_hmac(hmac);
+    EXPECT_TRUE(hmac_provider.ValidateHmac(message, "asdfasdf"));
+
+    // Switching algorithms re-keys rather than reusing the SHA-256 context
+    hmac_provider.set_algorithm(HmacAlgorithm::SHA1);
+    EXPECT_EQ(ReferenceHmac("message", "asdfasdf"), hmac_provider.ComputeHmac("message", 7, "asdfasdf"));
+    EXPECT_FALSE(hmac_provider.ValidateHmac(message, "asdfasdf"));
+
+    // Copies keep the algorithm
+    hmac_provider.set_algorithm(HmacAlgorithm::SHA256);
+    HmacProvider copy(hmac_provider);
+    EXPECT_EQ(hmac, copy.ComputeHmac("message", 7, "asdfasdf"));
+}
+
 } // namespace kinetic
@@ -0,0 +1,153 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "kinetic/kinetic.h"
+#include "nonblocking_packet_service.h"
+#include "mock_nonblocking_packet_service.h"
+#include "in_flight_table.h"
+
+namespace kinetic {
+
+using std::make_shared;
+
+class InFlightTableTest : public ::testing::Test {
+    protected:
+    InFlightTableTest() : table_(4), handler_(make_shared<MockHandler>()) {}
+
+    InFlightTable table_;
+    shared_ptr<HandlerInterface> handler_;
+};
+
+TEST_F(InFlightTableTest, FindsAndTakesBySequence) {
+    ASSERT_TRUE(table_.Insert(0, handler_, 10));
+    ASSERT_TRUE(table_.Insert(1, handler_, 11));
+    ASSERT_EQ(2u, table_.size());
+
+    const InFlightRequest *found = table_.Find(1);
+    ASSERT_TRUE(found != NULL);
+    ASSERT_EQ(11u, found->handler_key);
+    ASSERT_EQ(handler_, found->handler);
+    ASSERT_TRUE(table_.Find(2) == NULL);
+
+    InFlightRequest taken;
+    ASSERT_TRUE(table_.Take(1, &taken));
+    ASSERT_EQ(1, taken.sequence);
+    ASSERT_EQ(11u, taken.handler_key);
+    ASSERT_EQ(handler_, taken.handler);
+    ASSERT_TRUE(table_.Find(1) == NULL);
+    ASSERT_FALSE(table_.Take(1, &taken));
+    ASSERT_FALSE(table_.TakeByKey(11, &taken));
+    ASSERT_EQ(1u, table_.size());
+}
+
+TEST_F(InFlightTableTest, RejectsDuplicateSequenceOrKey) {
+    ASSERT_TRUE(table_.Insert(3, handler_, 7));
+    ASSERT_FALSE(table_.Insert(3, handler_, 8));
+    ASSERT_FALSE(table_.Insert(4, handler_, 7));
+    ASSERT_EQ(1u, table_.size());
+
+    // Neither failed insert left anything behind
+    InFlightRequest taken;
+    ASSERT_FALSE(table_.TakeByKey(8, &taken));
+    ASSERT_TRUE(table_.Find(4) == NULL);
+}
+
+TEST_F(InFlightTableTest, ReusesSlotsAsSequencesWrapAround) {
+    InFlightRequest taken;
+    for (int sequence = 0; sequence < 100; sequence++) {
+        ASSERT_TRUE(table_.Insert(sequence, handler_, 1000 + sequence));
+        if (sequence >= 2) {
+            ASSERT_TRUE(table_.Take(sequence - 2, &taken));
+            ASSERT_EQ(1000u + sequence - 2, taken.handler_key);
+        }
+    }
+    ASSERT_EQ(2u, table_.size());
+    ASSERT_EQ(0u, table_.overflowed());
+}
+
+TEST_F(InFlightTableTest, StragglersGoToOverflow) {
+    // Sequence 0 is still waiting when 4 and 8 want its slot
+    ASSERT_TRUE(table_.Insert(0, handler_, 0));
+    ASSERT_TRUE(table_.Insert(4, handler_, 4));
+    ASSERT_TRUE(table_.Insert(8, handler_, 8));
+    ASSERT_EQ(2u, table_.overflowed());
+    ASSERT_FALSE(table_.Insert(4, handler_, 12));
+
+    InFlightRequest taken;
+    ASSERT_TRUE(table_.Take(4, &taken));
+    ASSERT_EQ(4u, taken.handler_key);
+    ASSERT_TRUE(table_.Find(0) != NULL);
+    ASSERT_TRUE(table_.Find(8) != NULL);
+    ASSERT_TRUE(table_.Take(0, &taken));
+    ASSERT_TRUE(table_.Take(8, &taken));
+    ASSERT_TRUE(table_.empty());
+
+    // The slot is free again
+    ASSERT_TRUE(table_.Insert(12, handler_, 12));
+    ASSERT_EQ(0u, table_.overflowed());
+}
+
+TEST_F(InFlightTableTest, KeepsNegativeSequences) {
+    ASSERT_TRUE(table_.Insert(-1, handler_, -1));
+    ASSERT_TRUE(table_.Insert(3, handler_, 3));
+    ASSERT_TRUE(table_.Find(-1) != NULL);
+
+    InFlightRequest taken;
+    ASSERT_TRUE(table_.TakeByKey(-1, &taken));
+    ASSERT_EQ(-1, taken.sequence);
+    ASSERT_TRUE(table_.Find(-1) == NULL);
+    ASSERT_TRUE(table_.Find(3) != NULL);
+}
+
+TEST_F(InFlightTableTest, TakesByKeyWhenKeysCollide) {
+    ASSERT_TRUE(table_.Insert(0, handler_, 1));
+    ASSERT_TRUE(table_.Insert(1, handler_, 5));
+    ASSERT_TRUE(table_.Insert(2, handler_, 9));
+
+    InFlightRequest taken;
+    ASSERT_TRUE(table_.TakeByKey(5, &taken));
+    ASSERT_EQ(1, taken.sequence);
+    ASSERT_TRUE(table_.TakeByKey(1, &taken));
+    ASSERT_EQ(0, taken.sequence);
+    ASSERT_TRUE(table_.TakeByKey(9, &taken));
+    ASSERT_EQ(2, taken.sequence);
+    ASSERT_TRUE(table_.empty());
+}
+
+TEST_F(InFlightTableTest, TakeAllReturnsOldestFirst) {
+    ASSERT_TRUE(table_.Insert(6, handler_, 6));
+    ASSERT_TRUE(table_.Insert(-1, handler_, 100));
+    ASSERT_TRUE(table_.Insert(5, handler_, 5));
+    ASSERT_TRUE(table_.Insert(2, handler_, 2));
+
+    vector<InFlightRequest> requests;
+    table_.TakeAll(&requests);
+    ASSERT_EQ(4u, requests.size());
+    ASSERT_EQ(-1, requests[0].sequence);
+    ASSERT_EQ(2, requests[1].sequence);
+    ASSERT_EQ(5, requests[2].sequence);
+    ASSERT_EQ(6, requests[3].sequence);
+    ASSERT_TRUE(table_.empty());
+
+    // Everything was let go of, keys included
+    ASSERT_TRUE(table_.Insert(6, handler_, 6));
+    ASSERT_TRUE(table_.Insert(2, handler_, 100));
+}
+
+} // namespace kinetic
@@ -0,0 +1,140 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifdef KINETIC_HAVE_IO_URING
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "kinetic/kinetic.h"
+#include "io_uring_socket_io.h"
+#include "mock_socket_wrapper_interface.h"
+#include "nonblocking_packet.h"
+
+namespace kinetic {
+
+using std::make_shared;
+
+class IoUringSocketIoTest : public ::testing::Test {
+    protected:
+    void SetUp() {
+        ASSERT_TRUE(ring_.Init(16));
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds_));
+    }
+
+    void TearDown() {
+        close(fds_[0]);
+        close(fds_[1]);
+    }
+
+    // Submits queued operations and waits for one to complete
+    void Complete(uint64_t expected_cookie) {
+        ASSERT_TRUE(ring_.Submit(1, 1000));
+        ring_.Dispatch();
+        ASSERT_EQ(1u, ring_.ready().size());
+        ASSERT_EQ(expected_cookie, ring_.ready()[0]);
+        ring_.ready().clear();
+    }
+
+    IoUringRing ring_;
+    int fds_[2];
+};
+
+TEST_F(IoUringSocketIoTest, WritesOnceSubmitted) {
+    IoUringSocketIo io(&ring_, fds_[0], 7);
+    char data[] = "hello";
+    struct iovec iov = { data, 5 };
+    ASSERT_EQ(-1, io.Writev(&iov, 1));
+    ASSERT_EQ(EAGAIN, errno);
+    // Nothing happens until the ring is submitted
+    char buf[16];
+    ASSERT_EQ(-1, read(fds_[1], buf, sizeof(buf)));
+
+    Complete(7);
+    ASSERT_EQ(5, io.Writev(&iov, 1));
+    ASSERT_EQ(5, read(fds_[1], buf, sizeof(buf)));
+    ASSERT_EQ("hello", string(buf, 5));
+}
+
+TEST_F(IoUringSocketIoTest, HandsOutReceivedBytesAcrossReads) {
+    IoUringSocketIo io(&ring_, fds_[0], 7);
+    char buf[16];
+    ASSERT_EQ(-1, io.Read(buf, 3));
+    ASSERT_EQ(EAGAIN, errno);
+    ASSERT_EQ(5, write(fds_[1], "world", 5));
+
+    Complete(7);
+    ASSERT_EQ(3, io.Read(buf, 3));
+    ASSERT_EQ("wor", string(buf, 3));
+    ASSERT_EQ(2, io.Read(buf, sizeof(buf)));
+    ASSERT_EQ("ld", string(buf, 2));
+    // Drained, so the next read is queued again
+    ASSERT_EQ(-1, io.Read(buf, sizeof(buf)));
+    ASSERT_EQ(EAGAIN, errno);
+}
+
+TEST_F(IoUringSocketIoTest, ReportsEndOfFile) {
+    IoUringSocketIo io(&ring_, fds_[0], 7);
+    char buf[16];
+    ASSERT_EQ(-1, io.Read(buf, sizeof(buf)));
+    ASSERT_EQ(0, shutdown(fds_[1], SHUT_WR));
+
+    Complete(7);
+    ASSERT_EQ(0, io.Read(buf, sizeof(buf)));
+}
+
+TEST_F(IoUringSocketIoTest, DestructionWaitsForOutstandingReceive) {
+    {
+        IoUringSocketIo io(&ring_, fds_[0], 7);
+        char buf[16];
+        ASSERT_EQ(-1, io.Read(buf, sizeof(buf)));
+        ASSERT_TRUE(ring_.Submit(0, -1));
+    }
+    // The receive was cancelled rather than left to write into freed memory
+    ring_.ready().clear();
+    ASSERT_EQ(1, write(fds_[1], "x", 1));
+    ASSERT_TRUE(ring_.Submit(1, 50));
+    ring_.Dispatch();
+    ASSERT_TRUE(ring_.ready().empty());
+}
+
+TEST_F(IoUringSocketIoTest, CarriesPacketWriterOutput) {
+    auto io = make_shared<IoUringSocketIo>(&ring_, fds_[0], 7);
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    socket_wrapper->io_ = io.get();
+    unique_ptr<Message> message(new Message());
+    message->set_commandbytes("command");
+    NonblockingPacketWriter writer(socket_wrapper, move(message), make_shared<string>("value"));
+
+    NonblockingStringStatus status;
+    while ((status = writer.Write()) == kInProgress) {
+        Complete(7);
+    }
+    ASSERT_EQ(kDone, status);
+
+    char buf[64];
+    ssize_t n = read(fds_[1], buf, sizeof(buf));
+    ASSERT_GT(n, 9);
+    ASSERT_EQ('F', buf[0]);
+    ASSERT_EQ("value", string(buf + n - 5, 5));
+}
+
+} // namespace kinetic
+
+#endif  // KINETIC_HAVE_IO_URING
@@ -0,0 +1,126 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include "gtest/gtest.h"
+#include "kinetic_client.pb.h"
+#include "key_value_codec.h"
+
+namespace kinetic {
+
+using com::seagate::kinetic::client::proto::Command_Algorithm_SHA1;
+using com::seagate::kinetic::client::proto::Command_MessageType_GET;
+using com::seagate::kinetic::client::proto::Command_MessageType_PUT;
+using com::seagate::kinetic::client::proto::Command_MessageType_DELETE;
+using com::seagate::kinetic::client::proto::Command_MessageType_NOOP;
+using com::seagate::kinetic::client::proto::Command_Priority_HIGHEST;
+using com::seagate::kinetic::client::proto::Command_Synchronization_WRITEBACK;
+
+static string EncodeFromCommand(const Command &command) {
+    KeyValueRequest request;
+    EXPECT_TRUE(KeyValueRequestFromCommand(command, &request));
+    string encoded;
+    EncodeKeyValueRequest(request, &encoded);
+    return encoded;
+}
+
+TEST(KeyValueCodecTest, EncodesGetLikeProtobuf) {
+    Command command;
+    command.mutable_header()->set_clusterversion(3);
+    command.mutable_header()->set_connectionid(1234567890123LL);
+    command.mutable_header()->set_sequence(42);
+    command.mutable_header()->set_messagetype(Command_MessageType_GET);
+    command.mutable_body()->mutable_keyvalue()->set_key("key");
+
+    ASSERT_EQ(command.SerializeAsString(), EncodeFromCommand(command));
+}
+
+TEST(KeyValueCodecTest, EncodesPutLikeProtobuf) {
+    Command command;
+    command.mutable_header()->set_clusterversion(0);
+    command.mutable_header()->set_sequence(300);
+    command.mutable_header()->set_messagetype(Command_MessageType_PUT);
+    auto key_value = command.mutable_body()->mutable_keyvalue();
+    key_value->set_key(string(200, 'k'));
+    key_value->set_newversion("v2");
+    key_value->set_dbversion("");
+    key_value->set_tag("tag");
+    key_value->set_algorithm(Command_Algorithm_SHA1);
+    key_value->set_force(false);
+    key_value->set_synchronization(Command_Synchronization_WRITEBACK);
+
+    ASSERT_EQ(command.SerializeAsString(), EncodeFromCommand(command));
+}
+
+TEST(KeyValueCodecTest, EncodesNegativeValuesLikeProtobuf) {
+    Command command;
+    command.mutable_header()->set_clusterversion(-1);
+    command.mutable_header()->set_connectionid(-5);
+    command.mutable_header()->set_sequence(0);
+    command.mutable_header()->set_messagetype(Command_MessageType_DELETE);
+    auto key_value = command.mutable_body()->mutable_keyvalue();
+    key_value->set_key("key");
+    key_value->set_force(true);
+    key_value->set_metadataonly(true);
+    key_value->set_synchronization(
+        com::seagate::kinetic::client::proto::Command_Synchronization_INVALID_SYNCHRONIZATION);
+
+    ASSERT_EQ(command.SerializeAsString(), EncodeFromCommand(command));
+}
+
+TEST(KeyValueCodecTest, EncodesEmptyBodyLikeProtobuf) {
+    Command command;
+    command.mutable_header()->set_messagetype(Command_MessageType_GET);
+    command.mutable_body();
+    ASSERT_EQ(command.SerializeAsString(), EncodeFromCommand(command));
+
+    command.mutable_body()->mutable_keyvalue();
+    ASSERT_EQ(command.SerializeAsString(), EncodeFromCommand(command));
+}
+
+TEST(KeyValueCodecTest, EncodesRequestOptionsLikeProtobuf) {
+    Command command;
+    command.mutable_header()->set_clusterversion(0);
+    command.mutable_header()->set_sequence(7);
+    command.mutable_header()->set_messagetype(Command_MessageType_GET);
+    command.mutable_header()->set_timeout(250);
+    command.mutable_header()->set_earlyexit(true);
+    command.mutable_header()->set_priority(Command_Priority_HIGHEST);
+    command.mutable_header()->set_timequanta(0);
+    command.mutable_body()->mutable_keyvalue()->set_key("key");
+
+    ASSERT_EQ(command.SerializeAsString(), EncodeFromCommand(command));
+}
+
+TEST(KeyValueCodecTest, RejectsCommandsItCannotEncode) {
+    KeyValueRequest request;
+
+    Command noop;
+    noop.mutable_header()->set_messagetype(Command_MessageType_NOOP);
+    ASSERT_FALSE(KeyValueRequestFromCommand(noop, &request));
+
+    Command with_ack_sequence;
+    with_ack_sequence.mutable_header()->set_messagetype(Command_MessageType_GET);
+    with_ack_sequence.mutable_header()->set_acksequence(10);
+    ASSERT_FALSE(KeyValueRequestFromCommand(with_ack_sequence, &request));
+
+    Command with_range;
+    with_range.mutable_header()->set_messagetype(Command_MessageType_GET);
+    with_range.mutable_body()->mutable_range();
+    ASSERT_FALSE(KeyValueRequestFromCommand(with_range, &request));
+}
+
+} // namespace kinetic
@@ -0,0 +1,280 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifdef __linux__
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "kinetic/kinetic.h"
+#include "kinetic/kinetic_reactor.h"
+#include "nonblocking_packet_service.h"
+#include "mock_nonblocking_packet_service.h"
+#include "mock_callbacks.h"
+
+namespace kinetic {
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+
+// Finishes once its socket has something to read, or fails at its deadline
+class FakeConnectionAttempt : public ConnectionAttemptInterface {
+    public:
+    FakeConnectionAttempt(int fd, NonblockingPacketServiceInterface *service, int timeout_ms)
+        : fd_(fd), service_(service),
+        deadline_(std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms)) {}
+
+    ConnectionAttemptStatus Run(SocketInterest *interest) {
+        if (remaining_ms() == 0) {
+            return kConnectionAttemptFailed;
+        }
+        struct pollfd pfd = {fd_, POLLIN, 0};
+        if (poll(&pfd, 1, 0) == 1) {
+            return kConnectionAttemptDone;
+        }
+        interest->fd = fd_;
+        interest->read = true;
+        return kConnectionAttemptInProgress;
+    }
+
+    int remaining_ms() {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline_ - std::chrono::steady_clock::now()).count();
+        return remaining > 0 ? static_cast<int>(remaining) : 0;
+    }
+
+    Status error() {
+        return Status::makeInternalError("Connection error: Timed out");
+    }
+
+    unique_ptr<NonblockingKineticConnection> TakeConnection() {
+        return unique_ptr<NonblockingKineticConnection>(new NonblockingKineticConnection(service_));
+    }
+
+    private:
+    int fd_;
+    NonblockingPacketServiceInterface *service_;
+    std::chrono::steady_clock::time_point deadline_;
+};
+
+class KineticReactorTest : public ::testing::Test {
+    protected:
+    void SetUp() {
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds_));
+        interest_.fd = fds_[0];
+        service_ = new MockNonblockingPacketService();
+        EXPECT_CALL(*service_, TimeUntilDeadline()).WillRepeatedly(Return(-1));
+    }
+
+    void TearDown() {
+        close(fds_[0]);
+        close(fds_[1]);
+    }
+
+    unique_ptr<NonblockingKineticConnectionInterface> NewConnection() {
+        return unique_ptr<NonblockingKineticConnectionInterface>(
+            new NonblockingKineticConnection(service_));
+    }
+
+    int fds_[2];
+    SocketInterest interest_;
+    MockNonblockingPacketService *service_;
+};
+
+TEST_F(KineticReactorTest, RunsSubmittedConnectionWithoutWaiting) {
+    // Once to learn the socket when added, then once for the submitted request
+    EXPECT_CALL(*service_, Run(_)).Times(2)
+        .WillRepeatedly(DoAll(SetArgPointee<0>(interest_), Return(true)));
+    EXPECT_CALL(*service_, Submit_(_, _, _, _)).WillOnce(Return(0));
+
+    KineticReactor reactor;
+    KineticReactor::ConnectionId id;
+    ASSERT_TRUE(reactor.AddConnection(NewConnection(), &id));
+    auto callback = make_shared<MockSimpleCallback>();
+    ASSERT_TRUE(reactor.Submit(id, [&](NonblockingKineticConnectionInterface &connection) {
+        connection.NoOp(callback);
+    }));
+    // Would block forever if the scheduled connection weren't run straight away
+    ASSERT_TRUE(reactor.RunOnce(-1));
+    // Nothing to do now
+    ASSERT_TRUE(reactor.RunOnce(0));
+}
+
+TEST_F(KineticReactorTest, RunsConnectionWhenSocketBecomesReadable) {
+    EXPECT_CALL(*service_, Run(_)).Times(3)
+        .WillRepeatedly(DoAll(SetArgPointee<0>(interest_), Return(true)));
+
+    KineticReactor reactor;
+    KineticReactor::ConnectionId id;
+    ASSERT_TRUE(reactor.AddConnection(NewConnection(), &id));
+    // The socket starts out writable, which is reported once
+    ASSERT_TRUE(reactor.RunOnce(0));
+    ASSERT_TRUE(reactor.RunOnce(0));
+
+    ASSERT_EQ(1, write(fds_[1], "x", 1));
+    ASSERT_TRUE(reactor.RunOnce(1000));
+    // Edge-triggered, so the unread byte doesn't cause another run
+    ASSERT_TRUE(reactor.RunOnce(0));
+}
+
+TEST_F(KineticReactorTest, DropsFailedConnection) {
+    EXPECT_CALL(*service_, Run(_))
+        .WillOnce(DoAll(SetArgPointee<0>(interest_), Return(true)))
+        .WillOnce(Return(false));
+
+    KineticReactor reactor;
+    KineticReactor::ConnectionId id;
+    ASSERT_TRUE(reactor.AddConnection(NewConnection(), &id));
+    ASSERT_EQ(1u, reactor.connection_count());
+    ASSERT_TRUE(reactor.RunOnce(0));
+    ASSERT_EQ(0u, reactor.connection_count());
+    ASSERT_FALSE(reactor.Submit(id, [](NonblockingKineticConnectionInterface &connection) {
+        FAIL() << "Operation should not run on a dropped connection";
+    }));
+    ASSERT_FALSE(reactor.RemoveConnection(id));
+}
+
+TEST_F(KineticReactorTest, CanRemoveConnectionFromItsOwnCallback) {
+    EXPECT_CALL(*service_, Run(_)).WillRepeatedly(DoAll(SetArgPointee<0>(interest_), Return(true)));
+
+    KineticReactor reactor;
+    KineticReactor::ConnectionId id;
+    ASSERT_TRUE(reactor.AddConnection(NewConnection(), &id));
+    ASSERT_TRUE(reactor.Submit(id, [&](NonblockingKineticConnectionInterface &connection) {
+        ASSERT_TRUE(reactor.RemoveConnection(id));
+    }));
+    ASSERT_EQ(0u, reactor.connection_count());
+    ASSERT_TRUE(reactor.RunOnce(0));
+}
+
+TEST_F(KineticReactorTest, RunsConnectionWhenRequestDeadlineIsDue) {
+    int runs = 0;
+    EXPECT_CALL(*service_, Run(_)).Times(3)
+        .WillRepeatedly(DoAll(SetArgPointee<0>(interest_), Invoke([&](SocketInterest *interest) {
+            runs++;
+            return true;
+        })));
+    EXPECT_CALL(*service_, TimeUntilDeadline()).WillOnce(Return(20)).WillRepeatedly(Return(-1));
+
+    auto start = std::chrono::steady_clock::now();
+    KineticReactor reactor;
+    KineticReactor::ConnectionId id;
+    ASSERT_TRUE(reactor.AddConnection(NewConnection(), &id));
+    // Would block forever once the socket's first event is used up if the deadline weren't
+    // taken into account
+    while (runs < 3) {
+        ASSERT_TRUE(reactor.RunOnce(-1));
+    }
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+}
+
+TEST_F(KineticReactorTest, IoUringBackendHandsSocketIoToConnection) {
+    EXPECT_CALL(*service_, Run(_)).Times(2)
+        .WillRepeatedly(DoAll(SetArgPointee<0>(interest_), Return(true)));
+    EXPECT_CALL(*service_, SetSocketIo(_)).WillOnce(Return(true));
+
+    KineticReactor reactor(kIoUringBackend);
+#ifdef KINETIC_HAVE_IO_URING
+    ASSERT_EQ(kIoUringBackend, reactor.backend());
+#endif
+    KineticReactor::ConnectionId id;
+    ASSERT_TRUE(reactor.AddConnection(NewConnection(), &id));
+    // The new connection is run once to start using the ring, without waiting
+    ASSERT_TRUE(reactor.RunOnce(-1));
+    ASSERT_TRUE(reactor.RunOnce(0));
+}
+
+TEST_F(KineticReactorTest, DrivesConnectionAttemptUntilItSucceeds) {
+    EXPECT_CALL(*service_, Run(_)).WillRepeatedly(DoAll(SetArgPointee<0>(interest_), Return(true)));
+
+    KineticReactor reactor;
+    KineticReactor::ConnectionId id;
+    KineticReactor::ConnectionId done_id = 0;
+    int calls = 0;
+    unique_ptr<ConnectionAttemptInterface> attempt(
+        new FakeConnectionAttempt(fds_[0], service_, 10000));
+    ASSERT_TRUE(reactor.AddConnectionAttempt(std::move(attempt),
+        [&](KineticReactor::ConnectionId finished, const Status &status) {
+            ASSERT_TRUE(status.ok());
+            done_id = finished;
+            calls++;
+        }, &id));
+    ASSERT_EQ(1u, reactor.attempt_count());
+
+    // The first step is taken straight away and then waits for the socket
+    ASSERT_TRUE(reactor.RunOnce(-1));
+    ASSERT_TRUE(reactor.RunOnce(0));
+    ASSERT_EQ(0, calls);
+
+    ASSERT_EQ(1, write(fds_[1], "x", 1));
+    ASSERT_TRUE(reactor.RunOnce(1000));
+    ASSERT_EQ(1, calls);
+    ASSERT_EQ(id, done_id);
+    ASSERT_EQ(0u, reactor.attempt_count());
+    ASSERT_EQ(1u, reactor.connection_count());
+    ASSERT_TRUE(reactor.RemoveConnection(id));
+}
+
+TEST_F(KineticReactorTest, WaitsNoLongerThanAttemptDeadline) {
+    KineticReactor reactor;
+    KineticReactor::ConnectionId id;
+    int calls = 0;
+    unique_ptr<ConnectionAttemptInterface> attempt(new FakeConnectionAttempt(fds_[0], service_, 50));
+    ASSERT_TRUE(reactor.AddConnectionAttempt(std::move(attempt),
+        [&](KineticReactor::ConnectionId finished, const Status &status) {
+            ASSERT_FALSE(status.ok());
+            calls++;
+        }, &id));
+    ASSERT_TRUE(reactor.RunOnce(-1));
+
+    // Would block forever if the deadline weren't taken into account
+    while (calls == 0) {
+        ASSERT_TRUE(reactor.RunOnce(-1));
+    }
+    ASSERT_EQ(0u, reactor.attempt_count());
+    ASSERT_EQ(0u, reactor.connection_count());
+    delete service_;
+}
+
+TEST_F(KineticReactorTest, RemovingAttemptAbandonsIt) {
+    KineticReactor reactor;
+    KineticReactor::ConnectionId id;
+    unique_ptr<ConnectionAttemptInterface> attempt(
+        new FakeConnectionAttempt(fds_[0], service_, 10000));
+    ASSERT_TRUE(reactor.AddConnectionAttempt(std::move(attempt),
+        [&](KineticReactor::ConnectionId finished, const Status &status) {
+            FAIL() << "An abandoned attempt shouldn't report back";
+        }, &id));
+    ASSERT_TRUE(reactor.RunOnce(0));
+    ASSERT_TRUE(reactor.RemoveConnection(id));
+    ASSERT_EQ(0u, reactor.attempt_count());
+    ASSERT_EQ(1, write(fds_[1], "x", 1));
+    ASSERT_TRUE(reactor.RunOnce(0));
+    delete service_;
+}
+
+} // namespace kinetic
+
+#endif  // __linux__
@@ -51,6 +51,21 @@ class MockGetCallback : public GetCallbackInterface {
     MOCK_METHOD1(Failure, void(KineticStatus error));
 };
 
+class MockGetIntoCallback : public GetIntoCallbackInterface {
+    public:
+    MOCK_METHOD5(Success, void(const string &key, shared_ptr<ValueBuffer> value,
+        const string &version, const string &tag, Command_Algorithm algorithm));
+    MOCK_METHOD1(Failure, void(KineticStatus error));
+};
+
+class MockGetToFileCallback : public GetToFileCallbackInterface {
+    public:
+    MOCK_METHOD3(Destination, int(const string &key, size_t value_size, off_t *offset));
+    MOCK_METHOD5(Success, void(const string &key, size_t value_size,
+        const string &version, const string &tag, Command_Algorithm algorithm));
+    MOCK_METHOD1(Failure, void(KineticStatus error));
+};
+
 class MockGetVersionCallback : public GetVersionCallbackInterface {
     public:
     MOCK_METHOD1(Success, void(const string &version));
@@ -85,6 +100,16 @@ class MockGetLogCallback : public GetLogCallbackInterface {
     MOCK_METHOD1(Failure, void(KineticStatus error));
 };
 
+class MockBatchCallback : public BatchCallbackInterface {
+    public:
+    void Failure(KineticStatus error, unique_ptr<vector<KineticStatus>> statuses) {
+        Failure_(error, *statuses);
+    }
+
+    MOCK_METHOD0(Success, void());
+    MOCK_METHOD2(Failure_, void(KineticStatus error, vector<KineticStatus> statuses));
+};
+
 class MockP2PPushCallback : public P2PPushCallbackInterface {
     public:
     void Success(unique_ptr<vector<KineticStatus>> statuses, const Command& response) {
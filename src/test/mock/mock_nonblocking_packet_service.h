@@ -18,6 +18,8 @@
 #ifndef KINETIC_CPP_CLIENT_MOCK_NONBLOCKING_PACKET_SERVICE_H_
 #define KINETIC_CPP_CLIENT_MOCK_NONBLOCKING_PACKET_SERVICE_H_
 
+#include <mutex>
+
 #include "kinetic/nonblocking_packet_service_interface.h"
 
 namespace kinetic {
@@ -47,6 +49,7 @@ class MockNonblockingReceiver : public NonblockingReceiverInterface {
     MOCK_METHOD0(Receive, NonblockingPacketServiceStatus());
     MOCK_METHOD0(connection_id, int64_t());
     MOCK_METHOD1(Remove, bool(HandlerKey key));
+    MOCK_METHOD2(Fail, bool(HandlerKey key, KineticStatus error));
 };
 
 class MockNonblockingSender : public NonblockingSenderInterface {
@@ -57,37 +60,80 @@ class MockNonblockingSender : public NonblockingSenderInterface {
     }
     MOCK_METHOD5(Enqueue_, void(const Message& message, const Command& command, const shared_ptr<const string> value,
         HandlerInterface *handler, HandlerKey handler_key));
+    void Enqueue(unique_ptr<Message> message, unique_ptr<Command> command,
+        const shared_ptr<const OutgoingValueInterface> value, unique_ptr<HandlerInterface> handler,
+        HandlerKey handler_key) {
+        EnqueueSource_(*message, *command, value, handler.get(), handler_key);
+    }
+    MOCK_METHOD5(EnqueueSource_, void(const Message& message, const Command& command,
+        const shared_ptr<const OutgoingValueInterface> value, HandlerInterface *handler, HandlerKey handler_key));
     MOCK_METHOD0(Send, NonblockingPacketServiceStatus());
     MOCK_METHOD1(Remove, bool(HandlerKey key));
+    MOCK_METHOD2(Fail, bool(HandlerKey key, KineticStatus error));
+    MOCK_METHOD1(FailAll, void(KineticStatus error));
 };
 
 class MockNonblockingPacketWriter : public NonblockingPacketWriterInterface {
     public:
     MOCK_METHOD0(Write, NonblockingStringStatus());
+    void Append(unique_ptr<Message> message, const shared_ptr<const string> value) {
+        Append_(*message, value);
+    }
+    MOCK_METHOD2(Append_, void(const Message& message, const shared_ptr<const string> value));
+    void Append(unique_ptr<Message> message, const shared_ptr<const OutgoingValueInterface> value) {
+        AppendSource_(*message, value);
+    }
+    MOCK_METHOD2(AppendSource_, void(const Message& message, const shared_ptr<const OutgoingValueInterface> value));
 };
 
 class MockNonblockingPacketWriterFactory : public NonblockingPacketWriterFactoryInterface {
     public:
     unique_ptr<NonblockingPacketWriterInterface> CreateWriter(shared_ptr<SocketWrapperInterface> socket_wrapper,
-        unique_ptr<const Message> message, const shared_ptr<const string> value) {
+        unique_ptr<Message> message, const shared_ptr<const string> value) {
         return unique_ptr<NonblockingPacketWriterInterface>(
             CreateWriter_(socket_wrapper, *message, value));
     }
 
     MOCK_METHOD3(CreateWriter_,  NonblockingPacketWriterInterface* (shared_ptr<SocketWrapperInterface> socket_wrapper,
         const Message& message, const shared_ptr<const string> value));
+    unique_ptr<NonblockingPacketWriterInterface> CreateWriter(shared_ptr<SocketWrapperInterface> socket_wrapper,
+        unique_ptr<Message> message, const shared_ptr<const OutgoingValueInterface> value) {
+        return unique_ptr<NonblockingPacketWriterInterface>(
+            CreateSourceWriter_(socket_wrapper, *message, value));
+    }
+    MOCK_METHOD3(CreateSourceWriter_,  NonblockingPacketWriterInterface* (shared_ptr<SocketWrapperInterface> socket_wrapper,
+        const Message& message, const shared_ptr<const OutgoingValueInterface> value));
 };
 
 class MockNonblockingPacketService : public NonblockingPacketServiceInterface {
     public:
     HandlerKey Submit(unique_ptr<Message> message, unique_ptr<Command> command, const shared_ptr<const string> value,
             unique_ptr<HandlerInterface> handler) {
-        return Submit_(*message, *command, value, handler.get());
+        HandlerKey key = Submit_(*message, *command, value, handler.get());
+        // Kept so that tests can complete requests after they've been submitted
+        std::lock_guard<std::mutex> lock(submitted_handlers_mutex);
+        submitted_handlers.push_back(std::move(handler));
+        return key;
     }
     MOCK_METHOD4(Submit_, HandlerKey(const Message &message, const Command &command, const shared_ptr<const string> value,
     HandlerInterface* handler));
+    HandlerKey Submit(unique_ptr<Message> message, unique_ptr<Command> command,
+            const shared_ptr<const OutgoingValueInterface> value, unique_ptr<HandlerInterface> handler) {
+        return SubmitSource_(*message, *command, value, handler.get());
+    }
+    MOCK_METHOD4(SubmitSource_, HandlerKey(const Message &message, const Command &command,
+    const shared_ptr<const OutgoingValueInterface> value, HandlerInterface* handler));
     MOCK_METHOD3(Run, bool(fd_set *read_fds, fd_set *write_fds, int *nfds));
+    MOCK_METHOD1(Run, bool(SocketInterest *interest));
+    MOCK_METHOD1(SetSocketIo, bool(shared_ptr<SocketIoInterface> io));
     MOCK_METHOD1(Remove, bool(HandlerKey handler_key));
+    MOCK_METHOD2(SetDeadline, void(HandlerKey handler_key,
+        std::chrono::steady_clock::time_point deadline));
+    MOCK_METHOD0(TimeUntilDeadline, int());
+
+    std::vector<unique_ptr<HandlerInterface>> submitted_handlers;
+    // Requests may be submitted from several threads at once
+    std::mutex submitted_handlers_mutex;
 };
 
 } // namespace kinetic
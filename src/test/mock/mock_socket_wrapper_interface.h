@@ -26,10 +26,21 @@ namespace kinetic {
 
 class MockSocketWrapperInterface : public SocketWrapperInterface {
     public:
-    MockSocketWrapperInterface() {}
+    MockSocketWrapperInterface() : io_(NULL), zero_copy_(NULL) {}
     MOCK_METHOD0(Connect, bool());
     MOCK_METHOD0(fd, int());
     MOCK_METHOD0(getSSL, SSL*());
+    MOCK_METHOD0(descriptor_type, DescriptorType());
+    MOCK_METHOD1(set_io, bool(std::shared_ptr<SocketIoInterface> io));
+    // Asked on every read and write, so a plain accessor keeps tests that don't care quiet
+    SocketIoInterface *io() {
+        return io_;
+    }
+    SocketIoInterface *io_;
+    ZeroCopySender *zero_copy() {
+        return zero_copy_;
+    }
+    ZeroCopySender *zero_copy_;
 };
 
 }  // namespace kinetic
@@ -15,6 +15,9 @@
  * See www.openkinetic.org for more project information
  */
 
+#include <stdio.h>
+#include <unistd.h>
+
 #include "kinetic/kinetic.h"
 #include "matchers.h"
 
@@ -38,6 +41,9 @@ using com::seagate::kinetic::client::proto::Command_MessageType_GETLOG;
 using com::seagate::kinetic::client::proto::Command_MessageType_SECURITY;
 using com::seagate::kinetic::client::proto::Command_MessageType_PEER2PEERPUSH;
 using com::seagate::kinetic::client::proto::Command_MessageType_PINOP;
+using com::seagate::kinetic::client::proto::Command_Priority_LOWER;
+using com::seagate::kinetic::client::proto::Command_Priority_HIGHER;
+using com::seagate::kinetic::client::proto::Command_Priority_HIGHEST;
 using com::seagate::kinetic::client::proto::Command_Status_StatusCode_SUCCESS;
 using com::seagate::kinetic::client::proto::Command_Status_StatusCode_INTERNAL_ERROR;
 using com::seagate::kinetic::client::proto::Command_GetLog_Type_UTILIZATIONS;
@@ -69,7 +75,9 @@ using com::seagate::kinetic::client::proto::Command_PinOperation_PinOpType_ERASE
 
 using ::testing::_;
 using ::testing::DoAll;
+using ::testing::Invoke;
 using ::testing::SaveArg;
+using ::testing::SetArgPointee;
 using ::testing::StrictMock;
 using ::testing::NiceMock;
 using ::testing::Return;
@@ -113,6 +121,127 @@ TEST_F(NonblockingKineticConnectionTest, GetWorks) {
     ASSERT_EQ("key", message.body().keyvalue().key());
 }
 
+TEST_F(NonblockingKineticConnectionTest, GetIntoWorks) {
+    Command message;
+    EXPECT_CALL(*packet_service_, Submit_(_, _, StringSharedPtrEq(""), _))
+            .WillOnce(DoAll(SaveArg<1>(&message), Return(0)));
+    shared_ptr<GetIntoCallbackInterface> callback;
+    connection_.GetInto("key", make_shared<ValueBufferPool>(), callback);
+
+    ASSERT_EQ(Command_MessageType_GET, message.header().messagetype());
+    ASSERT_EQ("key", message.body().keyvalue().key());
+}
+
+TEST_F(NonblockingKineticConnectionTest, GetIntoHandlerReceivesIntoSuppliedBuffer) {
+    char memory[16];
+    auto buffer = make_shared<ValueBuffer>(memory, sizeof(memory));
+    auto callback = make_shared<MockGetIntoCallback>();
+    GetIntoHandler handler(buffer, callback);
+
+    Command response;
+    response.mutable_status()->set_code(Command_Status_StatusCode_SUCCESS);
+    response.mutable_body()->mutable_keyvalue()->set_key("key");
+    response.mutable_body()->mutable_keyvalue()->set_dbversion("version");
+    response.mutable_body()->mutable_keyvalue()->set_tag("tag");
+    response.mutable_body()->mutable_keyvalue()->set_algorithm(Command_Algorithm_SHA1);
+
+    // The receiver writes the value into the returned memory itself
+    char *destination = handler.ValueDestination(response, 5);
+    ASSERT_EQ(memory, destination);
+    memcpy(destination, "value", 5);
+
+    EXPECT_CALL(*callback, Success("key", buffer, "version", "tag", Command_Algorithm_SHA1));
+    unique_ptr<const string> empty_str(new string(""));
+    handler.Handle(response, move(empty_str));
+    ASSERT_EQ("value", buffer->ToString());
+}
+
+TEST_F(NonblockingKineticConnectionTest, GetIntoHandlerFailsWhenValueDoesNotFit) {
+    char memory[4];
+    auto buffer = make_shared<ValueBuffer>(memory, sizeof(memory));
+    auto callback = make_shared<MockGetIntoCallback>();
+    GetIntoHandler handler(buffer, callback);
+
+    Command response;
+    response.mutable_status()->set_code(Command_Status_StatusCode_SUCCESS);
+    ASSERT_EQ(NULL, handler.ValueDestination(response, 5));
+
+    EXPECT_CALL(*callback, Failure(KineticStatusEq(StatusCode::CLIENT_INTERNAL_ERROR,
+        "Value is larger than the supplied buffer")));
+    unique_ptr<const string> value(new string("value"));
+    handler.Handle(response, move(value));
+}
+
+TEST_F(NonblockingKineticConnectionTest, GetToFileWorks) {
+    Command message;
+    EXPECT_CALL(*packet_service_, Submit_(_, _, StringSharedPtrEq(""), _))
+            .WillOnce(DoAll(SaveArg<1>(&message), Return(0)));
+    shared_ptr<GetToFileCallbackInterface> callback;
+    connection_.GetToFile("key", callback);
+
+    ASSERT_EQ(Command_MessageType_GET, message.header().messagetype());
+    ASSERT_EQ("key", message.body().keyvalue().key());
+}
+
+TEST_F(NonblockingKineticConnectionTest, GetToFileHandlerHasValueWrittenToDestination) {
+    auto callback = make_shared<MockGetToFileCallback>();
+    GetToFileHandler handler(callback);
+
+    Command response;
+    response.mutable_status()->set_code(Command_Status_StatusCode_SUCCESS);
+    response.mutable_body()->mutable_keyvalue()->set_key("key");
+    response.mutable_body()->mutable_keyvalue()->set_dbversion("version");
+    response.mutable_body()->mutable_keyvalue()->set_tag("tag");
+    response.mutable_body()->mutable_keyvalue()->set_algorithm(Command_Algorithm_SHA1);
+
+    // The receiver writes the value to the returned descriptor itself
+    EXPECT_CALL(*callback, Destination("key", 5, _)).WillOnce(DoAll(SetArgPointee<2>(100), Return(7)));
+    off_t offset = -1;
+    ASSERT_EQ(7, handler.ValueFile(response, 5, &offset));
+    ASSERT_EQ(100, offset);
+
+    EXPECT_CALL(*callback, Success("key", 5, "version", "tag", Command_Algorithm_SHA1));
+    unique_ptr<const string> empty_str(new string(""));
+    handler.Handle(response, move(empty_str));
+}
+
+TEST_F(NonblockingKineticConnectionTest, GetToFileHandlerWritesValuesThatArriveInMemory) {
+    auto callback = make_shared<MockGetToFileCallback>();
+    GetToFileHandler handler(callback);
+    FILE *file = tmpfile();
+    ASSERT_TRUE(file != NULL);
+
+    Command response;
+    response.mutable_status()->set_code(Command_Status_StatusCode_SUCCESS);
+    response.mutable_body()->mutable_keyvalue()->set_key("key");
+    EXPECT_CALL(*callback, Destination("key", 5, _)).WillOnce(DoAll(SetArgPointee<2>(2),
+        Return(fileno(file))));
+    EXPECT_CALL(*callback, Success("key", 5, "", "", _));
+    unique_ptr<const string> value(new string("value"));
+    handler.Handle(response, move(value));
+
+    char contents[8];
+    ASSERT_EQ(7, pread(fileno(file), contents, sizeof(contents), 0));
+    ASSERT_EQ(string("\0\0value", 7), string(contents, 7));
+    ASSERT_EQ(0, fclose(file));
+}
+
+TEST_F(NonblockingKineticConnectionTest, GetToFileHandlerFailsWithoutDestination) {
+    auto callback = make_shared<MockGetToFileCallback>();
+    GetToFileHandler handler(callback);
+
+    Command response;
+    response.mutable_status()->set_code(Command_Status_StatusCode_SUCCESS);
+    EXPECT_CALL(*callback, Destination(_, 5, _)).WillOnce(Return(-1));
+    off_t offset = -1;
+    ASSERT_EQ(-1, handler.ValueFile(response, 5, &offset));
+
+    EXPECT_CALL(*callback, Failure(KineticStatusEq(StatusCode::CLIENT_INTERNAL_ERROR,
+        "No destination for value")));
+    unique_ptr<const string> value(new string("value"));
+    handler.Handle(response, move(value));
+}
+
 TEST_F(NonblockingKineticConnectionTest, GetWithClusterVersionWorks) {
     connection_.SetClientClusterVersion(123);
     Command message;
@@ -126,6 +255,52 @@ TEST_F(NonblockingKineticConnectionTest, GetWithClusterVersionWorks) {
     ASSERT_EQ("key", message.body().keyvalue().key());
 }
 
+TEST_F(NonblockingKineticConnectionTest, GetSendsRequestOptionsInHeader) {
+    Command message;
+    EXPECT_CALL(*packet_service_, Submit_(_, _, StringSharedPtrEq(""), _))
+            .WillOnce(DoAll(SaveArg<1>(&message), Return(0)));
+    RequestOptions options;
+    options.timeout_ms = 500;
+    options.early_exit = true;
+    options.priority = RequestPriority::HIGHER;
+    options.time_quanta_ms = 20;
+    shared_ptr<GetCallbackInterface> callback;
+    connection_.Get("key", callback, options);
+
+    ASSERT_EQ(500, message.header().timeout());
+    ASSERT_TRUE(message.header().earlyexit());
+    ASSERT_EQ(Command_Priority_HIGHER, message.header().priority());
+    ASSERT_EQ(20, message.header().timequanta());
+}
+
+TEST_F(NonblockingKineticConnectionTest, DefaultRequestOptionsAreNotSent) {
+    Command message;
+    EXPECT_CALL(*packet_service_, Submit_(_, _, StringSharedPtrEq(""), _))
+            .WillOnce(DoAll(SaveArg<1>(&message), Return(0)));
+    shared_ptr<GetCallbackInterface> callback;
+    connection_.Get("key", callback);
+
+    ASSERT_FALSE(message.header().has_timeout());
+    ASSERT_FALSE(message.header().has_earlyexit());
+    ASSERT_FALSE(message.header().has_priority());
+    ASSERT_FALSE(message.header().has_timequanta());
+}
+
+TEST_F(NonblockingKineticConnectionTest, MediaScanRunsAtLowerPriorityUnlessOverridden) {
+    Command message;
+    EXPECT_CALL(*packet_service_, Submit_(_, _, StringSharedPtrEq(""), _))
+            .WillOnce(DoAll(SaveArg<1>(&message), Return(0)))
+            .WillOnce(DoAll(SaveArg<1>(&message), Return(0)));
+    shared_ptr<MediaScanCallbackInterface> callback;
+    connection_.MediaScan("a", true, "z", true, 10, callback);
+    ASSERT_EQ(Command_Priority_LOWER, message.header().priority());
+
+    RequestOptions options;
+    options.priority = RequestPriority::HIGHEST;
+    connection_.MediaScan("a", true, "z", true, 10, callback, options);
+    ASSERT_EQ(Command_Priority_HIGHEST, message.header().priority());
+}
+
 TEST_F(NonblockingKineticConnectionTest, GetNextWorks) {
     Command message;
     EXPECT_CALL(*packet_service_, Submit_(_, _, StringSharedPtrEq(""), _)).WillOnce(
@@ -189,6 +364,141 @@ TEST_F(NonblockingKineticConnectionTest, PutWorks) {
     ASSERT_EQ(Command_Synchronization_WRITEBACK, message.body().keyvalue().synchronization());
 }
 
+TEST_F(NonblockingKineticConnectionTest, SubmitBatchSubmitsOperationsInOrder) {
+    Command put;
+    Command del;
+    {
+        ::testing::InSequence s;
+        EXPECT_CALL(*packet_service_, Submit_(_, _, StringSharedPtrEq("value"), _)).WillOnce(
+                DoAll(SaveArg<1>(&put), Return(1)));
+        EXPECT_CALL(*packet_service_, Submit_(_, _, StringSharedPtrEq(""), _)).WillOnce(
+                DoAll(SaveArg<1>(&del), Return(2)));
+    }
+    Batch batch(PersistMode::WRITE_THROUGH);
+    batch.Put("key1", "old_version", WriteMode::REQUIRE_SAME_VERSION,
+            make_shared<KineticRecord>("value", "new_version", "tag", Command_Algorithm_SHA1));
+    batch.Delete("key2", "version", WriteMode::IGNORE_VERSION);
+    auto callback = make_shared<StrictMock<MockBatchCallback>>();
+    // The operations are never answered, so they're discarded along with the connection
+    EXPECT_CALL(*callback, Failure_(KineticStatusEq(StatusCode::CLIENT_SHUTDOWN,
+            "Operation removed before completing"), _));
+    ASSERT_EQ(vector<HandlerKey>({1, 2}), connection_.SubmitBatch(batch, callback));
+
+    ASSERT_EQ(Command_MessageType_PUT, put.header().messagetype());
+    ASSERT_EQ("key1", put.body().keyvalue().key());
+    ASSERT_EQ("old_version", put.body().keyvalue().dbversion());
+    ASSERT_FALSE(put.body().keyvalue().force());
+    ASSERT_EQ(Command_Synchronization_WRITETHROUGH, put.body().keyvalue().synchronization());
+    ASSERT_EQ(Command_MessageType_DELETE, del.header().messagetype());
+    ASSERT_EQ("key2", del.body().keyvalue().key());
+    ASSERT_TRUE(del.body().keyvalue().force());
+    ASSERT_EQ(Command_Synchronization_WRITETHROUGH, del.body().keyvalue().synchronization());
+}
+
+TEST_F(NonblockingKineticConnectionTest, SubmitBatchCallsBackOnceAllOperationsSucceed) {
+    auto succeed = [](const Message &message, const Command &command,
+            const shared_ptr<const string> value, HandlerInterface *handler) {
+        handler->Handle(Command(), unique_ptr<const string>(new string()));
+        return HandlerKey(0);
+    };
+    EXPECT_CALL(*packet_service_, Submit_(_, _, _, _)).Times(3).WillRepeatedly(Invoke(succeed));
+    auto callback = make_shared<StrictMock<MockBatchCallback>>();
+    EXPECT_CALL(*callback, Success());
+
+    Batch batch;
+    batch.Delete("key1", "", WriteMode::IGNORE_VERSION);
+    batch.Delete("key2", "", WriteMode::IGNORE_VERSION);
+    batch.Delete("key3", "", WriteMode::IGNORE_VERSION);
+    connection_.SubmitBatch(batch, callback);
+}
+
+TEST_F(NonblockingKineticConnectionTest, SubmitBatchReportsTheOutcomeOfEachOperation) {
+    int submitted = 0;
+    auto complete = [&](const Message &message, const Command &command,
+            const shared_ptr<const string> value, HandlerInterface *handler) {
+        if (submitted++ == 1) {
+            handler->Error(KineticStatus(StatusCode::REMOTE_VERSION_MISMATCH, "Version mismatch"), NULL);
+        } else {
+            handler->Handle(Command(), unique_ptr<const string>(new string()));
+        }
+        return HandlerKey(0);
+    };
+    EXPECT_CALL(*packet_service_, Submit_(_, _, _, _)).Times(3).WillRepeatedly(Invoke(complete));
+    auto callback = make_shared<StrictMock<MockBatchCallback>>();
+    vector<KineticStatus> statuses;
+    EXPECT_CALL(*callback, Failure_(KineticStatusEq(StatusCode::REMOTE_VERSION_MISMATCH, "Version mismatch"), _))
+            .WillOnce(SaveArg<1>(&statuses));
+
+    Batch batch;
+    batch.Delete("key1", "", WriteMode::IGNORE_VERSION);
+    batch.Delete("key2", "", WriteMode::REQUIRE_SAME_VERSION);
+    batch.Delete("key3", "", WriteMode::IGNORE_VERSION);
+    connection_.SubmitBatch(batch, callback);
+
+    ASSERT_EQ(3u, statuses.size());
+    ASSERT_TRUE(statuses[0].ok());
+    ASSERT_EQ(StatusCode::REMOTE_VERSION_MISMATCH, statuses[1].statusCode());
+    ASSERT_TRUE(statuses[2].ok());
+}
+
+TEST_F(NonblockingKineticConnectionTest, EmptyBatchIsSubmittedAsNoOp) {
+    Command message;
+    EXPECT_CALL(*packet_service_, Submit_(_, _, StringSharedPtrEq(""), _)).WillOnce(
+            DoAll(SaveArg<1>(&message), Return(0)));
+    auto callback = make_shared<StrictMock<MockBatchCallback>>();
+    EXPECT_CALL(*callback, Failure_(_, _));
+    ASSERT_EQ(vector<HandlerKey>({0}), connection_.SubmitBatch(Batch(), callback));
+
+    ASSERT_EQ(Command_MessageType_NOOP, message.header().messagetype());
+}
+
+TEST_F(NonblockingKineticConnectionTest, RemovingABatchOperationCountsAsItsFailure) {
+    EXPECT_CALL(*packet_service_, Submit_(_, _, _, _))
+            .WillOnce(Return(1))
+            .WillOnce(Return(2));
+    // The packet service discards a removed request's handler
+    EXPECT_CALL(*packet_service_, Remove(2)).WillOnce(Invoke([&](HandlerKey key) {
+        packet_service_->submitted_handlers[1].reset();
+        return true;
+    }));
+    auto callback = make_shared<StrictMock<MockBatchCallback>>();
+    vector<KineticStatus> statuses;
+    EXPECT_CALL(*callback, Failure_(KineticStatusEq(StatusCode::CLIENT_SHUTDOWN,
+            "Operation removed before completing"), _)).WillOnce(SaveArg<1>(&statuses));
+
+    Batch batch;
+    batch.Delete("key1", "", WriteMode::IGNORE_VERSION);
+    batch.Delete("key2", "", WriteMode::IGNORE_VERSION);
+    vector<HandlerKey> keys = connection_.SubmitBatch(batch, callback);
+    ASSERT_EQ(vector<HandlerKey>({1, 2}), keys);
+
+    packet_service_->submitted_handlers[0]->Handle(Command(), unique_ptr<const string>(new string()));
+    ASSERT_TRUE(connection_.RemoveHandler(keys[1]));
+
+    ASSERT_EQ(2u, statuses.size());
+    ASSERT_TRUE(statuses[0].ok());
+    ASSERT_EQ(StatusCode::CLIENT_SHUTDOWN, statuses[1].statusCode());
+}
+
+TEST_F(NonblockingKineticConnectionTest, PutWithValueSourceStreamsIt) {
+    Command message;
+    shared_ptr<const OutgoingValueInterface> value = make_shared<OutgoingStringValue>("streamed");
+    EXPECT_CALL(*packet_service_, SubmitSource_(_, _, value, _)).WillOnce(
+            DoAll(SaveArg<1>(&message), Return(0)));
+    auto record = make_shared<KineticRecord>("", "new_version", "tag", Command_Algorithm_SHA1);
+    shared_ptr<PutCallbackInterface> callback;
+    connection_.Put("key", "old_version", WriteMode::REQUIRE_SAME_VERSION, record, value, callback,
+            PersistMode::FLUSH);
+
+    ASSERT_EQ(Command_MessageType_PUT, message.header().messagetype());
+    ASSERT_EQ("key", message.body().keyvalue().key());
+    ASSERT_EQ("old_version", message.body().keyvalue().dbversion());
+    ASSERT_FALSE(message.body().keyvalue().force());
+    ASSERT_EQ("new_version", message.body().keyvalue().newversion());
+    ASSERT_EQ("tag", message.body().keyvalue().tag());
+    ASSERT_EQ(Command_Synchronization_FLUSH, message.body().keyvalue().synchronization());
+}
+
 TEST_F(NonblockingKineticConnectionTest, GetKeyRangeWorks) {
     Command message;
     EXPECT_CALL(*packet_service_, Submit_(_, _, StringSharedPtrEq(""), _)).WillOnce(
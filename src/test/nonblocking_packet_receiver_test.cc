@@ -24,6 +24,7 @@
 #include "nonblocking_packet_service.h"
 #include "mock_socket_wrapper_interface.h"
 #include "mock_nonblocking_packet_service.h"
+#include "mock_callbacks.h"
 #include "matchers.h"
 
 #include <fcntl.h>
@@ -40,6 +41,7 @@ namespace kinetic {
 using ::testing::_;
 using ::testing::NiceMock;
 using ::testing::Return;
+using ::testing::SaveArg;
 using ::testing::StrictMock;
 using com::seagate::kinetic::client::proto::Command_MessageType_GET_RESPONSE;
 using com::seagate::kinetic::client::proto::Command_Status_StatusCode_SUCCESS;
@@ -129,6 +131,23 @@ TEST_F(NonblockingReceiverTest, SimpleMessageAndValue) {
     ASSERT_EQ(kIdle, receiver.Receive());
 }
 
+TEST_F(NonblockingReceiverTest, ReceivesValueIntoHandlerSuppliedMemory) {
+    Command command;
+    ConnectionOptions options;
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    defaultReceiverSetup(command, socket_wrapper, options);
+    NonblockingReceiver receiver(socket_wrapper, hmac_provider_, options);
+
+    auto pool = make_shared<ValueBufferPool>();
+    auto callback = make_shared<MockGetIntoCallback>();
+    shared_ptr<ValueBuffer> buffer;
+    EXPECT_CALL(*callback, Success(_, _, _, _, _)).WillOnce(SaveArg<1>(&buffer));
+    ASSERT_TRUE(receiver.Enqueue(make_shared<GetIntoHandler>(pool, callback), 33, 0));
+    ASSERT_EQ(kIdle, receiver.Receive());
+    ASSERT_TRUE(buffer != NULL);
+    ASSERT_EQ("value", buffer->ToString());
+}
+
 TEST_F(NonblockingReceiverTest, ReceiveResponsesOutOfOrder) {
     Command command;
     Message message;
@@ -327,6 +346,27 @@ TEST_F(NonblockingReceiverTest, RemoveValidHandlerKeyDeregistersHandler) {
     ASSERT_EQ(kIdle, receiver.Receive());
 }
 
+TEST_F(NonblockingReceiverTest, FailCallsErrorAndDeregistersHandler) {
+    Command command;
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    ConnectionOptions options;
+    defaultReceiverSetup(command, socket_wrapper, options);
+    NonblockingReceiver receiver(socket_wrapper, hmac_provider_, options);
+
+    auto handler1 = make_shared<StrictMock<MockHandler>>();
+    auto handler2 = make_shared<StrictMock<MockHandler>>();
+    EXPECT_CALL(*handler1, Handle_(_, "value"));
+    EXPECT_CALL(*handler2, Error(KineticStatusEq(StatusCode::CLIENT_IO_ERROR,
+        "Request timed out"), NULL));
+    ASSERT_TRUE(receiver.Enqueue(handler1, 33, 0));
+    ASSERT_TRUE(receiver.Enqueue(handler2, 34, 1));
+
+    ASSERT_TRUE(receiver.Fail(1, KineticStatus(StatusCode::CLIENT_IO_ERROR, "Request timed out")));
+    ASSERT_FALSE(receiver.Fail(1, KineticStatus(StatusCode::CLIENT_IO_ERROR, "Request timed out")));
+
+    ASSERT_EQ(kIdle, receiver.Receive());
+}
+
 TEST_F(NonblockingReceiverTest, EnqueueReturnsFalseWhenReUsingHandlerKey) {
     Command command;
     auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
@@ -16,8 +16,13 @@
  */
 
 #include <arpa/inet.h>
+#include <fcntl.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "gmock/gmock.h"
 
 #include "kinetic/kinetic.h"
@@ -208,6 +213,8 @@ TEST_F(NonblockingSenderTest, MaintainsCorrectHandlerKeyWhenWriteDoesntCompleteO
     ConnectionOptions options;
     options.user_id = 3;
     options.hmac_key = "key";
+    // Each request gets a writer of its own
+    options.max_coalesced_requests = 1;
     unique_ptr<HandlerInterface> handler1(new MockHandler());
     unique_ptr<HandlerInterface> handler2(new MockHandler());
     unique_ptr<HandlerInterface> handler3(new MockHandler());
@@ -366,4 +373,252 @@ TEST_F(NonblockingSenderTest, RemoveInvalidKeyReturnsFalse) {
     ASSERT_EQ(kIdle, sender.Send());
 }
 
+TEST_F(NonblockingSenderTest, FailCallsErrorAndDoesntSend) {
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    EXPECT_CALL(*socket_wrapper, fd()).WillRepeatedly(Return(fds_[1]));
+    ConnectionOptions options;
+    options.user_id = 3;
+    options.hmac_key = "key";
+    auto receiver = make_shared<StrictMock<MockNonblockingReceiver>>();
+    EXPECT_CALL(*receiver, connection_id()).WillRepeatedly(Return(1));
+
+    EXPECT_CALL(*socket_wrapper, getSSL()).WillRepeatedly(Return((SSL*) 0));
+    NonblockingSender sender(socket_wrapper, receiver, move(writer_factory_), hmac_provider_,
+        options);
+
+    unique_ptr<MockHandler> handler1(new StrictMock<MockHandler>());
+    unique_ptr<MockHandler> handler2(new StrictMock<MockHandler>());
+    EXPECT_CALL(*handler1, Error(KineticStatusEq(StatusCode::CLIENT_IO_ERROR, "Request timed out"),
+        NULL));
+    EXPECT_CALL(*receiver, Enqueue_(handler2.get(), 1, 1)).WillOnce(Return(true));
+
+    sender.Enqueue(unique_ptr<Message>(new Message()), unique_ptr<Command>(new Command()),
+        make_shared<string>(""), move(handler1), 0);
+    sender.Enqueue(unique_ptr<Message>(new Message()), unique_ptr<Command>(new Command()),
+        make_shared<string>(""), move(handler2), 1);
+
+    ASSERT_TRUE(sender.Fail(0, KineticStatus(StatusCode::CLIENT_IO_ERROR, "Request timed out")));
+    ASSERT_FALSE(sender.Fail(0, KineticStatus(StatusCode::CLIENT_IO_ERROR, "Request timed out")));
+
+    ASSERT_EQ(kIdle, sender.Send());
+}
+
+TEST_F(NonblockingSenderTest, RemoveAndFailMissRequestsAlreadyWritten) {
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    EXPECT_CALL(*socket_wrapper, fd()).WillRepeatedly(Return(fds_[1]));
+    EXPECT_CALL(*socket_wrapper, getSSL()).WillRepeatedly(Return((SSL*) 0));
+    ConnectionOptions options;
+    options.user_id = 3;
+    options.hmac_key = "key";
+    auto receiver = make_shared<StrictMock<MockNonblockingReceiver>>();
+    EXPECT_CALL(*receiver, connection_id()).WillRepeatedly(Return(1));
+    NonblockingSender sender(socket_wrapper, receiver, move(writer_factory_), hmac_provider_,
+        options);
+
+    unique_ptr<MockHandler> handler1(new StrictMock<MockHandler>());
+    unique_ptr<MockHandler> handler2(new StrictMock<MockHandler>());
+    EXPECT_CALL(*receiver, Enqueue_(handler1.get(), 0, 0)).WillOnce(Return(true));
+    EXPECT_CALL(*handler2, Error(KineticStatusEq(StatusCode::CLIENT_IO_ERROR, "Request timed out"),
+        NULL));
+
+    sender.Enqueue(unique_ptr<Message>(new Message()), unique_ptr<Command>(new Command()),
+        make_shared<string>(""), move(handler1), 0);
+    ASSERT_EQ(kIdle, sender.Send());
+    sender.Enqueue(unique_ptr<Message>(new Message()), unique_ptr<Command>(new Command()),
+        make_shared<string>(""), move(handler2), 1);
+
+    // The first request has been handed to the receiver, so only the second is still held
+    ASSERT_FALSE(sender.Remove(0));
+    ASSERT_FALSE(sender.Fail(0, KineticStatus(StatusCode::CLIENT_IO_ERROR, "Request timed out")));
+    ASSERT_TRUE(sender.Fail(1, KineticStatus(StatusCode::CLIENT_IO_ERROR, "Request timed out")));
+    ASSERT_FALSE(sender.Remove(1));
+    ASSERT_EQ(kIdle, sender.Send());
+}
+
+TEST_F(NonblockingSenderTest, CoalescesQueuedRequestsIntoOneWriter) {
+    // Requests queued together share a writer; each handler is passed to the receiver as soon as
+    // its own packet has been written, even while later ones are still going out
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    ConnectionOptions options;
+    options.user_id = 3;
+    options.hmac_key = "key";
+    unique_ptr<HandlerInterface> handler1(new MockHandler());
+    unique_ptr<HandlerInterface> handler2(new MockHandler());
+    unique_ptr<HandlerInterface> handler3(new MockHandler());
+    auto receiver = make_shared<StrictMock<MockNonblockingReceiver>>();
+    EXPECT_CALL(*receiver, connection_id()).WillRepeatedly(Return(1));
+    {
+        ::testing::InSequence s;
+        EXPECT_CALL(*receiver, Enqueue_(handler1.get(), 0, 0)).WillOnce(Return(true));
+        EXPECT_CALL(*receiver, Enqueue_(handler2.get(), 1, 1)).WillOnce(Return(true));
+        EXPECT_CALL(*receiver, Enqueue_(handler3.get(), 2, 2)).WillOnce(Return(true));
+    }
+
+    shared_ptr<const string> value = make_shared<string>("value");
+    auto mock_writer = new StrictMock<MockNonblockingPacketWriter>();
+    EXPECT_CALL(*mock_writer, Append_(_, value)).Times(2);
+    EXPECT_CALL(*mock_writer, Write())
+        .WillOnce(Return(kInProgress))
+        .WillOnce(Return(kDone))
+        .WillOnce(Return(kInProgress))
+        .WillOnce(Return(kDone))
+        .WillOnce(Return(kDone));
+    auto mock_factory = new StrictMock<MockNonblockingPacketWriterFactory>();
+    EXPECT_CALL(*mock_factory, CreateWriter_(_, _, value)).WillOnce(Return(mock_writer));
+
+    NonblockingSender sender(socket_wrapper, receiver,
+        shared_ptr<NonblockingPacketWriterFactoryInterface>(mock_factory), hmac_provider_,
+        options);
+    sender.Enqueue(unique_ptr<Message>(new Message()), unique_ptr<Command>(new Command()), value, move(handler1), 0);
+    sender.Enqueue(unique_ptr<Message>(new Message()), unique_ptr<Command>(new Command()), value, move(handler2), 1);
+    sender.Enqueue(unique_ptr<Message>(new Message()), unique_ptr<Command>(new Command()), value, move(handler3), 2);
+    ASSERT_EQ(kIoWait, sender.Send());
+    ASSERT_EQ(kIoWait, sender.Send());
+    ASSERT_EQ(kIdle, sender.Send());
+}
+
+TEST_F(NonblockingSenderTest, RemoveDropsHandlerOfCoalescedRequestNotYetWritten) {
+    // The second request is already in the writer when it's removed; its packet still goes out
+    // but its handler must never be passed to the receiver
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    ConnectionOptions options;
+    options.user_id = 3;
+    options.hmac_key = "key";
+    unique_ptr<HandlerInterface> handler1(new MockHandler());
+    unique_ptr<HandlerInterface> handler2(new StrictMock<MockHandler>());
+    auto receiver = make_shared<StrictMock<MockNonblockingReceiver>>();
+    EXPECT_CALL(*receiver, connection_id()).WillRepeatedly(Return(1));
+    EXPECT_CALL(*receiver, Enqueue_(handler1.get(), 0, 0)).WillOnce(Return(true));
+
+    shared_ptr<const string> value = make_shared<string>("value");
+    auto mock_writer = new StrictMock<MockNonblockingPacketWriter>();
+    EXPECT_CALL(*mock_writer, Append_(_, value)).Times(1);
+    EXPECT_CALL(*mock_writer, Write())
+        .WillOnce(Return(kInProgress))
+        .WillOnce(Return(kDone))
+        .WillOnce(Return(kDone));
+    auto mock_factory = new StrictMock<MockNonblockingPacketWriterFactory>();
+    EXPECT_CALL(*mock_factory, CreateWriter_(_, _, value)).WillOnce(Return(mock_writer));
+
+    NonblockingSender sender(socket_wrapper, receiver,
+        shared_ptr<NonblockingPacketWriterFactoryInterface>(mock_factory), hmac_provider_,
+        options);
+    sender.Enqueue(unique_ptr<Message>(new Message()), unique_ptr<Command>(new Command()), value, move(handler1), 0);
+    sender.Enqueue(unique_ptr<Message>(new Message()), unique_ptr<Command>(new Command()), value, move(handler2), 1);
+    ASSERT_EQ(kIoWait, sender.Send());
+
+    ASSERT_TRUE(sender.Remove(1));
+    ASSERT_FALSE(sender.Remove(1));
+
+    ASSERT_EQ(kIdle, sender.Send());
+}
+
+TEST_F(NonblockingSenderTest, StopsCoalescingAtByteBudget) {
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    ConnectionOptions options;
+    options.user_id = 3;
+    options.hmac_key = "key";
+    // Room for two of the requests below but not three
+    options.max_coalesced_bytes = 250;
+    auto receiver = make_shared<NiceMock<MockNonblockingReceiver>>();
+    EXPECT_CALL(*receiver, Enqueue_(_, _, _)).WillRepeatedly(Return(true));
+
+    shared_ptr<const string> value = make_shared<string>(100, 'v');
+    auto mock_writer1 = new StrictMock<MockNonblockingPacketWriter>();
+    EXPECT_CALL(*mock_writer1, Append_(_, value)).Times(1);
+    EXPECT_CALL(*mock_writer1, Write()).Times(2).WillRepeatedly(Return(kDone));
+    auto mock_writer2 = new StrictMock<MockNonblockingPacketWriter>();
+    EXPECT_CALL(*mock_writer2, Write()).WillOnce(Return(kDone));
+    auto mock_factory = new StrictMock<MockNonblockingPacketWriterFactory>();
+    EXPECT_CALL(*mock_factory, CreateWriter_(_, _, value))
+        .WillOnce(Return(mock_writer1))
+        .WillOnce(Return(mock_writer2));
+
+    NonblockingSender sender(socket_wrapper, receiver,
+        shared_ptr<NonblockingPacketWriterFactoryInterface>(mock_factory), hmac_provider_,
+        options);
+    for (int i = 0; i < 3; i++) {
+        sender.Enqueue(unique_ptr<Message>(new Message()), unique_ptr<Command>(new Command()), value,
+            unique_ptr<HandlerInterface>(new MockHandler()), i);
+    }
+    ASSERT_EQ(kIdle, sender.Send());
+}
+
+TEST_F(NonblockingSenderTest, RequestsSignedConcurrentlyGoOutInSequenceOrder) {
+    // Several threads enqueue while another sends; every request must be signed correctly and
+    // the sequence numbers on the wire must only ever increase
+    ASSERT_EQ(0, fcntl(fds_[0], F_SETFL, O_NONBLOCK));
+    ASSERT_EQ(0, fcntl(fds_[1], F_SETFL, O_NONBLOCK));
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    EXPECT_CALL(*socket_wrapper, fd()).WillRepeatedly(Return(fds_[1]));
+    EXPECT_CALL(*socket_wrapper, getSSL()).WillRepeatedly(Return((SSL*)0));
+    EXPECT_CALL(*socket_wrapper, descriptor_type()).WillRepeatedly(Return(kPlainDescriptor));
+    ConnectionOptions options;
+    options.user_id = 3;
+    options.hmac_key = "key";
+    auto receiver = make_shared<NiceMock<MockNonblockingReceiver>>();
+    EXPECT_CALL(*receiver, connection_id()).WillRepeatedly(Return(1));
+    EXPECT_CALL(*receiver, Enqueue_(_, _, _)).WillRepeatedly(Return(true));
+    NonblockingSender sender(socket_wrapper, receiver, writer_factory_, hmac_provider_, options);
+
+    const int kThreads = 8;
+    const int kRequestsPerThread = 200;
+    std::atomic<int> running(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.push_back(std::thread([&sender, &running, t, kRequestsPerThread]() {
+            for (int i = 0; i < kRequestsPerThread; i++) {
+                unique_ptr<Message> message(new Message());
+                message->set_authtype(com::seagate::kinetic::client::proto::Message_AuthType_HMACAUTH);
+                unique_ptr<Command> command(new Command());
+                command->mutable_body()->mutable_keyvalue()->set_key("key" + std::to_string(i));
+                sender.Enqueue(move(message), move(command), make_shared<string>("value"),
+                    unique_ptr<HandlerInterface>(new MockHandler()), t * kRequestsPerThread + i);
+            }
+            running--;
+        }));
+    }
+
+    string stream;
+    char buf[4096];
+    while (true) {
+        bool done = running == 0;
+        NonblockingPacketServiceStatus status = sender.Send();
+        ASSERT_NE(kError, status);
+        ssize_t n;
+        while ((n = read(fds_[0], buf, sizeof(buf))) > 0) {
+            stream.append(buf, n);
+        }
+        if (done && status == kIdle) {
+            break;
+        }
+    }
+    for (auto it = threads.begin(); it != threads.end(); ++it) {
+        it->join();
+    }
+
+    int packets = 0;
+    int64_t last_sequence = -1;
+    size_t offset = 0;
+    while (offset < stream.size()) {
+        ASSERT_EQ('F', stream[offset]);
+        uint32_t message_length, value_length;
+        memcpy(&message_length, stream.data() + offset + 1, 4);
+        memcpy(&value_length, stream.data() + offset + 5, 4);
+        message_length = ntohl(message_length);
+        value_length = ntohl(value_length);
+        Message message;
+        ASSERT_TRUE(message.ParseFromArray(stream.data() + offset + 9, message_length));
+        ASSERT_TRUE(hmac_provider_.ValidateHmac(message, "key"));
+        Command command;
+        ASSERT_TRUE(command.ParseFromString(message.commandbytes()));
+        ASSERT_GT(command.header().sequence(), last_sequence);
+        last_sequence = command.header().sequence();
+        ASSERT_EQ("value", stream.substr(offset + 9 + message_length, value_length));
+        offset += 9 + message_length + value_length;
+        packets++;
+    }
+    ASSERT_EQ(kThreads * kRequestsPerThread, packets);
+}
+
 }  // namespace kinetic
@@ -37,6 +37,8 @@ using com::seagate::kinetic::client::proto::Command_Status_StatusCode_SUCCESS;
 
 using std::string;
 using std::make_shared;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
 
 // NonblockingPacketServiceTest
 
@@ -81,6 +83,30 @@ TEST(NonblockingPacketServiceTest, SubmitAfterFailureInvokesErrorOnCallback) {
         unique_ptr<HandlerInterface>(handler));
 }
 
+TEST(NonblockingPacketServiceTest, SubmitFailsRequestEnqueuedAfterConcurrentFailure) {
+    // Another thread's Run() fails after Submit() has checked for failure but before the request
+    // reaches the sender, so the request misses the sender being drained
+    auto sender = new StrictMock<MockNonblockingSender>();
+    auto receiver = make_shared<StrictMock<MockNonblockingReceiver>>();
+    auto socket_wrapper = make_shared<StrictMock<MockSocketWrapperInterface>>();
+
+    NonblockingPacketService service(socket_wrapper, unique_ptr<NonblockingSenderInterface>(sender),
+        receiver);
+
+    fd_set read_fds, write_fds;
+    int nfds;
+    EXPECT_CALL(*sender, Send()).WillOnce(Return(kError));
+    EXPECT_CALL(*sender, FailAll(_));
+    EXPECT_CALL(*sender, Enqueue_(_, _, _, _, 0)).WillOnce(::testing::InvokeWithoutArgs([&]() {
+        ASSERT_FALSE(service.Run(&read_fds, &write_fds, &nfds));
+    }));
+    EXPECT_CALL(*sender, Fail(0, KineticStatusEq(StatusCode::CLIENT_SHUTDOWN,
+        "Client already shut down"))).WillOnce(Return(true));
+
+    service.Submit(unique_ptr<Message>(new Message()), unique_ptr<Command>(new Command()),
+        make_shared<string>("value"), unique_ptr<HandlerInterface>(new MockHandler()));
+}
+
 TEST(NonblockingPacketServiceTest, CanRemoveHandlerAfterError) {
     // If the sender fails, the service should return an error and subsequent
     // calls should fail immediately without even attempting I/O.
@@ -163,6 +189,9 @@ TEST(NonblockingPacketServiceTest, HandlesReceiverFailure) {
 
     EXPECT_CALL(*sender, Send()).WillOnce(Return(kIdle));
     EXPECT_CALL(*receiver, Receive()).WillOnce(Return(kError));
+    // Requests still waiting to be written fail straight away
+    EXPECT_CALL(*sender, FailAll(KineticStatusEq(StatusCode::CLIENT_SHUTDOWN,
+        "Client already shut down")));
 
     NonblockingPacketService service(socket_wrapper, unique_ptr<NonblockingSenderInterface>(sender),
         receiver);
@@ -215,4 +244,59 @@ TEST(NonblockingPacketServiceTest, SetsReadFileDescriptorWhenBusyReceiving) {
     ASSERT_EQ(fd + 1, nfds);
 }
 
+TEST(NonblockingPacketServiceTest, ReportsInterestAndSendsRequestsQueuedWhileReceiving) {
+    MockNonblockingSender *sender = new StrictMock<MockNonblockingSender>;
+    auto receiver = make_shared<StrictMock<MockNonblockingReceiver>>();
+    auto socket_wrapper = make_shared<StrictMock<MockSocketWrapperInterface>>();
+
+    const int fd = 4242;
+    EXPECT_CALL(*socket_wrapper, fd()).WillRepeatedly(Return(fd));
+    // The second send picks up whatever a handler queued during Receive
+    EXPECT_CALL(*sender, Send()).WillOnce(Return(kIdle)).WillOnce(Return(kIoWait));
+    EXPECT_CALL(*receiver, Receive()).WillOnce(Return(kIoWait));
+
+    NonblockingPacketService service(socket_wrapper, unique_ptr<NonblockingSenderInterface>(sender),
+        receiver);
+
+    SocketInterest interest;
+    ASSERT_TRUE(service.Run(&interest));
+    ASSERT_EQ(fd, interest.fd);
+    ASSERT_TRUE(interest.read);
+    ASSERT_TRUE(interest.write);
+}
+
+TEST(NonblockingPacketServiceTest, RunFailsRequestsPastTheirDeadline) {
+    MockNonblockingSender *sender = new StrictMock<MockNonblockingSender>;
+    auto receiver = make_shared<StrictMock<MockNonblockingReceiver>>();
+    auto socket_wrapper = make_shared<StrictMock<MockSocketWrapperInterface>>();
+
+    // The receiver is asked first; the sender only for requests it doesn't have
+    EXPECT_CALL(*receiver, Fail(1, KineticStatusEq(StatusCode::CLIENT_IO_ERROR,
+        "Request timed out"))).WillOnce(Return(true));
+    EXPECT_CALL(*receiver, Fail(2, _)).WillOnce(Return(false));
+    EXPECT_CALL(*sender, Fail(2, KineticStatusEq(StatusCode::CLIENT_IO_ERROR,
+        "Request timed out"))).WillOnce(Return(true));
+    EXPECT_CALL(*sender, Send()).WillRepeatedly(Return(kIdle));
+    EXPECT_CALL(*receiver, Receive()).WillRepeatedly(Return(kIdle));
+
+    NonblockingPacketService service(socket_wrapper, unique_ptr<NonblockingSenderInterface>(sender),
+        receiver);
+
+    ASSERT_EQ(-1, service.TimeUntilDeadline());
+    service.SetDeadline(1, steady_clock::now() - milliseconds(1));
+    service.SetDeadline(2, steady_clock::now() - milliseconds(1));
+    service.SetDeadline(3, steady_clock::now() + milliseconds(60000));
+    ASSERT_EQ(0, service.TimeUntilDeadline());
+
+    fd_set read_fds, write_fds;
+    int nfds;
+    ASSERT_TRUE(service.Run(&read_fds, &write_fds, &nfds));
+
+    // Request 3 isn't due for a minute, so it's left alone
+    int remaining_ms = service.TimeUntilDeadline();
+    ASSERT_GT(remaining_ms, 0);
+    ASSERT_LE(remaining_ms, 60000);
+    ASSERT_TRUE(service.Run(&read_fds, &write_fds, &nfds));
+}
+
 }  // namespace kinetic
@@ -15,8 +15,14 @@
  * See www.openkinetic.org for more project information
  */
 
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
 #include <unistd.h>
 
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include "kinetic/kinetic.h"
@@ -56,6 +62,264 @@ TEST(NonblockingPacketWriterTest, EmptyMessageAndValue) {
     ASSERT_EQ(0, close(fds[0]));
 }
 
+TEST(NonblockingPacketWriterTest, ResumesPartialWrite) {
+    // A value larger than the pipe buffer can't be written in one go; the writer should report
+    // progress and pick up where it left off once the reader drains the pipe
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    ASSERT_EQ(0, fcntl(fds[1], F_SETFL, O_NONBLOCK));
+    unique_ptr<Message> message(new Message());
+    message->set_commandbytes("command");
+    string expected_message;
+    ASSERT_TRUE(message->SerializeToString(&expected_message));
+    auto value = make_shared<string>(1024 * 1024, 'v');
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    EXPECT_CALL(*socket_wrapper, fd()).WillRepeatedly(Return(fds[1]));
+    EXPECT_CALL(*socket_wrapper, getSSL()).WillRepeatedly(Return((SSL*) 0));
+    EXPECT_CALL(*socket_wrapper, descriptor_type()).WillRepeatedly(Return(kPlainDescriptor));
+    NonblockingPacketWriter request(socket_wrapper, move(message), value);
+
+    string received;
+    char buf[4096];
+    NonblockingStringStatus status;
+    while ((status = request.Write()) == kInProgress) {
+        ssize_t n = read(fds[0], buf, sizeof(buf));
+        ASSERT_GT(n, 0);
+        received.append(buf, n);
+    }
+    ASSERT_EQ(kDone, status);
+    ASSERT_EQ(0, close(fds[1]));
+    ssize_t n;
+    while ((n = read(fds[0], buf, sizeof(buf))) > 0) {
+        received.append(buf, n);
+    }
+    ASSERT_EQ(0, close(fds[0]));
+
+    ASSERT_EQ(9 + expected_message.size() + value->size(), received.size());
+    ASSERT_EQ('F', received[0]);
+    ASSERT_EQ(expected_message.size(), ntohl(*reinterpret_cast<const uint32_t *>(received.data() + 1)));
+    ASSERT_EQ(value->size(), ntohl(*reinterpret_cast<const uint32_t *>(received.data() + 5)));
+    ASSERT_EQ(expected_message, received.substr(9, expected_message.size()));
+    ASSERT_TRUE(*value == received.substr(9 + expected_message.size()));
+}
+
+// Counts the gather writes a writer makes and performs them on a descriptor
+class CountingSocketIo : public SocketIoInterface {
+    public:
+    explicit CountingSocketIo(int fd) : fd_(fd), writes(0) {}
+    ssize_t Writev(const struct iovec *iov, int iovcnt) {
+        writes++;
+        return writev(fd_, iov, iovcnt);
+    }
+    ssize_t Read(char *buf, size_t size) {
+        return read(fd_, buf, size);
+    }
+    void AbandonWrite() {}
+
+    private:
+    int fd_;
+
+    public:
+    int writes;
+};
+
+// Splits a stream of packets back into their messages' command bytes and values
+static void ParsePackets(const string &stream, std::vector<string> *commands, std::vector<string> *values) {
+    size_t offset = 0;
+    while (offset < stream.size()) {
+        ASSERT_LE(offset + 9, stream.size());
+        ASSERT_EQ('F', stream[offset]);
+        uint32_t message_length = ntohl(*reinterpret_cast<const uint32_t *>(stream.data() + offset + 1));
+        uint32_t value_length = ntohl(*reinterpret_cast<const uint32_t *>(stream.data() + offset + 5));
+        offset += 9;
+        ASSERT_LE(offset + message_length + value_length, stream.size());
+        Message message;
+        ASSERT_TRUE(message.ParseFromArray(stream.data() + offset, message_length));
+        commands->push_back(message.commandbytes());
+        values->push_back(stream.substr(offset + message_length, value_length));
+        offset += message_length + value_length;
+    }
+}
+
+TEST(NonblockingPacketWriterTest, WritesAppendedPacketsInOneGatherWrite) {
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    CountingSocketIo io(fds[1]);
+    socket_wrapper->io_ = &io;
+    string values[] = { "value0", "", "value2" };
+    NonblockingPacketWriter writer(socket_wrapper, unique_ptr<Message>(new Message()), make_shared<string>(values[0]));
+    for (int i = 1; i < 3; i++) {
+        unique_ptr<Message> message(new Message());
+        message->set_commandbytes("command" + std::to_string(i));
+        writer.Append(move(message), make_shared<string>(values[i]));
+    }
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(kDone, writer.Write());
+    }
+    ASSERT_EQ(1, io.writes);
+    ASSERT_EQ(0, close(fds[1]));
+
+    string received;
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fds[0], buf, sizeof(buf))) > 0) {
+        received.append(buf, n);
+    }
+    ASSERT_EQ(0, close(fds[0]));
+    std::vector<string> commands, received_values;
+    ParsePackets(received, &commands, &received_values);
+    ASSERT_EQ(3u, commands.size());
+    ASSERT_EQ("", commands[0]);
+    ASSERT_EQ("command1", commands[1]);
+    ASSERT_EQ("command2", commands[2]);
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(values[i], received_values[i]);
+    }
+}
+
+TEST(NonblockingPacketWriterTest, ResumesPartialWriteAcrossPackets) {
+    // A large packet in the middle forces writes to stop partway through; packets must still be
+    // reported done one at a time and in order, and the stream must come out intact
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    ASSERT_EQ(0, fcntl(fds[1], F_SETFL, O_NONBLOCK));
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    EXPECT_CALL(*socket_wrapper, fd()).WillRepeatedly(Return(fds[1]));
+    EXPECT_CALL(*socket_wrapper, getSSL()).WillRepeatedly(Return((SSL*) 0));
+    EXPECT_CALL(*socket_wrapper, descriptor_type()).WillRepeatedly(Return(kPlainDescriptor));
+    string values[] = { "small", string(1024 * 1024, 'v'), string(100 * 1024, 'w'), "last" };
+    unique_ptr<NonblockingPacketWriter> writer;
+    for (int i = 0; i < 4; i++) {
+        unique_ptr<Message> message(new Message());
+        message->set_commandbytes("command" + std::to_string(i));
+        if (i == 0) {
+            writer.reset(new NonblockingPacketWriter(socket_wrapper, move(message), make_shared<string>(values[i])));
+        } else {
+            writer->Append(move(message), make_shared<string>(values[i]));
+        }
+    }
+
+    string received;
+    char buf[4096];
+    int done = 0;
+    while (done < 4) {
+        NonblockingStringStatus status = writer->Write();
+        if (status == kDone) {
+            done++;
+            continue;
+        }
+        ASSERT_EQ(kInProgress, status);
+        ssize_t n = read(fds[0], buf, sizeof(buf));
+        ASSERT_GT(n, 0);
+        received.append(buf, n);
+    }
+    ASSERT_EQ(0, close(fds[1]));
+    ssize_t n;
+    while ((n = read(fds[0], buf, sizeof(buf))) > 0) {
+        received.append(buf, n);
+    }
+    ASSERT_EQ(0, close(fds[0]));
+
+    std::vector<string> commands, received_values;
+    ParsePackets(received, &commands, &received_values);
+    ASSERT_EQ(4u, commands.size());
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ("command" + std::to_string(i), commands[i]);
+        ASSERT_TRUE(values[i] == received_values[i]);
+    }
+}
+
+// Runs a writer to completion against a nonblocking pipe, collecting everything it writes
+static void WriteAll(NonblockingPacketWriter *writer, size_t packets, int read_fd, string *received) {
+    char buf[4096];
+    size_t done = 0;
+    while (done < packets) {
+        NonblockingStringStatus status = writer->Write();
+        if (status == kDone) {
+            done++;
+            continue;
+        }
+        ASSERT_EQ(kInProgress, status);
+        ssize_t n = read(read_fd, buf, sizeof(buf));
+        ASSERT_GT(n, 0);
+        received->append(buf, n);
+    }
+    ssize_t n;
+    while ((n = read(read_fd, buf, sizeof(buf))) > 0) {
+        received->append(buf, n);
+    }
+}
+
+TEST(NonblockingPacketWriterTest, SendsFileValuesStraightFromTheFile) {
+    string contents(300 * 1024, 'f');
+    for (size_t i = 0; i < contents.size(); i += 7) {
+        contents[i] = 'a' + (i % 26);
+    }
+    FILE *file = tmpfile();
+    ASSERT_TRUE(file != NULL);
+    ASSERT_EQ(static_cast<ssize_t>(contents.size()), write(fileno(file), contents.data(), contents.size()));
+
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    ASSERT_EQ(0, fcntl(fds[0], F_SETFL, O_NONBLOCK));
+    ASSERT_EQ(0, fcntl(fds[1], F_SETFL, O_NONBLOCK));
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    EXPECT_CALL(*socket_wrapper, fd()).WillRepeatedly(Return(fds[1]));
+    EXPECT_CALL(*socket_wrapper, getSSL()).WillRepeatedly(Return((SSL*) 0));
+    EXPECT_CALL(*socket_wrapper, descriptor_type()).WillRepeatedly(Return(kPlainDescriptor));
+
+    NonblockingPacketWriter writer(socket_wrapper, unique_ptr<Message>(new Message()), make_shared<string>("before"));
+    writer.Append(unique_ptr<Message>(new Message()),
+        shared_ptr<const OutgoingValueInterface>(make_shared<OutgoingFileValue>(fileno(file), 5, contents.size() - 10)));
+    writer.Append(unique_ptr<Message>(new Message()), make_shared<string>("after"));
+    string received;
+    WriteAll(&writer, 3, fds[0], &received);
+    ASSERT_EQ(0, close(fds[0]));
+    ASSERT_EQ(0, close(fds[1]));
+    ASSERT_EQ(0, fclose(file));
+
+    std::vector<string> commands, values;
+    ParsePackets(received, &commands, &values);
+    ASSERT_EQ(3u, values.size());
+    ASSERT_EQ("before", values[0]);
+    ASSERT_TRUE(contents.substr(5, contents.size() - 10) == values[1]);
+    ASSERT_EQ("after", values[2]);
+}
+
+TEST(NonblockingPacketWriterTest, StreamsOtherValueSourcesInChunks) {
+    // Without a file to send from, the value is read and written a bounded chunk at a time
+    string contents(200 * 1024, 'c');
+    for (size_t i = 0; i < contents.size(); i += 5) {
+        contents[i] = 'a' + (i % 26);
+    }
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    ASSERT_EQ(0, fcntl(fds[0], F_SETFL, O_NONBLOCK));
+    ASSERT_EQ(0, fcntl(fds[1], F_SETFL, O_NONBLOCK));
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    EXPECT_CALL(*socket_wrapper, fd()).WillRepeatedly(Return(fds[1]));
+    EXPECT_CALL(*socket_wrapper, getSSL()).WillRepeatedly(Return((SSL*) 0));
+    EXPECT_CALL(*socket_wrapper, descriptor_type()).WillRepeatedly(Return(kPlainDescriptor));
+
+    unique_ptr<Message> message(new Message());
+    message->set_commandbytes("command");
+    NonblockingPacketWriter writer(socket_wrapper, move(message),
+        shared_ptr<const OutgoingValueInterface>(make_shared<OutgoingStringValue>(contents)));
+    writer.Append(unique_ptr<Message>(new Message()), make_shared<string>("after"));
+    string received;
+    WriteAll(&writer, 2, fds[0], &received);
+    ASSERT_EQ(0, close(fds[0]));
+    ASSERT_EQ(0, close(fds[1]));
+
+    std::vector<string> commands, values;
+    ParsePackets(received, &commands, &values);
+    ASSERT_EQ(2u, values.size());
+    ASSERT_EQ("command", commands[0]);
+    ASSERT_TRUE(contents == values[0]);
+    ASSERT_EQ("after", values[1]);
+}
+
 TEST(NonblockingPacketReaderTest, EmptyMessageAndValue) {
     // Create a pipe and write the 9-byte header into it
     int fds[2];
@@ -76,4 +340,235 @@ TEST(NonblockingPacketReaderTest, EmptyMessageAndValue) {
     ASSERT_EQ(0, close(fds[0]));
 }
 
+TEST(NonblockingPacketReaderTest, ReadsPipelinedPackets) {
+    // Several packets back to back, including one whose value is too big for the receive buffer
+    string values[] = { "value", string(200 * 1024, 'v'), "" };
+    FILE *file = tmpfile();
+    ASSERT_TRUE(file != NULL);
+    int fd = fileno(file);
+    for (int i = 0; i < 3; i++) {
+        Message message;
+        message.set_commandbytes("command" + std::to_string(i));
+        string serialized_message;
+        ASSERT_TRUE(message.SerializeToString(&serialized_message));
+        uint32_t message_length = htonl(serialized_message.size());
+        uint32_t value_length = htonl(values[i].size());
+        ASSERT_EQ(1, write(fd, "F", 1));
+        ASSERT_EQ(4, write(fd, &message_length, 4));
+        ASSERT_EQ(4, write(fd, &value_length, 4));
+        ASSERT_EQ(static_cast<ssize_t>(serialized_message.size()),
+            write(fd, serialized_message.data(), serialized_message.size()));
+        ASSERT_EQ(static_cast<ssize_t>(values[i].size()), write(fd, values[i].data(), values[i].size()));
+    }
+    ASSERT_EQ(0, lseek(fd, 0, SEEK_SET));
+
+    Message message;
+    unique_ptr<const string> value;
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    EXPECT_CALL(*socket_wrapper, fd()).WillRepeatedly(Return(fd));
+    EXPECT_CALL(*socket_wrapper, getSSL()).WillRepeatedly(Return((SSL*) 0));
+    NonblockingPacketReader response(socket_wrapper, &message, value);
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(kDone, response.Read());
+        ASSERT_EQ("command" + std::to_string(i), message.commandbytes());
+        ASSERT_TRUE(values[i] == *value);
+        ASSERT_FALSE(response.in_progress());
+    }
+    // Nothing left but EOF
+    ASSERT_EQ(kFailed, response.Read());
+
+    ASSERT_EQ(0, fclose(file));
+}
+
+class RecordingMessageListener : public PacketMessageListenerInterface {
+    public:
+    char *MessageReceived(const Message &message, const char *command_bytes,
+            size_t command_length, size_t value_size) {
+        message_had_command_bytes = message.has_commandbytes();
+        command = string(command_bytes, command_length);
+        return NULL;
+    }
+    bool message_had_command_bytes;
+    string command;
+};
+
+TEST(NonblockingPacketReaderTest, PassesCommandBytesToListenerInPlace) {
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    Message sent;
+    sent.set_authtype(com::seagate::kinetic::client::proto::Message_AuthType_HMACAUTH);
+    sent.mutable_hmacauth()->set_identity(1);
+    sent.set_commandbytes("command");
+    string serialized_message;
+    ASSERT_TRUE(sent.SerializeToString(&serialized_message));
+    uint32_t message_length = htonl(serialized_message.size());
+    uint32_t value_length = htonl(5);
+    ASSERT_EQ(1, write(fds[1], "F", 1));
+    ASSERT_EQ(4, write(fds[1], &message_length, 4));
+    ASSERT_EQ(4, write(fds[1], &value_length, 4));
+    ASSERT_EQ(static_cast<ssize_t>(serialized_message.size()),
+        write(fds[1], serialized_message.data(), serialized_message.size()));
+    ASSERT_EQ(5, write(fds[1], "value", 5));
+    ASSERT_EQ(0, close(fds[1]));
+
+    Message message;
+    unique_ptr<const string> value;
+    RecordingMessageListener listener;
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    EXPECT_CALL(*socket_wrapper, fd()).WillRepeatedly(Return(fds[0]));
+    EXPECT_CALL(*socket_wrapper, getSSL()).WillRepeatedly(Return((SSL*) 0));
+    NonblockingPacketReader response(socket_wrapper, &message, value, &listener);
+    ASSERT_EQ(kDone, response.Read());
+    ASSERT_EQ("command", listener.command);
+    ASSERT_FALSE(listener.message_had_command_bytes);
+    ASSERT_EQ(1, message.hmacauth().identity());
+    ASSERT_EQ("value", *value);
+
+    ASSERT_EQ(0, close(fds[0]));
+}
+
+static void WritePacket(int fd, const string &command, const string &value) {
+    Message message;
+    message.set_commandbytes(command);
+    string serialized_message;
+    ASSERT_TRUE(message.SerializeToString(&serialized_message));
+    uint32_t message_length = htonl(serialized_message.size());
+    uint32_t value_length = htonl(value.size());
+    ASSERT_EQ(1, write(fd, "F", 1));
+    ASSERT_EQ(4, write(fd, &message_length, 4));
+    ASSERT_EQ(4, write(fd, &value_length, 4));
+    ASSERT_EQ(static_cast<ssize_t>(serialized_message.size()),
+        write(fd, serialized_message.data(), serialized_message.size()));
+    ASSERT_EQ(static_cast<ssize_t>(value.size()), write(fd, value.data(), value.size()));
+}
+
+// Has the first value it's offered written to a file
+class FileMessageListener : public PacketMessageListenerInterface {
+    public:
+    FileMessageListener(int fd, off_t offset) : fd_(fd), offset_(offset) {}
+    char *MessageReceived(const Message &message, const char *command_bytes,
+            size_t command_length, size_t value_size) {
+        return NULL;
+    }
+    int ValueFile(size_t value_size, off_t *offset) {
+        int fd = fd_;
+        fd_ = -1;
+        *offset = offset_;
+        return fd;
+    }
+
+    private:
+    int fd_;
+    off_t offset_;
+};
+
+static string ReadFile(int fd) {
+    string contents;
+    char buf[4096];
+    ssize_t n;
+    off_t offset = 0;
+    while ((n = pread(fd, buf, sizeof(buf), offset)) > 0) {
+        contents.append(buf, n);
+        offset += n;
+    }
+    return contents;
+}
+
+TEST(NonblockingPacketReaderTest, SplicesValueIntoFile) {
+    string big(300 * 1024, 'v');
+    for (size_t i = 0; i < big.size(); i += 3) {
+        big[i] = 'a' + (i % 26);
+    }
+    FILE *source = tmpfile();
+    ASSERT_TRUE(source != NULL);
+    WritePacket(fileno(source), "command0", big);
+    WritePacket(fileno(source), "command1", "small");
+    ASSERT_EQ(0, lseek(fileno(source), 0, SEEK_SET));
+    FILE *destination = tmpfile();
+    ASSERT_TRUE(destination != NULL);
+
+    Message message;
+    unique_ptr<const string> value;
+    FileMessageListener listener(fileno(destination), 10);
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    EXPECT_CALL(*socket_wrapper, fd()).WillRepeatedly(Return(fileno(source)));
+    EXPECT_CALL(*socket_wrapper, getSSL()).WillRepeatedly(Return((SSL*) 0));
+    NonblockingPacketReader response(socket_wrapper, &message, value, &listener);
+    ASSERT_EQ(kDone, response.Read());
+    ASSERT_EQ(0, response.value_file_error());
+    ASSERT_EQ("", *value);
+    ASSERT_TRUE(string(10, '\0') + big == ReadFile(fileno(destination)));
+    // The file is written at the given offset rather than its own position
+    ASSERT_EQ(0, lseek(fileno(destination), 0, SEEK_CUR));
+
+    ASSERT_EQ(kDone, response.Read());
+    ASSERT_EQ("small", *value);
+
+    ASSERT_EQ(0, fclose(source));
+    ASSERT_EQ(0, fclose(destination));
+}
+
+TEST(NonblockingPacketReaderTest, CopiesValueIntoFileThatCannotBeSplicedInto) {
+    // Appending files refuse splice, so this goes through the receive buffer instead
+    string big(200 * 1024, 'v');
+    for (size_t i = 0; i < big.size(); i += 3) {
+        big[i] = 'a' + (i % 26);
+    }
+    FILE *source = tmpfile();
+    ASSERT_TRUE(source != NULL);
+    WritePacket(fileno(source), "command0", big);
+    WritePacket(fileno(source), "command1", "small");
+    ASSERT_EQ(0, lseek(fileno(source), 0, SEEK_SET));
+    FILE *destination = tmpfile();
+    ASSERT_TRUE(destination != NULL);
+    ASSERT_EQ(3, write(fileno(destination), "abc", 3));
+    ASSERT_EQ(0, fcntl(fileno(destination), F_SETFL, O_APPEND));
+
+    Message message;
+    unique_ptr<const string> value;
+    FileMessageListener listener(fileno(destination), -1);
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    EXPECT_CALL(*socket_wrapper, fd()).WillRepeatedly(Return(fileno(source)));
+    EXPECT_CALL(*socket_wrapper, getSSL()).WillRepeatedly(Return((SSL*) 0));
+    NonblockingPacketReader response(socket_wrapper, &message, value, &listener);
+    ASSERT_EQ(kDone, response.Read());
+    ASSERT_EQ(0, response.value_file_error());
+    ASSERT_EQ("", *value);
+    ASSERT_TRUE("abc" + big == ReadFile(fileno(destination)));
+
+    ASSERT_EQ(kDone, response.Read());
+    ASSERT_EQ("small", *value);
+
+    ASSERT_EQ(0, fclose(source));
+    ASSERT_EQ(0, fclose(destination));
+}
+
+TEST(NonblockingPacketReaderTest, DropsValueWhenFileWriteFails) {
+    FILE *source = tmpfile();
+    ASSERT_TRUE(source != NULL);
+    WritePacket(fileno(source), "command0", string(200 * 1024, 'v'));
+    WritePacket(fileno(source), "command1", "small");
+    ASSERT_EQ(0, lseek(fileno(source), 0, SEEK_SET));
+    int read_only = open("/dev/null", O_RDONLY);
+    ASSERT_GE(read_only, 0);
+
+    Message message;
+    unique_ptr<const string> value;
+    FileMessageListener listener(read_only, -1);
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    EXPECT_CALL(*socket_wrapper, fd()).WillRepeatedly(Return(fileno(source)));
+    EXPECT_CALL(*socket_wrapper, getSSL()).WillRepeatedly(Return((SSL*) 0));
+    NonblockingPacketReader response(socket_wrapper, &message, value, &listener);
+    ASSERT_EQ(kDone, response.Read());
+    ASSERT_EQ(EBADF, response.value_file_error());
+
+    // The connection is still in step with the stream
+    ASSERT_EQ(kDone, response.Read());
+    ASSERT_EQ(0, response.value_file_error());
+    ASSERT_EQ("small", *value);
+
+    ASSERT_EQ(0, close(read_only));
+    ASSERT_EQ(0, fclose(source));
+}
+
 }// namespace kinetic
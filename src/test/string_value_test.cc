@@ -17,6 +17,8 @@
 
 #include "gtest/gtest.h"
 
+#include <errno.h>
+#include <stdio.h>
 #include <unistd.h>
 
 #include <string>
@@ -108,4 +110,56 @@ TEST(OutgoingStringValueTest, ToStringWorks) {
     ASSERT_EQ("abc", s);
 }
 
+TEST(OutgoingFileValueTest, TransferToSocketSendsPartOfFile) {
+    FILE *file = tmpfile();
+    ASSERT_TRUE(file != NULL);
+    ASSERT_EQ(10, write(fileno(file), "0123456789", 10));
+    OutgoingFileValue value(fileno(file), 2, 5);
+    ASSERT_EQ(5u, value.size());
+
+    int output_pipe[2];
+    int err;
+    ASSERT_EQ(0, pipe(output_pipe));
+    ASSERT_TRUE(value.TransferToSocket(output_pipe[1], &err));
+    char result[8];
+    ASSERT_EQ(5, read(output_pipe[0], result, sizeof(result)));
+    ASSERT_EQ("23456", std::string(result, 5));
+
+    ASSERT_EQ(0, close(output_pipe[0]));
+    ASSERT_EQ(0, close(output_pipe[1]));
+    ASSERT_EQ(0, fclose(file));
+}
+
+TEST(OutgoingFileValueTest, ToStringWorks) {
+    FILE *file = tmpfile();
+    ASSERT_TRUE(file != NULL);
+    ASSERT_EQ(10, write(fileno(file), "0123456789", 10));
+    OutgoingFileValue value(fileno(file), 7, 3);
+    std::string s;
+    int err;
+    ASSERT_TRUE(value.ToString(&s, &err));
+    ASSERT_EQ("789", s);
+    ASSERT_EQ(0, fclose(file));
+}
+
+TEST(OutgoingFileValueTest, FailsWhenFileIsTooShort) {
+    FILE *file = tmpfile();
+    ASSERT_TRUE(file != NULL);
+    ASSERT_EQ(3, write(fileno(file), "abc", 3));
+    OutgoingFileValue value(fileno(file), 0, 10);
+    std::string s;
+    int err = 0;
+    ASSERT_FALSE(value.ToString(&s, &err));
+    ASSERT_EQ(EIO, err);
+
+    int output_pipe[2];
+    ASSERT_EQ(0, pipe(output_pipe));
+    err = 0;
+    ASSERT_FALSE(value.TransferToSocket(output_pipe[1], &err));
+    ASSERT_EQ(EIO, err);
+    ASSERT_EQ(0, close(output_pipe[0]));
+    ASSERT_EQ(0, close(output_pipe[1]));
+    ASSERT_EQ(0, fclose(file));
+}
+
 } // namespace kinetic
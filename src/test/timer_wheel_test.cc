@@ -0,0 +1,104 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "kinetic/kinetic.h"
+#include "timer_wheel.h"
+
+namespace kinetic {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using std::chrono::milliseconds;
+
+class TimerWheelTest : public ::testing::Test {
+    protected:
+    TimerWheelTest() : start_(TimerWheel::Clock::now()), wheel_(start_) {}
+
+    vector<HandlerKey> AdvanceTo(int64_t ms) {
+        vector<HandlerKey> expired;
+        wheel_.Advance(start_ + milliseconds(ms), &expired);
+        return expired;
+    }
+
+    TimerWheel::Clock::time_point start_;
+    TimerWheel wheel_;
+};
+
+TEST_F(TimerWheelTest, ExpiresTimersOnceTheirDeadlinePasses) {
+    wheel_.Add(1, start_ + milliseconds(5));
+    wheel_.Add(2, start_ + milliseconds(10));
+    wheel_.Add(3, start_ + milliseconds(10));
+    ASSERT_EQ(3u, wheel_.size());
+
+    ASSERT_THAT(AdvanceTo(4), IsEmpty());
+    ASSERT_THAT(AdvanceTo(5), ElementsAre(1));
+    ASSERT_THAT(AdvanceTo(100), ElementsAre(2, 3));
+    ASSERT_TRUE(wheel_.empty());
+}
+
+TEST_F(TimerWheelTest, TimersAlreadyDueExpireOnNextAdvance) {
+    AdvanceTo(50);
+    wheel_.Add(1, start_ + milliseconds(20));
+    wheel_.Add(2, start_ - milliseconds(20));
+    ASSERT_EQ(0, wheel_.NextTimeout(start_ + milliseconds(50)));
+    ASSERT_THAT(AdvanceTo(50), ElementsAre(1, 2));
+    ASSERT_TRUE(wheel_.empty());
+}
+
+TEST_F(TimerWheelTest, CascadesTimersFromCoarserLevelsOnSchedule) {
+    // One deadline for each level, and one beyond the reach of the wheel
+    const int64_t deadlines[] = {40, 3000, 200000, 10000000, 20000000};
+    for (HandlerKey key = 0; key < 5; key++) {
+        wheel_.Add(key, start_ + milliseconds(deadlines[key]));
+    }
+    for (HandlerKey key = 0; key < 5; key++) {
+        ASSERT_THAT(AdvanceTo(deadlines[key] - 1), IsEmpty()) << "timer " << key;
+        ASSERT_THAT(AdvanceTo(deadlines[key]), ElementsAre(key)) << "timer " << key;
+    }
+    ASSERT_TRUE(wheel_.empty());
+}
+
+TEST_F(TimerWheelTest, NextTimeoutIsNeverLaterThanEarliestDeadline) {
+    ASSERT_EQ(-1, wheel_.NextTimeout(start_));
+
+    wheel_.Add(1, start_ + milliseconds(30));
+    ASSERT_EQ(30, wheel_.NextTimeout(start_));
+
+    wheel_.Add(2, start_ + milliseconds(10));
+    ASSERT_EQ(10, wheel_.NextTimeout(start_));
+    ASSERT_EQ(4, wheel_.NextTimeout(start_ + milliseconds(6)));
+
+    // Following the timeouts reaches each deadline, even when a coarser slot has to be
+    // cascaded first
+    wheel_.Add(3, start_ + milliseconds(5000));
+    vector<HandlerKey> expired;
+    TimerWheel::Clock::time_point now = start_;
+    int wakeups = 0;
+    while (!wheel_.empty()) {
+        int timeout = wheel_.NextTimeout(now);
+        ASSERT_GE(timeout, 0);
+        now += milliseconds(timeout);
+        wheel_.Advance(now, &expired);
+        ASSERT_LT(++wakeups, 100);
+    }
+    ASSERT_THAT(expired, ElementsAre(2, 1, 3));
+    ASSERT_EQ(start_ + milliseconds(5000), now);
+}
+
+} // namespace kinetic
@@ -0,0 +1,64 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#include "gtest/gtest.h"
+
+#include "kinetic/value_buffer.h"
+
+namespace kinetic {
+
+using std::make_shared;
+
+TEST(ValueBufferPoolTest, RoundsUpToSizeClass) {
+    ValueBufferPool pool;
+    ASSERT_EQ(ValueBufferPool::kMinBufferSize, pool.Lease(1)->capacity());
+    ASSERT_EQ(8192u, pool.Lease(4097)->capacity());
+    ASSERT_EQ(1024u * 1024u, pool.Lease(1024 * 1024)->capacity());
+}
+
+TEST(ValueBufferPoolTest, ReusesReleasedBuffers) {
+    ValueBufferPool pool;
+    auto buffer = pool.Lease(5000);
+    char *data = buffer->data();
+    buffer.reset();
+
+    // Any size in the same class gets the released memory back
+    auto reused = pool.Lease(6000);
+    ASSERT_EQ(data, reused->data());
+    ASSERT_EQ(0u, reused->size());
+}
+
+TEST(ValueBufferPoolTest, LeaseCanOutlivePool) {
+    std::shared_ptr<ValueBuffer> buffer;
+    {
+        ValueBufferPool pool;
+        buffer = pool.Lease(10);
+    }
+    buffer->data()[0] = 'x';
+    buffer->set_size(1);
+    ASSERT_EQ("x", buffer->ToString());
+}
+
+TEST(ValueBufferTest, WrapsCallerMemory) {
+    char memory[8];
+    ValueBuffer buffer(memory, sizeof(memory));
+    ASSERT_EQ(memory, buffer.data());
+    ASSERT_EQ(sizeof(memory), buffer.capacity());
+    ASSERT_EQ(0u, buffer.size());
+}
+
+}  // namespace kinetic
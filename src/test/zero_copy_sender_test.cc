@@ -0,0 +1,169 @@
+/**
+ * Copyright 2013-2015 Seagate Technology LLC.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla
+ * Public License, v. 2.0. If a copy of the MPL was not
+ * distributed with this file, You can obtain one at
+ * https://mozilla.org/MP:/2.0/.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but is provided AS-IS, WITHOUT ANY WARRANTY; including without
+ * the implied warranty of MERCHANTABILITY, NON-INFRINGEMENT or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the Mozilla Public
+ * License for more details.
+ *
+ * See www.openkinetic.org for more project information
+ */
+
+#ifdef __linux__
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "kinetic/kinetic.h"
+#include "mock_socket_wrapper_interface.h"
+#include "nonblocking_packet.h"
+#include "zero_copy_sender.h"
+
+namespace kinetic {
+
+using std::make_shared;
+using ::testing::Return;
+
+class ZeroCopySenderTest : public ::testing::Test {
+    protected:
+    // Zero-copy sends need a real TCP connection
+    void SetUp() {
+        int listener = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_NE(-1, listener);
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        ASSERT_EQ(0, bind(listener, reinterpret_cast<struct sockaddr *>(&address), length));
+        ASSERT_EQ(0, listen(listener, 1));
+        ASSERT_EQ(0, getsockname(listener, reinterpret_cast<struct sockaddr *>(&address), &length));
+        sender_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_EQ(0, connect(sender_fd_, reinterpret_cast<struct sockaddr *>(&address), length));
+        receiver_fd_ = accept(listener, NULL, NULL);
+        ASSERT_NE(-1, receiver_fd_);
+        ASSERT_EQ(0, close(listener));
+        ASSERT_EQ(0, fcntl(sender_fd_, F_SETFL, O_NONBLOCK));
+        ASSERT_EQ(0, fcntl(receiver_fd_, F_SETFL, O_NONBLOCK));
+        ASSERT_TRUE(ZeroCopySender::Enable(sender_fd_));
+    }
+
+    void TearDown() {
+        close(sender_fd_);
+        close(receiver_fd_);
+    }
+
+    // Reads whatever has arrived so far
+    void Drain(string *received) {
+        char buf[64 * 1024];
+        ssize_t n;
+        while ((n = read(receiver_fd_, buf, sizeof(buf))) > 0) {
+            received->append(buf, n);
+        }
+    }
+
+    // Waits for the kernel to be done with every send
+    void ReapAll(ZeroCopySender *sender) {
+        for (int i = 0; i < 100 && sender->outstanding() > 0; i++) {
+            struct pollfd pfd = { sender_fd_, 0, 0 };
+            poll(&pfd, 1, 10);
+            sender->ReapCompletions();
+        }
+    }
+
+    int sender_fd_;
+    int receiver_fd_;
+};
+
+TEST_F(ZeroCopySenderTest, KeepsValueAliveUntilNotified) {
+    ZeroCopySender sender(sender_fd_, 1);
+    shared_ptr<const string> value = make_shared<string>(256 * 1024, 'z');
+    string received;
+    size_t sent = 0;
+    while (sent < value->size()) {
+        struct iovec iov = { const_cast<char *>(value->data() + sent), value->size() - sent };
+        ssize_t n = sender.Send(&iov, 1, value);
+        if (n < 0) {
+            ASSERT_EQ(EAGAIN, errno);
+            Drain(&received);
+            continue;
+        }
+        sent += n;
+    }
+    ASSERT_GT(sender.outstanding(), 0u);
+    ASSERT_GT(value.use_count(), 1);
+
+    while (received.size() < value->size()) {
+        Drain(&received);
+    }
+    ASSERT_TRUE(*value == received);
+    ReapAll(&sender);
+    ASSERT_EQ(0u, sender.outstanding());
+    ASSERT_EQ(1, value.use_count());
+}
+
+TEST_F(ZeroCopySenderTest, PacketWriterSendsLargeValuesWithoutCopying) {
+    ZeroCopySender sender(sender_fd_, 64 * 1024);
+    auto socket_wrapper = make_shared<MockSocketWrapperInterface>();
+    EXPECT_CALL(*socket_wrapper, fd()).WillRepeatedly(Return(sender_fd_));
+    EXPECT_CALL(*socket_wrapper, getSSL()).WillRepeatedly(Return((SSL*) 0));
+    EXPECT_CALL(*socket_wrapper, descriptor_type()).WillRepeatedly(Return(kTcpSocket));
+    socket_wrapper->zero_copy_ = &sender;
+
+    string values[] = { "small", string(512 * 1024, 'v'), "last" };
+    shared_ptr<const string> large_value = make_shared<string>(values[1]);
+    NonblockingPacketWriter writer(socket_wrapper, unique_ptr<Message>(new Message()),
+        make_shared<string>(values[0]));
+    writer.Append(unique_ptr<Message>(new Message()), large_value);
+    writer.Append(unique_ptr<Message>(new Message()), make_shared<string>(values[2]));
+
+    string received;
+    int done = 0;
+    while (done < 3) {
+        NonblockingStringStatus status = writer.Write();
+        if (status == kDone) {
+            done++;
+        } else {
+            ASSERT_EQ(kInProgress, status);
+            Drain(&received);
+        }
+    }
+    // Only the large value went out as zero-copy sends
+    ASSERT_GT(sender.outstanding(), 0u);
+    ASSERT_GT(large_value.use_count(), 1);
+
+    size_t expected_size = 0;
+    for (int i = 0; i < 3; i++) {
+        expected_size += 9 + values[i].size();
+    }
+    while (received.size() < expected_size) {
+        Drain(&received);
+    }
+    ASSERT_EQ(expected_size, received.size());
+    size_t offset = 0;
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ('F', received[offset]);
+        ASSERT_EQ(0u, ntohl(*reinterpret_cast<const uint32_t *>(received.data() + offset + 1)));
+        ASSERT_EQ(values[i].size(), ntohl(*reinterpret_cast<const uint32_t *>(received.data() + offset + 5)));
+        ASSERT_TRUE(values[i] == received.substr(offset + 9, values[i].size()));
+        offset += 9 + values[i].size();
+    }
+    ReapAll(&sender);
+    ASSERT_EQ(0u, sender.outstanding());
+}
+
+}  // namespace kinetic
+
+#endif  // __linux__